@@ -0,0 +1,275 @@
+#include "twitter-test-main.h"
+#include "twitter-test-server.h"
+
+#include <string.h>
+
+static const gchar *pool_statuses[] = {
+  "{ \"id\":1, \"text\":\"first\","
+  "  \"user\":{ \"id\":11, \"screen_name\":\"one\" } }",
+  "{ \"id\":2, \"text\":\"second\","
+  "  \"user\":{ \"id\":12, \"screen_name\":\"two\" } }",
+  "{ \"id\":3, \"text\":\"third\","
+  "  \"user\":{ \"id\":13, \"screen_name\":\"three\" } }"
+};
+
+/* the same user, before and after changing their screen name */
+static const gchar *pool_timelines[] = {
+  "[ { \"id\":4, \"text\":\"fourth\","
+  "    \"user\":{ \"id\":11, \"screen_name\":\"one\" } },"
+  "  { \"id\":5, \"text\":\"fifth\","
+  "    \"user\":{ \"id\":11, \"screen_name\":\"one\" } } ]",
+  "[ { \"id\":6, \"text\":\"sixth\","
+  "    \"user\":{ \"id\":11, \"screen_name\":\"uno\" } } ]"
+};
+
+static TwitterTestServer *
+pool_server_new (void)
+{
+  TwitterTestServer *server;
+  guint i;
+
+  server = twitter_test_server_new ();
+
+  for (i = 0; i < G_N_ELEMENTS (pool_statuses); i++)
+    {
+      gchar *path = g_strdup_printf ("/statuses/show/%u.json", i + 1);
+
+      twitter_test_server_add (server, path, NULL,
+                               pool_statuses[i],
+                               strlen (pool_statuses[i]));
+      g_free (path);
+    }
+
+  twitter_test_server_add (server, "/statuses/user_timeline/one.json", NULL,
+                           pool_timelines[0],
+                           strlen (pool_timelines[0]));
+  twitter_test_server_add (server, "/statuses/user_timeline/uno.json", NULL,
+                           pool_timelines[1],
+                           strlen (pool_timelines[1]));
+
+  return server;
+}
+
+static void
+fetch_status (TwitterClient *client,
+              guint          status_id)
+{
+  TwitterStatus *status;
+  GError *error = NULL;
+
+  status = twitter_test_get_status (client, status_id, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (twitter_status_get_id (status), ==, status_id);
+  g_object_unref (status);
+}
+
+void
+test_client_pool_session (void)
+{
+  TwitterTestServer *server;
+  TwitterClientPool *pool;
+  TwitterClient *one, *two;
+  SoupSession *session_one, *session_two;
+
+  server = pool_server_new ();
+  pool = twitter_client_pool_new_full (TWITTER_CUSTOM_PROVIDER,
+                                       twitter_test_server_get_url (server));
+
+  one = twitter_client_pool_add_account (pool, "one@example.com", "one");
+  two = twitter_client_pool_add_account (pool, "two@example.com", "two");
+  g_assert (one != two);
+  g_assert (twitter_client_pool_add_account (pool, "one@example.com", "1") == one);
+  g_assert_cmpint (twitter_client_pool_get_n_clients (pool), ==, 2);
+
+  g_object_get (G_OBJECT (one), "session", &session_one, NULL);
+  g_object_get (G_OBJECT (two), "session", &session_two, NULL);
+  g_assert (session_one != NULL);
+  g_assert (session_one == session_two);
+  g_object_unref (session_one);
+  g_object_unref (session_two);
+
+  /* both accounts go through the shared session */
+  fetch_status (one, 1);
+  fetch_status (two, 2);
+  g_assert_cmpint (twitter_test_server_get_requests (server), ==, 2);
+
+  g_object_unref (pool);
+  twitter_test_server_free (server);
+}
+
+void
+test_client_pool_users (void)
+{
+  TwitterTestServer *server;
+  TwitterClientPool *pool;
+  TwitterClient *one, *two;
+  TwitterUser *user;
+
+  server = pool_server_new ();
+  pool = twitter_client_pool_new_full (TWITTER_CUSTOM_PROVIDER,
+                                       twitter_test_server_get_url (server));
+
+  one = twitter_client_pool_add_account (pool, "one@example.com", "one");
+  two = twitter_client_pool_add_account (pool, "two@example.com", "two");
+
+  /* the users received by any account are shared */
+  fetch_status (one, 1);
+  fetch_status (two, 2);
+
+  user = twitter_client_pool_lookup_user (pool, 11);
+  g_assert (user != NULL);
+  g_assert_cmpstr (twitter_user_get_screen_name (user), ==, "one");
+
+  user = twitter_client_pool_lookup_user (pool, 12);
+  g_assert (user != NULL);
+  g_assert_cmpstr (twitter_user_get_screen_name (user), ==, "two");
+
+  /* the least recently used user is released first */
+  g_object_set (G_OBJECT (pool), "max-users", 2, NULL);
+  fetch_status (one, 3);
+
+  g_assert (twitter_client_pool_lookup_user (pool, 11) == NULL);
+  g_assert (twitter_client_pool_lookup_user (pool, 12) != NULL);
+  g_assert (twitter_client_pool_lookup_user (pool, 13) != NULL);
+
+  g_object_set (G_OBJECT (pool), "max-users", 1, NULL);
+  g_assert (twitter_client_pool_lookup_user (pool, 12) == NULL);
+  g_assert (twitter_client_pool_lookup_user (pool, 13) != NULL);
+
+  g_object_unref (pool);
+  twitter_test_server_free (server);
+}
+
+static TwitterTimeline *
+fetch_timeline (TwitterClient *client,
+                const gchar   *user)
+{
+  TwitterTimeline *timeline;
+  GError *error = NULL;
+
+  timeline = twitter_test_get_user_timeline (client, user, &error);
+  g_assert_no_error (error);
+
+  return timeline;
+}
+
+static void
+user_changed_cb (TwitterUser *user,
+                 guint       *n_changed)
+{
+  *n_changed += 1;
+}
+
+void
+test_client_pool_shared_users (void)
+{
+  TwitterTestServer *server;
+  TwitterClientPool *pool;
+  TwitterClient *one, *two;
+  TwitterTimeline *first, *second;
+  TwitterUser *user;
+  guint n_changed = 0;
+
+  server = pool_server_new ();
+  pool = twitter_client_pool_new_full (TWITTER_CUSTOM_PROVIDER,
+                                       twitter_test_server_get_url (server));
+
+  one = twitter_client_pool_add_account (pool, "one@example.com", "one");
+  two = twitter_client_pool_add_account (pool, "two@example.com", "two");
+
+  /* the statuses of a timeline reference the cached user */
+  first = fetch_timeline (one, "one");
+  g_assert_cmpint (twitter_timeline_get_count (first), ==, 2);
+
+  user = twitter_client_pool_lookup_user (pool, 11);
+  g_assert (user != NULL);
+  g_assert (twitter_status_get_user (twitter_timeline_get_id (first, 4)) == user);
+  g_assert (twitter_status_get_user (twitter_timeline_get_id (first, 5)) == user);
+
+  g_signal_connect (user, "changed", G_CALLBACK (user_changed_cb), &n_changed);
+
+  /* and so do the ones received by another account, which refresh
+   * the shared instance
+   */
+  second = fetch_timeline (two, "uno");
+  g_assert (twitter_status_get_user (twitter_timeline_get_id (second, 6)) == user);
+  g_assert (twitter_client_pool_lookup_user (pool, 11) == user);
+  g_assert_cmpstr (twitter_user_get_screen_name (user), ==, "uno");
+  g_assert_cmpint (n_changed, ==, 1);
+
+  g_signal_handlers_disconnect_by_func (user, user_changed_cb, &n_changed);
+
+  g_object_unref (first);
+  g_object_unref (second);
+  g_object_unref (pool);
+  twitter_test_server_free (server);
+}
+
+void
+test_client_pool_authenticate (void)
+{
+  TwitterTestServer *server;
+  TwitterClientPool *pool;
+  TwitterClient *one, *two;
+  SoupSession *session;
+  guint signal_id, n_handlers;
+
+  server = pool_server_new ();
+  pool = twitter_client_pool_new_full (TWITTER_CUSTOM_PROVIDER,
+                                       twitter_test_server_get_url (server));
+
+  one = twitter_client_pool_add_account (pool, "one@example.com", "one");
+  two = twitter_client_pool_add_account (pool, "two@example.com", "two");
+
+  /* both accounts send authenticated requests */
+  g_object_unref (fetch_timeline (one, "one"));
+  g_object_unref (fetch_timeline (two, "uno"));
+
+  /* but the shared session has a single handler for the challenges */
+  g_object_get (G_OBJECT (one), "session", &session, NULL);
+  signal_id = g_signal_lookup ("authenticate", SOUP_TYPE_SESSION);
+  n_handlers = g_signal_handlers_block_matched (session,
+                                                G_SIGNAL_MATCH_ID,
+                                                signal_id, 0,
+                                                NULL, NULL, NULL);
+  g_signal_handlers_unblock_matched (session, G_SIGNAL_MATCH_ID,
+                                     signal_id, 0,
+                                     NULL, NULL, NULL);
+  g_assert_cmpuint (n_handlers, ==, 1);
+
+  g_object_unref (session);
+  g_object_unref (pool);
+  twitter_test_server_free (server);
+}
+
+void
+test_client_pool_remove (void)
+{
+  TwitterTestServer *server;
+  TwitterClientPool *pool;
+  TwitterClient *client;
+
+  server = pool_server_new ();
+  pool = twitter_client_pool_new_full (TWITTER_CUSTOM_PROVIDER,
+                                       twitter_test_server_get_url (server));
+
+  client = twitter_client_pool_add_account (pool, "one@example.com", "one");
+  twitter_client_pool_add_account (pool, "two@example.com", "two");
+
+  g_object_ref (client);
+  g_assert (twitter_client_pool_remove_account (pool, "one@example.com"));
+  g_assert (!twitter_client_pool_remove_account (pool, "one@example.com"));
+  g_assert (twitter_client_pool_get_client (pool, "one@example.com") == NULL);
+  g_assert_cmpint (twitter_client_pool_get_n_clients (pool), ==, 1);
+
+  /* a removed client keeps working, outside of the pool */
+  fetch_status (client, 1);
+  g_assert (twitter_client_pool_lookup_user (pool, 11) == NULL);
+
+  /* and outlives the pool */
+  g_object_unref (pool);
+  fetch_status (client, 2);
+
+  g_object_unref (client);
+  twitter_test_server_free (server);
+}
@@ -0,0 +1,645 @@
+#include "twitter-test-main.h"
+#include "twitter-test-server.h"
+
+#include <string.h>
+#include <unistd.h>
+#include <glib/gstdio.h>
+
+static const gchar client_status[] =
+"{"
+"  \"id\":42,"
+"  \"text\":\"testing compressed responses\","
+"  \"created_at\":\"Sat May 09 10:08:10 +0000 2009\","
+"  \"user\":{ \"id\":1, \"screen_name\":\"one\" }"
+"}";
+
+static const gchar client_page[] =
+"["
+"  {"
+"    \"text\":\"caf\\u00e9 \\\"au lait\\\"\","
+"    \"id\":1745345412,"
+"    \"created_at\":\"Sat May 09 10:08:10 +0000 2009\","
+"    \"user\":{ \"id\":14296080, \"screen_name\":\"ebassi\" }"
+"  },"
+"  {"
+"    \"text\":\"which, I guess, it's exactly what will happen anyway\","
+"    \"id\":1745345411,"
+"    \"created_at\":\"Sat May 09 10:07:10 +0000 2009\","
+"    \"user\":{ \"id\":14296080, \"screen_name\":\"ebassi\" }"
+"  }"
+"]";
+
+/* the timelines of two users, and of the authenticated user */
+static const gchar client_timeline_one[] =
+"[ { \"id\":30, \"text\":\"from one\","
+"    \"user\":{ \"id\":1, \"screen_name\":\"one\" } } ]";
+
+static const gchar client_timeline_two[] =
+"[ { \"id\":20, \"text\":\"from two\","
+"    \"user\":{ \"id\":2, \"screen_name\":\"two\" } } ]";
+
+static const gchar client_timeline_own[] =
+"[ { \"id\":10, \"text\":\"from user\","
+"    \"user\":{ \"id\":3, \"screen_name\":\"user\" } } ]";
+
+static TwitterClient *
+client_new_for_server (TwitterTestServer *server)
+{
+  return twitter_client_new_full (TWITTER_CUSTOM_PROVIDER,
+                                  twitter_test_server_get_url (server),
+                                  "user",
+                                  "password");
+}
+
+void
+test_client_compression (void)
+{
+  TwitterTestServer *server;
+  TwitterClient *client;
+  TwitterStatus *status;
+  GError *error;
+  guint64 wire_bytes, decoded_bytes;
+  gchar *data;
+  gsize length;
+
+  server = twitter_test_server_new ();
+  client = client_new_for_server (server);
+  twitter_client_set_compression (client, TRUE);
+
+  data = twitter_test_compress (client_status,
+                                G_ZLIB_COMPRESSOR_FORMAT_GZIP,
+                                &length);
+  twitter_test_server_add (server, "/statuses/show/42.json", "gzip",
+                           data, length);
+  g_free (data);
+
+  error = NULL;
+  status = twitter_test_get_status (client, 42, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (twitter_status_get_id (status), ==, 42);
+  g_assert_cmpstr (twitter_status_get_text (status), ==,
+                   "testing compressed responses");
+  g_object_unref (status);
+
+  twitter_client_get_transfer_stats (client, &wire_bytes, &decoded_bytes);
+  g_assert_cmpint (wire_bytes, ==, length);
+  g_assert_cmpint (decoded_bytes, ==, strlen (client_status));
+
+  data = twitter_test_compress (client_status,
+                                G_ZLIB_COMPRESSOR_FORMAT_ZLIB,
+                                &length);
+  twitter_test_server_add (server, "/statuses/show/42.json", "deflate",
+                           data, length);
+  g_free (data);
+
+  status = twitter_test_get_status (client, 42, &error);
+  g_assert_no_error (error);
+  g_assert_cmpstr (twitter_status_get_text (status), ==,
+                   "testing compressed responses");
+  g_object_unref (status);
+
+  g_object_unref (client);
+  twitter_test_server_free (server);
+}
+
+typedef struct {
+  gboolean done;
+
+  gulong handle;
+  GError *error;
+} SignalClosure;
+
+static void
+on_status_received (TwitterClient *client,
+                    gulong         handle,
+                    TwitterStatus *status,
+                    const GError  *error,
+                    gpointer       user_data)
+{
+  SignalClosure *closure = user_data;
+
+  g_assert_cmpint (handle, ==, closure->handle);
+
+  if (error != NULL)
+    closure->error = g_error_copy (error);
+
+  closure->done = TRUE;
+}
+
+void
+test_client_compression_errors (void)
+{
+  TwitterTestServer *server;
+  TwitterClient *client;
+  SignalClosure closure = { FALSE, 0, NULL };
+  GError *error;
+  gchar *data;
+  gsize length;
+
+  server = twitter_test_server_new ();
+  client = client_new_for_server (server);
+  twitter_client_set_compression (client, TRUE);
+
+  /* a truncated stream is only detected at the end of the body */
+  data = twitter_test_compress (client_status,
+                                G_ZLIB_COMPRESSOR_FORMAT_GZIP,
+                                &length);
+  twitter_test_server_add (server, "/statuses/show/42.json", "gzip",
+                           data, length / 2);
+
+  error = NULL;
+  g_assert (twitter_test_get_status (client, 42, &error) == NULL);
+  g_assert_error (error, TWITTER_ERROR, TWITTER_ERROR_PARSE_ERROR);
+  g_clear_error (&error);
+
+  /* the first deflate block of the stream uses the reserved type */
+  data[10] = (gchar) 0xff;
+  twitter_test_server_add (server, "/statuses/show/42.json", "gzip",
+                           data, length);
+  g_free (data);
+
+  g_assert (twitter_test_get_status (client, 42, &error) == NULL);
+  g_assert_error (error, TWITTER_ERROR, TWITTER_ERROR_PARSE_ERROR);
+  g_clear_error (&error);
+
+  /* the signal reports the error as well */
+  g_signal_connect (client, "status-received",
+                    G_CALLBACK (on_status_received),
+                    &closure);
+
+  closure.handle = twitter_client_get_status (client, 42);
+  twitter_test_run_until (&closure.done);
+  g_assert_error (closure.error, TWITTER_ERROR, TWITTER_ERROR_PARSE_ERROR);
+  g_error_free (closure.error);
+
+  g_object_unref (client);
+  twitter_test_server_free (server);
+}
+
+typedef struct {
+  gboolean done;
+
+  TwitterStatus *status;
+  GError *error;
+} CancelClosure;
+
+static void
+on_cancelled_ready (GObject      *source,
+                    GAsyncResult *result,
+                    gpointer      user_data)
+{
+  CancelClosure *closure = user_data;
+
+  closure->status =
+    twitter_client_get_status_finish (TWITTER_CLIENT (source), result,
+                                      &closure->error);
+  closure->done = TRUE;
+}
+
+static gpointer
+cancel_thread (gpointer data)
+{
+  g_cancellable_cancel (data);
+
+  return NULL;
+}
+
+void
+test_client_cancel (void)
+{
+  TwitterTestServer *server;
+  TwitterClient *client;
+  GCancellable *cancellable;
+  CancelClosure closure = { FALSE, NULL, NULL };
+  GThread *thread;
+  guint n_requests;
+
+  server = twitter_test_server_new ();
+  client = client_new_for_server (server);
+  twitter_test_server_add_paused (server, "/statuses/show/42.json");
+
+  /* cancelled before the request */
+  cancellable = g_cancellable_new ();
+  g_cancellable_cancel (cancellable);
+
+  twitter_client_get_status_async (client, 42, cancellable,
+                                   on_cancelled_ready,
+                                   &closure);
+  g_assert (!closure.done);
+
+  twitter_test_run_until (&closure.done);
+  g_assert (closure.status == NULL);
+  g_assert_error (closure.error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+  g_clear_error (&closure.error);
+  g_object_unref (cancellable);
+
+  /* cancelled while waiting for the response */
+  cancellable = g_cancellable_new ();
+  closure.done = FALSE;
+  n_requests = twitter_test_server_get_requests (server);
+
+  twitter_client_get_status_async (client, 42, cancellable,
+                                   on_cancelled_ready,
+                                   &closure);
+
+  while (twitter_test_server_get_requests (server) == n_requests)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_cancellable_cancel (cancellable);
+  g_assert (!closure.done);
+
+  twitter_test_run_until (&closure.done);
+  g_assert (closure.status == NULL);
+  g_assert_error (closure.error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+  g_clear_error (&closure.error);
+  g_object_unref (cancellable);
+
+  /* cancelled from another thread: the message is cancelled inside
+   * the context of the session
+   */
+  cancellable = g_cancellable_new ();
+  closure.done = FALSE;
+  n_requests = twitter_test_server_get_requests (server);
+
+  twitter_client_get_status_async (client, 42, cancellable,
+                                   on_cancelled_ready,
+                                   &closure);
+
+  while (twitter_test_server_get_requests (server) == n_requests)
+    g_main_context_iteration (NULL, TRUE);
+
+  thread = g_thread_create (cancel_thread, cancellable, TRUE, NULL);
+  g_thread_join (thread);
+  g_assert (!closure.done);
+
+  twitter_test_run_until (&closure.done);
+  g_assert (closure.status == NULL);
+  g_assert_error (closure.error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+  g_clear_error (&closure.error);
+  g_object_unref (cancellable);
+
+  g_object_unref (client);
+  twitter_test_server_free (server);
+}
+
+void
+test_client_result_ownership (void)
+{
+  TwitterTestServer *server;
+  TwitterClient *client;
+  TwitterStatus *status;
+  GError *error = NULL;
+
+  server = twitter_test_server_new ();
+  client = client_new_for_server (server);
+  twitter_test_server_add (server, "/statuses/show/42.json", NULL,
+                           client_status, strlen (client_status));
+
+  /* the caller owns the returned status */
+  status = twitter_test_get_status (client, 42, &error);
+  g_assert_no_error (error);
+  g_assert (!g_object_is_floating (status));
+
+  g_object_add_weak_pointer (G_OBJECT (status), (gpointer *) &status);
+  g_object_unref (status);
+  g_assert (status == NULL);
+
+  g_object_unref (client);
+  twitter_test_server_free (server);
+}
+
+typedef struct {
+  gboolean done;
+
+  GMainContext *context;
+  GThread *thread;
+  gboolean in_context;
+
+  GAsyncResult *result;
+} WorkerClosure;
+
+static void
+on_worker_ready (GObject      *source,
+                 GAsyncResult *result,
+                 gpointer      user_data)
+{
+  WorkerClosure *closure = user_data;
+
+  closure->in_context = g_thread_self () == closure->thread &&
+                        g_main_context_is_owner (closure->context);
+  closure->result = g_object_ref (result);
+  closure->done = TRUE;
+}
+
+void
+test_client_worker (void)
+{
+  TwitterTestServer *server;
+  TwitterClient *client;
+  TwitterStatus *status;
+  WorkerClosure closure = { FALSE, NULL, NULL, FALSE, NULL };
+  GError *error = NULL;
+  guint64 wire_bytes, decoded_bytes;
+  gchar *data;
+  gsize length;
+
+  /* the results must be delivered in the context of the thread
+   * creating the client, and not in the default one
+   */
+  closure.context = g_main_context_new ();
+  closure.thread = g_thread_self ();
+  g_main_context_push_thread_default (closure.context);
+
+  server = twitter_test_server_new ();
+  client = g_object_new (TWITTER_TYPE_CLIENT,
+                         "provider", TWITTER_CUSTOM_PROVIDER,
+                         "base-url", twitter_test_server_get_url (server),
+                         "compression", TRUE,
+                         "use-thread", TRUE,
+                         NULL);
+
+  data = twitter_test_compress (client_status,
+                                G_ZLIB_COMPRESSOR_FORMAT_GZIP,
+                                &length);
+  twitter_test_server_add (server, "/statuses/show/42.json", "gzip",
+                           data, length);
+  g_free (data);
+
+  twitter_client_get_status_async (client, 42, NULL,
+                                   on_worker_ready,
+                                   &closure);
+  twitter_test_run_until (&closure.done);
+  g_assert (closure.in_context);
+
+  status = twitter_client_get_status_finish (client, closure.result, &error);
+  g_assert_no_error (error);
+  g_assert_cmpstr (twitter_status_get_text (status), ==,
+                   "testing compressed responses");
+  g_object_unref (status);
+  g_object_unref (closure.result);
+
+  /* the response was decoded inside the worker thread */
+  twitter_client_get_transfer_stats (client, &wire_bytes, &decoded_bytes);
+  g_assert_cmpint (wire_bytes, ==, length);
+  g_assert_cmpint (decoded_bytes, ==, strlen (client_status));
+
+  g_object_unref (client);
+  twitter_test_server_free (server);
+
+  g_main_context_pop_thread_default (closure.context);
+  g_main_context_unref (closure.context);
+}
+
+static void
+on_notify_count (GObject    *gobject,
+                 GParamSpec *pspec,
+                 gpointer    user_data)
+{
+  guint *count = user_data;
+
+  *count += 1;
+}
+
+void
+test_client_compression_property (void)
+{
+  TwitterClient *client;
+  guint n_notify = 0;
+
+  client = twitter_client_new ();
+  g_assert (twitter_client_get_compression (client));
+
+  g_signal_connect (client, "notify::compression",
+                    G_CALLBACK (on_notify_count),
+                    &n_notify);
+
+  /* the property goes through the setter */
+  g_object_set (G_OBJECT (client), "compression", FALSE, NULL);
+  g_assert (!twitter_client_get_compression (client));
+  g_assert_cmpint (n_notify, ==, 1);
+
+  /* setting the same value does not notify */
+  twitter_client_set_compression (client, FALSE);
+  g_assert_cmpint (n_notify, ==, 1);
+
+  twitter_client_set_compression (client, TRUE);
+  g_assert (twitter_client_get_compression (client));
+  g_assert_cmpint (n_notify, ==, 2);
+
+  g_object_unref (client);
+}
+
+static TwitterTimeline *
+fetch_user_timeline (TwitterClient *client,
+                     const gchar   *user)
+{
+  TwitterTimeline *timeline;
+  GError *error = NULL;
+
+  timeline = twitter_test_get_user_timeline (client, user, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (twitter_timeline_get_count (timeline), ==, 1);
+
+  return timeline;
+}
+
+void
+test_client_endpoints (void)
+{
+  TwitterTestServer *server;
+  TwitterClient *client;
+  TwitterTimeline *one, *two, *own, *endpoint;
+
+  server = twitter_test_server_new ();
+  twitter_test_server_add (server, "/statuses/user_timeline/one.json", NULL,
+                           client_timeline_one,
+                           strlen (client_timeline_one));
+  twitter_test_server_add (server, "/statuses/user_timeline/two.json", NULL,
+                           client_timeline_two,
+                           strlen (client_timeline_two));
+  twitter_test_server_add (server, "/statuses/user_timeline.json", NULL,
+                           client_timeline_own,
+                           strlen (client_timeline_own));
+
+  client = client_new_for_server (server);
+
+  /* the timelines of two users stay separate */
+  one = fetch_user_timeline (client, "one");
+  two = fetch_user_timeline (client, "two");
+
+  g_assert_cmpint (twitter_status_get_id (twitter_timeline_get_pos (one, 0)), ==, 30);
+  g_assert_cmpint (twitter_status_get_id (twitter_timeline_get_pos (two, 0)), ==, 20);
+  g_assert (twitter_timeline_get_id (one, 20) == NULL);
+  g_assert (twitter_timeline_get_id (two, 30) == NULL);
+
+  /* and neither is mixed with the timeline of the endpoint, which
+   * keeps the statuses of the authenticated user
+   */
+  endpoint = twitter_client_get_endpoint_timeline (client, TWITTER_ENDPOINT_USER_TIMELINE);
+  g_assert_cmpint (twitter_timeline_get_count (endpoint), ==, 0);
+  g_assert_cmpint (twitter_client_get_last_status_id (client, TWITTER_ENDPOINT_USER_TIMELINE), ==, 0);
+
+  own = fetch_user_timeline (client, NULL);
+  g_assert_cmpint (twitter_timeline_get_count (endpoint), ==, 1);
+  g_assert_cmpint (twitter_client_get_last_status_id (client, TWITTER_ENDPOINT_USER_TIMELINE), ==, 10);
+
+  g_object_unref (fetch_user_timeline (client, "one"));
+  g_assert_cmpint (twitter_timeline_get_count (endpoint), ==, 1);
+  g_assert_cmpint (twitter_client_get_last_status_id (client, TWITTER_ENDPOINT_USER_TIMELINE), ==, 10);
+
+  g_object_unref (one);
+  g_object_unref (two);
+  g_object_unref (own);
+  g_object_unref (client);
+  twitter_test_server_free (server);
+}
+
+static gchar *
+create_state_filename (void)
+{
+  gchar *filename;
+  gint fd;
+
+  filename = g_build_filename (g_get_tmp_dir (), "twitter-state-XXXXXX", NULL);
+
+  fd = g_mkstemp (filename);
+  g_assert (fd >= 0);
+  close (fd);
+
+  return filename;
+}
+
+/* stores the current time, moved by @offset seconds */
+static void
+set_state_time (GKeyFile    *key_file,
+                const gchar *key,
+                glong        offset)
+{
+  GTimeVal now;
+  gchar *value;
+
+  g_get_current_time (&now);
+
+  value = g_strdup_printf ("%ld", now.tv_sec + offset);
+  g_key_file_set_string (key_file, "Client", key, value);
+  g_free (value);
+}
+
+void
+test_client_state (void)
+{
+  TwitterClient *client;
+  TwitterTimeline *timeline;
+  GKeyFile *key_file;
+  GError *error = NULL;
+  gchar *filename, *binary, *encoded, *data;
+  gsize length;
+  gint limit, remaining;
+
+  filename = create_state_filename ();
+
+  /* the state of a previous run */
+  timeline = twitter_timeline_new_from_data (client_page);
+  binary = twitter_timeline_to_binary (timeline, &length);
+  encoded = g_base64_encode ((const guchar *) binary, length);
+  g_object_unref (timeline);
+  g_free (binary);
+
+  client = twitter_client_new ();
+
+  key_file = g_key_file_new ();
+  g_key_file_set_integer (key_file, "Client", "Version", 1);
+  g_key_file_set_string (key_file, "Client", "BaseURL",
+                         twitter_client_get_base_url (client));
+  g_key_file_set_integer (key_file, "Client", "RateLimit", 150);
+  g_key_file_set_integer (key_file, "Client", "RateLimitRemaining", 42);
+  set_state_time (key_file, "RateLimitReset", 600);
+  g_key_file_set_string (key_file, "Endpoint friends-timeline", "Timeline",
+                         encoded);
+
+  data = g_key_file_to_data (key_file, &length, NULL);
+  g_assert (g_file_set_contents (filename, data, length, NULL));
+  g_key_file_free (key_file);
+  g_free (encoded);
+  g_free (data);
+
+  g_assert (twitter_client_restore_state (client, filename, &error));
+  g_assert_no_error (error);
+
+  twitter_client_get_rate_limit (client, &limit, &remaining);
+  g_assert_cmpint (limit, ==, 150);
+  g_assert_cmpint (remaining, ==, 42);
+
+  timeline = twitter_client_get_endpoint_timeline (client, TWITTER_ENDPOINT_FRIENDS_TIMELINE);
+  g_assert_cmpint (twitter_timeline_get_count (timeline), ==, 2);
+  g_assert_cmpint (twitter_client_get_last_status_id (client, TWITTER_ENDPOINT_FRIENDS_TIMELINE), ==, 1745345412);
+  g_assert_cmpint (twitter_client_get_last_status_id (client, TWITTER_ENDPOINT_REPLIES), ==, 0);
+
+  /* saving and restoring again gives back the same state */
+  g_assert (twitter_client_save_state (client, filename, &error));
+  g_assert_no_error (error);
+  g_object_unref (client);
+
+  client = twitter_client_new ();
+  g_assert (twitter_client_restore_state (client, filename, &error));
+  g_assert_no_error (error);
+
+  timeline = twitter_client_get_endpoint_timeline (client, TWITTER_ENDPOINT_FRIENDS_TIMELINE);
+  g_assert_cmpint (twitter_timeline_get_count (timeline), ==, 2);
+  g_assert_cmpstr (twitter_status_get_text (twitter_timeline_get_pos (timeline, 1)), ==,
+                   "which, I guess, it's exactly what will happen anyway");
+  g_object_unref (client);
+
+  /* the rate limitation of an old state is dropped */
+  key_file = g_key_file_new ();
+  g_assert (g_key_file_load_from_file (key_file, filename, G_KEY_FILE_NONE, NULL));
+  g_key_file_remove_key (key_file, "Client", "RateLimitReset", NULL);
+  set_state_time (key_file, "RateLimitTime", -2 * 3600);
+
+  data = g_key_file_to_data (key_file, &length, NULL);
+  g_assert (g_file_set_contents (filename, data, length, NULL));
+  g_free (data);
+
+  client = twitter_client_new ();
+  g_assert (twitter_client_restore_state (client, filename, &error));
+  g_assert_no_error (error);
+
+  twitter_client_get_rate_limit (client, &limit, &remaining);
+  g_assert_cmpint (limit, ==, -1);
+  g_assert_cmpint (remaining, ==, -1);
+
+  timeline = twitter_client_get_endpoint_timeline (client, TWITTER_ENDPOINT_FRIENDS_TIMELINE);
+  g_assert_cmpint (twitter_timeline_get_count (timeline), ==, 2);
+  g_object_unref (client);
+
+  /* a broken timeline leaves the client untouched */
+  set_state_time (key_file, "RateLimitTime", 0);
+  g_key_file_set_string (key_file, "Endpoint replies", "Timeline", "AAAA");
+
+  data = g_key_file_to_data (key_file, &length, NULL);
+  g_assert (g_file_set_contents (filename, data, length, NULL));
+  g_key_file_free (key_file);
+  g_free (data);
+
+  client = twitter_client_new ();
+  g_assert (!twitter_client_restore_state (client, filename, &error));
+  g_assert_error (error, TWITTER_ERROR, TWITTER_ERROR_PARSE_ERROR);
+  g_clear_error (&error);
+
+  twitter_client_get_rate_limit (client, &limit, &remaining);
+  g_assert_cmpint (limit, ==, -1);
+
+  timeline = twitter_client_get_endpoint_timeline (client, TWITTER_ENDPOINT_FRIENDS_TIMELINE);
+  g_assert_cmpint (twitter_timeline_get_count (timeline), ==, 0);
+  g_object_unref (client);
+
+  /* the state of another provider is refused */
+  client = twitter_client_new_full (TWITTER_IDENTI_CA, NULL, NULL, NULL);
+  g_assert (!twitter_client_restore_state (client, filename, &error));
+  g_assert_error (error, TWITTER_ERROR, TWITTER_ERROR_FAILED);
+  g_clear_error (&error);
+  g_object_unref (client);
+
+  g_unlink (filename);
+  g_free (filename);
+}
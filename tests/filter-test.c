@@ -0,0 +1,96 @@
+#include "twitter-test-main.h"
+
+static const gchar filter_page[] =
+"["
+"  { \"id\":43, \"text\":\"GNOME 3 is out, thanks @ebassi!\","
+"    \"user\":{ \"id\":1, \"screen_name\":\"one\" } },"
+"  { \"id\":42, \"text\":\"gnomes in the garden\","
+"    \"user\":{ \"id\":2, \"screen_name\":\"two\" } },"
+"  { \"id\":41, \"text\":\"nothing to see\","
+"    \"user\":{ \"id\":3, \"screen_name\":\"Ebassi\" } }"
+"]";
+
+void
+test_filter_matches (void)
+{
+  const TwitterFilterMatch *matches;
+  TwitterTimeline *timeline;
+  TwitterFilter *filter;
+  TwitterStatus *status;
+  guint keyword, screen_name, n_matches;
+
+  filter = twitter_filter_new ();
+
+  keyword = twitter_filter_add_keyword (filter, "gnome");
+  screen_name = twitter_filter_add_screen_name (filter, "@EBassi");
+  g_assert_cmpint (twitter_filter_add_keyword (filter, "GNOME"), ==, keyword);
+  g_assert_cmpint (twitter_filter_get_n_patterns (filter), ==, 2);
+
+  timeline = twitter_timeline_new_from_data (filter_page);
+
+  status = twitter_timeline_get_id (timeline, 43);
+  g_assert (twitter_filter_match_status (filter, status));
+  matches = twitter_filter_get_matches (filter, status, &n_matches);
+  g_assert_cmpint (n_matches, ==, 2);
+  g_assert_cmpint (matches[0].pattern_id, ==, keyword);
+  g_assert_cmpint (matches[0].offset, ==, 0);
+  g_assert_cmpint (matches[0].length, ==, 5);
+  g_assert_cmpint (matches[1].pattern_id, ==, screen_name);
+  g_assert_cmpint (matches[1].offset, ==, 23);
+  g_assert_cmpint (matches[1].length, ==, 7);
+
+  /* keywords only match whole words */
+  status = twitter_timeline_get_id (timeline, 42);
+  g_assert (!twitter_filter_match_status (filter, status));
+  g_assert (twitter_filter_get_matches (filter, status, &n_matches) == NULL);
+  g_assert_cmpint (n_matches, ==, 0);
+
+  /* screen names also match the author */
+  status = twitter_timeline_get_id (timeline, 41);
+  g_assert (twitter_filter_match_status (filter, status));
+  matches = twitter_filter_get_matches (filter, status, &n_matches);
+  g_assert_cmpint (n_matches, ==, 1);
+  g_assert_cmpint (matches[0].pattern_id, ==, screen_name);
+  g_assert_cmpint (matches[0].offset, ==, -1);
+
+  g_object_unref (timeline);
+  g_object_unref (filter);
+}
+
+void
+test_filter_multiple (void)
+{
+  const TwitterFilterMatch *matches;
+  TwitterFilter *first, *second;
+  TwitterTimeline *timeline;
+  TwitterStatus *status;
+  guint keyword, n_matches;
+
+  first = twitter_filter_new ();
+  keyword = twitter_filter_add_keyword (first, "gnome");
+
+  second = twitter_filter_new ();
+  twitter_filter_add_keyword (second, "garden");
+
+  timeline = twitter_timeline_new_from_data (filter_page);
+  status = twitter_timeline_get_id (timeline, 43);
+
+  /* matching with another filter keeps the matches of the first */
+  g_assert (twitter_filter_match_status (first, status));
+  g_assert (!twitter_filter_match_status (second, status));
+
+  matches = twitter_filter_get_matches (first, status, &n_matches);
+  g_assert_cmpint (n_matches, ==, 1);
+  g_assert_cmpint (matches[0].pattern_id, ==, keyword);
+  g_assert (twitter_filter_get_matches (second, status, &n_matches) == NULL);
+  g_assert_cmpint (n_matches, ==, 0);
+
+  /* and a new filter does not see the matches of a released one */
+  g_object_unref (first);
+  first = twitter_filter_new ();
+  g_assert (twitter_filter_get_matches (first, status, &n_matches) == NULL);
+
+  g_object_unref (timeline);
+  g_object_unref (second);
+  g_object_unref (first);
+}
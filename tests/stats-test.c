@@ -0,0 +1,69 @@
+#include "twitter-test-main.h"
+
+static const gchar stats_page[] =
+"["
+"  { \"id\":63, \"text\":\"#GNOME #gnome rocks\","
+"    \"created_at\":\"Sat May 09 10:08:10 +0000 2009\","
+"    \"user\":{ \"id\":1, \"screen_name\":\"one\" } },"
+"  { \"id\":62, \"text\":\"#guadec and #GNOME\","
+"    \"created_at\":\"Sat May 09 10:07:10 +0000 2009\","
+"    \"user\":{ \"id\":2, \"screen_name\":\"two\" } },"
+"  { \"id\":61, \"text\":\"#guadec\","
+"    \"created_at\":\"Sat May 09 09:08:10 +0000 2009\","
+"    \"user\":{ \"id\":1, \"screen_name\":\"one\" } }"
+"]";
+
+void
+test_stats_aggregations (void)
+{
+  TwitterTimelineStats *stats;
+  TwitterHashtagCount *hashtags;
+  TwitterUserCount *users;
+  TwitterTimeline *timeline;
+  guint n_users, n_hashtags;
+  guint *buckets;
+
+  timeline = twitter_timeline_new_from_data (stats_page);
+
+  stats = twitter_timeline_stats_new ();
+  twitter_timeline_stats_add_timeline (stats, timeline);
+
+  /* the statuses already added are skipped */
+  twitter_timeline_stats_add_timeline (stats, timeline);
+  g_assert_cmpint (twitter_timeline_stats_get_count (stats), ==, 3);
+
+  users = twitter_timeline_stats_count_by_user (stats, 0, G_MAXINT64, &n_users);
+  g_assert_cmpint (n_users, ==, 2);
+  g_assert_cmpint (users[0].user_id, ==, 1);
+  g_assert_cmpint (users[0].count, ==, 2);
+  g_assert_cmpint (users[1].user_id, ==, 2);
+  g_assert_cmpint (users[1].count, ==, 1);
+  g_free (users);
+
+  /* hashtags are counted once per status, ignoring the case */
+  hashtags = twitter_timeline_stats_top_hashtags (stats, 0, G_MAXINT64, 0,
+                                                  &n_hashtags);
+  g_assert_cmpint (n_hashtags, ==, 2);
+  g_assert_cmpstr (hashtags[0].hashtag, ==, "gnome");
+  g_assert_cmpint (hashtags[0].count, ==, 2);
+  g_assert_cmpstr (hashtags[1].hashtag, ==, "guadec");
+  g_assert_cmpint (hashtags[1].count, ==, 2);
+  g_free (hashtags);
+
+  /* only the last hour */
+  hashtags = twitter_timeline_stats_top_hashtags (stats,
+                                                  1241863630, G_MAXINT64, 1,
+                                                  &n_hashtags);
+  g_assert_cmpint (n_hashtags, ==, 1);
+  g_assert_cmpstr (hashtags[0].hashtag, ==, "gnome");
+  g_free (hashtags);
+
+  buckets = twitter_timeline_stats_histogram (stats, 1241856000, 3600, 3);
+  g_assert_cmpint (buckets[0], ==, 0);
+  g_assert_cmpint (buckets[1], ==, 1);
+  g_assert_cmpint (buckets[2], ==, 2);
+  g_free (buckets);
+
+  g_object_unref (stats);
+  g_object_unref (timeline);
+}
@@ -0,0 +1,64 @@
+#include "twitter-test-main.h"
+
+static const gchar batch_page[] =
+"["
+"  { \"id\":63, \"text\":\"#GNOME #gnome rocks\","
+"    \"created_at\":\"Sat May 09 10:08:10 +0000 2009\","
+"    \"user\":{ \"id\":1, \"screen_name\":\"one\" } },"
+"  { \"id\":62, \"text\":\"#guadec and #GNOME\","
+"    \"created_at\":\"Sat May 09 10:07:10 +0000 2009\","
+"    \"user\":{ \"id\":2, \"screen_name\":\"two\" } },"
+"  { \"id\":61, \"text\":\"#guadec\","
+"    \"created_at\":\"Sat May 09 09:08:10 +0000 2009\","
+"    \"user\":{ \"id\":1, \"screen_name\":\"one\" } }"
+"]";
+
+void
+test_status_batch_columns (void)
+{
+  TwitterStatusBatch *batch;
+  TwitterStatus *status;
+  const guint *ids, *user_ids;
+  const gint64 *timestamps;
+  GError *error;
+
+  batch = twitter_status_batch_new ();
+
+  error = NULL;
+  twitter_status_batch_add_from_data (batch, batch_page, &error);
+  g_assert_no_error (error);
+  twitter_status_batch_add_from_data (batch,
+                                      "[ { \"id\":60, \"text\":\"no user\" } ]",
+                                      &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (twitter_status_batch_get_count (batch), ==, 4);
+
+  ids = twitter_status_batch_get_ids (batch);
+  user_ids = twitter_status_batch_get_user_ids (batch);
+  timestamps = twitter_status_batch_get_timestamps (batch);
+  g_assert_cmpint (ids[0], ==, 63);
+  g_assert_cmpint (ids[3], ==, 60);
+  g_assert_cmpint (user_ids[1], ==, 2);
+  g_assert_cmpint (user_ids[3], ==, 0);
+  g_assert_cmpint (timestamps[0], ==, 1241863690);
+  g_assert_cmpint (timestamps[3], ==, 0);
+  g_assert_cmpstr (twitter_status_batch_get_text (batch, 2), ==, "#guadec");
+
+  /* a broken page leaves the batch untouched */
+  g_assert (!twitter_status_batch_add_from_data (batch, "[ { \"id\":59 ", &error));
+  g_assert_error (error, TWITTER_ERROR, TWITTER_ERROR_PARSE_ERROR);
+  g_error_free (error);
+  g_assert_cmpint (twitter_status_batch_get_count (batch), ==, 4);
+
+  status = g_object_ref_sink (twitter_status_batch_get_status (batch, 1));
+  g_assert_cmpint (twitter_status_get_id (status), ==, 62);
+  g_assert_cmpstr (twitter_status_get_text (status), ==, "#guadec and #GNOME");
+  g_assert_cmpstr (twitter_user_get_screen_name (twitter_status_get_user (status)), ==, "two");
+  g_assert_cmpint (twitter_status_get_timestamp (status), ==, 1241863630);
+
+  /* the status does not depend on the batch */
+  g_object_unref (batch);
+  g_assert_cmpstr (twitter_status_get_created_at (status), ==,
+                   "Sat May 09 10:07:10 +0000 2009");
+  g_object_unref (status);
+}
@@ -0,0 +1,247 @@
+#include "twitter-test-main.h"
+
+static const gchar index_page[] =
+"["
+"  { \"id\":12, \"text\":\"c\", \"in_reply_to_status_id\":10,"
+"    \"created_at\":\"Sat May 09 12:00:00 +0000 2009\","
+"    \"user\":{ \"id\":1, \"screen_name\":\"one\" } },"
+"  { \"id\":11, \"text\":\"b\", \"in_reply_to_status_id\":10,"
+"    \"created_at\":\"Sat May 09 11:00:00 +0000 2009\","
+"    \"user\":{ \"id\":2, \"screen_name\":\"two\" } },"
+"  { \"id\":10, \"text\":\"a\","
+"    \"created_at\":\"Sat May 09 10:00:00 +0000 2009\","
+"    \"user\":{ \"id\":1, \"screen_name\":\"one\" } }"
+"]";
+
+static const gchar index_next_page[] =
+"["
+"  { \"id\":13, \"text\":\"d\", \"in_reply_to_status_id\":11,"
+"    \"created_at\":\"Sat May 09 13:00:00 +0000 2009\","
+"    \"user\":{ \"id\":1, \"screen_name\":\"one\" } },"
+"  { \"id\":12, \"text\":\"c\", \"in_reply_to_status_id\":10,"
+"    \"created_at\":\"Sat May 09 12:00:00 +0000 2009\","
+"    \"user\":{ \"id\":1, \"screen_name\":\"one\" } },"
+"  { \"id\":9, \"text\":\"z\","
+"    \"created_at\":\"Fri May 08 10:00:00 +0000 2009\","
+"    \"user\":{ \"id\":2, \"screen_name\":\"two\" } }"
+"]";
+
+static void
+assert_status_ids (GList       *statuses,
+                   const guint *ids,
+                   guint        n_ids)
+{
+  GList *l;
+  guint i;
+
+  g_assert_cmpint (g_list_length (statuses), ==, n_ids);
+
+  for (l = statuses, i = 0; l != NULL; l = l->next, i++)
+    g_assert_cmpint (twitter_status_get_id (l->data), ==, ids[i]);
+
+  g_list_free (statuses);
+}
+
+void
+test_status_index (void)
+{
+  static const guint by_user[] = { 13, 12, 10 };
+  static const guint replies[] = { 12, 11 };
+  static const guint range[] = { 12, 11 };
+  static const guint all[] = { 13, 12, 11, 10, 9 };
+  TwitterStatusIndex *status_index;
+  TwitterTimeline *timeline;
+
+  status_index = twitter_status_index_new ();
+
+  timeline = twitter_timeline_new_from_data (index_page);
+  twitter_status_index_add_timeline (status_index, timeline);
+  g_object_unref (timeline);
+
+  /* the statuses already indexed are skipped */
+  timeline = twitter_timeline_new_from_data (index_next_page);
+  twitter_status_index_add_timeline (status_index, timeline);
+  g_object_unref (timeline);
+
+  g_assert_cmpint (twitter_status_index_get_count (status_index), ==, 5);
+  g_assert (twitter_status_index_get_status (status_index, 11) != NULL);
+  g_assert (twitter_status_index_get_status (status_index, 14) == NULL);
+
+  assert_status_ids (twitter_status_index_get_by_user (status_index, 1),
+                     by_user, G_N_ELEMENTS (by_user));
+  assert_status_ids (twitter_status_index_get_replies (status_index, 10),
+                     replies, G_N_ELEMENTS (replies));
+  g_assert (twitter_status_index_get_replies (status_index, 12) == NULL);
+
+  /* from 11:00 to 13:00, excluded */
+  assert_status_ids (twitter_status_index_get_range (status_index,
+                                                     1241866800,
+                                                     1241874000),
+                     range, G_N_ELEMENTS (range));
+  assert_status_ids (twitter_status_index_get_range (status_index,
+                                                     0,
+                                                     G_MAXINT64),
+                     all, G_N_ELEMENTS (all));
+
+  g_object_unref (status_index);
+}
+
+static const gchar search_page[] =
+"["
+"  { \"id\":23, \"text\":\"See you at #GUADEC, @ebassi!\","
+"    \"user\":{ \"id\":1, \"screen_name\":\"one\" } },"
+"  { \"id\":22, \"text\":\"you see, guadec is in Gran Canaria\","
+"    \"user\":{ \"id\":2, \"screen_name\":\"two\" } },"
+"  { \"id\":21, \"text\":\"Flying to Berlin\","
+"    \"user\":{ \"id\":1, \"screen_name\":\"one\" } },"
+"  { \"id\":20, \"text\":\"See you soon\","
+"    \"user\":{ \"id\":2, \"screen_name\":\"two\" } }"
+"]";
+
+void
+test_status_index_search (void)
+{
+  static const guint guadec[] = { 23, 22 };
+  static const guint phrase[] = { 23, 20 };
+  static const guint alternatives[] = { 23, 21 };
+  static const guint mention[] = { 23 };
+  TwitterStatusIndex *status_index;
+  TwitterTimeline *timeline;
+
+  status_index = twitter_status_index_new ();
+
+  timeline = twitter_timeline_new_from_data (search_page);
+  twitter_status_index_add_timeline (status_index, timeline);
+  g_object_unref (timeline);
+
+  /* case and punctuation are ignored */
+  assert_status_ids (twitter_status_index_search (status_index, "guadec"),
+                     guadec, G_N_ELEMENTS (guadec));
+  assert_status_ids (twitter_status_index_search (status_index, "@EBASSI"),
+                     mention, G_N_ELEMENTS (mention));
+
+  /* the words of a phrase must be in sequence */
+  assert_status_ids (twitter_status_index_search (status_index, "\"see you\""),
+                     phrase, G_N_ELEMENTS (phrase));
+  assert_status_ids (twitter_status_index_search (status_index,
+                                                  "\"see you\" guadec OR berlin"),
+                     alternatives, G_N_ELEMENTS (alternatives));
+
+  g_assert (twitter_status_index_search (status_index, "see paris") == NULL);
+  g_assert (twitter_status_index_search (status_index, "") == NULL);
+
+  g_object_unref (status_index);
+}
+
+static const gchar mentions_page[] =
+"["
+"  { \"id\":52, \"text\":\"@EBassi @ebassi: #GUADEC http://www.gnome.org.\" },"
+"  { \"id\":51, \"text\":\"mail foo@ebassi.org, C# rocks\" },"
+"  { \"id\":50, \"text\":\"thanks, @ebassi!\" }"
+"]";
+
+void
+test_status_index_mentions (void)
+{
+  static const guint mentions[] = { 52, 50 };
+  TwitterStatusIndex *status_index;
+  TwitterTimeline *timeline;
+
+  timeline = twitter_timeline_new_from_data (mentions_page);
+
+  status_index = twitter_status_index_new ();
+  twitter_status_index_add_timeline (status_index, timeline);
+
+  assert_status_ids (twitter_status_index_get_mentions (status_index, "@ebassi"),
+                     mentions, G_N_ELEMENTS (mentions));
+  g_assert (twitter_status_index_get_mentions (status_index, "foo") == NULL);
+
+  g_object_unref (status_index);
+  g_object_unref (timeline);
+}
+
+/* a page of @n_statuses sharing the same words, newest first unless
+ * @oldest_first is set
+ */
+static gchar *
+build_search_page (guint    n_statuses,
+                   gboolean oldest_first)
+{
+  GString *buffer = g_string_new ("[");
+  guint i;
+
+  for (i = 0; i < n_statuses; i++)
+    {
+      guint status_id = oldest_first ? i + 1 : n_statuses - i;
+
+      if (i > 0)
+        g_string_append_c (buffer, ',');
+
+      g_string_append_printf (buffer,
+                              "{ \"id\":%u, \"text\":\"status %u about GNOME\" }",
+                              status_id, status_id);
+    }
+
+  g_string_append_c (buffer, ']');
+
+  return g_string_free (buffer, FALSE);
+}
+
+static gdouble
+time_add_timeline (const gchar *buffer,
+                   guint        n_statuses)
+{
+  TwitterStatusIndex *status_index;
+  TwitterTimeline *timeline;
+  GList *results;
+  GTimer *timer;
+  gdouble elapsed;
+
+  timeline = twitter_timeline_new ();
+  twitter_timeline_load_from_data (timeline, buffer, NULL);
+  g_assert_cmpint (twitter_timeline_get_count (timeline), ==, n_statuses);
+
+  status_index = twitter_status_index_new ();
+
+  timer = g_timer_new ();
+  twitter_status_index_add_timeline (status_index, timeline);
+  elapsed = g_timer_elapsed (timer, NULL);
+  g_timer_destroy (timer);
+
+  results = twitter_status_index_search (status_index, "about gnome");
+  g_assert_cmpint (g_list_length (results), ==, n_statuses);
+  g_assert_cmpint (twitter_status_get_id (results->data), ==, n_statuses);
+  g_list_free (results);
+
+  g_object_unref (status_index);
+  g_object_unref (timeline);
+
+  return elapsed;
+}
+
+void
+test_status_index_perf (void)
+{
+  const guint n_statuses = 3200;
+  gdouble oldest_first, newest_first;
+  gchar *buffer;
+
+  if (!g_test_perf ())
+    return;
+
+  buffer = build_search_page (n_statuses, TRUE);
+  oldest_first = time_add_timeline (buffer, n_statuses);
+  g_free (buffer);
+
+  /* the order of the timelines received from the provider */
+  buffer = build_search_page (n_statuses, FALSE);
+  newest_first = time_add_timeline (buffer, n_statuses);
+  g_free (buffer);
+
+  g_test_minimized_result (oldest_first,
+                           "oldest first, 3200 statuses: %.3f msecs",
+                           1000.0 * oldest_first);
+  g_test_minimized_result (newest_first,
+                           "newest first, 3200 statuses: %.3f msecs",
+                           1000.0 * newest_first);
+}
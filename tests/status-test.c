@@ -0,0 +1,41 @@
+#include "twitter-test-main.h"
+
+static const gchar entities_page[] =
+"["
+"  { \"id\":52, \"text\":\"@EBassi @ebassi: #GUADEC http://www.gnome.org.\" },"
+"  { \"id\":51, \"text\":\"mail foo@ebassi.org, C# rocks\" },"
+"  { \"id\":50, \"text\":\"thanks, @ebassi!\" }"
+"]";
+
+void
+test_status_entities (void)
+{
+  const TwitterEntity *entities;
+  TwitterTimeline *timeline;
+  TwitterStatus *status;
+  guint n_entities;
+
+  timeline = twitter_timeline_new_from_data (entities_page);
+
+  status = twitter_timeline_get_id (timeline, 52);
+  entities = twitter_status_get_entities (status, &n_entities);
+  g_assert_cmpint (n_entities, ==, 4);
+  g_assert_cmpint (entities[0].type, ==, TWITTER_ENTITY_MENTION);
+  g_assert_cmpint (entities[0].offset, ==, 0);
+  g_assert_cmpint (entities[0].length, ==, 7);
+  g_assert_cmpint (entities[2].type, ==, TWITTER_ENTITY_HASHTAG);
+  g_assert_cmpint (entities[2].offset, ==, 17);
+  g_assert_cmpint (entities[2].length, ==, 7);
+
+  /* the trailing punctuation is not part of the link */
+  g_assert_cmpint (entities[3].type, ==, TWITTER_ENTITY_URL);
+  g_assert_cmpint (entities[3].offset, ==, 25);
+  g_assert_cmpint (entities[3].length, ==, 20);
+
+  /* neither email addresses nor "C#" are entities */
+  status = twitter_timeline_get_id (timeline, 51);
+  g_assert (twitter_status_get_entities (status, &n_entities) == NULL);
+  g_assert_cmpint (n_entities, ==, 0);
+
+  g_object_unref (timeline);
+}
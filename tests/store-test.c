@@ -0,0 +1,245 @@
+#include "twitter-test-main.h"
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <glib/gstdio.h>
+
+#ifdef G_OS_UNIX
+#include <signal.h>
+#include <sys/resource.h>
+#endif
+
+static const gchar store_page[] =
+"["
+"  {"
+"    \"text\":\"caf\\u00e9 \\\"au lait\\\"\","
+"    \"truncated\":false,"
+"    \"in_reply_to_status_id\":1745345411,"
+"    \"in_reply_to_user_id\":14296080,"
+"    \"id\":1745345412,"
+"    \"source\":\"<a href=\\\"http:\\/\\/example.com\\\">web<\\/a>\","
+"    \"created_at\":\"Sat May 09 10:08:10 +0000 2009\","
+"    \"user\":{"
+"      \"screen_name\":\"ebassi\","
+"      \"name\":\"Emmanuele Bassi\","
+"      \"location\":\"London, United Kingdom\","
+"      \"followers_count\":397,"
+"      \"id\":14296080,"
+"      \"utc_offset\":-3600"
+"    }"
+"  },"
+"  {"
+"    \"text\":\"which, I guess, it's exactly what will happen anyway\","
+"    \"truncated\":true,"
+"    \"id\":1745345411,"
+"    \"source\":\"web\","
+"    \"created_at\":\"Sat May 09 10:07:10 +0000 2009\","
+"    \"user\":{"
+"      \"screen_name\":\"ebassi\","
+"      \"name\":\"Emmanuele Bassi\","
+"      \"location\":\"London, United Kingdom\","
+"      \"followers_count\":397,"
+"      \"id\":14296080,"
+"      \"utc_offset\":-3600"
+"    }"
+"  }"
+"]";
+
+static const gchar store_next_page[] =
+"["
+"  {"
+"    \"text\":\"a newer status\","
+"    \"id\":1745345413,"
+"    \"source\":\"web\","
+"    \"created_at\":\"Sat May 09 10:09:10 +0000 2009\","
+"    \"user\":{ \"screen_name\":\"ebassi\", \"id\":14296080 }"
+"  }"
+"]";
+
+static gchar *
+create_store_filename (void)
+{
+  gchar *filename;
+  gint fd;
+
+  filename = g_build_filename (g_get_tmp_dir (), "twitter-store-XXXXXX", NULL);
+
+  fd = g_mkstemp (filename);
+  g_assert (fd >= 0);
+  close (fd);
+
+  /* a missing file is an empty store */
+  g_unlink (filename);
+
+  return filename;
+}
+
+static void
+compare_stored_status (TwitterStatus *stored,
+                       TwitterStatus *status)
+{
+  TwitterUser *stored_user = twitter_status_get_user (stored);
+  TwitterUser *user = twitter_status_get_user (status);
+
+  g_assert_cmpint (twitter_status_get_id (stored), ==,
+                   twitter_status_get_id (status));
+  g_assert_cmpstr (twitter_status_get_text (stored), ==,
+                   twitter_status_get_text (status));
+  g_assert_cmpstr (twitter_status_get_source (stored), ==,
+                   twitter_status_get_source (status));
+  g_assert_cmpstr (twitter_status_get_created_at (stored), ==,
+                   twitter_status_get_created_at (status));
+  g_assert_cmpstr (twitter_status_get_url (stored), ==,
+                   twitter_status_get_url (status));
+  g_assert (twitter_status_get_truncated (stored) ==
+            twitter_status_get_truncated (status));
+  g_assert_cmpint (twitter_status_get_reply_to_status (stored), ==,
+                   twitter_status_get_reply_to_status (status));
+  g_assert (twitter_status_get_timestamp (stored) ==
+            twitter_status_get_timestamp (status));
+
+  g_assert_cmpint (twitter_user_get_id (stored_user), ==,
+                   twitter_user_get_id (user));
+  g_assert_cmpstr (twitter_user_get_screen_name (stored_user), ==,
+                   twitter_user_get_screen_name (user));
+  g_assert_cmpstr (twitter_user_get_name (stored_user), ==,
+                   twitter_user_get_name (user));
+  g_assert_cmpstr (twitter_user_get_location (stored_user), ==,
+                   twitter_user_get_location (user));
+  g_assert_cmpint (twitter_user_get_followers_count (stored_user), ==,
+                   twitter_user_get_followers_count (user));
+  g_assert_cmpint (twitter_user_get_utc_offset (stored_user), ==,
+                   twitter_user_get_utc_offset (user));
+}
+
+void
+test_store_timeline (void)
+{
+  TwitterTimeline *timeline, *stored;
+  TwitterStore *store;
+  GError *error = NULL;
+  gchar *filename;
+  GList *keys;
+  FILE *file;
+  guint i;
+
+  filename = create_store_filename ();
+  timeline = twitter_timeline_new_from_data (store_page);
+
+  store = twitter_store_new (filename);
+  g_assert (twitter_store_load (store, &error));
+  g_assert_no_error (error);
+  g_assert (twitter_store_get_timeline (store, "test/friends") == NULL);
+
+  /* adding the same statuses twice does not duplicate them */
+  g_assert (twitter_store_add_timeline (store, "test/friends", timeline, &error));
+  g_assert (twitter_store_add_timeline (store, "test/friends", timeline, &error));
+  g_assert_no_error (error);
+  g_object_unref (store);
+
+  store = twitter_store_new (filename);
+  stored = twitter_store_get_timeline (store, "test/friends");
+  g_assert (stored != NULL);
+  g_assert_cmpint (twitter_timeline_get_count (stored), ==, 2);
+
+  for (i = 0; i < 2; i++)
+    compare_stored_status (twitter_timeline_get_pos (stored, i),
+                           twitter_timeline_get_pos (timeline, i));
+
+  /* the users are shared */
+  g_assert (twitter_status_get_user (twitter_timeline_get_pos (stored, 0)) ==
+            twitter_status_get_user (twitter_timeline_get_pos (stored, 1)));
+
+  keys = twitter_store_get_keys (store);
+  g_assert_cmpint (g_list_length (keys), ==, 1);
+  g_assert_cmpstr (keys->data, ==, "test/friends");
+  g_list_free (keys);
+
+  g_object_unref (stored);
+  g_object_unref (store);
+  g_object_unref (timeline);
+
+  /* a record interrupted by a crash is dropped by the next append */
+  file = g_fopen (filename, "ab");
+  fwrite ("\x40\0\0\0\2\0", 6, 1, file);
+  fclose (file);
+
+  timeline = twitter_timeline_new_from_data (store_next_page);
+
+  store = twitter_store_new (filename);
+  g_assert (twitter_store_add_timeline (store, "test/friends", timeline, &error));
+  g_assert_no_error (error);
+
+  stored = twitter_store_get_timeline (store, "test/friends");
+  g_assert_cmpint (twitter_timeline_get_count (stored), ==, 3);
+  g_assert_cmpint (twitter_status_get_id (twitter_timeline_get_pos (stored, 0)), ==, 1745345413);
+
+  g_object_unref (stored);
+  g_object_unref (store);
+  g_object_unref (timeline);
+
+  g_unlink (filename);
+  g_free (filename);
+}
+
+#ifdef G_OS_UNIX
+void
+test_store_write_error (void)
+{
+  TwitterTimeline *timeline, *stored;
+  TwitterStore *store;
+  GError *error = NULL;
+  struct rlimit limit, saved_limit;
+  struct stat stat_buf;
+  void (* saved_handler) (int);
+  gchar *filename;
+
+  filename = create_store_filename ();
+
+  timeline = twitter_timeline_new_from_data (store_page);
+  store = twitter_store_new (filename);
+  g_assert (twitter_store_add_timeline (store, "test/friends", timeline, &error));
+  g_assert_no_error (error);
+  g_object_unref (timeline);
+
+  /* let only part of the next records reach the file */
+  g_assert (g_stat (filename, &stat_buf) == 0);
+  g_assert (getrlimit (RLIMIT_FSIZE, &saved_limit) == 0);
+
+  limit = saved_limit;
+  limit.rlim_cur = stat_buf.st_size + 16;
+
+  saved_handler = signal (SIGXFSZ, SIG_IGN);
+  g_assert (setrlimit (RLIMIT_FSIZE, &limit) == 0);
+
+  timeline = twitter_timeline_new_from_data (store_next_page);
+  g_assert (!twitter_store_add_timeline (store, "test/friends", timeline, &error));
+  g_assert (error != NULL);
+  g_clear_error (&error);
+
+  g_assert (setrlimit (RLIMIT_FSIZE, &saved_limit) == 0);
+  signal (SIGXFSZ, saved_handler);
+
+  /* the failed statuses are written again, after the partial record */
+  g_assert (twitter_store_add_timeline (store, "test/friends", timeline, &error));
+  g_assert_no_error (error);
+  g_object_unref (timeline);
+
+  stored = twitter_store_get_timeline (store, "test/friends");
+  g_assert_cmpint (twitter_timeline_get_count (stored), ==, 3);
+  g_object_unref (stored);
+  g_object_unref (store);
+
+  /* and the file can be read back */
+  store = twitter_store_new (filename);
+  stored = twitter_store_get_timeline (store, "test/friends");
+  g_assert (stored != NULL);
+  g_assert_cmpint (twitter_timeline_get_count (stored), ==, 3);
+  g_assert_cmpint (twitter_status_get_id (twitter_timeline_get_pos (stored, 0)), ==, 1745345413);
+  g_object_unref (stored);
+  g_object_unref (store);
+
+  g_unlink (filename);
+  g_free (filename);
+}
+#endif /* G_OS_UNIX */
@@ -0,0 +1,267 @@
+#include "twitter-test-main.h"
+#include "twitter-test-server.h"
+
+#include <string.h>
+
+#include <libsoup/soup.h>
+
+static const gchar thread_page[] =
+"["
+"  { \"id\":33, \"text\":\"me too\", \"in_reply_to_status_id\":30 },"
+"  { \"id\":32, \"text\":\"indeed\", \"in_reply_to_status_id\":31 },"
+"  { \"id\":31, \"text\":\"it is\", \"in_reply_to_status_id\":30 },"
+"  { \"id\":30, \"text\":\"nice weather\" },"
+"  { \"id\":29, \"text\":\"unrelated\" }"
+"]";
+
+typedef struct {
+  GMainLoop *loop;
+  gulong handle;
+  guint n_nodes;
+  guint root_id;
+  guint first_reply_id;
+} ThreadClosure;
+
+static void
+on_thread_resolved (TwitterThreadResolver *resolver,
+                    gulong                 handle,
+                    GNode                 *thread,
+                    const GError          *error,
+                    ThreadClosure         *closure)
+{
+  g_assert_cmpint (handle, ==, closure->handle);
+  g_assert (error == NULL);
+  g_assert (thread != NULL);
+
+  closure->n_nodes = g_node_n_nodes (thread, G_TRAVERSE_ALL);
+  closure->root_id = twitter_status_get_id (thread->data);
+  closure->first_reply_id = twitter_status_get_id (g_node_first_child (thread)->data);
+
+  g_main_loop_quit (closure->loop);
+}
+
+void
+test_thread_resolver_local (void)
+{
+  TwitterThreadResolver *resolver;
+  TwitterTimeline *timeline;
+  TwitterClient *client;
+  ThreadClosure closure = { NULL, };
+
+  client = twitter_client_new ();
+  resolver = twitter_thread_resolver_new (client, NULL);
+
+  /* every status is available locally, so no request is made */
+  timeline = twitter_timeline_new_from_data (thread_page);
+  twitter_status_index_add_timeline (twitter_thread_resolver_get_status_index (resolver),
+                                     timeline);
+  g_object_unref (timeline);
+
+  g_signal_connect (resolver, "thread-resolved",
+                    G_CALLBACK (on_thread_resolved),
+                    &closure);
+
+  closure.loop = g_main_loop_new (NULL, FALSE);
+  closure.handle = twitter_thread_resolver_resolve (resolver, 32);
+  g_assert (closure.handle != 0);
+
+  g_main_loop_run (closure.loop);
+
+  g_assert_cmpint (closure.n_nodes, ==, 4);
+  g_assert_cmpint (closure.root_id, ==, 30);
+  g_assert_cmpint (closure.first_reply_id, ==, 31);
+
+  g_main_loop_unref (closure.loop);
+  g_object_unref (resolver);
+  g_object_unref (client);
+}
+
+/* the statuses on the server: 42 -> 41 -> 40, and 50 to 53 */
+static const gchar *remote_statuses[][2] = {
+  { "/statuses/show/40.json", "{ \"id\":40, \"text\":\"nice weather\" }" },
+  { "/statuses/show/41.json", "{ \"id\":41, \"text\":\"it is\", \"in_reply_to_status_id\":40 }" },
+  { "/statuses/show/42.json", "{ \"id\":42, \"text\":\"indeed\", \"in_reply_to_status_id\":41 }" },
+  { "/statuses/show/50.json", "{ \"id\":50, \"text\":\"one\" }" },
+  { "/statuses/show/51.json", "{ \"id\":51, \"text\":\"two\" }" },
+  { "/statuses/show/52.json", "{ \"id\":52, \"text\":\"three\" }" },
+  { "/statuses/show/53.json", "{ \"id\":53, \"text\":\"four\" }" }
+};
+
+typedef struct {
+  guint n_resolved;
+  guint n_expected;
+  gboolean done;
+
+  /* the root of each resolved thread, in order */
+  guint root_ids[4];
+} CountClosure;
+
+static void
+on_thread_counted (TwitterThreadResolver *resolver,
+                   gulong                 handle,
+                   GNode                 *thread,
+                   const GError          *error,
+                   CountClosure          *closure)
+{
+  g_assert (error == NULL);
+  g_assert (thread != NULL);
+  g_assert_cmpint (closure->n_resolved, <, G_N_ELEMENTS (closure->root_ids));
+
+  closure->root_ids[closure->n_resolved] = twitter_status_get_id (thread->data);
+  closure->n_resolved += 1;
+
+  if (closure->n_resolved == closure->n_expected)
+    closure->done = TRUE;
+}
+
+static TwitterTestServer *
+remote_server_new (gboolean delayed)
+{
+  TwitterTestServer *server;
+  guint i;
+
+  server = twitter_test_server_new ();
+
+  for (i = 0; i < G_N_ELEMENTS (remote_statuses); i++)
+    {
+      const gchar *path = remote_statuses[i][0];
+      const gchar *data = remote_statuses[i][1];
+
+      if (delayed)
+        twitter_test_server_add_delayed (server, path, data, strlen (data));
+      else
+        twitter_test_server_add (server, path, NULL, data, strlen (data));
+    }
+
+  return server;
+}
+
+static TwitterClient *
+remote_client_new (TwitterTestServer *server)
+{
+  return twitter_client_new_full (TWITTER_CUSTOM_PROVIDER,
+                                  twitter_test_server_get_url (server),
+                                  "user",
+                                  "password");
+}
+
+void
+test_thread_resolver_remote (void)
+{
+  TwitterTestServer *server;
+  TwitterThreadResolver *resolver;
+  TwitterClient *client;
+  CountClosure closure = { 0, };
+
+  server = remote_server_new (FALSE);
+  client = remote_client_new (server);
+  resolver = twitter_thread_resolver_new (client, NULL);
+
+  g_signal_connect (resolver, "thread-resolved",
+                    G_CALLBACK (on_thread_counted),
+                    &closure);
+
+  /* each missing parent is requested in turn */
+  closure.n_expected = 1;
+  g_assert (twitter_thread_resolver_resolve (resolver, 42) != 0);
+  twitter_test_run_until (&closure.done);
+
+  g_assert_cmpint (closure.root_ids[0], ==, 40);
+  g_assert_cmpint (twitter_test_server_get_requests (server), ==, 3);
+  g_assert_cmpint (twitter_status_index_get_count (twitter_thread_resolver_get_status_index (resolver)), ==, 3);
+
+  /* and then found inside the index */
+  closure.done = FALSE;
+  closure.n_expected = 2;
+  g_assert (twitter_thread_resolver_resolve (resolver, 41) != 0);
+  twitter_test_run_until (&closure.done);
+
+  g_assert_cmpint (closure.root_ids[1], ==, 40);
+  g_assert_cmpint (twitter_test_server_get_requests (server), ==, 3);
+
+  g_object_unref (resolver);
+  g_object_unref (client);
+  twitter_test_server_free (server);
+}
+
+void
+test_thread_resolver_coalesce (void)
+{
+  TwitterTestServer *server;
+  TwitterThreadResolver *resolver;
+  TwitterClient *client;
+  CountClosure closure = { 0, };
+
+  server = remote_server_new (FALSE);
+  client = remote_client_new (server);
+  resolver = twitter_thread_resolver_new (client, NULL);
+
+  g_signal_connect (resolver, "thread-resolved",
+                    G_CALLBACK (on_thread_counted),
+                    &closure);
+
+  /* concurrent resolutions of the same status share its request,
+   * and the requests of its parents
+   */
+  closure.n_expected = 3;
+  g_assert (twitter_thread_resolver_resolve (resolver, 42) != 0);
+  g_assert (twitter_thread_resolver_resolve (resolver, 42) != 0);
+  g_assert (twitter_thread_resolver_resolve (resolver, 41) != 0);
+  twitter_test_run_until (&closure.done);
+
+  g_assert_cmpint (closure.root_ids[0], ==, 40);
+  g_assert_cmpint (closure.root_ids[1], ==, 40);
+  g_assert_cmpint (closure.root_ids[2], ==, 40);
+  g_assert_cmpint (twitter_test_server_get_requests (server), ==, 3);
+
+  g_object_unref (resolver);
+  g_object_unref (client);
+  twitter_test_server_free (server);
+}
+
+void
+test_thread_resolver_max_requests (void)
+{
+  TwitterTestServer *server;
+  TwitterThreadResolver *resolver;
+  TwitterClient *client;
+  CountClosure closure = { 0, };
+  SoupSession *session;
+  guint i;
+
+  server = remote_server_new (TRUE);
+  client = remote_client_new (server);
+  resolver = twitter_thread_resolver_new (client, NULL);
+  g_object_set (G_OBJECT (resolver), "max-requests", 2, NULL);
+
+  /* the session alone would let all of them through */
+  g_object_get (G_OBJECT (client), "session", &session, NULL);
+  g_object_set (G_OBJECT (session), SOUP_SESSION_MAX_CONNS_PER_HOST, 8, NULL);
+  g_object_unref (session);
+
+  g_signal_connect (resolver, "thread-resolved",
+                    G_CALLBACK (on_thread_counted),
+                    &closure);
+
+  closure.n_expected = 4;
+  for (i = 50; i < 54; i++)
+    g_assert (twitter_thread_resolver_resolve (resolver, i) != 0);
+
+  /* only two requests are sent while the responses are delayed */
+  twitter_test_server_wait_requests (server, 2);
+  while (g_main_context_iteration (NULL, FALSE))
+    ;
+
+  g_assert_cmpint (twitter_test_server_get_requests (server), ==, 2);
+  g_assert_cmpint (closure.n_resolved, ==, 0);
+
+  /* the queued ones follow once the first ones are answered */
+  twitter_test_server_resume (server);
+  twitter_test_run_until (&closure.done);
+
+  g_assert_cmpint (twitter_test_server_get_requests (server), ==, 4);
+
+  g_object_unref (resolver);
+  g_object_unref (client);
+  twitter_test_server_free (server);
+}
@@ -0,0 +1,1073 @@
+#include "twitter-test-main.h"
+#include <stdlib.h>
+#include <string.h>
+#include <gio/gio.h>
+#include <json-glib/json-glib.h>
+
+static const gchar valid_timeline[] =
+"["
+"  {"
+"    \"text\":\"caf\\u00e9 \\\"au lait\\\"\","
+"    \"truncated\":false,"
+"    \"in_reply_to_status_id\":1745345411,"
+"    \"in_reply_to_user_id\":14296080,"
+"    \"favorited\":false,"
+"    \"id\":1745345412,"
+"    \"source\":\"<a href=\\\"http:\\/\\/example.com\\\">web<\\/a>\","
+"    \"created_at\":\"Sat May 09 10:08:10 +0000 2009\","
+"    \"user\":{"
+"      \"screen_name\":\"ebassi\","
+"      \"id\":14296080,"
+"      \"utc_offset\":0,"
+"      \"profile_link_color\":[1, 2, { \"nested\" : null }]"
+"    }"
+"  },"
+"  42,"
+"  {"
+"    \"text\":\"which, I guess, it's exactly what will happen anyway\","
+"    \"truncated\":true,"
+"    \"in_reply_to_status_id\":null,"
+"    \"id\":1745345411,"
+"    \"source\":\"web\","
+"    \"created_at\":\"Sat May 09 10:07:10 +0000 2009\""
+"  }"
+"]";
+
+static const gchar invalid_timeline[] =
+"["
+"  { \"id\" : 1, \"text\" : \"foo\" },"
+"  { \"id\" : 2, \"text\" : \"bar\" "
+"]";
+
+static void
+compare_statuses (TwitterStatus *a,
+                  TwitterStatus *b)
+{
+  g_assert_cmpint (twitter_status_get_id (a), ==, twitter_status_get_id (b));
+  g_assert_cmpstr (twitter_status_get_text (a), ==, twitter_status_get_text (b));
+  g_assert_cmpstr (twitter_status_get_source (a), ==, twitter_status_get_source (b));
+  g_assert_cmpstr (twitter_status_get_created_at (a), ==, twitter_status_get_created_at (b));
+  g_assert_cmpstr (twitter_status_get_url (a), ==, twitter_status_get_url (b));
+  g_assert_cmpint (twitter_status_get_truncated (a), ==, twitter_status_get_truncated (b));
+  g_assert_cmpint (twitter_status_get_reply_to_user (a), ==, twitter_status_get_reply_to_user (b));
+  g_assert_cmpint (twitter_status_get_reply_to_status (a), ==, twitter_status_get_reply_to_status (b));
+  g_assert ((twitter_status_get_user (a) == NULL) == (twitter_status_get_user (b) == NULL));
+}
+
+void
+test_timeline_decoder (void)
+{
+  TwitterTimeline *decoded, *parsed;
+  TwitterStatus *status;
+  GError *error = NULL;
+  guint i;
+
+  twitter_set_parse_flags (TWITTER_PARSE_DEFAULT);
+
+  decoded = twitter_timeline_new ();
+  twitter_timeline_load_from_data (decoded, valid_timeline, &error);
+  g_assert (error == NULL);
+
+  twitter_set_parse_flags (TWITTER_PARSE_USE_JSON_GLIB);
+
+  parsed = twitter_timeline_new ();
+  twitter_timeline_load_from_data (parsed, valid_timeline, &error);
+  g_assert (error == NULL);
+
+  twitter_set_parse_flags (TWITTER_PARSE_DEFAULT);
+
+  g_assert_cmpint (twitter_timeline_get_count (decoded), ==, 2);
+  g_assert_cmpint (twitter_timeline_get_count (parsed), ==, 2);
+
+  for (i = 0; i < 2; i++)
+    compare_statuses (twitter_timeline_get_pos (decoded, i),
+                      twitter_timeline_get_pos (parsed, i));
+
+  status = twitter_timeline_get_id (decoded, 1745345412);
+  g_assert (TWITTER_IS_STATUS (status));
+  g_assert_cmpstr (twitter_status_get_text (status), ==, "caf\xc3\xa9 \"au lait\"");
+  g_assert_cmpint (twitter_status_get_reply_to_user (status), ==, 14296080);
+  g_assert_cmpstr (twitter_user_get_screen_name (twitter_status_get_user (status)), ==, "ebassi");
+
+  g_object_unref (decoded);
+  g_object_unref (parsed);
+}
+
+void
+test_timeline_invalid (void)
+{
+  TwitterTimeline *timeline = twitter_timeline_new ();
+  GError *error = NULL;
+  gboolean res;
+
+  /* the decoder must give up and let json-glib report the error */
+  res = twitter_timeline_load_from_data (timeline, invalid_timeline, &error);
+  g_assert (!res);
+  g_assert_error (error, TWITTER_ERROR, TWITTER_ERROR_PARSE_ERROR);
+  g_assert_cmpint (twitter_timeline_get_count (timeline), ==, 0);
+
+  g_error_free (error);
+  g_object_unref (timeline);
+}
+
+/* integers at the boundaries of the 64 bit range: values out of the
+ * range saturate, and no digit is silently dropped
+ */
+static const gchar boundary_timeline[] =
+"["
+"  { \"id\":1, \"text\":\"max\", \"in_reply_to_status_id\":9223372036854775807,"
+"    \"user\":{ \"id\":1, \"screen_name\":\"max\", \"followers_count\":9223372036854775806 } },"
+"  { \"id\":2, \"text\":\"over\", \"in_reply_to_status_id\":9223372036854775808,"
+"    \"user\":{ \"id\":2, \"screen_name\":\"over\", \"followers_count\":92233720368547758070 } },"
+"  { \"id\":3, \"text\":\"min\", \"in_reply_to_status_id\":-9223372036854775808,"
+"    \"user\":{ \"id\":3, \"screen_name\":\"min\", \"followers_count\":-9223372036854775809 } }"
+"]";
+
+void
+test_timeline_boundary_ids (void)
+{
+  TwitterTimeline *timeline;
+  TwitterStatus *status;
+  GError *error = NULL;
+
+  timeline = twitter_timeline_new ();
+  twitter_timeline_load_from_data (timeline, boundary_timeline, &error);
+  g_assert_no_error (error);
+  g_assert_cmpint (twitter_timeline_get_count (timeline), ==, 3);
+
+  /* the values are truncated to 32 bits by the accessors */
+  status = twitter_timeline_get_id (timeline, 1);
+  g_assert_cmpuint (twitter_status_get_reply_to_status (status), ==,
+                    (guint) G_MAXINT64);
+  g_assert_cmpuint (twitter_user_get_followers_count (twitter_status_get_user (status)), ==,
+                    (guint) (G_MAXINT64 - 1));
+
+  status = twitter_timeline_get_id (timeline, 2);
+  g_assert_cmpuint (twitter_status_get_reply_to_status (status), ==,
+                    (guint) G_MAXINT64);
+  g_assert_cmpuint (twitter_user_get_followers_count (twitter_status_get_user (status)), ==,
+                    (guint) G_MAXINT64);
+
+  status = twitter_timeline_get_id (timeline, 3);
+  g_assert_cmpuint (twitter_status_get_reply_to_status (status), ==,
+                    (guint) G_MININT64);
+  g_assert_cmpuint (twitter_user_get_followers_count (twitter_status_get_user (status)), ==,
+                    (guint) G_MININT64);
+
+  g_object_unref (timeline);
+}
+
+/* a status as returned by the provider, used to build larger timelines */
+static const gchar recorded_status[] =
+"{"
+"  \"in_reply_to_screen_name\":null,"
+"  \"text\":\"Just landed in Berlin \\u2014 the \\\"GUADEC\\\" crowd is already at the \\/bar\\/, "
+"see you all there!\\nhttp:\\/\\/example.com\\/guadec\","
+"  \"in_reply_to_status_id\":null,"
+"  \"favorited\":false,"
+"  \"id\":%u,"
+"  \"source\":\"<a href=\\\"http:\\/\\/example.com\\/client\\\">Tweet Client<\\/a>\","
+"  \"in_reply_to_user_id\":null,"
+"  \"truncated\":false,"
+"  \"created_at\":\"Sat May 09 10:08:10 +0000 2009\","
+"  \"user\":{"
+"    \"profile_background_tile\":false,"
+"    \"description\":\"Long time GNOME hacker, short time \\\"tweeter\\\"\","
+"    \"profile_sidebar_fill_color\":\"e0ff92\","
+"    \"screen_name\":\"ebassi\","
+"    \"followers_count\":397,"
+"    \"location\":\"London, United Kingdom\","
+"    \"url\":\"http:\\/\\/www.emmanuelebassi.net\","
+"    \"name\":\"Emmanuele Bassi\","
+"    \"id\":14296080,"
+"    \"utc_offset\":0,"
+"    \"profile_image_url\":\"http:\\/\\/s3.amazonaws.com\\/twitter_production\\/profile_images\\/52293419\\/ebassi_normal.png\""
+"  }"
+"}";
+
+static gchar *
+build_page (guint first_id,
+            guint n_statuses)
+{
+  GString *buffer = g_string_new ("[");
+  guint i;
+
+  for (i = 0; i < n_statuses; i++)
+    {
+      if (i > 0)
+        g_string_append_c (buffer, ',');
+
+      g_string_append_printf (buffer, recorded_status, first_id + i);
+    }
+
+  g_string_append_c (buffer, ']');
+
+  return g_string_free (buffer, FALSE);
+}
+
+static gchar *
+build_timeline (guint n_statuses)
+{
+  return build_page (1, n_statuses);
+}
+
+void
+test_timeline_long_strings (void)
+{
+  TwitterStatus *decoded, *parsed;
+  GString *text;
+  gchar *buffer;
+  guint i;
+
+  /* escapes on every position of a vector block, and across them */
+  text = g_string_new (NULL);
+  for (i = 0; i < 80; i++)
+    {
+      g_string_append_len (text, "abcdefghijklmnopqrstuvwxyz0123456789", i % 37);
+      g_string_append (text, (i % 2) ? "\\\"" : "\\u00e9");
+    }
+
+  buffer = g_strdup_printf ("{ \"id\" : 1, \"text\" : \"%s\" }", text->str);
+
+  twitter_set_parse_flags (TWITTER_PARSE_DEFAULT);
+  decoded = twitter_status_new_from_data (buffer);
+
+  twitter_set_parse_flags (TWITTER_PARSE_USE_JSON_GLIB);
+  parsed = twitter_status_new_from_data (buffer);
+
+  twitter_set_parse_flags (TWITTER_PARSE_DEFAULT);
+
+  compare_statuses (decoded, parsed);
+
+  g_object_unref (decoded);
+  g_object_unref (parsed);
+  g_string_free (text, TRUE);
+  g_free (buffer);
+}
+
+static gdouble
+time_timeline_load (const gchar      *buffer,
+                    TwitterParseFlags flags,
+                    guint             n_runs)
+{
+  GTimer *timer;
+  gdouble elapsed;
+  guint i;
+
+  twitter_set_parse_flags (flags);
+
+  timer = g_timer_new ();
+
+  for (i = 0; i < n_runs; i++)
+    {
+      TwitterTimeline *timeline = twitter_timeline_new_from_data (buffer);
+
+      g_assert_cmpint (twitter_timeline_get_count (timeline), >, 0);
+      g_object_unref (timeline);
+    }
+
+  elapsed = g_timer_elapsed (timer, NULL);
+  g_timer_destroy (timer);
+
+  twitter_set_parse_flags (TWITTER_PARSE_DEFAULT);
+
+  return elapsed;
+}
+
+void
+test_timeline_decoder_perf (void)
+{
+  static const guint sizes[] = { 20, 200, 3200 };
+  guint i;
+
+  if (!g_test_perf ())
+    return;
+
+  for (i = 0; i < G_N_ELEMENTS (sizes); i++)
+    {
+      gchar *buffer = build_timeline (sizes[i]);
+      guint n_runs = MAX (1, 6400 / sizes[i]);
+      gdouble decoder, json_glib;
+
+      decoder = time_timeline_load (buffer, TWITTER_PARSE_DEFAULT, n_runs);
+      json_glib = time_timeline_load (buffer, TWITTER_PARSE_USE_JSON_GLIB, n_runs);
+
+      g_test_minimized_result (decoder / n_runs,
+                               "decoder, %u statuses: %.3f msecs",
+                               sizes[i], 1000.0 * decoder / n_runs);
+      g_test_minimized_result (json_glib / n_runs,
+                               "json-glib, %u statuses: %.3f msecs",
+                               sizes[i], 1000.0 * json_glib / n_runs);
+
+      g_free (buffer);
+    }
+}
+
+/* the statuses of a page built by the parse pool must be the same,
+ * and in the same order, as the statuses decoded one by one
+ */
+static void
+check_parallel_timeline (const gchar *buffer,
+                         GPtrArray   *elements)
+{
+  TwitterTimeline *timeline;
+  guint i;
+
+  timeline = twitter_timeline_new_from_data (buffer);
+  g_assert_cmpint (twitter_timeline_get_count (timeline), ==, elements->len);
+
+  for (i = 0; i < elements->len; i++)
+    {
+      TwitterStatus *status;
+
+      status = twitter_status_new_from_data (g_ptr_array_index (elements, i));
+      compare_statuses (twitter_timeline_get_pos (timeline, i), status);
+      g_object_unref (status);
+    }
+
+  g_object_unref (timeline);
+}
+
+void
+test_timeline_parallel (void)
+{
+  GPtrArray *elements;
+  GString *buffer;
+  guint n_statuses, i;
+
+  /* enough statuses for both the array and the buffer thresholds
+   * of the parse pool; the pool is only used on machines with more
+   * than one processor
+   */
+  n_statuses = 200;
+
+  elements = g_ptr_array_new ();
+  buffer = g_string_new ("[");
+
+  /* newest first, like the timeline */
+  for (i = 0; i < n_statuses; i++)
+    {
+      gchar *element = g_strdup_printf (recorded_status, n_statuses - i);
+
+      if (i > 0)
+        g_string_append_c (buffer, ',');
+
+      g_string_append (buffer, element);
+      g_ptr_array_add (elements, element);
+    }
+
+  g_string_append_c (buffer, ']');
+  g_assert_cmpint (buffer->len, >, 128 * 1024);
+
+  twitter_set_parse_flags (TWITTER_PARSE_DEFAULT);
+  check_parallel_timeline (buffer->str, elements);
+
+  twitter_set_parse_flags (TWITTER_PARSE_USE_JSON_GLIB);
+  check_parallel_timeline (buffer->str, elements);
+
+  twitter_set_parse_flags (TWITTER_PARSE_DEFAULT);
+
+  g_ptr_array_foreach (elements, (GFunc) g_free, NULL);
+  g_ptr_array_free (elements, TRUE);
+  g_string_free (buffer, TRUE);
+}
+
+void
+test_timeline_lazy (void)
+{
+  TwitterTimeline *lazy, *parsed;
+  TwitterUser *lazy_user, *parsed_user;
+  gchar *buffer, *location;
+  guint i;
+
+  buffer = build_timeline (3);
+
+  twitter_set_parse_flags (TWITTER_PARSE_LAZY);
+  lazy = twitter_timeline_new_from_data (buffer);
+
+  twitter_set_parse_flags (TWITTER_PARSE_USE_JSON_GLIB);
+  parsed = twitter_timeline_new_from_data (buffer);
+
+  twitter_set_parse_flags (TWITTER_PARSE_DEFAULT);
+
+  /* the strings must outlive the data they were decoded from */
+  g_free (buffer);
+
+  g_assert_cmpint (twitter_timeline_get_count (lazy), ==, 3);
+
+  for (i = 0; i < 3; i++)
+    compare_statuses (twitter_timeline_get_pos (lazy, i),
+                      twitter_timeline_get_pos (parsed, i));
+
+  lazy_user = twitter_status_get_user (twitter_timeline_get_pos (lazy, 0));
+  parsed_user = twitter_status_get_user (twitter_timeline_get_pos (parsed, 0));
+
+  g_object_get (G_OBJECT (lazy_user), "location", &location, NULL);
+  g_assert_cmpstr (location, ==, "London, United Kingdom");
+  g_free (location);
+
+  g_assert_cmpstr (twitter_user_get_name (lazy_user), ==,
+                   twitter_user_get_name (parsed_user));
+  g_assert_cmpstr (twitter_user_get_description (lazy_user), ==,
+                   twitter_user_get_description (parsed_user));
+  g_assert_cmpstr (twitter_user_get_url (lazy_user), ==,
+                   twitter_user_get_url (parsed_user));
+  g_assert_cmpstr (twitter_user_get_profile_image_url (lazy_user), ==,
+                   twitter_user_get_profile_image_url (parsed_user));
+  g_assert (twitter_user_get_time_zone (lazy_user) == NULL);
+
+  g_object_unref (lazy);
+  g_object_unref (parsed);
+}
+
+/* the string scanners must agree on every position of the special
+ * characters, including the ones at the boundaries of a vector
+ */
+#define N_SCANNER_STATUSES      80
+
+static gchar *
+scanner_text (guint    i,
+              gboolean escaped)
+{
+  GString *text = g_string_new (NULL);
+  guint j;
+
+  for (j = 0; j < i; j++)
+    g_string_append_c (text, 'x');
+
+  g_string_append (text, escaped ? "\\\"" : "\"");
+
+  for (j = 0; j < N_SCANNER_STATUSES - i; j++)
+    g_string_append_c (text, 'y');
+
+  g_string_append (text, escaped ? "\\\\" : "\\");
+
+  for (j = 0; j < i % 37; j++)
+    g_string_append_c (text, 'z');
+
+  return g_string_free (text, FALSE);
+}
+
+void
+test_timeline_scanners (void)
+{
+  static const TwitterParseFlags scanners[] = {
+    TWITTER_PARSE_DEFAULT,
+    TWITTER_PARSE_NO_AVX2,
+    TWITTER_PARSE_NO_SIMD
+  };
+  GString *buffer;
+  guint i, j;
+
+  buffer = g_string_new ("[");
+
+  for (i = 0; i < N_SCANNER_STATUSES; i++)
+    {
+      gchar *text = scanner_text (i, TRUE);
+
+      g_string_append_printf (buffer,
+                              "%s{ \"id\":%u, \"text\":\"%s\","
+                              "  \"created_at\":\"%s\","
+                              "  \"user\":{ \"id\":1, \"screen_name\":\"scanner\" } }",
+                              i > 0 ? "," : "",
+                              i + 1, text, text);
+      g_free (text);
+    }
+
+  g_string_append (buffer, "]");
+
+  for (j = 0; j < G_N_ELEMENTS (scanners) * 2; j++)
+    {
+      TwitterTimeline *timeline;
+      GError *error = NULL;
+
+      /* every scanner is used both eagerly and lazily */
+      twitter_set_parse_flags (scanners[j / 2] |
+                               ((j % 2) ? TWITTER_PARSE_LAZY : 0));
+
+      timeline = twitter_timeline_new ();
+      twitter_timeline_load_from_data (timeline, buffer->str, &error);
+      g_assert_no_error (error);
+      g_assert_cmpint (twitter_timeline_get_count (timeline), ==, N_SCANNER_STATUSES);
+
+      for (i = 0; i < N_SCANNER_STATUSES; i++)
+        {
+          TwitterStatus *status = twitter_timeline_get_id (timeline, i + 1);
+          gchar *text = scanner_text (i, FALSE);
+
+          g_assert_cmpstr (twitter_status_get_text (status), ==, text);
+          g_assert_cmpstr (twitter_status_get_created_at (status), ==, text);
+          g_free (text);
+        }
+
+      g_object_unref (timeline);
+    }
+
+  twitter_set_parse_flags (TWITTER_PARSE_DEFAULT);
+
+  g_string_free (buffer, TRUE);
+}
+
+void
+test_timeline_arena (void)
+{
+  TwitterTimeline *timeline;
+  TwitterStatus *status;
+  TwitterUser *user;
+  gchar *buffer;
+
+  buffer = build_timeline (50);
+  timeline = twitter_timeline_new_from_data (buffer);
+  g_free (buffer);
+
+  g_assert_cmpint (twitter_timeline_get_count (timeline), ==, 50);
+
+  /* the strings are shared by the whole page, and must stay alive
+   * as long as a single status of the page does
+   */
+  status = g_object_ref (twitter_timeline_get_id (timeline, 42));
+  user = g_object_ref (twitter_status_get_user (status));
+  g_object_unref (timeline);
+
+  g_assert_cmpint (twitter_status_get_id (status), ==, 42);
+  g_assert_cmpstr (twitter_status_get_created_at (status), ==,
+                   "Sat May 09 10:08:10 +0000 2009");
+  g_assert_cmpstr (twitter_user_get_screen_name (user), ==, "ebassi");
+  g_assert_cmpstr (twitter_user_get_location (user), ==, "London, United Kingdom");
+
+  g_object_unref (status);
+  g_object_unref (user);
+}
+
+void
+test_timeline_string_pool (void)
+{
+  TwitterTimeline *decoded, *parsed;
+  TwitterUser *first, *last;
+  guint n_strings, n_references, base_references;
+  gsize bytes_saved, base_bytes_saved;
+  gchar *buffer;
+
+  twitter_get_string_pool_stats (NULL, &base_references, &base_bytes_saved);
+
+  buffer = build_timeline (10);
+
+  decoded = twitter_timeline_new_from_data (buffer);
+
+  twitter_set_parse_flags (TWITTER_PARSE_USE_JSON_GLIB);
+  parsed = twitter_timeline_new_from_data (buffer);
+  twitter_set_parse_flags (TWITTER_PARSE_DEFAULT);
+
+  g_free (buffer);
+
+  /* the source, location and profile image of 20 statuses */
+  twitter_get_string_pool_stats (&n_strings, &n_references, &bytes_saved);
+  g_assert_cmpint (n_strings, >=, 3);
+  g_assert_cmpint (n_references - base_references, ==, 60);
+  g_assert_cmpint (bytes_saved, >, base_bytes_saved);
+
+  first = twitter_status_get_user (twitter_timeline_get_pos (decoded, 0));
+  last = twitter_status_get_user (twitter_timeline_get_pos (parsed, 9));
+
+  g_assert (twitter_user_get_location (first) == twitter_user_get_location (last));
+  g_assert (twitter_status_get_source (twitter_timeline_get_pos (decoded, 3)) ==
+            twitter_status_get_source (twitter_timeline_get_pos (parsed, 5)));
+
+  g_object_unref (decoded);
+  g_object_unref (parsed);
+}
+
+/* times the json-glib load of @buffer the way the library does it;
+ * with @reuse the same parser is used for every load, and its tree
+ * is released after each load by parsing an empty array, as done by
+ * _twitter_parse_pool_put_parser(); otherwise, a new parser is
+ * created for each load
+ */
+static gdouble
+time_parser_load (const gchar *buffer,
+                  gboolean     reuse,
+                  guint        n_runs)
+{
+  JsonParser *parser = NULL;
+  GTimer *timer;
+  gdouble elapsed;
+  guint i;
+
+  timer = g_timer_new ();
+
+  for (i = 0; i < n_runs; i++)
+    {
+      if (parser == NULL)
+        parser = json_parser_new ();
+
+      json_parser_load_from_data (parser, buffer, -1, NULL);
+      g_assert (json_parser_get_root (parser) != NULL);
+
+      if (reuse)
+        json_parser_load_from_data (parser, "[]", 2, NULL);
+      else
+        {
+          g_object_unref (parser);
+          parser = NULL;
+        }
+    }
+
+  if (parser != NULL)
+    g_object_unref (parser);
+
+  elapsed = g_timer_elapsed (timer, NULL);
+  g_timer_destroy (timer);
+
+  return elapsed;
+}
+
+void
+test_timeline_parser_reuse (void)
+{
+  static const guint sizes[] = { 1, 20, 200 };
+  GTimer *timer;
+  guint i;
+
+  if (!g_test_perf ())
+    return;
+
+  timer = g_timer_new ();
+
+  for (i = 0; i < G_N_ELEMENTS (sizes); i++)
+    {
+      guint n_runs = MAX (1, 4000 / sizes[i]);
+      gchar *buffer;
+      gdouble fresh, reused, library;
+      guint j;
+
+      /* a single status is the case the reuse is meant for */
+      if (sizes[i] == 1)
+        buffer = g_strdup_printf (recorded_status, 1);
+      else
+        buffer = build_timeline (sizes[i]);
+
+      fresh = time_parser_load (buffer, FALSE, n_runs);
+      reused = time_parser_load (buffer, TRUE, n_runs);
+
+      /* the actual load path of the library, for reference */
+      twitter_set_parse_flags (TWITTER_PARSE_USE_JSON_GLIB);
+      g_timer_start (timer);
+      for (j = 0; j < n_runs; j++)
+        {
+          if (sizes[i] == 1)
+            g_object_unref (twitter_status_new_from_data (buffer));
+          else
+            g_object_unref (twitter_timeline_new_from_data (buffer));
+        }
+      library = g_timer_elapsed (timer, NULL);
+      twitter_set_parse_flags (TWITTER_PARSE_DEFAULT);
+
+      g_test_minimized_result (fresh / n_runs,
+                               "%u statuses, new parser per load: %.2f usecs",
+                               sizes[i], 1e6 * fresh / n_runs);
+      g_test_minimized_result (reused / n_runs,
+                               "%u statuses, reused and released parser: %.2f usecs",
+                               sizes[i], 1e6 * reused / n_runs);
+      g_test_minimized_result (library / n_runs,
+                               "%u statuses, library load: %.2f usecs",
+                               sizes[i], 1e6 * library / n_runs);
+
+      g_free (buffer);
+    }
+
+  g_timer_destroy (timer);
+}
+
+void
+test_timeline_timestamps (void)
+{
+  TwitterTimeline *timeline;
+  TwitterStatus *status;
+  GTimeVal time_;
+  gchar *buffer;
+  gint64 timestamp;
+
+  twitter_date_to_time_val ("Sat May 09 10:08:10 +0000 2009", &time_);
+  g_assert_cmpint (time_.tv_sec, ==, 1241863690);
+
+  /* the offset of the time zone must be honoured */
+  twitter_date_to_time_val ("Sat May 09 12:08:10 +0200 2009", &time_);
+  g_assert_cmpint (time_.tv_sec, ==, 1241863690);
+
+  buffer = build_timeline (2);
+
+  timeline = twitter_timeline_new_from_data (buffer);
+  status = twitter_timeline_get_pos (timeline, 0);
+  g_assert_cmpint (twitter_status_get_timestamp (status), ==, 1241863690);
+  g_assert_cmpint (twitter_user_get_timestamp (twitter_status_get_user (status)), ==, 0);
+
+  g_object_get (G_OBJECT (status), "timestamp", &timestamp, NULL);
+  g_assert_cmpint (timestamp, ==, 1241863690);
+  g_object_unref (timeline);
+
+  /* the lazy strings are parsed without being materialized */
+  twitter_set_parse_flags (TWITTER_PARSE_LAZY);
+  timeline = twitter_timeline_new_from_data (buffer);
+  twitter_set_parse_flags (TWITTER_PARSE_DEFAULT);
+
+  status = twitter_timeline_get_pos (timeline, 1);
+  g_assert_cmpint (twitter_status_get_timestamp (status), ==, 1241863690);
+  g_object_unref (timeline);
+
+  g_free (buffer);
+}
+
+static void
+merge_page (TwitterTimeline *timeline,
+            guint            first_id,
+            guint            n_statuses)
+{
+  GError *error = NULL;
+  gchar *buffer;
+
+  buffer = build_page (first_id, n_statuses);
+  twitter_timeline_merge_from_data (timeline, buffer, &error);
+  g_assert_no_error (error);
+  g_free (buffer);
+}
+
+#define assert_status_id(timeline,pos,id) \
+  g_assert_cmpint (twitter_status_get_id (twitter_timeline_get_pos ((timeline), (pos))), ==, (id))
+
+void
+test_timeline_merge (void)
+{
+  TwitterTimeline *timeline, *page;
+  gchar *buffer;
+  guint i;
+
+  buffer = build_page (1, 5);
+  timeline = twitter_timeline_new_from_data (buffer);
+  g_free (buffer);
+
+  /* newest first, whatever the order of the response */
+  g_assert_cmpint (twitter_timeline_get_count (timeline), ==, 5);
+  assert_status_id (timeline, 0, 5);
+  assert_status_id (timeline, -1, 1);
+
+  /* overlapping pages do not add duplicates */
+  merge_page (timeline, 4, 4);
+  g_assert_cmpint (twitter_timeline_get_count (timeline), ==, 7);
+
+  for (i = 0; i < 7; i++)
+    assert_status_id (timeline, i, 7 - i);
+
+  /* the oldest statuses are evicted first */
+  twitter_timeline_set_max_length (timeline, 5);
+  g_assert_cmpint (twitter_timeline_get_count (timeline), ==, 5);
+  assert_status_id (timeline, -1, 3);
+  g_assert (twitter_timeline_get_id (timeline, 2) == NULL);
+
+  merge_page (timeline, 1, 2);
+  g_assert_cmpint (twitter_timeline_get_count (timeline), ==, 5);
+  assert_status_id (timeline, -1, 3);
+
+  buffer = build_page (8, 2);
+  page = twitter_timeline_new_from_data (buffer);
+  g_free (buffer);
+
+  twitter_timeline_merge (timeline, page);
+  g_assert_cmpint (twitter_timeline_get_count (timeline), ==, 5);
+  assert_status_id (timeline, 0, 9);
+  assert_status_id (timeline, -1, 5);
+  g_assert (twitter_timeline_get_id (timeline, 8) ==
+            twitter_timeline_get_id (page, 8));
+
+  g_object_unref (page);
+  g_object_unref (timeline);
+}
+
+/* applies each change to a copy of the ids inside the timeline */
+static void
+on_items_changed (TwitterTimeline *timeline,
+                  guint            position,
+                  guint            removed,
+                  guint            added,
+                  GArray          *ids)
+{
+  guint i;
+
+  g_array_remove_range (ids, position, removed);
+
+  for (i = 0; i < added; i++)
+    {
+      TwitterStatus *status;
+      guint status_id;
+
+      status = twitter_timeline_get_pos (timeline, position + i);
+      status_id = twitter_status_get_id (status);
+
+      g_array_insert_val (ids, position + i, status_id);
+    }
+
+  g_assert_cmpint (ids->len, ==, twitter_timeline_get_count (timeline));
+}
+
+static void
+assert_same_ids (TwitterTimeline *timeline,
+                 GArray          *ids)
+{
+  guint i;
+
+  g_assert_cmpint (ids->len, ==, twitter_timeline_get_count (timeline));
+
+  for (i = 0; i < ids->len; i++)
+    assert_status_id (timeline, i, g_array_index (ids, guint, i));
+}
+
+void
+test_timeline_items_changed (void)
+{
+  TwitterTimeline *timeline;
+  GArray *ids;
+  gchar *buffer;
+
+  ids = g_array_new (FALSE, FALSE, sizeof (guint));
+
+  timeline = twitter_timeline_new ();
+  g_signal_connect (timeline, "items-changed",
+                    G_CALLBACK (on_items_changed),
+                    ids);
+
+  merge_page (timeline, 10, 5);
+  assert_same_ids (timeline, ids);
+
+  /* a gap in the middle, and new statuses at the top */
+  merge_page (timeline, 1, 2);
+  merge_page (timeline, 20, 3);
+  merge_page (timeline, 5, 12);
+  assert_same_ids (timeline, ids);
+
+  twitter_timeline_set_max_length (timeline, 4);
+  assert_same_ids (timeline, ids);
+
+  merge_page (timeline, 8, 16);
+  assert_same_ids (timeline, ids);
+
+  buffer = build_page (30, 2);
+  twitter_timeline_load_from_data (timeline, buffer, NULL);
+  g_free (buffer);
+
+  assert_same_ids (timeline, ids);
+  assert_status_id (timeline, 0, 31);
+
+  g_object_unref (timeline);
+  g_array_free (ids, TRUE);
+}
+
+/* a subclass overriding the class handler of ::items-changed */
+typedef struct _CountingTimeline      CountingTimeline;
+typedef struct _CountingTimelineClass CountingTimelineClass;
+
+struct _CountingTimeline
+{
+  TwitterTimeline parent_instance;
+
+  guint n_changes;
+  guint n_added;
+};
+
+struct _CountingTimelineClass
+{
+  TwitterTimelineClass parent_class;
+};
+
+GType counting_timeline_get_type (void);
+
+G_DEFINE_TYPE (CountingTimeline, counting_timeline, TWITTER_TYPE_TIMELINE);
+
+static void
+counting_timeline_items_changed (TwitterTimeline *timeline,
+                                 guint            position,
+                                 guint            removed,
+                                 guint            added)
+{
+  CountingTimeline *counting = (CountingTimeline *) timeline;
+
+  counting->n_changes += 1;
+  counting->n_added += added;
+}
+
+static void
+counting_timeline_class_init (CountingTimelineClass *klass)
+{
+  TwitterTimelineClass *timeline_class = TWITTER_TIMELINE_CLASS (klass);
+
+  timeline_class->items_changed = counting_timeline_items_changed;
+}
+
+static void
+counting_timeline_init (CountingTimeline *timeline)
+{
+}
+
+void
+test_timeline_items_changed_class (void)
+{
+  CountingTimeline *timeline;
+  GArray *ids;
+
+  ids = g_array_new (FALSE, FALSE, sizeof (guint));
+
+  /* the class handler runs with every version of GLib, next to the
+   * handlers connected to the signal
+   */
+  timeline = g_object_new (counting_timeline_get_type (), NULL);
+  g_signal_connect (timeline, "items-changed",
+                    G_CALLBACK (on_items_changed),
+                    ids);
+
+  merge_page ((TwitterTimeline *) timeline, 10, 5);
+  g_assert_cmpint (timeline->n_changes, >, 0);
+  g_assert_cmpint (timeline->n_added, ==, 5);
+  assert_same_ids ((TwitterTimeline *) timeline, ids);
+
+  g_object_unref (timeline);
+  g_array_free (ids, TRUE);
+}
+
+#if GLIB_CHECK_VERSION (2, 44, 0)
+void
+test_timeline_list_model (void)
+{
+  TwitterTimeline *timeline;
+  GListModel *model;
+  TwitterStatus *status;
+  gchar *buffer;
+
+  buffer = build_page (1, 3);
+  timeline = twitter_timeline_new_from_data (buffer);
+  g_free (buffer);
+
+  model = G_LIST_MODEL (timeline);
+  g_assert (g_list_model_get_item_type (model) == TWITTER_TYPE_STATUS);
+  g_assert_cmpint (g_list_model_get_n_items (model), ==, 3);
+
+  status = g_list_model_get_item (model, 0);
+  g_assert (status == twitter_timeline_get_pos (timeline, 0));
+  g_assert_cmpint (twitter_status_get_id (status), ==, 3);
+  g_object_unref (status);
+
+  g_assert (g_list_model_get_item (model, 3) == NULL);
+
+  g_object_unref (timeline);
+}
+#endif
+
+void
+test_timeline_binary (void)
+{
+  TwitterTimeline *timeline, *loaded;
+  TwitterStatus *status;
+  TwitterUser *user;
+  GError *error;
+  gchar *buffer, *data;
+  gsize length;
+  guint i;
+
+  buffer = build_timeline (5);
+  timeline = twitter_timeline_new_from_data (buffer);
+  g_free (buffer);
+
+  data = twitter_timeline_to_binary (timeline, &length);
+  g_assert (data != NULL);
+
+  loaded = twitter_timeline_new ();
+
+  error = NULL;
+  g_assert (twitter_timeline_load_from_binary (loaded, data, length, &error));
+  g_assert_no_error (error);
+  g_assert_cmpint (twitter_timeline_get_count (loaded), ==, 5);
+
+  for (i = 0; i < 5; i++)
+    {
+      TwitterStatus *a = twitter_timeline_get_pos (timeline, i);
+      TwitterStatus *b = twitter_timeline_get_pos (loaded, i);
+
+      compare_statuses (a, b);
+      g_assert_cmpint (twitter_status_get_timestamp (b), ==, 1241863690);
+    }
+
+  /* the statuses of a user share it */
+  user = twitter_status_get_user (twitter_timeline_get_pos (loaded, 0));
+  g_assert (user == twitter_status_get_user (twitter_timeline_get_pos (loaded, 4)));
+  g_assert_cmpstr (twitter_user_get_screen_name (user), ==, "ebassi");
+  g_assert_cmpstr (twitter_user_get_location (user), ==, "London, United Kingdom");
+
+  /* truncated data is refused, and leaves the timeline empty */
+  error = NULL;
+  g_assert (!twitter_timeline_load_from_binary (loaded, data, length - 1, &error));
+  g_assert_error (error, TWITTER_ERROR, TWITTER_ERROR_PARSE_ERROR);
+  g_assert_cmpint (twitter_timeline_get_count (loaded), ==, 0);
+  g_clear_error (&error);
+
+  /* so is the data of a different object */
+  status = twitter_status_new ();
+  g_assert (!twitter_status_load_from_binary (status, data, length, &error));
+  g_assert_error (error, TWITTER_ERROR, TWITTER_ERROR_PARSE_ERROR);
+  g_clear_error (&error);
+  g_free (data);
+
+  data = twitter_status_to_binary (twitter_timeline_get_pos (timeline, 2), &length);
+  g_assert (twitter_status_load_from_binary (status, data, length, NULL));
+  compare_statuses (twitter_timeline_get_pos (timeline, 2), status);
+  g_free (data);
+
+  g_object_unref (status);
+  g_object_unref (loaded);
+  g_object_unref (timeline);
+}
+
+void
+test_timeline_binary_perf (void)
+{
+  const guint n_runs = 20;
+  TwitterTimeline *timeline;
+  GTimer *timer;
+  gchar *buffer, *data;
+  gdouble json, binary;
+  gsize length;
+  guint i;
+
+  if (!g_test_perf ())
+    return;
+
+  buffer = build_timeline (3200);
+  timeline = twitter_timeline_new_from_data (buffer);
+  data = twitter_timeline_to_binary (timeline, &length);
+
+  g_test_message ("3200 statuses: %" G_GSIZE_FORMAT " bytes of JSON, "
+                  "%" G_GSIZE_FORMAT " bytes of binary data",
+                  strlen (buffer), length);
+
+  timer = g_timer_new ();
+
+  g_timer_start (timer);
+  for (i = 0; i < n_runs; i++)
+    twitter_timeline_load_from_data (timeline, buffer, NULL);
+  json = g_timer_elapsed (timer, NULL);
+
+  g_timer_start (timer);
+  for (i = 0; i < n_runs; i++)
+    twitter_timeline_load_from_binary (timeline, data, length, NULL);
+  binary = g_timer_elapsed (timer, NULL);
+
+  g_assert_cmpint (twitter_timeline_get_count (timeline), ==, 3200);
+
+  g_test_minimized_result (json / n_runs,
+                           "JSON, 3200 statuses: %.3f msecs",
+                           1000.0 * json / n_runs);
+  g_test_minimized_result (binary / n_runs,
+                           "binary, 3200 statuses: %.3f msecs",
+                           1000.0 * binary / n_runs);
+
+  g_timer_destroy (timer);
+  g_object_unref (timeline);
+  g_free (data);
+  g_free (buffer);
+}
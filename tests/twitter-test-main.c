@@ -38,6 +38,67 @@ main (int argc, char *argv[])
   twitter_test_add ("/user/loading",        test_user_load);
   twitter_test_add ("/user/full-parsing",   test_user_full);
   twitter_test_add ("/user/profile-image",  test_user_profile_image);
+  twitter_test_add ("/user/list-parallel",  test_user_list_parallel);
+
+  twitter_test_add ("/client/compression", test_client_compression);
+  twitter_test_add ("/client/compression-errors", test_client_compression_errors);
+  twitter_test_add ("/client/compression-property", test_client_compression_property);
+  twitter_test_add ("/client/cancel",       test_client_cancel);
+  twitter_test_add ("/client/result-ownership", test_client_result_ownership);
+  twitter_test_add ("/client/worker",       test_client_worker);
+  twitter_test_add ("/client/endpoints",    test_client_endpoints);
+  twitter_test_add ("/client/state",        test_client_state);
+
+  twitter_test_add ("/client-pool/session", test_client_pool_session);
+  twitter_test_add ("/client-pool/users",   test_client_pool_users);
+  twitter_test_add ("/client-pool/remove",  test_client_pool_remove);
+  twitter_test_add ("/client-pool/shared-users", test_client_pool_shared_users);
+  twitter_test_add ("/client-pool/authenticate", test_client_pool_authenticate);
+
+  twitter_test_add ("/store/timeline",      test_store_timeline);
+#ifdef G_OS_UNIX
+  twitter_test_add ("/store/write-error",   test_store_write_error);
+#endif
+
+  twitter_test_add ("/timeline/decoder",    test_timeline_decoder);
+  twitter_test_add ("/timeline/invalid",    test_timeline_invalid);
+  twitter_test_add ("/timeline/boundary-ids", test_timeline_boundary_ids);
+  twitter_test_add ("/timeline/long-strings", test_timeline_long_strings);
+  twitter_test_add ("/timeline/parallel",   test_timeline_parallel);
+  twitter_test_add ("/timeline/lazy",       test_timeline_lazy);
+  twitter_test_add ("/timeline/scanners",   test_timeline_scanners);
+  twitter_test_add ("/timeline/arena",      test_timeline_arena);
+  twitter_test_add ("/timeline/string-pool", test_timeline_string_pool);
+  twitter_test_add ("/timeline/timestamps", test_timeline_timestamps);
+  twitter_test_add ("/timeline/merge",      test_timeline_merge);
+  twitter_test_add ("/timeline/items-changed", test_timeline_items_changed);
+  twitter_test_add ("/timeline/items-changed-class", test_timeline_items_changed_class);
+#if GLIB_CHECK_VERSION (2, 44, 0)
+  twitter_test_add ("/timeline/list-model", test_timeline_list_model);
+#endif
+  twitter_test_add ("/timeline/binary",     test_timeline_binary);
+  twitter_test_add ("/timeline/decoder-perf", test_timeline_decoder_perf);
+  twitter_test_add ("/timeline/parser-reuse", test_timeline_parser_reuse);
+  twitter_test_add ("/timeline/binary-perf", test_timeline_binary_perf);
+
+  twitter_test_add ("/status/entities",     test_status_entities);
+
+  twitter_test_add ("/status-index/lookup", test_status_index);
+  twitter_test_add ("/status-index/search", test_status_index_search);
+  twitter_test_add ("/status-index/mentions", test_status_index_mentions);
+  twitter_test_add ("/status-index/perf",   test_status_index_perf);
+
+  twitter_test_add ("/thread-resolver/local", test_thread_resolver_local);
+  twitter_test_add ("/thread-resolver/remote", test_thread_resolver_remote);
+  twitter_test_add ("/thread-resolver/coalesce", test_thread_resolver_coalesce);
+  twitter_test_add ("/thread-resolver/max-requests", test_thread_resolver_max_requests);
+
+  twitter_test_add ("/filter/matches",      test_filter_matches);
+  twitter_test_add ("/filter/multiple",     test_filter_multiple);
+
+  twitter_test_add ("/stats/aggregations",  test_stats_aggregations);
+
+  twitter_test_add ("/status-batch/columns", test_status_batch_columns);
 
   return twitter_test_run ();
 }
@@ -0,0 +1,395 @@
+#include "twitter-test-server.h"
+
+#include <string.h>
+
+#include <libsoup/soup.h>
+
+/* a local HTTP server answering with canned responses, used to test
+ * the requests of TwitterClient without reaching the network
+ */
+struct _TwitterTestServer
+{
+  SoupServer *server;
+  GMainContext *context;
+
+  gchar *url;
+
+  /* path -> Response */
+  GHashTable *responses;
+
+  /* the messages of the paused responses */
+  GSList *paused;
+
+  guint n_requests;
+
+  /* set once n_requests reaches wait_requests */
+  guint wait_requests;
+  gboolean requests_done;
+};
+
+typedef struct {
+  gchar *encoding;
+  gchar *data;
+  gsize length;
+
+  guint paused : 1;
+} Response;
+
+static void
+response_free (gpointer data)
+{
+  Response *response = data;
+
+  g_free (response->encoding);
+  g_free (response->data);
+
+  g_free (response);
+}
+
+static void
+server_respond (SoupMessage *msg,
+                Response    *response)
+{
+  if (response == NULL || response->data == NULL)
+    {
+      soup_message_set_status (msg, response == NULL
+                                      ? SOUP_STATUS_NOT_FOUND
+                                      : SOUP_STATUS_SERVICE_UNAVAILABLE);
+      return;
+    }
+
+  if (response->encoding != NULL)
+    soup_message_headers_replace (msg->response_headers,
+                                  "Content-Encoding",
+                                  response->encoding);
+
+  soup_message_set_status (msg, SOUP_STATUS_OK);
+  soup_message_set_response (msg, "application/json",
+                             SOUP_MEMORY_COPY,
+                             response->data,
+                             response->length);
+}
+
+static void
+server_callback (SoupServer        *soup_server,
+                 SoupMessage       *msg,
+                 const char        *path,
+                 GHashTable        *query,
+                 SoupClientContext *client,
+                 gpointer           user_data)
+{
+  TwitterTestServer *server = user_data;
+  Response *response;
+
+  server->n_requests += 1;
+  if (server->n_requests >= server->wait_requests)
+    server->requests_done = TRUE;
+
+  response = g_hash_table_lookup (server->responses, path);
+
+  /* the response does not arrive until the server is resumed */
+  if (response != NULL && response->paused)
+    {
+      server->paused = g_slist_append (server->paused, g_object_ref (msg));
+      soup_server_pause_message (soup_server, msg);
+      return;
+    }
+
+  server_respond (msg, response);
+}
+
+TwitterTestServer *
+twitter_test_server_new (void)
+{
+  TwitterTestServer *server;
+  SoupAddress *address;
+
+  server = g_new0 (TwitterTestServer, 1);
+
+  server->context = g_main_context_get_thread_default ();
+  if (server->context == NULL)
+    server->context = g_main_context_default ();
+
+  g_main_context_ref (server->context);
+
+  server->responses = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                             g_free,
+                                             response_free);
+
+  address = soup_address_new_any (SOUP_ADDRESS_FAMILY_IPV4,
+                                  SOUP_ADDRESS_ANY_PORT);
+  server->server = soup_server_new (SOUP_SERVER_INTERFACE, address,
+                                    SOUP_SERVER_ASYNC_CONTEXT, server->context,
+                                    NULL);
+  g_object_unref (address);
+
+  g_assert (server->server != NULL);
+
+  soup_server_add_handler (server->server, NULL,
+                           server_callback,
+                           server,
+                           NULL);
+  soup_server_run_async (server->server);
+
+  server->url = g_strdup_printf ("http://127.0.0.1:%u",
+                                 soup_server_get_port (server->server));
+
+  return server;
+}
+
+void
+twitter_test_server_free (TwitterTestServer *server)
+{
+  /* answer the paused requests, so that their connections are
+   * closed before the server goes away
+   */
+  twitter_test_server_resume (server);
+
+  while (g_main_context_iteration (server->context, FALSE))
+    ;
+
+  soup_server_quit (server->server);
+  g_object_unref (server->server);
+
+  g_hash_table_destroy (server->responses);
+  g_main_context_unref (server->context);
+  g_free (server->url);
+
+  g_free (server);
+}
+
+const gchar *
+twitter_test_server_get_url (TwitterTestServer *server)
+{
+  return server->url;
+}
+
+guint
+twitter_test_server_get_requests (TwitterTestServer *server)
+{
+  return server->n_requests;
+}
+
+/* answers the requests for @path with @length bytes of @data, using
+ * @encoding as the Content-Encoding, if not %NULL
+ */
+void
+twitter_test_server_add (TwitterTestServer *server,
+                         const gchar       *path,
+                         const gchar       *encoding,
+                         const gchar       *data,
+                         gsize              length)
+{
+  Response *response;
+
+  response = g_new0 (Response, 1);
+  response->encoding = g_strdup (encoding);
+  response->data = g_memdup (data, length);
+  response->length = length;
+
+  g_hash_table_replace (server->responses, g_strdup (path), response);
+}
+
+/* never answers the requests for @path, until the server is freed */
+void
+twitter_test_server_add_paused (TwitterTestServer *server,
+                                const gchar       *path)
+{
+  twitter_test_server_add_delayed (server, path, NULL, 0);
+}
+
+/* answers the requests for @path with @length bytes of @data, once
+ * twitter_test_server_resume() is called
+ */
+void
+twitter_test_server_add_delayed (TwitterTestServer *server,
+                                 const gchar       *path,
+                                 const gchar       *data,
+                                 gsize              length)
+{
+  twitter_test_server_add (server, path, NULL, data, length);
+
+  ((Response *) g_hash_table_lookup (server->responses, path))->paused = TRUE;
+}
+
+/* answers the requests waiting for a delayed response, and the
+ * following ones right away; the paused responses are answered
+ * with an error
+ */
+void
+twitter_test_server_resume (TwitterTestServer *server)
+{
+  GHashTableIter iter;
+  gpointer value;
+  GSList *paused, *l;
+
+  g_hash_table_iter_init (&iter, server->responses);
+  while (g_hash_table_iter_next (&iter, NULL, &value))
+    ((Response *) value)->paused = FALSE;
+
+  paused = server->paused;
+  server->paused = NULL;
+
+  for (l = paused; l != NULL; l = l->next)
+    {
+      SoupMessage *msg = l->data;
+      Response *response;
+
+      response = g_hash_table_lookup (server->responses,
+                                      soup_message_get_uri (msg)->path);
+      server_respond (msg, response);
+
+      soup_server_unpause_message (server->server, msg);
+      g_object_unref (msg);
+    }
+
+  g_slist_free (paused);
+}
+
+/* iterates the main context until the server received @n_requests
+ * requests since it was created
+ */
+void
+twitter_test_server_wait_requests (TwitterTestServer *server,
+                                   guint              n_requests)
+{
+  server->wait_requests = n_requests;
+  server->requests_done = (server->n_requests >= n_requests);
+
+  twitter_test_run_until (&server->requests_done);
+}
+
+/* compresses @data using @format; the returned buffer should be
+ * freed using g_free()
+ */
+gchar *
+twitter_test_compress (const gchar           *data,
+                       GZlibCompressorFormat  format,
+                       gsize                 *length)
+{
+  GConverter *compressor;
+  GString *buffer;
+  gchar outbuf[4096];
+  gsize data_left = strlen (data);
+  GConverterResult res;
+
+  compressor = G_CONVERTER (g_zlib_compressor_new (format, -1));
+  buffer = g_string_new (NULL);
+
+  do
+    {
+      gsize bytes_read = 0, bytes_written = 0;
+      GError *error = NULL;
+
+      res = g_converter_convert (compressor,
+                                 data, data_left,
+                                 outbuf, sizeof (outbuf),
+                                 G_CONVERTER_INPUT_AT_END,
+                                 &bytes_read, &bytes_written,
+                                 &error);
+      g_assert_no_error (error);
+
+      g_string_append_len (buffer, outbuf, bytes_written);
+
+      data += bytes_read;
+      data_left -= bytes_read;
+    }
+  while (res != G_CONVERTER_FINISHED);
+
+  g_object_unref (compressor);
+
+  *length = buffer->len;
+
+  return g_string_free (buffer, FALSE);
+}
+
+static gboolean
+run_timeout (gpointer data)
+{
+  g_error ("Timed out while waiting for a response");
+
+  return FALSE;
+}
+
+/* iterates the thread-default main context until @done is set */
+void
+twitter_test_run_until (gboolean *done)
+{
+  GMainContext *context;
+  GSource *timeout;
+
+  context = g_main_context_get_thread_default ();
+  if (context == NULL)
+    context = g_main_context_default ();
+
+  timeout = g_timeout_source_new (10000);
+  g_source_set_callback (timeout, run_timeout, NULL, NULL);
+  g_source_attach (timeout, context);
+
+  while (!*done)
+    g_main_context_iteration (context, TRUE);
+
+  g_source_destroy (timeout);
+  g_source_unref (timeout);
+}
+
+typedef struct {
+  gboolean done;
+
+  GAsyncResult *result;
+} AsyncClosure;
+
+static void
+async_ready (GObject      *source,
+             GAsyncResult *result,
+             gpointer      user_data)
+{
+  AsyncClosure *closure = user_data;
+
+  closure->result = g_object_ref (result);
+  closure->done = TRUE;
+}
+
+/* retrieves a status using twitter_client_get_status_async(), and
+ * waits for the result
+ */
+TwitterStatus *
+twitter_test_get_status (TwitterClient  *client,
+                         guint           status_id,
+                         GError        **error)
+{
+  AsyncClosure closure = { FALSE, NULL };
+  TwitterStatus *retval;
+
+  twitter_client_get_status_async (client, status_id, NULL,
+                                   async_ready,
+                                   &closure);
+  twitter_test_run_until (&closure.done);
+
+  retval = twitter_client_get_status_finish (client, closure.result, error);
+  g_object_unref (closure.result);
+
+  return retval;
+}
+
+/* retrieves the timeline of @user using
+ * twitter_client_get_user_timeline_async(), and waits for the result
+ */
+TwitterTimeline *
+twitter_test_get_user_timeline (TwitterClient  *client,
+                                const gchar    *user,
+                                GError        **error)
+{
+  AsyncClosure closure = { FALSE, NULL };
+  TwitterTimeline *retval;
+
+  twitter_client_get_user_timeline_async (client, user, 0, 0, NULL,
+                                          async_ready,
+                                          &closure);
+  twitter_test_run_until (&closure.done);
+
+  retval = twitter_client_get_timeline_finish (client, closure.result, error);
+  g_object_unref (closure.result);
+
+  return retval;
+}
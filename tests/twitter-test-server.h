@@ -0,0 +1,41 @@
+#include <gio/gio.h>
+#include <twitter-glib/twitter-glib.h>
+
+#ifndef __TWITTER_TEST_SERVER_H__
+#define __TWITTER_TEST_SERVER_H__
+
+typedef struct _TwitterTestServer       TwitterTestServer;
+
+TwitterTestServer *twitter_test_server_new          (void);
+void               twitter_test_server_free         (TwitterTestServer *server);
+const gchar *      twitter_test_server_get_url      (TwitterTestServer *server);
+guint              twitter_test_server_get_requests (TwitterTestServer *server);
+
+void               twitter_test_server_add          (TwitterTestServer *server,
+                                                     const gchar       *path,
+                                                     const gchar       *encoding,
+                                                     const gchar       *data,
+                                                     gsize              length);
+void               twitter_test_server_add_paused   (TwitterTestServer *server,
+                                                     const gchar       *path);
+void               twitter_test_server_add_delayed  (TwitterTestServer *server,
+                                                     const gchar       *path,
+                                                     const gchar       *data,
+                                                     gsize              length);
+void               twitter_test_server_resume       (TwitterTestServer *server);
+void               twitter_test_server_wait_requests (TwitterTestServer *server,
+                                                      guint              n_requests);
+
+gchar *            twitter_test_compress            (const gchar           *data,
+                                                     GZlibCompressorFormat  format,
+                                                     gsize                 *length);
+void               twitter_test_run_until           (gboolean              *done);
+
+TwitterStatus *    twitter_test_get_status          (TwitterClient         *client,
+                                                     guint                  status_id,
+                                                     GError               **error);
+TwitterTimeline *  twitter_test_get_user_timeline   (TwitterClient         *client,
+                                                     const gchar           *user,
+                                                     GError               **error);
+
+#endif /* __TWITTER_TEST_SERVER_H__ */
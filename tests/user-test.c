@@ -1,5 +1,6 @@
 #include "twitter-test-main.h"
 #include <stdlib.h>
+#include <string.h>
 
 static const gchar valid_base[] =
 "{"
@@ -46,6 +47,33 @@ static const gchar valid_full[] =
 "  \"created_at\":\"Thu Apr 03 19:29:02 +0000 2008\""
 "}";
 
+/* a user with a variable id, used to build large user lists */
+static const gchar recorded_user[] =
+"{"
+"  \"profile_background_color\":\"9ae4e8\","
+"  \"followers_count\":182,"
+"  \"profile_image_url\":\"http:\\/\\/s3.amazonaws.com\\/twitter_production\\/profile_images\\/56107602\\/ebassi-new_normal.png\","
+"  \"description\":\"is this the way to the cabal?\","
+"  \"utc_offset\":0,"
+"  \"friends_count\":122,"
+"  \"screen_name\":\"user%u\","
+"  \"url\":\"http:\\/\\/www.emmanuelebassi.name\","
+"  \"name\":\"Emmanuele Bassi\","
+"  \"protected\":false,"
+"  \"status\":{"
+"    \"text\":\"which, I guess, it's exactly what will happen anyway\","
+"    \"truncated\":false,"
+"    \"id\":1745345411,"
+"    \"source\":\"web\","
+"    \"created_at\":\"Sat May 09 10:07:10 +0000 2009\""
+"  },"
+"  \"time_zone\":\"London\","
+"  \"location\":\"London, UK\","
+"  \"id\":%u,"
+"  \"statuses_count\":1108,"
+"  \"created_at\":\"Thu Apr 03 19:29:02 +0000 2008\""
+"}";
+
 void
 test_user_init (void)
 {
@@ -190,3 +218,86 @@ test_user_profile_image (void)
   g_signal_handlers_disconnect_by_func (user, G_CALLBACK (on_user_changed), NULL);
   g_object_unref (user);
 }
+
+static void
+compare_users (TwitterUser *a,
+               TwitterUser *b)
+{
+  g_assert_cmpint (twitter_user_get_id (a), ==, twitter_user_get_id (b));
+  g_assert_cmpstr (twitter_user_get_name (a), ==, twitter_user_get_name (b));
+  g_assert_cmpstr (twitter_user_get_screen_name (a), ==, twitter_user_get_screen_name (b));
+  g_assert_cmpstr (twitter_user_get_location (a), ==, twitter_user_get_location (b));
+  g_assert_cmpstr (twitter_user_get_profile_image_url (a), ==, twitter_user_get_profile_image_url (b));
+  g_assert_cmpint (twitter_user_get_followers_count (a), ==, twitter_user_get_followers_count (b));
+  g_assert ((twitter_user_get_status (a) == NULL) == (twitter_user_get_status (b) == NULL));
+}
+
+/* the users of a list built by the parse pool must be the same, and
+ * in the same order, as the users decoded one by one
+ */
+static void
+check_parallel_user_list (const gchar *buffer,
+                          GPtrArray   *elements)
+{
+  TwitterUserList *user_list;
+  guint i;
+
+  user_list = twitter_user_list_new_from_data (buffer);
+  g_assert_cmpint (twitter_user_list_get_count (user_list), ==, elements->len);
+
+  for (i = 0; i < elements->len; i++)
+    {
+      TwitterUser *user;
+
+      user = twitter_user_new_from_data (g_ptr_array_index (elements, i));
+      compare_users (twitter_user_list_get_pos (user_list, i), user);
+      g_object_unref (user);
+    }
+
+  g_object_unref (user_list);
+}
+
+void
+test_user_list_parallel (void)
+{
+  GPtrArray *elements;
+  GString *buffer;
+  guint n_users, i;
+
+  /* enough users for both the array and the buffer thresholds of
+   * the parse pool; the pool is only used on machines with more
+   * than one processor
+   */
+  n_users = 256;
+
+  elements = g_ptr_array_new ();
+  buffer = g_string_new ("[");
+
+  /* in no particular order, since the list keeps the response order */
+  for (i = 0; i < n_users; i++)
+    {
+      guint user_id = (i * 7919) % n_users + 1;
+      gchar *element = g_strdup_printf (recorded_user, user_id, user_id);
+
+      if (i > 0)
+        g_string_append_c (buffer, ',');
+
+      g_string_append (buffer, element);
+      g_ptr_array_add (elements, element);
+    }
+
+  g_string_append_c (buffer, ']');
+  g_assert_cmpint (buffer->len, >, 128 * 1024);
+
+  twitter_set_parse_flags (TWITTER_PARSE_DEFAULT);
+  check_parallel_user_list (buffer->str, elements);
+
+  twitter_set_parse_flags (TWITTER_PARSE_USE_JSON_GLIB);
+  check_parallel_user_list (buffer->str, elements);
+
+  twitter_set_parse_flags (TWITTER_PARSE_DEFAULT);
+
+  g_ptr_array_foreach (elements, (GFunc) g_free, NULL);
+  g_ptr_array_free (elements, TRUE);
+  g_string_free (buffer, TRUE);
+}
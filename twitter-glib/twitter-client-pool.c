@@ -0,0 +1,673 @@
+/* twitter-client-pool.c: Pool of clients sharing a session
+ *
+ * This file is part of Twitter-GLib.
+ * Copyright (C) 2008  Emmanuele Bassi  <ebassi@gnome.org>
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:twitter-client-pool
+ * @short_description: A pool of clients for multiple accounts
+ *
+ * #TwitterClientPool multiplexes many accounts over a single HTTP
+ * session, so that every #TwitterClient inside the pool shares the
+ * same connections to the provider.
+ *
+ * Each account is represented by a #TwitterClient, created using
+ * twitter_client_pool_add_account(); every client keeps its own
+ * request handles and rate limit state, so they can be used exactly
+ * like a stand-alone #TwitterClient.
+ *
+ * The users received by any client inside the pool are also stored
+ * inside a shared cache, which can be queried using
+ * twitter_client_pool_lookup_user(). Every status, user list and
+ * user received by a client inside the pool references the cached
+ * #TwitterUser instance, which is refreshed each time a newer copy
+ * of the same user is received; the #TwitterUser::changed signal is
+ * emitted when that happens. The cache holds at most #TwitterClientPool:max-users users; the
+ * least recently used users are released first.
+ *
+ * Clients inside a pool authenticate every request preemptively
+ * using their credentials, since the authentication state cannot be
+ * shared between accounts; the #TwitterClient::authenticate signal
+ * will only be emitted with the %TWITTER_AUTH_SUCCESS and
+ * %TWITTER_AUTH_FAILED states.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include <libsoup/soup.h>
+
+#ifdef HAVE_LIBSOUP_GNOME
+#include <libsoup/soup-gnome.h>
+#endif
+
+#include "twitter-api.h"
+#include "twitter-client.h"
+#include "twitter-client-pool.h"
+#include "twitter-enum-types.h"
+#include "twitter-private.h"
+#include "twitter-user.h"
+
+#define TWITTER_CLIENT_POOL_GET_PRIVATE(obj)    (G_TYPE_INSTANCE_GET_PRIVATE ((obj), TWITTER_TYPE_CLIENT_POOL, TwitterClientPoolPrivate))
+
+#define DEFAULT_MAX_CONNECTIONS 8
+#define DEFAULT_MAX_USERS       1024
+
+struct _TwitterClientPoolPrivate
+{
+  SoupSession *session;
+
+  gchar *user_agent;
+
+  TwitterProvider provider;
+  gchar *base_url;
+
+  gint max_connections;
+
+  /* email -> TwitterClient */
+  GHashTable *clients;
+
+  /* user id -> link inside users_lru */
+  GHashTable *users;
+
+  /* TwitterUser, the most recently used first */
+  GQueue users_lru;
+  guint max_users;
+};
+
+enum
+{
+  PROP_0,
+
+  PROP_USER_AGENT,
+  PROP_PROVIDER,
+  PROP_BASE_URL,
+  PROP_MAX_CONNECTIONS,
+  PROP_MAX_USERS
+};
+
+G_DEFINE_TYPE (TwitterClientPool, twitter_client_pool, G_TYPE_OBJECT);
+
+/* releases the least recently used users exceeding max-users */
+static void
+twitter_client_pool_trim_users (TwitterClientPool *pool)
+{
+  TwitterClientPoolPrivate *priv = pool->priv;
+
+  if (priv->users == NULL)
+    return;
+
+  while (priv->users_lru.length > priv->max_users)
+    {
+      TwitterUser *user = g_queue_pop_tail (&priv->users_lru);
+
+      g_hash_table_remove (priv->users,
+                           GUINT_TO_POINTER (twitter_user_get_id (user)));
+      g_object_unref (user);
+    }
+}
+
+/* marks the cached user at @link as the most recently used */
+static void
+twitter_client_pool_touch_user (TwitterClientPool *pool,
+                                GList             *link)
+{
+  TwitterClientPoolPrivate *priv = pool->priv;
+
+  if (priv->users_lru.head == link)
+    return;
+
+  g_queue_unlink (&priv->users_lru, link);
+  g_queue_push_head_link (&priv->users_lru, link);
+}
+
+static void
+detach_client (gpointer key,
+               gpointer value,
+               gpointer data)
+{
+  _twitter_client_set_pool (value, NULL);
+}
+
+static void
+twitter_client_pool_dispose (GObject *gobject)
+{
+  TwitterClientPoolPrivate *priv = TWITTER_CLIENT_POOL (gobject)->priv;
+
+  if (priv->clients)
+    {
+      g_hash_table_foreach (priv->clients, detach_client, NULL);
+      g_hash_table_destroy (priv->clients);
+      priv->clients = NULL;
+    }
+
+  if (priv->users)
+    {
+      g_hash_table_destroy (priv->users);
+      priv->users = NULL;
+
+      g_queue_foreach (&priv->users_lru, (GFunc) g_object_unref, NULL);
+      g_queue_clear (&priv->users_lru);
+    }
+
+  /* clients still referenced outside of the pool keep using the
+   * session, so we must not abort it here
+   */
+  if (priv->session)
+    {
+      g_object_unref (priv->session);
+      priv->session = NULL;
+    }
+
+  G_OBJECT_CLASS (twitter_client_pool_parent_class)->dispose (gobject);
+}
+
+static void
+twitter_client_pool_finalize (GObject *gobject)
+{
+  TwitterClientPoolPrivate *priv = TWITTER_CLIENT_POOL (gobject)->priv;
+
+  g_free (priv->user_agent);
+  g_free (priv->base_url);
+
+  G_OBJECT_CLASS (twitter_client_pool_parent_class)->finalize (gobject);
+}
+
+static void
+twitter_client_pool_set_property (GObject      *gobject,
+                                  guint         prop_id,
+                                  const GValue *value,
+                                  GParamSpec   *pspec)
+{
+  TwitterClientPoolPrivate *priv = TWITTER_CLIENT_POOL (gobject)->priv;
+
+  switch (prop_id)
+    {
+    case PROP_USER_AGENT:
+      g_free (priv->user_agent);
+      priv->user_agent = g_value_dup_string (value);
+      break;
+
+    case PROP_PROVIDER:
+      priv->provider = g_value_get_enum (value);
+      break;
+
+    case PROP_BASE_URL:
+      g_free (priv->base_url);
+      if (g_value_get_string (value) != NULL)
+        {
+          priv->base_url = g_value_dup_string (value);
+          priv->provider = TWITTER_CUSTOM_PROVIDER;
+        }
+      else
+        priv->base_url = NULL;
+      break;
+
+    case PROP_MAX_CONNECTIONS:
+      priv->max_connections = g_value_get_int (value);
+      break;
+
+    case PROP_MAX_USERS:
+      priv->max_users = g_value_get_uint (value);
+      twitter_client_pool_trim_users (TWITTER_CLIENT_POOL (gobject));
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+twitter_client_pool_get_property (GObject    *gobject,
+                                  guint       prop_id,
+                                  GValue     *value,
+                                  GParamSpec *pspec)
+{
+  TwitterClientPoolPrivate *priv = TWITTER_CLIENT_POOL (gobject)->priv;
+
+  switch (prop_id)
+    {
+    case PROP_USER_AGENT:
+      g_value_set_string (value, priv->user_agent);
+      break;
+
+    case PROP_PROVIDER:
+      g_value_set_enum (value, priv->provider);
+      break;
+
+    case PROP_BASE_URL:
+      g_value_set_string (value, priv->base_url);
+      break;
+
+    case PROP_MAX_CONNECTIONS:
+      g_value_set_int (value, priv->max_connections);
+      break;
+
+    case PROP_MAX_USERS:
+      g_value_set_uint (value, priv->max_users);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+twitter_client_pool_authenticate (SoupSession *session,
+                                  SoupMessage *msg,
+                                  SoupAuth    *auth,
+                                  gboolean     retrying,
+                                  gpointer     user_data)
+{
+  /* dispatched to the client that queued the message */
+  _twitter_client_authenticate (msg, auth, retrying);
+}
+
+static void
+twitter_client_pool_constructed (GObject *gobject)
+{
+  TwitterClientPoolPrivate *priv = TWITTER_CLIENT_POOL (gobject)->priv;
+  gchar *user_agent;
+
+  if (priv->user_agent == NULL)
+    user_agent = g_strdup ("Twitter-GLib/" VERSION);
+  else
+    user_agent = g_strdup (priv->user_agent);
+
+  priv->session =
+    soup_session_async_new_with_options ("user-agent", user_agent,
+                                         "max-conns", priv->max_connections,
+                                         "max-conns-per-host", priv->max_connections,
+                                         NULL);
+
+  if (g_getenv ("TWITTER_GLIB_DEBUG"))
+    {
+      SoupLogger* logger = soup_logger_new (SOUP_LOGGER_LOG_BODY, 0);
+
+      soup_session_add_feature (priv->session, SOUP_SESSION_FEATURE (logger));
+    }
+
+  /* a single handler answers the challenges of every client; it
+   * does not reference the pool, since the clients can outlive it
+   */
+  g_signal_connect (priv->session, "authenticate",
+                    G_CALLBACK (twitter_client_pool_authenticate),
+                    NULL);
+
+#ifdef HAVE_LIBSOUP_GNOME
+  /* use the proxy support in libsoup-gnome */
+  soup_session_add_feature_by_type (priv->session,
+                                    SOUP_TYPE_PROXY_RESOLVER_GNOME);
+#endif /* HAVE_LIBSOUP_GNOME */
+
+  if (priv->base_url == NULL && priv->provider == TWITTER_CUSTOM_PROVIDER)
+    {
+      g_critical ("No base URL has been set for a custom provider. "
+                  "Falling base to the default provider");
+      priv->provider = TWITTER_DEFAULT_PROVIDER;
+    }
+
+  g_free (user_agent);
+}
+
+static void
+twitter_client_pool_class_init (TwitterClientPoolClass *klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  GParamSpec *pspec;
+
+  g_type_class_add_private (klass, sizeof (TwitterClientPoolPrivate));
+
+  gobject_class->constructed = twitter_client_pool_constructed;
+  gobject_class->set_property = twitter_client_pool_set_property;
+  gobject_class->get_property = twitter_client_pool_get_property;
+  gobject_class->dispose = twitter_client_pool_dispose;
+  gobject_class->finalize = twitter_client_pool_finalize;
+
+  pspec = g_param_spec_string ("user-agent",
+                               "User Agent",
+                               "The client name to be used when connecting",
+                               NULL,
+                               G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE);
+  g_object_class_install_property (gobject_class, PROP_USER_AGENT, pspec);
+
+  pspec = g_param_spec_enum ("provider",
+                             "Provider",
+                             "The Twitter service provider",
+                             TWITTER_TYPE_PROVIDER,
+                             TWITTER_DEFAULT_PROVIDER,
+                             G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE);
+  g_object_class_install_property (gobject_class, PROP_PROVIDER, pspec);
+
+  pspec = g_param_spec_string ("base-url",
+                               "Base URL",
+                               "The base URL of the Twitter service provider",
+                               NULL,
+                               G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE);
+  g_object_class_install_property (gobject_class, PROP_BASE_URL, pspec);
+
+  pspec = g_param_spec_int ("max-connections",
+                            "Max Connections",
+                            "The maximum number of connections shared "
+                            "by the clients",
+                            1, G_MAXINT, DEFAULT_MAX_CONNECTIONS,
+                            G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE);
+  g_object_class_install_property (gobject_class, PROP_MAX_CONNECTIONS, pspec);
+
+  /**
+   * TwitterClientPool:max-users:
+   *
+   * The maximum number of users kept inside the shared cache; once
+   * the cache is full, the least recently used user is released.
+   *
+   * Since: 0.9.10
+   */
+  pspec = g_param_spec_uint ("max-users",
+                             "Max Users",
+                             "The maximum number of cached users",
+                             1, G_MAXUINT, DEFAULT_MAX_USERS,
+                             G_PARAM_READWRITE);
+  g_object_class_install_property (gobject_class, PROP_MAX_USERS, pspec);
+}
+
+static void
+twitter_client_pool_init (TwitterClientPool *pool)
+{
+  TwitterClientPoolPrivate *priv;
+
+  pool->priv = priv = TWITTER_CLIENT_POOL_GET_PRIVATE (pool);
+
+  priv->provider = TWITTER_DEFAULT_PROVIDER;
+  priv->max_connections = DEFAULT_MAX_CONNECTIONS;
+  priv->max_users = DEFAULT_MAX_USERS;
+
+  priv->clients = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                         g_free,
+                                         g_object_unref);
+  priv->users = g_hash_table_new (NULL, NULL);
+  g_queue_init (&priv->users_lru);
+}
+
+/**
+ * twitter_client_pool_new:
+ *
+ * Creates a new #TwitterClientPool using the default provider.
+ *
+ * Return value: the newly created #TwitterClientPool. Use
+ *   g_object_unref() to free the allocated resources
+ *
+ * Since: 0.9.10
+ */
+TwitterClientPool *
+twitter_client_pool_new (void)
+{
+  return g_object_new (TWITTER_TYPE_CLIENT_POOL, NULL);
+}
+
+/**
+ * twitter_client_pool_new_full:
+ * @provider: the provider logical id
+ * @base_url: the base URL of the provider, or %NULL if @provider
+ *    is not %TWITTER_CUSTOM_PROVIDER
+ *
+ * Creates a new #TwitterClientPool using the given @provider.
+ *
+ * Return value: the newly created #TwitterClientPool. Use
+ *   g_object_unref() to free the allocated resources
+ *
+ * Since: 0.9.10
+ */
+TwitterClientPool *
+twitter_client_pool_new_full (TwitterProvider  provider,
+                              const gchar     *base_url)
+{
+  if (provider == TWITTER_CUSTOM_PROVIDER)
+    g_return_val_if_fail (base_url != NULL, NULL);
+
+  return g_object_new (TWITTER_TYPE_CLIENT_POOL,
+                       "provider", provider,
+                       "base-url", base_url,
+                       NULL);
+}
+
+/**
+ * twitter_client_pool_add_account:
+ * @pool: a #TwitterClientPool
+ * @email: the email address of the user
+ * @password: the password of the user
+ *
+ * Adds an account to @pool. If an account for @email already
+ * exists, its password will be updated.
+ *
+ * Return value: the #TwitterClient for the account. The returned
+ *   client is owned by @pool and should not be unreferenced
+ *
+ * Since: 0.9.10
+ */
+TwitterClient *
+twitter_client_pool_add_account (TwitterClientPool *pool,
+                                 const gchar       *email,
+                                 const gchar       *password)
+{
+  TwitterClientPoolPrivate *priv;
+  TwitterClient *client;
+
+  g_return_val_if_fail (TWITTER_IS_CLIENT_POOL (pool), NULL);
+  g_return_val_if_fail (email != NULL, NULL);
+  g_return_val_if_fail (password != NULL, NULL);
+
+  priv = pool->priv;
+
+  client = g_hash_table_lookup (priv->clients, email);
+  if (client != NULL)
+    {
+      twitter_client_set_user (client, email, password);
+      return client;
+    }
+
+  client = g_object_new (TWITTER_TYPE_CLIENT,
+                         "provider", priv->provider,
+                         "base-url", priv->base_url,
+                         "email", email,
+                         "password", password,
+                         "session", priv->session,
+                         NULL);
+
+  _twitter_client_set_pool (client, pool);
+
+  g_hash_table_replace (priv->clients, g_strdup (email), client);
+
+  return client;
+}
+
+/**
+ * twitter_client_pool_remove_account:
+ * @pool: a #TwitterClientPool
+ * @email: the email address of the user
+ *
+ * Removes the account for @email from @pool. The #TwitterClient
+ * for the account will be released.
+ *
+ * Return value: %TRUE if the account was found
+ *
+ * Since: 0.9.10
+ */
+gboolean
+twitter_client_pool_remove_account (TwitterClientPool *pool,
+                                    const gchar       *email)
+{
+  TwitterClient *client;
+
+  g_return_val_if_fail (TWITTER_IS_CLIENT_POOL (pool), FALSE);
+  g_return_val_if_fail (email != NULL, FALSE);
+
+  client = g_hash_table_lookup (pool->priv->clients, email);
+  if (client == NULL)
+    return FALSE;
+
+  _twitter_client_set_pool (client, NULL);
+
+  return g_hash_table_remove (pool->priv->clients, email);
+}
+
+/**
+ * twitter_client_pool_get_client:
+ * @pool: a #TwitterClientPool
+ * @email: the email address of the user
+ *
+ * Retrieves the #TwitterClient for the account of @email.
+ *
+ * Return value: a #TwitterClient owned by @pool, or %NULL
+ *
+ * Since: 0.9.10
+ */
+TwitterClient *
+twitter_client_pool_get_client (TwitterClientPool *pool,
+                                const gchar       *email)
+{
+  g_return_val_if_fail (TWITTER_IS_CLIENT_POOL (pool), NULL);
+  g_return_val_if_fail (email != NULL, NULL);
+
+  return g_hash_table_lookup (pool->priv->clients, email);
+}
+
+static void
+add_client_to_list (gpointer key,
+                    gpointer value,
+                    gpointer data)
+{
+  GList **list = data;
+
+  *list = g_list_prepend (*list, value);
+}
+
+/**
+ * twitter_client_pool_get_clients:
+ * @pool: a #TwitterClientPool
+ *
+ * Retrieves all the clients inside @pool.
+ *
+ * Return value: a list of #TwitterClient. The clients are owned by
+ *   @pool and should not be unreferenced. Use g_list_free() to free
+ *   the resources allocated by the list
+ *
+ * Since: 0.9.10
+ */
+GList *
+twitter_client_pool_get_clients (TwitterClientPool *pool)
+{
+  GList *retval = NULL;
+
+  g_return_val_if_fail (TWITTER_IS_CLIENT_POOL (pool), NULL);
+
+  g_hash_table_foreach (pool->priv->clients, add_client_to_list, &retval);
+
+  return retval;
+}
+
+/**
+ * twitter_client_pool_get_n_clients:
+ * @pool: a #TwitterClientPool
+ *
+ * Retrieves the number of accounts inside @pool.
+ *
+ * Return value: the number of clients
+ *
+ * Since: 0.9.10
+ */
+guint
+twitter_client_pool_get_n_clients (TwitterClientPool *pool)
+{
+  g_return_val_if_fail (TWITTER_IS_CLIENT_POOL (pool), 0);
+
+  return g_hash_table_size (pool->priv->clients);
+}
+
+/**
+ * twitter_client_pool_lookup_user:
+ * @pool: a #TwitterClientPool
+ * @user_id: the id of a user
+ *
+ * Looks up the last #TwitterUser with @user_id received by any
+ * of the clients inside @pool, unless it has been released from the
+ * cache. See #TwitterClientPool:max-users.
+ *
+ * Return value: a #TwitterUser owned by @pool, or %NULL. Use
+ *   g_object_ref() to keep it after receiving more users
+ *
+ * Since: 0.9.10
+ */
+TwitterUser *
+twitter_client_pool_lookup_user (TwitterClientPool *pool,
+                                 guint              user_id)
+{
+  GList *link;
+
+  g_return_val_if_fail (TWITTER_IS_CLIENT_POOL (pool), NULL);
+
+  link = g_hash_table_lookup (pool->priv->users,
+                              GUINT_TO_POINTER (user_id));
+  if (link == NULL)
+    return NULL;
+
+  twitter_client_pool_touch_user (pool, link);
+
+  return link->data;
+}
+
+/* caches @user, returning the instance shared by every client inside
+ * @pool; an already cached instance is refreshed with the fields of
+ * @user, so that the statuses holding it always show the newest ones
+ */
+TwitterUser *
+_twitter_client_pool_cache_user (TwitterClientPool *pool,
+                                 TwitterUser       *user)
+{
+  TwitterClientPoolPrivate *priv = pool->priv;
+  GList *link;
+  guint user_id;
+
+  user_id = twitter_user_get_id (user);
+  if (user_id == 0 || priv->users == NULL)
+    return user;
+
+  link = g_hash_table_lookup (priv->users, GUINT_TO_POINTER (user_id));
+  if (link != NULL)
+    {
+      _twitter_user_update (link->data, user);
+      twitter_client_pool_touch_user (pool, link);
+
+      return link->data;
+    }
+
+  /* download profile images through the shared connections */
+  _twitter_user_set_session (user, priv->session);
+
+  g_queue_push_head (&priv->users_lru, g_object_ref (user));
+  g_hash_table_insert (priv->users,
+                       GUINT_TO_POINTER (user_id),
+                       priv->users_lru.head);
+
+  twitter_client_pool_trim_users (pool);
+
+  return user;
+}
@@ -0,0 +1,86 @@
+/* twitter-client-pool.h: Pool of clients sharing a session
+ *
+ * This file is part of Twitter-GLib.
+ * Copyright (C) 2008  Emmanuele Bassi  <ebassi@gnome.org>
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef __TWITTER_CLIENT_POOL_H__
+#define __TWITTER_CLIENT_POOL_H__
+
+#include <glib-object.h>
+
+#include <twitter-glib/twitter-client.h>
+#include <twitter-glib/twitter-user.h>
+
+G_BEGIN_DECLS
+
+#define TWITTER_TYPE_CLIENT_POOL                (twitter_client_pool_get_type ())
+#define TWITTER_CLIENT_POOL(obj)                (G_TYPE_CHECK_INSTANCE_CAST ((obj), TWITTER_TYPE_CLIENT_POOL, TwitterClientPool))
+#define TWITTER_IS_CLIENT_POOL(obj)             (G_TYPE_CHECK_INSTANCE_TYPE ((obj), TWITTER_TYPE_CLIENT_POOL))
+#define TWITTER_CLIENT_POOL_CLASS(klass)        (G_TYPE_CHECK_CLASS_CAST ((klass), TWITTER_TYPE_CLIENT_POOL, TwitterClientPoolClass))
+#define TWITTER_IS_CLIENT_POOL_CLASS(klass)     (G_TYPE_CHECK_CLASS_TYPE ((klass), TWITTER_TYPE_CLIENT_POOL))
+#define TWITTER_CLIENT_POOL_GET_CLASS(obj)      (G_TYPE_INSTANCE_GET_CLASS ((obj), TWITTER_TYPE_CLIENT_POOL, TwitterClientPoolClass))
+
+typedef struct _TwitterClientPool               TwitterClientPool;
+typedef struct _TwitterClientPoolPrivate        TwitterClientPoolPrivate;
+typedef struct _TwitterClientPoolClass          TwitterClientPoolClass;
+
+/**
+ * TwitterClientPool:
+ *
+ * The #TwitterClientPool struct contains private data only, and
+ * should only be accessed using the functions below.
+ */
+struct _TwitterClientPool
+{
+  /*< private >*/
+  GObject parent_instance;
+
+  TwitterClientPoolPrivate *priv;
+};
+
+/**
+ * TwitterClientPoolClass:
+ *
+ * The #TwitterClientPoolClass struct contains only private data
+ */
+struct _TwitterClientPoolClass
+{
+  /*< private >*/
+  GObjectClass parent_class;
+};
+
+GType              twitter_client_pool_get_type       (void) G_GNUC_CONST;
+
+TwitterClientPool *twitter_client_pool_new            (void);
+TwitterClientPool *twitter_client_pool_new_full       (TwitterProvider    provider,
+                                                       const gchar       *base_url);
+
+TwitterClient *    twitter_client_pool_add_account    (TwitterClientPool *pool,
+                                                       const gchar       *email,
+                                                       const gchar       *password);
+gboolean           twitter_client_pool_remove_account (TwitterClientPool *pool,
+                                                       const gchar       *email);
+TwitterClient *    twitter_client_pool_get_client     (TwitterClientPool *pool,
+                                                       const gchar       *email);
+GList *            twitter_client_pool_get_clients    (TwitterClientPool *pool);
+guint              twitter_client_pool_get_n_clients  (TwitterClientPool *pool);
+
+TwitterUser *      twitter_client_pool_lookup_user    (TwitterClientPool *pool,
+                                                       guint              user_id);
+
+G_END_DECLS
+
+#endif /* __TWITTER_CLIENT_POOL_H__ */
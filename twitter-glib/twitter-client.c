@@ -73,6 +73,7 @@
 #include "twitter-client.h"
 #include "twitter-common.h"
 #include "twitter-enum-types.h"
+#include "twitter-filter.h"
 #include "twitter-marshal.h"
 #include "twitter-private.h"
 #include "twitter-status.h"
@@ -86,10 +87,34 @@
 
 #define TWITTER_CLIENT_GET_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE ((obj), TWITTER_TYPE_CLIENT, TwitterClientPrivate))
 
+#define N_ENDPOINTS             (TWITTER_ENDPOINT_ARCHIVE + 1)
+
+/* the number of statuses kept for each endpoint */
+#define ENDPOINT_MAX_STATUSES   200
+
+/* only the statuses of the authenticated user, and of the newest page,
+ * are kept for each endpoint: the timelines of other users and the
+ * older pages would mix with them, and change the newest status id
+ */
+#define IS_DEFAULT_USER(u)      ((u) == NULL || *(u) == '\0')
+#define IS_FIRST_PAGE(p)        ((p) <= 1)
+
+/* the state saved by twitter_client_save_state() */
+#define STATE_GROUP             "Client"
+#define STATE_VERSION           1
+
+/* the window of the rate limitation, used to expire the saved
+ * counters when the provider did not say when they reset
+ */
+#define RATE_LIMIT_WINDOW       3600
+
 struct _TwitterClientPrivate
 {
   SoupSession *session_async;
 
+  /* the pool owning the client, if any */
+  TwitterClientPool *pool;
+
   gchar *user_agent;
 
   TwitterProvider provider;
@@ -105,7 +130,28 @@ struct _TwitterClientPrivate
   gint rate_limit;
   gint rate_limit_remaining;
 
-  guint auth_complete : 1;
+  /* when the counters reset, in seconds since the epoch, or 0 */
+  gint64 rate_limit_reset;
+
+  guint64 bytes_received;
+  guint64 bytes_decoded;
+
+  /* the statuses received from each endpoint, created on demand */
+  TwitterTimeline *endpoints[N_ENDPOINTS];
+
+  /* only the statuses matching the filter are emitted, if set */
+  TwitterFilter *filter;
+
+  /* the worker thread running the session, if any */
+  GThread *worker_thread;
+  GMainLoop *worker_loop;
+  GMainContext *worker_context;
+  GMainContext *caller_context;
+
+  guint auth_complete  : 1;
+  guint compression    : 1;
+  guint shared_session : 1;
+  guint use_thread     : 1;
 };
 
 enum
@@ -118,7 +164,11 @@ enum
   PROP_PROVIDER,
   PROP_BASE_URL,
   PROP_MAX_REQUESTS,
-  PROP_REMAINING_REQUESTS
+  PROP_REMAINING_REQUESTS,
+  PROP_COMPRESSION,
+  PROP_SESSION,
+  PROP_USE_THREAD,
+  PROP_FILTER
 };
 
 enum
@@ -149,14 +199,136 @@ twitter_debug (const gchar *action,
 # define twitter_debug(a,b)
 #endif /* TWEET_ENABLE_DEBUG */
 
+/* schedules @func to be called inside @context */
+static void
+twitter_client_invoke (GMainContext *context,
+                       GSourceFunc   func,
+                       gpointer      data)
+{
+  GSource *source;
+
+  source = g_idle_source_new ();
+  g_source_set_priority (source, G_PRIORITY_DEFAULT);
+  g_source_set_callback (source, func, data, NULL);
+  g_source_attach (source, context);
+  g_source_unref (source);
+}
+
+static gpointer
+twitter_client_worker (gpointer data)
+{
+  GMainLoop *loop = data;
+  GMainContext *context = g_main_loop_get_context (loop);
+
+  g_main_context_push_thread_default (context);
+  g_main_loop_run (loop);
+  g_main_context_pop_thread_default (context);
+
+  g_main_loop_unref (loop);
+
+  return NULL;
+}
+
+static gboolean
+twitter_client_worker_quit (gpointer data)
+{
+  g_main_loop_quit (data);
+
+  return FALSE;
+}
+
+static void
+twitter_client_start_worker (TwitterClient *client)
+{
+  TwitterClientPrivate *priv = client->priv;
+  GError *error = NULL;
+
+  if (!g_thread_supported ())
+    {
+      g_warning ("The GLib thread system has not been initialized; "
+                 "call g_thread_init() before creating a threaded "
+                 "TwitterClient");
+      return;
+    }
+
+  priv->worker_context = g_main_context_new ();
+  priv->worker_loop = g_main_loop_new (priv->worker_context, FALSE);
+
+  priv->worker_thread = g_thread_create (twitter_client_worker,
+                                         g_main_loop_ref (priv->worker_loop),
+                                         TRUE,
+                                         &error);
+  if (error != NULL)
+    {
+      g_warning ("Unable to create the worker thread: %s", error->message);
+      g_error_free (error);
+
+      /* the reference held by the thread */
+      g_main_loop_unref (priv->worker_loop);
+
+      g_main_loop_unref (priv->worker_loop);
+      priv->worker_loop = NULL;
+
+      g_main_context_unref (priv->worker_context);
+      priv->worker_context = NULL;
+
+      return;
+    }
+
+  /* results are delivered to the context of the thread that
+   * created the client
+   */
+  priv->caller_context = g_main_context_get_thread_default ();
+  if (priv->caller_context == NULL)
+    priv->caller_context = g_main_context_default ();
+
+  g_main_context_ref (priv->caller_context);
+}
+
 static void
 twitter_client_finalize (GObject *gobject)
 {
   TwitterClientPrivate *priv = TWITTER_CLIENT (gobject)->priv;
+  guint i;
+
+  /* every request holds a reference on the client, so the worker
+   * thread is idle by now and the session can be used from here
+   */
+  if (priv->worker_thread != NULL)
+    {
+      twitter_client_invoke (priv->worker_context,
+                             twitter_client_worker_quit,
+                             priv->worker_loop);
+
+      g_thread_join (priv->worker_thread);
+      priv->worker_thread = NULL;
+    }
+
+  if (priv->auth_id)
+    g_signal_handler_disconnect (priv->session_async, priv->auth_id);
+
+  /* a shared session is used by other clients as well */
+  if (!priv->shared_session)
+    soup_session_abort (priv->session_async);
 
-  soup_session_abort (priv->session_async);
   g_object_unref (priv->session_async);
 
+  if (priv->worker_loop != NULL)
+    g_main_loop_unref (priv->worker_loop);
+
+  if (priv->worker_context != NULL)
+    g_main_context_unref (priv->worker_context);
+
+  if (priv->caller_context != NULL)
+    g_main_context_unref (priv->caller_context);
+
+  for (i = 0; i < N_ENDPOINTS; i++)
+    if (priv->endpoints[i] != NULL)
+      g_object_unref (priv->endpoints[i]);
+
+  if (priv->filter != NULL)
+    g_object_unref (priv->filter);
+
   g_free (priv->base_url);
   g_free (priv->user_agent);
   g_free (priv->email);
@@ -205,6 +377,24 @@ twitter_client_set_property (GObject      *gobject,
         priv->base_url = NULL;
       break;
 
+    case PROP_COMPRESSION:
+      twitter_client_set_compression (TWITTER_CLIENT (gobject),
+                                      g_value_get_boolean (value));
+      break;
+
+    case PROP_SESSION:
+      priv->session_async = g_value_dup_object (value);
+      break;
+
+    case PROP_USE_THREAD:
+      priv->use_thread = g_value_get_boolean (value);
+      break;
+
+    case PROP_FILTER:
+      twitter_client_set_filter (TWITTER_CLIENT (gobject),
+                                 g_value_get_object (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
       break;
@@ -249,6 +439,22 @@ twitter_client_get_property (GObject    *gobject,
       g_value_set_int (value, priv->rate_limit_remaining);
       break;
 
+    case PROP_COMPRESSION:
+      g_value_set_boolean (value, priv->compression);
+      break;
+
+    case PROP_SESSION:
+      g_value_set_object (value, priv->session_async);
+      break;
+
+    case PROP_USE_THREAD:
+      g_value_set_boolean (value, priv->worker_thread != NULL);
+      break;
+
+    case PROP_FILTER:
+      g_value_set_object (value, priv->filter);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
       break;
@@ -259,29 +465,48 @@ static void
 twitter_client_constructed (GObject *gobject)
 {
   TwitterClientPrivate *priv = TWITTER_CLIENT (gobject)->priv;
-  gchar *user_agent;
 
-  if (priv->user_agent == NULL)
-    user_agent = g_strdup ("Twitter-GLib/" VERSION);
+  if (priv->session_async != NULL)
+    {
+      priv->shared_session = TRUE;
+
+      if (priv->use_thread)
+        g_warning ("A TwitterClient using a shared session cannot use "
+                   "a worker thread");
+    }
   else
-    user_agent = g_strdup (priv->user_agent);
+    {
+      gchar *user_agent;
 
-  priv->session_async =
-    soup_session_async_new_with_options ("user-agent", user_agent, NULL);
+      if (priv->use_thread)
+        twitter_client_start_worker (TWITTER_CLIENT (gobject));
 
-  if (g_getenv ("TWITTER_GLIB_DEBUG"))
-    {
-      SoupLogger* logger = soup_logger_new (SOUP_LOGGER_LOG_BODY, 0);
+      if (priv->user_agent == NULL)
+        user_agent = g_strdup ("Twitter-GLib/" VERSION);
+      else
+        user_agent = g_strdup (priv->user_agent);
 
-      soup_session_add_feature (priv->session_async, SOUP_SESSION_FEATURE (logger));
-    }
+      priv->session_async =
+        soup_session_async_new_with_options ("user-agent", user_agent,
+                                             "async-context", priv->worker_context,
+                                             NULL);
+
+      if (g_getenv ("TWITTER_GLIB_DEBUG"))
+        {
+          SoupLogger* logger = soup_logger_new (SOUP_LOGGER_LOG_BODY, 0);
+
+          soup_session_add_feature (priv->session_async, SOUP_SESSION_FEATURE (logger));
+        }
 
 #ifdef HAVE_LIBSOUP_GNOME
-  /* use the proxy support in libsoup-gnome */
-  soup_session_add_feature_by_type (priv->session_async,
-                                    SOUP_TYPE_PROXY_RESOLVER_GNOME);
+      /* use the proxy support in libsoup-gnome */
+      soup_session_add_feature_by_type (priv->session_async,
+                                        SOUP_TYPE_PROXY_RESOLVER_GNOME);
 #endif /* HAVE_LIBSOUP_GNOME */
 
+      g_free (user_agent);
+    }
+
   if (G_UNLIKELY (priv->base_url == NULL))
     {
       switch (priv->provider)
@@ -302,8 +527,6 @@ twitter_client_constructed (GObject *gobject)
           break;
         }
     }
-
-  g_free (user_agent);
 }
 
 static void
@@ -371,6 +594,81 @@ twitter_client_class_init (TwitterClientClass *klass)
                             G_PARAM_READABLE);
   g_object_class_install_property (gobject_class, PROP_REMAINING_REQUESTS, pspec);
 
+  /**
+   * TwitterClient:compression:
+   *
+   * Whether the #TwitterClient should ask the provider for compressed
+   * (gzip or deflate) responses. Compressed payloads are decoded while
+   * they are being received.
+   *
+   * Since: 0.9.10
+   */
+  pspec = g_param_spec_boolean ("compression",
+                                "Compression",
+                                "Whether to request compressed responses",
+                                TRUE,
+                                G_PARAM_READWRITE);
+  g_object_class_install_property (gobject_class, PROP_COMPRESSION, pspec);
+
+  /**
+   * TwitterClient:use-thread:
+   *
+   * Whether the #TwitterClient should run its session inside a
+   * dedicated worker thread. The network I/O and the parsing of the
+   * responses will happen inside the worker thread, and the results
+   * will be delivered inside the thread-default main context of the
+   * thread that created the client.
+   *
+   * A threaded client authenticates every request preemptively, so
+   * the #TwitterClient::authenticate signal will never be emitted
+   * with %TWITTER_AUTH_NEGOTIATING or %TWITTER_AUTH_RETRY.
+   *
+   * The GLib thread system must be initialized using g_thread_init()
+   * before creating a threaded client. This property is ignored when
+   * the #TwitterClient:session property is set.
+   *
+   * Since: 0.9.10
+   */
+  pspec = g_param_spec_boolean ("use-thread",
+                                "Use Thread",
+                                "Whether to use a worker thread",
+                                FALSE,
+                                G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE);
+  g_object_class_install_property (gobject_class, PROP_USE_THREAD, pspec);
+
+  /**
+   * TwitterClient:filter:
+   *
+   * The #TwitterFilter used to select the statuses of the timelines
+   * emitted with the #TwitterClient::status-received signal, or
+   * %NULL to emit every status.
+   *
+   * Since: 0.9.10
+   */
+  pspec = g_param_spec_object ("filter",
+                               "Filter",
+                               "The filter of the received statuses",
+                               TWITTER_TYPE_FILTER,
+                               G_PARAM_READWRITE);
+  g_object_class_install_property (gobject_class, PROP_FILTER, pspec);
+
+  /**
+   * TwitterClient:session:
+   *
+   * The #SoupSession used by the #TwitterClient. If unset, a new
+   * session will be created for the client; a session set at
+   * construction time can be shared between different clients,
+   * like inside a #TwitterClientPool.
+   *
+   * Since: 0.9.10
+   */
+  pspec = g_param_spec_object ("session",
+                               "Session",
+                               "The HTTP session used by the client",
+                               SOUP_TYPE_SESSION,
+                               G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE);
+  g_object_class_install_property (gobject_class, PROP_SESSION, pspec);
+
   /**
    * TwitterClient::authenticate:
    * @client: the #TwitterClient that received the signal
@@ -537,6 +835,8 @@ twitter_client_init (TwitterClient *client)
 
   priv->rate_limit = -1;
   priv->rate_limit_remaining = -1;
+
+  priv->compression = TRUE;
 }
 
 static inline void
@@ -567,6 +867,12 @@ twitter_client_parse_rate_limit (TwitterClient      *client,
 
   g_object_notify (G_OBJECT (client), "remaining-requests");
 
+  val = soup_message_headers_get (headers, "X-RateLimit-Reset");
+  if (val == NULL || *val == '\0')
+    priv->rate_limit_reset = 0;
+  else
+    priv->rate_limit_reset = g_ascii_strtoll (val, NULL, 10);
+
   g_object_thaw_notify (G_OBJECT (client));
 }
 
@@ -623,11 +929,36 @@ static const gchar *action_names[N_CLIENT_ACTIONS] = {
 };
 #endif /* TWEET_ENABLE_DEBUG */
 
+typedef gboolean (* ClientLoadFunc) (gpointer      object,
+                                     const gchar  *buffer,
+                                     GError      **error);
+
 typedef struct {
   ClientAction action;
   TwitterClient *client;
   guint requires_auth : 1;
   gulong handle;
+
+  /* the object filled with the response, and the function used to
+   * fill it; when using a worker thread, the worker will do this
+   * before passing the response back to the callback
+   */
+  gpointer object;
+  ClientLoadFunc load;
+  GError *load_error;
+  guint is_loaded : 1;
+
+  /* the size of the response, accounted in the transfer statistics
+   * of the client when the response is delivered
+   */
+  gsize wire_length;
+  gsize decoded_length;
+
+  /* set by the asynchronous variants of the requests */
+  GSimpleAsyncResult *result;
+  GCancellable *cancellable;
+  gulong cancelled_id;
+  SoupMessage *message;
 } ClientClosure;
 
 #define closure_set_action(c,v)         (((ClientClosure *) (c))->action) = (v)
@@ -638,6 +969,7 @@ typedef struct {
 #define closure_get_requires_auth(c)    (((ClientClosure *) (c))->requires_auth)
 #define closure_set_handle(c,v)         (((ClientClosure *) (c))->handle) = (v)
 #define closure_get_handle(c)           (((ClientClosure *) (c))->handle)
+#define closure_get_result(c)           (((ClientClosure *) (c))->result)
 
 #ifdef TWEET_ENABLE_DEBUG
 #define closure_get_action_name(c)      (action_names[(((ClientClosure *) (c))->action)])
@@ -648,6 +980,9 @@ typedef struct {
 typedef struct {
   ClientClosure closure;
   TwitterTimeline *timeline;
+
+  /* whether the statuses are added to the timeline of the endpoint */
+  guint merge_endpoint : 1;
 } GetTimelineClosure;
 
 typedef struct {
@@ -669,17 +1004,40 @@ typedef struct {
   ClientClosure closure;
 } VerifyClosure;
 
-static void
-twitter_client_auth (SoupSession *session,
-                     SoupMessage *msg,
-                     SoupAuth    *auth,
-                     gboolean     retrying,
-                     gpointer     user_data)
+#define MESSAGE_CLIENT_KEY      "twitter-message-client"
+#define MESSAGE_DONE_KEY        "twitter-message-done"
+
+/* clients sharing a session authenticate preemptively: letting the
+ * session authenticate would make it reuse the credentials of one
+ * client for the requests of every other client. threaded clients
+ * do the same, so that the authentication never has to wait on the
+ * caller's thread
+ */
+#define twitter_client_preemptive_auth(priv) \
+  ((priv)->shared_session || (priv)->worker_thread != NULL)
+
+/* answers the authentication challenge of @msg on behalf of the
+ * client that queued it; sessions shared by many clients connect
+ * a single handler calling this function
+ */
+void
+_twitter_client_authenticate (SoupMessage *msg,
+                              SoupAuth    *auth,
+                              gboolean     retrying)
 {
-  TwitterClient *client = user_data;
-  TwitterClientPrivate *priv = client->priv;
+  TwitterClient *client;
+  TwitterClientPrivate *priv;
   gboolean retval = FALSE;
 
+  client = g_object_get_data (G_OBJECT (msg), MESSAGE_CLIENT_KEY);
+  if (client == NULL)
+    return;
+
+  priv = client->priv;
+
+  if (twitter_client_preemptive_auth (priv))
+    return;
+
   if (!retrying)
     {
       g_signal_emit (client, client_signals[AUTHENTICATE], 0,
@@ -709,714 +1067,940 @@ twitter_client_auth (SoupSession *session,
     }
 }
 
-static gulong
-twitter_client_queue_message (TwitterClient       *client,
-                              SoupMessage         *msg,
-                              gboolean             requires_auth,
-                              SoupSessionCallback  callback,
-                              gpointer             data)
+static void
+twitter_client_auth (SoupSession *session,
+                     SoupMessage *msg,
+                     SoupAuth    *auth,
+                     gboolean     retrying,
+                     gpointer     user_data)
 {
-  TwitterClientPrivate *priv = client->priv;
-  gulong retval;
+  _twitter_client_authenticate (msg, auth, retrying);
+}
 
-  if (requires_auth && !priv->auth_id)
-    priv->auth_id = g_signal_connect (priv->session_async, "authenticate",
-                                      G_CALLBACK (twitter_client_auth),
-                                      client);
+/* per-message state used to decode compressed responses while the
+ * chunks are being received, so that we never keep around both the
+ * compressed and the decompressed payloads
+ */
+typedef struct {
+  GConverter *decoder;
+  GString *buffer;
 
-  soup_session_queue_message (priv->session_async, msg,
-                              callback,
-                              data);
+  gsize wire_length;
 
-  /* the handle used for the closure, if any, must be the last_handle_id
-   * value; thus we return the same value, but we also bump up the handle
-   * by one for the next queued message
-   */
-  retval = priv->last_handle_id;
+  /* set if the payload could not be decoded */
+  GError *error;
 
-  priv->last_handle_id += 1;
+  guint finished : 1;
+} MessageBody;
 
-  return retval;
+#define MESSAGE_BODY_KEY        "twitter-message-body"
+
+static void
+message_body_reset (MessageBody *body)
+{
+  if (body->decoder)
+    {
+      g_object_unref (body->decoder);
+      body->decoder = NULL;
+    }
+
+  if (body->buffer)
+    {
+      g_string_free (body->buffer, TRUE);
+      body->buffer = NULL;
+    }
+
+  if (body->error)
+    {
+      g_error_free (body->error);
+      body->error = NULL;
+    }
+
+  body->wire_length = 0;
+  body->finished = FALSE;
 }
 
-/**
- * twitter_client_new:
- *
- * Creates a new #TwitterClient using the default provider.
- *
- * It is possible to use the #TwitterClient::authenticate signal
- * to handle the authentication interactively when needed, or to
- * use twitter_client_set_user() to set the user credentials.
- *
- * Return value: the newly created #TwitterClient. Use g_object_unref()
- *   to free the allocated resources
- */
-TwitterClient *
-twitter_client_new (void)
+static void
+message_body_free (gpointer data)
 {
-  return g_object_new (TWITTER_TYPE_CLIENT, NULL);
+  MessageBody *body = data;
+
+  message_body_reset (body);
+
+  g_free (body);
 }
 
-/**
- * twitter_client_new_for_user:
- * @email: the email address of the user
- * @password: the password of the user
- *
- * Creates a new #TwitterClient using the default provider, and
- * sets the credentials of the user.
- *
- * Return value: the newly created #TwitterClient. Use g_object_unref()
- *   to free the allocated resources
- */
-TwitterClient *
-twitter_client_new_for_user (const gchar *email,
-                             const gchar *password)
+static void
+message_got_headers (SoupMessage *msg,
+                     gpointer     user_data)
 {
-  return g_object_new (TWITTER_TYPE_CLIENT,
-                       "email", email,
-                       "password", password,
-                       NULL);
+  MessageBody *body = user_data;
+  const gchar *encoding;
+  GZlibCompressorFormat format;
+
+  /* we might get more than one set of headers for a message, for
+   * instance when a request needs to be authenticated
+   */
+  message_body_reset (body);
+  soup_message_body_set_accumulate (msg->response_body, TRUE);
+
+  encoding = soup_message_headers_get (msg->response_headers,
+                                       "Content-Encoding");
+  if (encoding == NULL || *encoding == '\0')
+    return;
+
+  if (g_ascii_strcasecmp (encoding, "gzip") == 0 ||
+      g_ascii_strcasecmp (encoding, "x-gzip") == 0)
+    format = G_ZLIB_COMPRESSOR_FORMAT_GZIP;
+  else if (g_ascii_strcasecmp (encoding, "deflate") == 0)
+    format = G_ZLIB_COMPRESSOR_FORMAT_ZLIB;
+  else
+    {
+      g_warning ("Unsupported content encoding `%s'", encoding);
+      return;
+    }
+
+  body->decoder = G_CONVERTER (g_zlib_decompressor_new (format));
+  body->buffer = g_string_new (NULL);
+
+  soup_message_body_set_accumulate (msg->response_body, FALSE);
 }
 
-/**
- * twitter_client_new_ful:
- * @provider: the provider logical id
- * @base_url: the base URL of the provider, or %NULL if @provider
- *    is not %TWITTER_CUSTOM_PROVIDER
- * @email: the email address of the user
- * @password: the password of the user
- *
- * Creates a new #TwitterClient using the given @provider, and
- * sets the credentials of the user.
- *
- * Return value: the newly created #TwitterClient. Use g_object_unref()
- *   to free the allocated resources
+/* feeds @length bytes of the compressed payload to the decoder; the
+ * end of the payload is signalled by %G_CONVERTER_INPUT_AT_END, so
+ * that a truncated stream is detected
  */
-TwitterClient *
-twitter_client_new_full (TwitterProvider  provider,
-                         const gchar     *base_url,
-                         const gchar     *email,
-                         const gchar     *password)
+static void
+message_body_decode (MessageBody     *body,
+                     const gchar     *inbuf,
+                     gsize            inbuf_left,
+                     GConverterFlags  flags)
 {
-  if (provider == TWITTER_CUSTOM_PROVIDER)
-    g_return_val_if_fail (base_url != NULL, NULL);
+  gchar outbuf[4096];
+  gsize bytes_read, bytes_written;
 
-  return g_object_new (TWITTER_TYPE_CLIENT,
-                       "provider", provider,
-                       "base-url", base_url,
-                       "email", email,
-                       "password", password,
-                       NULL);
-}
-
-/**
- * twitter_client_set_user:
- * @client: a #TwitterClient
- * @email: the email address of the user
- * @password: the password of the user
- *
- * Sets the user credentials of the user. The [ @email, @password ] tuple
- * will be used to authenticate the @client whenever a request requiring
- * authentication is queued.
- */
-void
-twitter_client_set_user (TwitterClient *client,
-                         const gchar   *email,
-                         const gchar   *password)
-{
-  TwitterClientPrivate *priv;
-
-  g_return_if_fail (TWITTER_IS_CLIENT (client));
-  g_return_if_fail (email != NULL);
-  g_return_if_fail (password != NULL);
-
-  priv = client->priv;
-
-  g_free (priv->email);
-  g_free (priv->password);
-
-  priv->email = g_strdup (email);
-  priv->password = g_strdup (password);
+  if (body->decoder == NULL || body->finished || body->error != NULL)
+    return;
 
-  priv->auth_complete = FALSE;
+  do
+    {
+      GConverterResult res;
+      GError *error = NULL;
 
-  g_object_notify (G_OBJECT (client), "email");
-  g_object_notify (G_OBJECT (client), "password");
-}
+      bytes_read = bytes_written = 0;
+      res = g_converter_convert (body->decoder,
+                                 inbuf, inbuf_left,
+                                 outbuf, sizeof (outbuf),
+                                 flags,
+                                 &bytes_read, &bytes_written,
+                                 &error);
+      if (res == G_CONVERTER_ERROR)
+        {
+          /* the decoder needs more data than this chunk provides */
+          if (!(flags & G_CONVERTER_INPUT_AT_END) &&
+              g_error_matches (error, G_IO_ERROR, G_IO_ERROR_PARTIAL_INPUT))
+            {
+              g_error_free (error);
+              break;
+            }
+
+          body->error = error;
+          break;
+        }
 
-/**
- * twitter_client_get_user
- * @client: a #TwitterClient#
- * @email: return location for the email address, or %NULL
- * @password: return location for the password, or %NULL
- *
- * Retrieves the user credentials.
- *
- * The returned strings are newly allocated and should be freed
- * using g_free() when done using them.
- */
-void
-twitter_client_get_user (TwitterClient  *client,
-                         gchar         **email,
-                         gchar         **password)
-{
-  g_return_if_fail (TWITTER_IS_CLIENT (client));
+      g_string_append_len (body->buffer, outbuf, bytes_written);
 
-  if (email)
-    *email = g_strdup (client->priv->email);
+      inbuf += bytes_read;
+      inbuf_left -= bytes_read;
 
-  if (password)
-    *password = g_strdup (client->priv->password);
+      if (res == G_CONVERTER_FINISHED)
+        {
+          body->finished = TRUE;
+          break;
+        }
+    }
+  while (inbuf_left > 0 || bytes_written == sizeof (outbuf));
 }
 
-typedef struct {
-  TwitterClient *client;
-  TwitterUserList *user_list;
-  gulong handle;
-  guint n_users;
-  guint current_user;
-} EmitUserClosure;
-
-static gboolean
-do_emit_user_received (gpointer data)
+static void
+message_got_chunk (SoupMessage *msg,
+                   SoupBuffer  *chunk,
+                   gpointer     user_data)
 {
-  EmitUserClosure *closure = data;
-  TwitterUser *user;
-
-  user = twitter_user_list_get_pos (closure->user_list,
-                                    closure->current_user);
-  if (!user)
-    return FALSE;
+  MessageBody *body = user_data;
 
-  g_signal_emit (closure->client, client_signals[USER_RECEIVED], 0,
-                 closure->handle, user, NULL);
-
-  closure->current_user += 1;
+  body->wire_length += chunk->length;
 
-  if (closure->current_user == closure->n_users)
-    return FALSE;
-
-  return TRUE;
+  message_body_decode (body, chunk->data, chunk->length,
+                       G_CONVERTER_NO_FLAGS);
 }
 
 static void
-cleanup_emit_user_received (gpointer data)
+message_got_body (SoupMessage *msg,
+                  gpointer     user_data)
 {
-  EmitUserClosure *closure = data;
-
-  g_object_unref (closure->client);
-  g_object_unref (closure->user_list);
+  MessageBody *body = user_data;
 
-  g_free (closure);
+  message_body_decode (body, NULL, 0, G_CONVERTER_INPUT_AT_END);
 }
 
+/* a deferred cancellation must not touch a message the session
+ * already released
+ */
 static void
-emit_user_received (TwitterClient   *client,
-                    TwitterUserList *user_list,
-                    gulong           handle)
+message_finished (SoupMessage *msg,
+                  gpointer     user_data)
 {
-  EmitUserClosure *closure;
-  guint count;
-
-  count = twitter_user_list_get_count (user_list);
-
-  closure = g_new (EmitUserClosure, 1);
-  closure->client = g_object_ref (client);
-  closure->user_list = g_object_ref (user_list);
-  closure->handle = handle;
-  closure->n_users = count;
-  closure->current_user = 0;
-
-  g_idle_add_full (G_PRIORITY_DEFAULT_IDLE + 50,
-                   do_emit_user_received,
-                   closure,
-                   cleanup_emit_user_received);
+  g_object_set_data (G_OBJECT (msg), MESSAGE_DONE_KEY, GINT_TO_POINTER (1));
 }
 
 static void
-get_status_cb (SoupSession *session,
-               SoupMessage *msg,
-               gpointer     user_data)
+twitter_client_prepare_message (TwitterClient *client,
+                                SoupMessage   *msg,
+                                gboolean       requires_auth)
 {
-  GetStatusClosure *closure = user_data;
-  gboolean requires_auth = closure_get_requires_auth (closure);
-  gulong handle = closure_get_handle (closure);
-  TwitterClient *client = closure_get_client (closure);
   TwitterClientPrivate *priv = client->priv;
+  MessageBody *body;
 
-  /* we want to parse them as soo as we can so we can use
-   * the values right inside the signal callbacks
-   */
-  twitter_client_parse_rate_limit (client, msg->response_headers);
+  g_object_set_data (G_OBJECT (msg), MESSAGE_CLIENT_KEY, client);
+  g_signal_connect (msg, "finished", G_CALLBACK (message_finished), NULL);
 
-  if (!SOUP_STATUS_IS_SUCCESSFUL (msg->status_code))
+  if (requires_auth && twitter_client_preemptive_auth (priv) &&
+      priv->email != NULL && priv->password != NULL)
     {
-      GError *error = NULL;
+      gchar *credentials, *encoded, *header;
 
-      if (msg->status_code == SOUP_STATUS_UNAUTHORIZED)
-        {
-          gboolean retval = FALSE;
+      credentials = g_strconcat (priv->email, ":", priv->password, NULL);
+      encoded = g_base64_encode ((const guchar *) credentials,
+                                 strlen (credentials));
+      header = g_strconcat ("Basic ", encoded, NULL);
 
-          g_signal_emit (client, client_signals[AUTHENTICATE], 0,
-                         TWITTER_AUTH_FAILED, &retval);
+      soup_message_headers_replace (msg->request_headers,
+                                    "Authorization",
+                                    header);
 
-          priv->auth_complete = FALSE;
-        }
+      g_free (header);
+      g_free (encoded);
+      g_free (credentials);
+    }
 
-      g_set_error (&error, TWITTER_ERROR,
-                   twitter_error_from_status (msg->status_code),
-                   "%s",
-                   msg->reason_phrase);
+  if (!priv->compression)
+    return;
 
-      g_signal_emit (client, client_signals[STATUS_RECEIVED], 0,
-                     handle, closure->status, error);
+  soup_message_headers_replace (msg->request_headers,
+                                "Accept-Encoding",
+                                "gzip, deflate");
+
+  body = g_new0 (MessageBody, 1);
+  g_object_set_data_full (G_OBJECT (msg), MESSAGE_BODY_KEY,
+                          body,
+                          message_body_free);
+
+  g_signal_connect (msg, "got-headers",
+                    G_CALLBACK (message_got_headers),
+                    body);
+  g_signal_connect (msg, "got-chunk",
+                    G_CALLBACK (message_got_chunk),
+                    body);
+  g_signal_connect (msg, "got-body",
+                    G_CALLBACK (message_got_body),
+                    body);
+}
 
-      g_error_free (error);
-    }
-  else
+/* retrieves the (decoded) body of a response as a NUL-terminated
+ * string, and its size before and after decoding; the returned string
+ * should be freed using g_free(). If the body could not be decoded,
+ * %NULL is returned and @error is set.
+ *
+ * this function might be called inside the worker thread, so it must
+ * not touch the client
+ */
+static gchar *
+message_read_body (SoupMessage  *msg,
+                   gsize        *wire_length,
+                   gsize        *decoded_length,
+                   GError      **error)
+{
+  MessageBody *body;
+  gchar *retval;
+
+  body = g_object_get_data (G_OBJECT (msg), MESSAGE_BODY_KEY);
+  if (body != NULL && body->buffer != NULL)
     {
-      gboolean retval = FALSE;
-      GError *error = NULL;
-      gchar *buffer;
+      *wire_length = body->wire_length;
 
-      if (requires_auth && !priv->auth_complete)
+      if (body->error != NULL)
         {
-          g_signal_emit (client, client_signals[AUTHENTICATE], 0,
-                         TWITTER_AUTH_SUCCESS, &retval);
-          priv->auth_complete = TRUE;
+          g_set_error (error, TWITTER_ERROR,
+                       TWITTER_ERROR_PARSE_ERROR,
+                       "Unable to decode the response (%s)",
+                       body->error->message);
+          return NULL;
         }
 
-      buffer = g_strndup (msg->response_body->data,
-                          msg->response_body->length);
+      *decoded_length = body->buffer->len;
 
-      twitter_debug (closure_get_action_name (closure), buffer);
+      retval = g_string_free (body->buffer, FALSE);
+      body->buffer = NULL;
 
-      if (G_UNLIKELY (!buffer))
-        g_warning ("No data received");
-      else
-        twitter_status_load_from_data (closure->status, buffer, &error);
+      return retval;
+    }
 
-      g_signal_emit (client, client_signals[STATUS_RECEIVED], 0,
-                     handle, closure->status, error);
+  *wire_length = msg->response_body->length;
+  *decoded_length = msg->response_body->length;
 
-      if (error)
-        g_error_free (error);
+  return g_strndup (msg->response_body->data,
+                    msg->response_body->length);
+}
 
-      g_free (buffer);
-    }
+static void
+client_closure_parse (ClientClosure *closure,
+                      SoupMessage   *msg)
+{
+  gchar *buffer;
 
-  g_object_unref (closure->status);
-  g_object_unref (client);
+  buffer = message_read_body (msg,
+                              &closure->wire_length,
+                              &closure->decoded_length,
+                              &closure->load_error);
 
-  g_free (closure);
+  twitter_debug (closure_get_action_name (closure), buffer);
+
+  if (buffer != NULL)
+    closure->load (closure->object, buffer, &closure->load_error);
+
+  closure->is_loaded = TRUE;
+
+  g_free (buffer);
 }
 
-void
-verify_cb (SoupSession *session,
-           SoupMessage *msg,
-           gpointer     user_data)
+/* loads the response into the object of the closure, unless the
+ * worker thread already did, and updates the transfer statistics;
+ * returns %FALSE and sets @error if the response could not be decoded
+ * or parsed
+ */
+static gboolean
+client_closure_load (gpointer      data,
+                     SoupMessage  *msg,
+                     GError      **error)
 {
-  VerifyClosure *closure = user_data;
-  TwitterClient *client = closure_get_client (closure);
-  gulong handle = closure_get_handle (closure);
-
-  /* we want to parse them as soo as we can so we can use
-   * the values right inside the signal callbacks
-   */
-  twitter_client_parse_rate_limit (client, msg->response_headers);
+  ClientClosure *closure = data;
+  TwitterClientPrivate *priv = closure->client->priv;
 
-  if (!SOUP_STATUS_IS_SUCCESSFUL (msg->status_code))
-    {
-      GError *error = NULL;
+  if (!closure->is_loaded)
+    client_closure_parse (closure, msg);
 
-      g_set_error (&error, TWITTER_ERROR,
-                   twitter_error_from_status (msg->status_code),
-                   "%s",
-                   msg->reason_phrase);
+  priv->bytes_received += closure->wire_length;
+  priv->bytes_decoded += closure->decoded_length;
 
-      g_signal_emit (client, client_signals[USER_VERIFIED], 0,
-                     handle, FALSE, error);
+  if (closure->load_error != NULL)
+    {
+      g_propagate_error (error, closure->load_error);
+      closure->load_error = NULL;
 
-      g_error_free (error);
+      return FALSE;
     }
-  else
-    {
-      gboolean is_verified;
 
-      is_verified = (msg->status_code == 200);
+  return TRUE;
+}
 
-      g_signal_emit (client, client_signals[USER_VERIFIED], 0,
-                     handle, is_verified, NULL);
-    }
+/* a request queued on the session of a worker thread */
+typedef struct {
+  TwitterClient *client;
+  SoupMessage *message;
 
-  g_object_unref (client);
+  SoupSessionCallback callback;
+  gpointer data;
 
-  g_free (closure);
-}
+  /* the closure of the request, if any, for parsing the response */
+  ClientClosure *closure;
+} WorkerRequest;
 
-/**
- * twitter_client_verify_user:
- * @client: a #TwitterClient
- *
- * Requests a verification of the user credentials used by @client
- * to the provider.
- *
- * The #TwitterClient::user-verified signal will be emitted with
- * the results of the request.
- *
- * Return value: the handle of the request, or 0
- */
-gulong
-twitter_client_verify_user (TwitterClient *client)
+static gboolean
+worker_request_deliver (gpointer data)
 {
-  VerifyClosure *clos;
-  SoupMessage *msg;
+  WorkerRequest *request = data;
+  TwitterClientPrivate *priv = request->client->priv;
 
-  g_return_val_if_fail (TWITTER_IS_CLIENT (client), 0);
+  request->callback (priv->session_async,
+                     request->message,
+                     request->data);
 
-  msg = twitter_api_verify_credentials (client->priv->base_url);
+  g_object_unref (request->message);
+  g_object_unref (request->client);
 
-  clos = g_new0 (VerifyClosure, 1);
-  closure_set_action (clos, VERIFY_CREDENTIALS);
-  closure_set_client (clos, g_object_ref (client));
-  closure_set_requires_auth (clos, TRUE);
-  closure_set_handle (clos, client->priv->last_handle_id);
+  g_free (request);
 
-  return twitter_client_queue_message (client, msg, TRUE,
-                                       verify_cb,
-                                       clos);
+  return FALSE;
 }
 
+/* called inside the worker thread */
 static void
-end_session_cb (SoupSession *session,
-                SoupMessage *message,
-                gpointer     user_data)
+worker_request_done (SoupSession *session,
+                     SoupMessage *msg,
+                     gpointer     data)
 {
-  TwitterClient *client = user_data;
+  WorkerRequest *request = data;
+  ClientClosure *closure = request->closure;
 
-  client->priv->auth_complete = FALSE;
+  if (closure != NULL && closure->load != NULL &&
+      SOUP_STATUS_IS_SUCCESSFUL (msg->status_code))
+    client_closure_parse (closure, msg);
 
-  g_signal_emit (client, client_signals[SESSION_ENDED], 0);
+  /* the session will release the message when we return */
+  g_object_ref (msg);
+
+  twitter_client_invoke (request->client->priv->caller_context,
+                         worker_request_deliver,
+                         request);
 }
 
-/**
- * twitter_client_end_session:
- * @client: a #TwitterClient
- *
- * Ends the current session of @client. The authentication state
- * will be reset.
- *
- * The #TwitterClient::session-ended signal will be emitted when the
- * provider acknowledged the request.
- */
-void
-twitter_client_end_session (TwitterClient *client)
+/* called inside the worker thread */
+static gboolean
+worker_request_queue (gpointer data)
 {
-  SoupMessage *msg;
-
-  g_return_if_fail (TWITTER_IS_CLIENT (client));
+  WorkerRequest *request = data;
 
-  msg = twitter_api_end_session (client->priv->base_url);
+  soup_session_queue_message (request->client->priv->session_async,
+                              request->message,
+                              worker_request_done,
+                              request);
 
-  twitter_client_queue_message (client, msg, FALSE,
-                                end_session_cb,
-                                client);
+  return FALSE;
 }
 
 typedef struct {
-  TwitterClient *client;
-  TwitterTimeline *timeline;
-  gulong handle;
-  guint n_status;
-  guint current_status;
-} EmitStatusClosure;
+  SoupSession *session;
+  SoupMessage *message;
+} CancelRequest;
 
+/* called inside the context of the session */
 static gboolean
-do_emit_status_received (gpointer data)
+session_cancel_message (gpointer data)
 {
-  EmitStatusClosure *closure = data;
-  TwitterStatus *status;
-
-  status = twitter_timeline_get_pos (closure->timeline,
-                                     closure->current_status);
-  if (!status)
-    return FALSE;
-
-  g_signal_emit (closure->client, client_signals[STATUS_RECEIVED], 0,
-                 closure->handle, status, NULL);
-
-  closure->current_status += 1;
-
-  if (closure->current_status == closure->n_status)
-    {
-      g_signal_emit (closure->client, client_signals[TIMELINE_COMPLETE], 0);
-      return FALSE;
-    }
+  CancelRequest *cancel = data;
 
-  return TRUE;
-}
+  /* the response might have been received in the meantime */
+  if (g_object_get_data (G_OBJECT (cancel->message), MESSAGE_DONE_KEY) == NULL)
+    soup_session_cancel_message (cancel->session,
+                                 cancel->message,
+                                 SOUP_STATUS_CANCELLED);
 
-static void
-cleanup_emit_status_received (gpointer data)
-{
-  EmitStatusClosure *closure = data;
+  g_object_unref (cancel->message);
+  g_object_unref (cancel->session);
 
-  g_object_unref (closure->client);
-  g_object_unref (closure->timeline);
+  g_free (cancel);
 
-  g_free (closure);
+  return FALSE;
 }
 
+/* the cancellable can be triggered from any thread, while the session
+ * must only be used from its own context; so we always defer the
+ * cancellation to an idle source running there
+ */
 static void
-emit_status_received (TwitterClient   *client,
-                      TwitterTimeline *timeline,
-                      gulong           handle)
+twitter_client_cancel_message (TwitterClient *client,
+                               SoupMessage   *msg)
 {
-  EmitStatusClosure *closure;
-  guint count;
+  TwitterClientPrivate *priv = client->priv;
+  CancelRequest *cancel;
+  GMainContext *context;
 
-  count = twitter_timeline_get_count (timeline);
+  context = soup_session_get_async_context (priv->session_async);
+  if (context == NULL)
+    context = g_main_context_default ();
 
-  closure = g_new (EmitStatusClosure, 1);
-  closure->client = g_object_ref (client);
-  closure->timeline = g_object_ref (timeline);
-  closure->handle = handle;
-  closure->n_status = count;
-  closure->current_status = 0;
+  cancel = g_new0 (CancelRequest, 1);
+  cancel->session = g_object_ref (priv->session_async);
+  cancel->message = g_object_ref (msg);
 
-  g_idle_add_full (G_PRIORITY_DEFAULT_IDLE + 50,
-                   do_emit_status_received,
-                   closure,
-                   cleanup_emit_status_received);
+  twitter_client_invoke (context, session_cancel_message, cancel);
 }
 
-static void
-get_timeline_cb (SoupSession *session,
-                 SoupMessage *msg,
-                 gpointer     user_data)
+static gulong
+twitter_client_queue_message_full (TwitterClient       *client,
+                                   SoupMessage         *msg,
+                                   gboolean             requires_auth,
+                                   SoupSessionCallback  callback,
+                                   gpointer             data,
+                                   ClientClosure       *closure)
 {
-  GetTimelineClosure *closure = user_data;
-  gboolean requires_auth = closure_get_requires_auth (closure);
-  gulong handle = closure_get_handle (closure);
-  TwitterClient *client = closure_get_client (closure);
   TwitterClientPrivate *priv = client->priv;
+  gulong retval;
 
-  /* we want to parse them as soo as we can so we can use
-   * the values right inside the signal callbacks
+  /* the owner of a shared session answers the challenges of
+   * every client using it; see _twitter_client_authenticate()
    */
-  twitter_client_parse_rate_limit (client, msg->response_headers);
-
-  if (!SOUP_STATUS_IS_SUCCESSFUL (msg->status_code))
-    {
-      GError *error = NULL;
-
-      if (msg->status_code == SOUP_STATUS_UNAUTHORIZED)
-        {
-          gboolean retval = FALSE;
-
-          g_signal_emit (client, client_signals[AUTHENTICATE], 0,
-                         TWITTER_AUTH_FAILED, &retval);
-
-          priv->auth_complete = FALSE;
-        }
-
-      g_set_error (&error, TWITTER_ERROR,
-                   twitter_error_from_status (msg->status_code),
-                   "%s",
-                   msg->reason_phrase);
+  if (requires_auth && !priv->auth_id && !priv->shared_session)
+    priv->auth_id = g_signal_connect (priv->session_async, "authenticate",
+                                      G_CALLBACK (twitter_client_auth),
+                                      client);
 
-      g_signal_emit (client, client_signals[STATUS_RECEIVED], 0,
-                     handle, NULL, error);
+  twitter_client_prepare_message (client, msg, requires_auth);
 
-      g_error_free (error);
+  if (priv->worker_thread != NULL)
+    {
+      WorkerRequest *request;
+
+      request = g_new0 (WorkerRequest, 1);
+      request->client = g_object_ref (client);
+      request->message = msg;
+      request->callback = callback;
+      request->data = data;
+      request->closure = closure;
+
+      twitter_client_invoke (priv->worker_context,
+                             worker_request_queue,
+                             request);
     }
   else
-    {
-      gboolean retval = FALSE;
-      GError *error = NULL;
-      gchar *buffer;
-
-      if (requires_auth && !priv->auth_complete)
-        {
-          g_signal_emit (client, client_signals[AUTHENTICATE], 0,
-                         TWITTER_AUTH_SUCCESS, &retval);
-          priv->auth_complete = TRUE;
-        }
-
-      buffer = g_strndup (msg->response_body->data,
-                          msg->response_body->length);
-
-      if (G_UNLIKELY (!buffer))
-        g_warning ("No data received");
-      else
-        twitter_timeline_load_from_data (closure->timeline, buffer, &error);
-
-      if (error)
-        {
-          g_signal_emit (client, client_signals[STATUS_RECEIVED], 0,
-                         handle, NULL, error);
-
-          g_error_free (error);
-        }
-      else
-        emit_status_received (client, closure->timeline, handle);
+    soup_session_queue_message (priv->session_async, msg,
+                                callback,
+                                data);
 
-      g_free (buffer);
-    }
+  /* the handle used for the closure, if any, must be the last_handle_id
+   * value; thus we return the same value, but we also bump up the handle
+   * by one for the next queued message
+   */
+  retval = priv->last_handle_id;
 
-  g_object_unref (closure->timeline);
-  g_object_unref (client);
+  priv->last_handle_id += 1;
 
-  g_free (closure);
+  return retval;
 }
 
-gulong
-twitter_client_get_public_timeline (TwitterClient *client,
-                                    guint          since_id)
+static gulong
+twitter_client_queue_message (TwitterClient       *client,
+                              SoupMessage         *msg,
+                              gboolean             requires_auth,
+                              SoupSessionCallback  callback,
+                              gpointer             data)
 {
-  GetTimelineClosure *clos;
-  SoupMessage *msg;
-
-  g_return_val_if_fail (TWITTER_IS_CLIENT (client), 0);
-
-  msg = twitter_api_public_timeline (client->priv->base_url, since_id);
+  return twitter_client_queue_message_full (client, msg, requires_auth,
+                                            callback, data,
+                                            NULL);
+}
 
-  clos = g_new0 (GetTimelineClosure, 1);
-  closure_set_action (clos, PUBLIC_TIMELINE);
-  closure_set_client (clos, g_object_ref (client));
-  closure_set_requires_auth (clos, FALSE);
-  closure_set_handle (clos, client->priv->last_handle_id);
-  clos->timeline = twitter_timeline_new ();
+static void
+client_closure_cancelled (GCancellable *cancellable,
+                          gpointer      data)
+{
+  ClientClosure *closure = data;
 
-  return twitter_client_queue_message (client, msg, FALSE,
-                                       get_timeline_cb,
-                                       clos);
+  twitter_client_cancel_message (closure->client, closure->message);
 }
 
-gulong
-twitter_client_get_friends_timeline (TwitterClient *client,
-                                     const gchar   *friend_,
-                                     gint64         since_date)
+static gulong
+twitter_client_queue_closure (TwitterClient       *client,
+                              ClientClosure       *closure,
+                              ClientAction         action,
+                              SoupMessage         *msg,
+                              gboolean             requires_auth,
+                              SoupSessionCallback  callback,
+                              GSimpleAsyncResult  *result,
+                              GCancellable        *cancellable)
 {
-  GetTimelineClosure *clos;
-  SoupMessage *msg;
+  gulong handle;
 
-  g_return_val_if_fail (TWITTER_IS_CLIENT (client), 0);
+  closure_set_action (closure, action);
+  closure_set_client (closure, g_object_ref (client));
+  closure_set_requires_auth (closure, requires_auth);
+  closure_set_handle (closure, client->priv->last_handle_id);
 
-  msg = twitter_api_friends_timeline (client->priv->base_url, friend_, since_date);
+  closure->result = result;
+  closure->message = msg;
 
-  clos = g_new0 (GetTimelineClosure, 1);
-  closure_set_action (clos, FRIENDS_TIMELINE);
-  closure_set_client (clos, g_object_ref (client));
-  closure_set_requires_auth (clos, TRUE);
-  closure_set_handle (clos, client->priv->last_handle_id);
-  clos->timeline = twitter_timeline_new ();
+  if (cancellable != NULL)
+    closure->cancellable = g_object_ref (cancellable);
 
-  return twitter_client_queue_message (client, msg, TRUE,
-                                       get_timeline_cb,
-                                       clos);
+  handle = twitter_client_queue_message_full (client, msg, requires_auth,
+                                              callback, closure,
+                                              closure);
+
+  /* if the request was already cancelled the handler is invoked
+   * right away, and no handler id is returned
+   */
+  if (cancellable != NULL)
+    closure->cancelled_id =
+      g_cancellable_connect (cancellable,
+                             G_CALLBACK (client_closure_cancelled),
+                             closure,
+                             NULL);
+
+  return handle;
 }
 
-gulong
-twitter_client_get_user_timeline (TwitterClient *client,
-                                  const gchar   *user,
-                                  guint          count,
-                                  gint64         since_date)
+/* completes the asynchronous variant of a request; if the request
+ * was not asynchronous the result should be delivered through the
+ * signals, and %FALSE will be returned
+ */
+static gboolean
+client_closure_complete (gpointer      data,
+                         gpointer      res,
+                         const GError *error)
 {
-  GetTimelineClosure *clos;
-  SoupMessage *msg;
+  ClientClosure *closure = data;
+  GSimpleAsyncResult *result = closure->result;
 
-  g_return_val_if_fail (TWITTER_IS_CLIENT (client), 0);
-
-  msg = twitter_api_user_timeline (client->priv->base_url, user, count, since_date);
-
-  clos = g_new0 (GetTimelineClosure, 1);
-  closure_set_action (clos, USER_TIMELINE);
-  closure_set_client (clos, g_object_ref (client));
-  closure_set_requires_auth (clos, TRUE);
-  closure_set_handle (clos, client->priv->last_handle_id);
-  clos->timeline = twitter_timeline_new ();
+  if (result == NULL)
+    return FALSE;
 
-  return twitter_client_queue_message (client, msg, TRUE,
-                                       get_timeline_cb,
-                                       clos);
-}
+  if (closure->cancellable != NULL &&
+      g_cancellable_is_cancelled (closure->cancellable))
+    {
+      g_simple_async_result_set_error (result, G_IO_ERROR,
+                                       G_IO_ERROR_CANCELLED,
+                                       "%s",
+                                       "Operation was cancelled");
 
-gulong
-twitter_client_get_replies (TwitterClient *client)
-{
-  GetTimelineClosure *clos;
-  SoupMessage *msg;
+      /* we might be called from inside soup_session_cancel_message(), so
+       * we must not invoke the callback re-entrantly
+       */
+      g_simple_async_result_complete_in_idle (result);
 
-  g_return_val_if_fail (TWITTER_IS_CLIENT (client), 0);
+      return TRUE;
+    }
 
-  msg = twitter_api_replies (client->priv->base_url);
+  if (error != NULL)
+    g_simple_async_result_set_from_error (result, (GError *) error);
+  else
+    g_simple_async_result_set_op_res_gpointer (result,
+                                               g_object_ref_sink (res),
+                                               g_object_unref);
 
-  clos = g_new0 (GetTimelineClosure, 1);
-  closure_set_action (clos, STATUS_REPLIES);
-  closure_set_client (clos, g_object_ref (client));
-  closure_set_requires_auth (clos, TRUE);
-  closure_set_handle (clos, client->priv->last_handle_id);
-  clos->timeline = twitter_timeline_new ();
+  g_simple_async_result_complete (result);
 
-  return twitter_client_queue_message (client, msg, TRUE,
-                                       get_timeline_cb,
-                                       clos);
+  return TRUE;
 }
 
-gulong
-twitter_client_get_favorites (TwitterClient *client,
-                              const gchar   *user,
-                              gint           page)
+static void
+client_closure_clear (gpointer data)
 {
-  GetTimelineClosure *clos;
-  SoupMessage *msg;
+  ClientClosure *closure = data;
 
-  g_return_val_if_fail (TWITTER_IS_CLIENT (client), 0);
+  if (closure->load_error != NULL)
+    g_error_free (closure->load_error);
 
-  msg = twitter_api_favorites (client->priv->base_url, user, page);
+  if (closure->cancellable != NULL)
+    {
+      /* waits for a handler running in another thread */
+      g_cancellable_disconnect (closure->cancellable,
+                                closure->cancelled_id);
 
-  clos = g_new0 (GetTimelineClosure, 1);
-  closure_set_action (clos, FAVORITES);
-  closure_set_client (clos, g_object_ref (client));
-  closure_set_requires_auth (clos, TRUE);
-  closure_set_handle (clos, client->priv->last_handle_id);
-  clos->timeline = twitter_timeline_new ();
+      g_object_unref (closure->cancellable);
+    }
 
-  return twitter_client_queue_message (client, msg, TRUE,
-                                       get_timeline_cb,
-                                       clos);
+  if (closure->result != NULL)
+    g_object_unref (closure->result);
+
+  g_object_unref (closure->client);
 }
 
-gulong
-twitter_client_get_archive (TwitterClient *client,
-                            gint           page)
+static gpointer
+twitter_client_finish (TwitterClient  *client,
+                       GAsyncResult   *result,
+                       gpointer        source_tag,
+                       GError        **error)
 {
-  GetTimelineClosure *clos;
-  SoupMessage *msg;
+  GSimpleAsyncResult *simple;
 
-  g_return_val_if_fail (TWITTER_IS_CLIENT (client), 0);
+  g_return_val_if_fail (TWITTER_IS_CLIENT (client), NULL);
+  g_return_val_if_fail (g_simple_async_result_is_valid (result,
+                                                        G_OBJECT (client),
+                                                        source_tag),
+                        NULL);
 
-  msg = twitter_api_archive (client->priv->base_url, page);
+  simple = G_SIMPLE_ASYNC_RESULT (result);
 
-  clos = g_new0 (GetTimelineClosure, 1);
-  closure_set_action (clos, ARCHIVE);
-  closure_set_client (clos, g_object_ref (client));
-  closure_set_requires_auth (clos, TRUE);
-  closure_set_handle (clos, client->priv->last_handle_id);
-  clos->timeline = twitter_timeline_new ();
+  if (g_simple_async_result_propagate_error (simple, error))
+    return NULL;
 
-  return twitter_client_queue_message (client, msg, TRUE,
-                                       get_timeline_cb,
-                                       clos);
+  return g_object_ref (g_simple_async_result_get_op_res_gpointer (simple));
 }
 
-static void
-get_user_cb (SoupSession *session,
-             SoupMessage *msg,
-             gpointer     user_data)
+/**
+ * twitter_client_new:
+ *
+ * Creates a new #TwitterClient using the default provider.
+ *
+ * It is possible to use the #TwitterClient::authenticate signal
+ * to handle the authentication interactively when needed, or to
+ * use twitter_client_set_user() to set the user credentials.
+ *
+ * Return value: the newly created #TwitterClient. Use g_object_unref()
+ *   to free the allocated resources
+ */
+TwitterClient *
+twitter_client_new (void)
 {
-  GetUserClosure *closure = user_data;
+  return g_object_new (TWITTER_TYPE_CLIENT, NULL);
+}
+
+/**
+ * twitter_client_new_for_user:
+ * @email: the email address of the user
+ * @password: the password of the user
+ *
+ * Creates a new #TwitterClient using the default provider, and
+ * sets the credentials of the user.
+ *
+ * Return value: the newly created #TwitterClient. Use g_object_unref()
+ *   to free the allocated resources
+ */
+TwitterClient *
+twitter_client_new_for_user (const gchar *email,
+                             const gchar *password)
+{
+  return g_object_new (TWITTER_TYPE_CLIENT,
+                       "email", email,
+                       "password", password,
+                       NULL);
+}
+
+/**
+ * twitter_client_new_ful:
+ * @provider: the provider logical id
+ * @base_url: the base URL of the provider, or %NULL if @provider
+ *    is not %TWITTER_CUSTOM_PROVIDER
+ * @email: the email address of the user
+ * @password: the password of the user
+ *
+ * Creates a new #TwitterClient using the given @provider, and
+ * sets the credentials of the user.
+ *
+ * Return value: the newly created #TwitterClient. Use g_object_unref()
+ *   to free the allocated resources
+ */
+TwitterClient *
+twitter_client_new_full (TwitterProvider  provider,
+                         const gchar     *base_url,
+                         const gchar     *email,
+                         const gchar     *password)
+{
+  if (provider == TWITTER_CUSTOM_PROVIDER)
+    g_return_val_if_fail (base_url != NULL, NULL);
+
+  return g_object_new (TWITTER_TYPE_CLIENT,
+                       "provider", provider,
+                       "base-url", base_url,
+                       "email", email,
+                       "password", password,
+                       NULL);
+}
+
+/**
+ * twitter_client_set_user:
+ * @client: a #TwitterClient
+ * @email: the email address of the user
+ * @password: the password of the user
+ *
+ * Sets the user credentials of the user. The [ @email, @password ] tuple
+ * will be used to authenticate the @client whenever a request requiring
+ * authentication is queued.
+ */
+void
+twitter_client_set_user (TwitterClient *client,
+                         const gchar   *email,
+                         const gchar   *password)
+{
+  TwitterClientPrivate *priv;
+
+  g_return_if_fail (TWITTER_IS_CLIENT (client));
+  g_return_if_fail (email != NULL);
+  g_return_if_fail (password != NULL);
+
+  priv = client->priv;
+
+  g_free (priv->email);
+  g_free (priv->password);
+
+  priv->email = g_strdup (email);
+  priv->password = g_strdup (password);
+
+  priv->auth_complete = FALSE;
+
+  g_object_notify (G_OBJECT (client), "email");
+  g_object_notify (G_OBJECT (client), "password");
+}
+
+/**
+ * twitter_client_get_user
+ * @client: a #TwitterClient#
+ * @email: return location for the email address, or %NULL
+ * @password: return location for the password, or %NULL
+ *
+ * Retrieves the user credentials.
+ *
+ * The returned strings are newly allocated and should be freed
+ * using g_free() when done using them.
+ */
+void
+twitter_client_get_user (TwitterClient  *client,
+                         gchar         **email,
+                         gchar         **password)
+{
+  g_return_if_fail (TWITTER_IS_CLIENT (client));
+
+  if (email)
+    *email = g_strdup (client->priv->email);
+
+  if (password)
+    *password = g_strdup (client->priv->password);
+}
+
+#define STATUS_SHARED_USER_KEY  "twitter-status-shared-user"
+
+/* returns the instance of @user shared by every client inside the
+ * pool, refreshed with the fields of @user
+ */
+static TwitterUser *
+twitter_client_share_user (TwitterClient *client,
+                           TwitterUser   *user)
+{
+  if (client->priv->pool == NULL || user == NULL)
+    return user;
+
+  return _twitter_client_pool_cache_user (client->priv->pool, user);
+}
+
+/* points the user of @status to the shared instance, so that the
+ * statuses received by every account reference a single copy of
+ * each user
+ */
+static void
+twitter_client_share_status_user (TwitterClient *client,
+                                  TwitterStatus *status)
+{
+  TwitterUser *user, *shared;
+
+  if (client->priv->pool == NULL)
+    return;
+
+  user = twitter_status_get_user (status);
+  if (user == NULL)
+    return;
+
+  shared = twitter_client_share_user (client, user);
+
+  /* a status only holds a weak reference on its user, while the
+   * shared user can be released by the pool at any time
+   */
+  g_object_set_data_full (G_OBJECT (status), STATUS_SHARED_USER_KEY,
+                          g_object_ref (shared),
+                          g_object_unref);
+
+  if (shared != user)
+    _twitter_status_set_user (status, shared);
+}
+
+static void
+twitter_client_share_user_list (TwitterClient   *client,
+                                TwitterUserList *user_list)
+{
+  guint n_users, i;
+
+  if (client->priv->pool == NULL)
+    return;
+
+  n_users = twitter_user_list_get_count (user_list);
+  for (i = 0; i < n_users; i++)
+    {
+      TwitterUser *user, *shared;
+
+      user = twitter_user_list_get_pos (user_list, i);
+      shared = twitter_client_share_user (client, user);
+
+      if (shared != user)
+        _twitter_user_list_replace (user_list, i, shared);
+    }
+}
+
+static void
+twitter_client_share_timeline (TwitterClient   *client,
+                               TwitterTimeline *timeline)
+{
+  GList *statuses, *l;
+
+  if (client->priv->pool == NULL)
+    return;
+
+  statuses = twitter_timeline_get_all (timeline);
+  for (l = statuses; l != NULL; l = l->next)
+    twitter_client_share_status_user (client, l->data);
+
+  g_list_free (statuses);
+}
+
+typedef struct {
+  TwitterClient *client;
+  TwitterUserList *user_list;
+  gulong handle;
+  guint n_users;
+  guint current_user;
+} EmitUserClosure;
+
+static gboolean
+do_emit_user_received (gpointer data)
+{
+  EmitUserClosure *closure = data;
+  TwitterUser *user;
+
+  user = twitter_user_list_get_pos (closure->user_list,
+                                    closure->current_user);
+  if (!user)
+    return FALSE;
+
+  g_signal_emit (closure->client, client_signals[USER_RECEIVED], 0,
+                 closure->handle, user, NULL);
+
+  closure->current_user += 1;
+
+  if (closure->current_user == closure->n_users)
+    return FALSE;
+
+  return TRUE;
+}
+
+static void
+cleanup_emit_user_received (gpointer data)
+{
+  EmitUserClosure *closure = data;
+
+  g_object_unref (closure->client);
+  g_object_unref (closure->user_list);
+
+  g_free (closure);
+}
+
+static void
+emit_user_received (TwitterClient   *client,
+                    TwitterUserList *user_list,
+                    gulong           handle)
+{
+  EmitUserClosure *closure;
+  guint count;
+
+  count = twitter_user_list_get_count (user_list);
+
+  closure = g_new (EmitUserClosure, 1);
+  closure->client = g_object_ref (client);
+  closure->user_list = g_object_ref (user_list);
+  closure->handle = handle;
+  closure->n_users = count;
+  closure->current_user = 0;
+
+  g_idle_add_full (G_PRIORITY_DEFAULT_IDLE + 50,
+                   do_emit_user_received,
+                   closure,
+                   cleanup_emit_user_received);
+}
+
+static void
+get_status_cb (SoupSession *session,
+               SoupMessage *msg,
+               gpointer     user_data)
+{
+  GetStatusClosure *closure = user_data;
   gboolean requires_auth = closure_get_requires_auth (closure);
   gulong handle = closure_get_handle (closure);
   TwitterClient *client = closure_get_client (closure);
@@ -1446,8 +2030,9 @@ get_user_cb (SoupSession *session,
                    "%s",
                    msg->reason_phrase);
 
-      g_signal_emit (client, client_signals[USER_RECEIVED], 0,
-                     handle, NULL, error);
+      if (!client_closure_complete (closure, NULL, error))
+        g_signal_emit (client, client_signals[STATUS_RECEIVED], 0,
+                       handle, closure->status, error);
 
       g_error_free (error);
     }
@@ -1455,7 +2040,6 @@ get_user_cb (SoupSession *session,
     {
       gboolean retval = FALSE;
       GError *error = NULL;
-      gchar *buffer;
 
       if (requires_auth && !priv->auth_complete)
         {
@@ -1464,124 +2048,298 @@ get_user_cb (SoupSession *session,
           priv->auth_complete = TRUE;
         }
 
-      buffer = g_strndup (msg->response_body->data,
-                          msg->response_body->length);
+      if (client_closure_load (closure, msg, &error))
+        twitter_client_share_status_user (client, closure->status);
 
-      twitter_debug (closure_get_action_name (closure), buffer);
+      if (!client_closure_complete (closure, closure->status, error))
+        g_signal_emit (client, client_signals[STATUS_RECEIVED], 0,
+                       handle, closure->status, error);
 
-      if (G_UNLIKELY (!buffer))
-        g_warning ("No data received");
-      else
-        {
-          twitter_user_load_from_data (closure->user, buffer, &error);
-
-          g_signal_emit (client, client_signals[USER_RECEIVED], 0,
-                         handle, closure->user, error);
-
-          if (error)
-            g_error_free (error);
-        }
-
-      g_free (buffer);
+      if (error)
+        g_error_free (error);
     }
 
-  g_object_unref (closure->user);
-  g_object_unref (client);
+  g_object_unref (closure->status);
+  client_closure_clear (closure);
 
   g_free (closure);
 }
 
-gulong
-twitter_client_get_status (TwitterClient *client,
-                           guint          status_id)
+static gulong
+twitter_client_queue_status (TwitterClient      *client,
+                             ClientAction        action,
+                             SoupMessage        *msg,
+                             gboolean            requires_auth,
+                             GSimpleAsyncResult *result,
+                             GCancellable       *cancellable)
 {
   GetStatusClosure *clos;
-  SoupMessage *msg;
-
-  g_return_val_if_fail (TWITTER_IS_CLIENT (client), 0);
-  g_return_val_if_fail (status_id > 0, 0);
-
-  msg = twitter_api_status_show (client->priv->base_url, status_id);
 
   clos = g_new0 (GetStatusClosure, 1);
-  closure_set_action (clos, STATUS_SHOW);
-  closure_set_client (clos, g_object_ref (client));
-  closure_set_requires_auth (clos, FALSE);
-  closure_set_handle (clos, client->priv->last_handle_id);
-  clos->status = twitter_status_new ();
+  clos->status = g_object_ref_sink (twitter_status_new ());
+  clos->closure.object = clos->status;
+  clos->closure.load = (ClientLoadFunc) twitter_status_load_from_data;
 
-  return twitter_client_queue_message (client, msg, FALSE,
+  return twitter_client_queue_closure (client, (ClientClosure *) clos,
+                                       action, msg, requires_auth,
                                        get_status_cb,
-                                       clos);
+                                       result, cancellable);
+}
+
+void
+verify_cb (SoupSession *session,
+           SoupMessage *msg,
+           gpointer     user_data)
+{
+  VerifyClosure *closure = user_data;
+  TwitterClient *client = closure_get_client (closure);
+  gulong handle = closure_get_handle (closure);
+
+  /* we want to parse them as soo as we can so we can use
+   * the values right inside the signal callbacks
+   */
+  twitter_client_parse_rate_limit (client, msg->response_headers);
+
+  if (!SOUP_STATUS_IS_SUCCESSFUL (msg->status_code))
+    {
+      GError *error = NULL;
+
+      g_set_error (&error, TWITTER_ERROR,
+                   twitter_error_from_status (msg->status_code),
+                   "%s",
+                   msg->reason_phrase);
+
+      g_signal_emit (client, client_signals[USER_VERIFIED], 0,
+                     handle, FALSE, error);
+
+      g_error_free (error);
+    }
+  else
+    {
+      gboolean is_verified;
+
+      is_verified = (msg->status_code == 200);
+
+      g_signal_emit (client, client_signals[USER_VERIFIED], 0,
+                     handle, is_verified, NULL);
+    }
+
+  client_closure_clear (closure);
+
+  g_free (closure);
 }
 
 /**
- * twitter_client_add_status:
+ * twitter_client_verify_user:
  * @client: a #TwitterClient
- * @text: the text of the status message
  *
- * Adds @text to the status messages of the user currently
- * authenticated by @client.
+ * Requests a verification of the user credentials used by @client
+ * to the provider.
  *
- * The #TwitterClient::status-received signal will be emitted
- * with the #TwitterStatus for @text.
+ * The #TwitterClient::user-verified signal will be emitted with
+ * the results of the request.
  *
  * Return value: the handle of the request, or 0
  */
 gulong
-twitter_client_add_status (TwitterClient *client,
-                           const gchar   *text)
+twitter_client_verify_user (TwitterClient *client)
 {
-  GetStatusClosure *clos;
+  VerifyClosure *clos;
   SoupMessage *msg;
 
   g_return_val_if_fail (TWITTER_IS_CLIENT (client), 0);
-  g_return_val_if_fail (text != NULL, 0);
 
-  msg = twitter_api_update (client->priv->base_url, text);
+  msg = twitter_api_verify_credentials (client->priv->base_url);
 
-  clos = g_new0 (GetStatusClosure, 1);
-  closure_set_action (clos, STATUS_UPDATE);
+  clos = g_new0 (VerifyClosure, 1);
+  closure_set_action (clos, VERIFY_CREDENTIALS);
   closure_set_client (clos, g_object_ref (client));
   closure_set_requires_auth (clos, TRUE);
   closure_set_handle (clos, client->priv->last_handle_id);
-  clos->status = twitter_status_new ();
 
   return twitter_client_queue_message (client, msg, TRUE,
-                                       get_status_cb,
+                                       verify_cb,
                                        clos);
 }
 
-gulong
-twitter_client_remove_status (TwitterClient *client,
-                              guint          status_id)
+static void
+end_session_cb (SoupSession *session,
+                SoupMessage *message,
+                gpointer     user_data)
+{
+  TwitterClient *client = user_data;
+
+  client->priv->auth_complete = FALSE;
+
+  g_signal_emit (client, client_signals[SESSION_ENDED], 0);
+}
+
+/**
+ * twitter_client_end_session:
+ * @client: a #TwitterClient
+ *
+ * Ends the current session of @client. The authentication state
+ * will be reset.
+ *
+ * The #TwitterClient::session-ended signal will be emitted when the
+ * provider acknowledged the request.
+ */
+void
+twitter_client_end_session (TwitterClient *client)
 {
-  GetStatusClosure *clos;
   SoupMessage *msg;
 
-  g_return_val_if_fail (TWITTER_IS_CLIENT (client), 0);
-  g_return_val_if_fail (status_id > 0, 0);
+  g_return_if_fail (TWITTER_IS_CLIENT (client));
 
-  msg = twitter_api_destroy (client->priv->base_url, status_id);
+  msg = twitter_api_end_session (client->priv->base_url);
 
-  clos = g_new0 (GetStatusClosure, 1);
-  closure_set_action (clos, STATUS_DESTROY);
-  closure_set_client (clos, g_object_ref (client));
-  closure_set_requires_auth (clos, TRUE);
-  closure_set_handle (clos, client->priv->last_handle_id);
-  clos->status = twitter_status_new ();
+  twitter_client_queue_message (client, msg, FALSE,
+                                end_session_cb,
+                                client);
+}
 
-  return twitter_client_queue_message (client, msg, TRUE,
-                                       get_status_cb,
-                                       clos);
+typedef struct {
+  TwitterClient *client;
+  TwitterTimeline *timeline;
+  gulong handle;
+  guint n_status;
+  guint current_status;
+} EmitStatusClosure;
+
+static gboolean
+do_emit_status_received (gpointer data)
+{
+  EmitStatusClosure *closure = data;
+  TwitterFilter *filter = closure->client->priv->filter;
+  TwitterStatus *status;
+
+  /* the statuses not matching the filter are skipped */
+  while (closure->current_status < closure->n_status)
+    {
+      status = twitter_timeline_get_pos (closure->timeline,
+                                         closure->current_status);
+      if (!status)
+        return FALSE;
+
+      closure->current_status += 1;
+
+      if (filter == NULL || twitter_filter_match_status (filter, status))
+        {
+          g_signal_emit (closure->client, client_signals[STATUS_RECEIVED], 0,
+                         closure->handle, status, NULL);
+          break;
+        }
+    }
+
+  if (closure->current_status == closure->n_status)
+    {
+      g_signal_emit (closure->client, client_signals[TIMELINE_COMPLETE], 0);
+      return FALSE;
+    }
+
+  return TRUE;
 }
 
 static void
-get_user_list_cb (SoupSession *session,
-                  SoupMessage *msg,
-                  gpointer     user_data)
+cleanup_emit_status_received (gpointer data)
 {
-  GetUserListClosure *closure = user_data;
+  EmitStatusClosure *closure = data;
+
+  g_object_unref (closure->client);
+  g_object_unref (closure->timeline);
+
+  g_free (closure);
+}
+
+static void
+emit_status_received (TwitterClient   *client,
+                      TwitterTimeline *timeline,
+                      gulong           handle)
+{
+  EmitStatusClosure *closure;
+  guint count;
+
+  count = twitter_timeline_get_count (timeline);
+
+  closure = g_new (EmitStatusClosure, 1);
+  closure->client = g_object_ref (client);
+  closure->timeline = g_object_ref (timeline);
+  closure->handle = handle;
+  closure->n_status = count;
+  closure->current_status = 0;
+
+  g_idle_add_full (G_PRIORITY_DEFAULT_IDLE + 50,
+                   do_emit_status_received,
+                   closure,
+                   cleanup_emit_status_received);
+}
+
+static TwitterTimeline *
+twitter_client_ensure_endpoint (TwitterClient   *client,
+                                TwitterEndpoint  endpoint)
+{
+  TwitterClientPrivate *priv = client->priv;
+
+  if (priv->endpoints[endpoint] == NULL)
+    {
+      priv->endpoints[endpoint] = twitter_timeline_new ();
+      twitter_timeline_set_max_length (priv->endpoints[endpoint],
+                                       ENDPOINT_MAX_STATUSES);
+    }
+
+  return priv->endpoints[endpoint];
+}
+
+/* adds the statuses received by a request to the timeline of its
+ * endpoint
+ */
+static void
+twitter_client_merge_endpoint (TwitterClient   *client,
+                               ClientAction     action,
+                               TwitterTimeline *timeline)
+{
+  TwitterEndpoint endpoint;
+
+  switch (action)
+    {
+    case PUBLIC_TIMELINE:
+      endpoint = TWITTER_ENDPOINT_PUBLIC_TIMELINE;
+      break;
+
+    case FRIENDS_TIMELINE:
+      endpoint = TWITTER_ENDPOINT_FRIENDS_TIMELINE;
+      break;
+
+    case USER_TIMELINE:
+      endpoint = TWITTER_ENDPOINT_USER_TIMELINE;
+      break;
+
+    case STATUS_REPLIES:
+      endpoint = TWITTER_ENDPOINT_REPLIES;
+      break;
+
+    case FAVORITES:
+      endpoint = TWITTER_ENDPOINT_FAVORITES;
+      break;
+
+    case ARCHIVE:
+      endpoint = TWITTER_ENDPOINT_ARCHIVE;
+      break;
+
+    default:
+      return;
+    }
+
+  twitter_timeline_merge (twitter_client_ensure_endpoint (client, endpoint),
+                          timeline);
+}
+
+static void
+get_timeline_cb (SoupSession *session,
+                 SoupMessage *msg,
+                 gpointer     user_data)
+{
+  GetTimelineClosure *closure = user_data;
   gboolean requires_auth = closure_get_requires_auth (closure);
   gulong handle = closure_get_handle (closure);
   TwitterClient *client = closure_get_client (closure);
@@ -1611,8 +2369,9 @@ get_user_list_cb (SoupSession *session,
                    "%s",
                    msg->reason_phrase);
 
-      g_signal_emit (client, client_signals[USER_RECEIVED], 0,
-                     handle, NULL, error);
+      if (!client_closure_complete (closure, NULL, error))
+        g_signal_emit (client, client_signals[STATUS_RECEIVED], 0,
+                       handle, NULL, error);
 
       g_error_free (error);
     }
@@ -1620,7 +2379,6 @@ get_user_list_cb (SoupSession *session,
     {
       gboolean retval = FALSE;
       GError *error = NULL;
-      gchar *buffer;
 
       if (requires_auth && !priv->auth_complete)
         {
@@ -1629,397 +2387,1747 @@ get_user_list_cb (SoupSession *session,
           priv->auth_complete = TRUE;
         }
 
-      buffer = g_strndup (msg->response_body->data,
-                          msg->response_body->length);
-
-      if (G_UNLIKELY (!buffer))
-        g_warning ("No data received");
-      else
-        twitter_user_list_load_from_data (closure->user_list, buffer, &error);
-
-      if (error)
+      if (!client_closure_load (closure, msg, &error))
         {
-          g_signal_emit (client, client_signals[USER_RECEIVED], 0,
-                         handle, NULL, error);
+          if (!client_closure_complete (closure, NULL, error))
+            g_signal_emit (client, client_signals[STATUS_RECEIVED], 0,
+                           handle, NULL, error);
 
           g_error_free (error);
         }
       else
-        emit_user_received (client, closure->user_list, handle);
-
-      g_free (buffer);
+        {
+          twitter_client_share_timeline (client, closure->timeline);
+          if (closure->merge_endpoint)
+            twitter_client_merge_endpoint (client,
+                                           closure_get_action (closure),
+                                           closure->timeline);
+
+          if (!client_closure_complete (closure, closure->timeline, NULL))
+            emit_status_received (client, closure->timeline, handle);
+        }
     }
 
-  g_object_unref (closure->user_list);
-  g_object_unref (client);
+  g_object_unref (closure->timeline);
+  client_closure_clear (closure);
 
   g_free (closure);
 }
 
-gulong
-twitter_client_add_friend (TwitterClient *client,
-                           const gchar   *user)
+static gulong
+twitter_client_queue_timeline (TwitterClient      *client,
+                               ClientAction        action,
+                               SoupMessage        *msg,
+                               gboolean            requires_auth,
+                               gboolean            merge_endpoint,
+                               GSimpleAsyncResult *result,
+                               GCancellable       *cancellable)
 {
-  GetUserClosure *clos;
-  SoupMessage *msg;
-
-  g_return_val_if_fail (TWITTER_IS_CLIENT (client), 0);
-  g_return_val_if_fail (user != NULL, 0);
-
-  msg = twitter_api_create_friend (client->priv->base_url, user);
+  GetTimelineClosure *clos;
 
-  clos = g_new0 (GetUserClosure, 1);
-  closure_set_action (clos, FRIEND_CREATE);
-  closure_set_client (clos, g_object_ref (client));
-  closure_set_requires_auth (clos, TRUE);
-  closure_set_handle (clos, client->priv->last_handle_id);
-  clos->user = twitter_user_new ();
+  clos = g_new0 (GetTimelineClosure, 1);
+  clos->timeline = twitter_timeline_new ();
+  clos->merge_endpoint = merge_endpoint;
+  clos->closure.object = clos->timeline;
+  clos->closure.load = (ClientLoadFunc) twitter_timeline_load_from_data;
 
-  return twitter_client_queue_message (client, msg, TRUE,
-                                       get_user_cb,
-                                       clos);
+  return twitter_client_queue_closure (client, (ClientClosure *) clos,
+                                       action, msg, requires_auth,
+                                       get_timeline_cb,
+                                       result, cancellable);
 }
 
 gulong
-twitter_client_remove_friend (TwitterClient *client,
-                              const gchar   *user)
+twitter_client_get_public_timeline (TwitterClient *client,
+                                    guint          since_id)
 {
-  GetUserClosure *clos;
   SoupMessage *msg;
 
   g_return_val_if_fail (TWITTER_IS_CLIENT (client), 0);
-  g_return_val_if_fail (user != NULL, 0);
 
-  msg = twitter_api_destroy_friend (client->priv->base_url, user);
+  msg = twitter_api_public_timeline (client->priv->base_url, since_id);
 
-  clos = g_new0 (GetUserClosure, 1);
-  closure_set_action (clos, FRIEND_DESTROY);
-  closure_set_client (clos, g_object_ref (client));
-  closure_set_requires_auth (clos, TRUE);
-  closure_set_handle (clos, client->priv->last_handle_id);
-  clos->user = twitter_user_new ();
+  return twitter_client_queue_timeline (client, PUBLIC_TIMELINE, msg, FALSE,
+                                        TRUE,
+                                        NULL, NULL);
+}
 
-  return twitter_client_queue_message (client, msg, TRUE,
-                                       get_user_cb,
-                                       clos);
+gulong
+twitter_client_get_friends_timeline (TwitterClient *client,
+                                     const gchar   *friend_,
+                                     gint64         since_date)
+{
+  SoupMessage *msg;
+
+  g_return_val_if_fail (TWITTER_IS_CLIENT (client), 0);
+
+  msg = twitter_api_friends_timeline (client->priv->base_url, friend_, since_date);
+
+  return twitter_client_queue_timeline (client, FRIENDS_TIMELINE, msg, TRUE,
+                                        IS_DEFAULT_USER (friend_),
+                                        NULL, NULL);
 }
 
 gulong
-twitter_client_follow_user (TwitterClient *client,
-                            const gchar   *user)
+twitter_client_get_user_timeline (TwitterClient *client,
+                                  const gchar   *user,
+                                  guint          count,
+                                  gint64         since_date)
 {
-  GetUserClosure *clos;
   SoupMessage *msg;
 
   g_return_val_if_fail (TWITTER_IS_CLIENT (client), 0);
-  g_return_val_if_fail (user != NULL, 0);
 
-  msg = twitter_api_follow (client->priv->base_url, user);
+  msg = twitter_api_user_timeline (client->priv->base_url, user, count, since_date);
 
-  clos = g_new0 (GetUserClosure, 1);
-  closure_set_action (clos, NOTIFICATION_FOLLOW);
-  closure_set_client (clos, g_object_ref (client));
-  closure_set_requires_auth (clos, TRUE);
-  closure_set_handle (clos, client->priv->last_handle_id);
-  clos->user = twitter_user_new ();
+  return twitter_client_queue_timeline (client, USER_TIMELINE, msg, TRUE,
+                                        IS_DEFAULT_USER (user),
+                                        NULL, NULL);
+}
 
-  return twitter_client_queue_message (client, msg, TRUE,
-                                       get_user_cb,
-                                       clos);
+gulong
+twitter_client_get_replies (TwitterClient *client)
+{
+  SoupMessage *msg;
+
+  g_return_val_if_fail (TWITTER_IS_CLIENT (client), 0);
+
+  msg = twitter_api_replies (client->priv->base_url);
+
+  return twitter_client_queue_timeline (client, STATUS_REPLIES, msg, TRUE,
+                                        TRUE,
+                                        NULL, NULL);
 }
 
 gulong
-twitter_client_leave_user (TwitterClient  *client,
-                           const gchar    *user)
+twitter_client_get_favorites (TwitterClient *client,
+                              const gchar   *user,
+                              gint           page)
 {
-  GetUserClosure *clos;
   SoupMessage *msg;
 
   g_return_val_if_fail (TWITTER_IS_CLIENT (client), 0);
-  g_return_val_if_fail (user != NULL, 0);
 
-  msg = twitter_api_leave (client->priv->base_url, user);
+  msg = twitter_api_favorites (client->priv->base_url, user, page);
+
+  return twitter_client_queue_timeline (client, FAVORITES, msg, TRUE,
+                                        IS_DEFAULT_USER (user) && IS_FIRST_PAGE (page),
+                                        NULL, NULL);
+}
+
+gulong
+twitter_client_get_archive (TwitterClient *client,
+                            gint           page)
+{
+  SoupMessage *msg;
+
+  g_return_val_if_fail (TWITTER_IS_CLIENT (client), 0);
+
+  msg = twitter_api_archive (client->priv->base_url, page);
+
+  return twitter_client_queue_timeline (client, ARCHIVE, msg, TRUE,
+                                        IS_FIRST_PAGE (page),
+                                        NULL, NULL);
+}
+
+static void
+get_user_cb (SoupSession *session,
+             SoupMessage *msg,
+             gpointer     user_data)
+{
+  GetUserClosure *closure = user_data;
+  gboolean requires_auth = closure_get_requires_auth (closure);
+  gulong handle = closure_get_handle (closure);
+  TwitterClient *client = closure_get_client (closure);
+  TwitterClientPrivate *priv = client->priv;
+
+  /* we want to parse them as soo as we can so we can use
+   * the values right inside the signal callbacks
+   */
+  twitter_client_parse_rate_limit (client, msg->response_headers);
+
+  if (!SOUP_STATUS_IS_SUCCESSFUL (msg->status_code))
+    {
+      GError *error = NULL;
+
+      if (msg->status_code == SOUP_STATUS_UNAUTHORIZED)
+        {
+          gboolean retval = FALSE;
+
+          g_signal_emit (client, client_signals[AUTHENTICATE], 0,
+                         TWITTER_AUTH_FAILED, &retval);
+
+          priv->auth_complete = FALSE;
+        }
+
+      g_set_error (&error, TWITTER_ERROR,
+                   twitter_error_from_status (msg->status_code),
+                   "%s",
+                   msg->reason_phrase);
+
+      if (!client_closure_complete (closure, NULL, error))
+        g_signal_emit (client, client_signals[USER_RECEIVED], 0,
+                       handle, NULL, error);
+
+      g_error_free (error);
+    }
+  else
+    {
+      gboolean retval = FALSE;
+      GError *error = NULL;
+
+      if (requires_auth && !priv->auth_complete)
+        {
+          g_signal_emit (client, client_signals[AUTHENTICATE], 0,
+                         TWITTER_AUTH_SUCCESS, &retval);
+          priv->auth_complete = TRUE;
+        }
+
+      if (client_closure_load (closure, msg, &error))
+        {
+          TwitterUser *shared;
+
+          shared = twitter_client_share_user (client, closure->user);
+          if (shared != closure->user)
+            {
+              g_object_unref (closure->user);
+              closure->user = g_object_ref (shared);
+            }
+        }
+
+      if (!client_closure_complete (closure, closure->user, error))
+        g_signal_emit (client, client_signals[USER_RECEIVED], 0,
+                       handle, closure->user, error);
+
+      if (error)
+        g_error_free (error);
+    }
+
+  g_object_unref (closure->user);
+  client_closure_clear (closure);
+
+  g_free (closure);
+}
+
+static gulong
+twitter_client_queue_user (TwitterClient      *client,
+                           ClientAction        action,
+                           SoupMessage        *msg,
+                           gboolean            requires_auth,
+                           GSimpleAsyncResult *result,
+                           GCancellable       *cancellable)
+{
+  GetUserClosure *clos;
 
   clos = g_new0 (GetUserClosure, 1);
-  closure_set_action (clos, NOTIFICATION_LEAVE);
-  closure_set_client (clos, g_object_ref (client));
-  closure_set_requires_auth (clos, TRUE);
-  closure_set_handle (clos, client->priv->last_handle_id);
-  clos->user = twitter_user_new ();
+  clos->user = g_object_ref_sink (twitter_user_new ());
+  clos->closure.object = clos->user;
+  clos->closure.load = (ClientLoadFunc) twitter_user_load_from_data;
 
-  return twitter_client_queue_message (client, msg, TRUE,
+  return twitter_client_queue_closure (client, (ClientClosure *) clos,
+                                       action, msg, requires_auth,
                                        get_user_cb,
-                                       clos);
+                                       result, cancellable);
 }
 
 gulong
-twitter_client_add_favorite (TwitterClient  *client,
-                             guint           status_id)
+twitter_client_get_status (TwitterClient *client,
+                           guint          status_id)
 {
-  GetStatusClosure *clos;
   SoupMessage *msg;
 
   g_return_val_if_fail (TWITTER_IS_CLIENT (client), 0);
   g_return_val_if_fail (status_id > 0, 0);
 
-  msg = twitter_api_create_favorite (client->priv->base_url, status_id);
+  msg = twitter_api_status_show (client->priv->base_url, status_id);
 
-  clos = g_new0 (GetStatusClosure, 1);
-  closure_set_action (clos, FAVORITE_CREATE);
-  closure_set_client (clos, g_object_ref (client));
-  closure_set_requires_auth (clos, TRUE);
-  closure_set_handle (clos, client->priv->last_handle_id);
-  clos->status = twitter_status_new ();
+  return twitter_client_queue_status (client, STATUS_SHOW, msg, FALSE,
+                                      NULL, NULL);
+}
 
-  return twitter_client_queue_message (client, msg, TRUE,
-                                       get_status_cb,
-                                       clos);
+/**
+ * twitter_client_add_status:
+ * @client: a #TwitterClient
+ * @text: the text of the status message
+ *
+ * Adds @text to the status messages of the user currently
+ * authenticated by @client.
+ *
+ * The #TwitterClient::status-received signal will be emitted
+ * with the #TwitterStatus for @text.
+ *
+ * Return value: the handle of the request, or 0
+ */
+gulong
+twitter_client_add_status (TwitterClient *client,
+                           const gchar   *text)
+{
+  SoupMessage *msg;
+
+  g_return_val_if_fail (TWITTER_IS_CLIENT (client), 0);
+  g_return_val_if_fail (text != NULL, 0);
+
+  msg = twitter_api_update (client->priv->base_url, text);
+
+  return twitter_client_queue_status (client, STATUS_UPDATE, msg, TRUE,
+                                      NULL, NULL);
 }
 
 gulong
-twitter_client_remove_favorite (TwitterClient  *client,
-                                guint           status_id)
+twitter_client_remove_status (TwitterClient *client,
+                              guint          status_id)
 {
-  GetStatusClosure *clos;
   SoupMessage *msg;
 
   g_return_val_if_fail (TWITTER_IS_CLIENT (client), 0);
   g_return_val_if_fail (status_id > 0, 0);
 
-  msg = twitter_api_destroy_favorite (client->priv->base_url, status_id);
-
-  clos = g_new0 (GetStatusClosure, 1);
-  closure_set_action (clos, FAVORITE_DESTROY);
-  closure_set_client (clos, g_object_ref (client));
-  closure_set_requires_auth (clos, TRUE);
-  closure_set_handle (clos, client->priv->last_handle_id);
-  clos->status = twitter_status_new ();
+  msg = twitter_api_destroy (client->priv->base_url, status_id);
 
-  return twitter_client_queue_message (client, msg, TRUE,
-                                       get_status_cb,
-                                       clos);
+  return twitter_client_queue_status (client, STATUS_DESTROY, msg, TRUE,
+                                      NULL, NULL);
 }
 
-/**
- * twitter_client_get_friends:
- * @client: a #TwitterClient
- * @user: the user id or screen name
- * @page: the page number of the friends list
- * @omit_status: %TRUE if the #TwitterUser should not have
- *   the last status associated to them
- *
- * Requests the provider used by @client for a (paged) list
- * of the people followed by the #TwitterClient authenticated
- * user.
+static void
+get_user_list_cb (SoupSession *session,
+                  SoupMessage *msg,
+                  gpointer     user_data)
+{
+  GetUserListClosure *closure = user_data;
+  gboolean requires_auth = closure_get_requires_auth (closure);
+  gulong handle = closure_get_handle (closure);
+  TwitterClient *client = closure_get_client (closure);
+  TwitterClientPrivate *priv = client->priv;
+
+  /* we want to parse them as soo as we can so we can use
+   * the values right inside the signal callbacks
+   */
+  twitter_client_parse_rate_limit (client, msg->response_headers);
+
+  if (!SOUP_STATUS_IS_SUCCESSFUL (msg->status_code))
+    {
+      GError *error = NULL;
+
+      if (msg->status_code == SOUP_STATUS_UNAUTHORIZED)
+        {
+          gboolean retval = FALSE;
+
+          g_signal_emit (client, client_signals[AUTHENTICATE], 0,
+                         TWITTER_AUTH_FAILED, &retval);
+
+          priv->auth_complete = FALSE;
+        }
+
+      g_set_error (&error, TWITTER_ERROR,
+                   twitter_error_from_status (msg->status_code),
+                   "%s",
+                   msg->reason_phrase);
+
+      if (!client_closure_complete (closure, NULL, error))
+        g_signal_emit (client, client_signals[USER_RECEIVED], 0,
+                       handle, NULL, error);
+
+      g_error_free (error);
+    }
+  else
+    {
+      gboolean retval = FALSE;
+      GError *error = NULL;
+
+      if (requires_auth && !priv->auth_complete)
+        {
+          g_signal_emit (client, client_signals[AUTHENTICATE], 0,
+                         TWITTER_AUTH_SUCCESS, &retval);
+          priv->auth_complete = TRUE;
+        }
+
+      if (!client_closure_load (closure, msg, &error))
+        {
+          if (!client_closure_complete (closure, NULL, error))
+            g_signal_emit (client, client_signals[USER_RECEIVED], 0,
+                           handle, NULL, error);
+
+          g_error_free (error);
+        }
+      else
+        {
+          twitter_client_share_user_list (client, closure->user_list);
+
+          if (!client_closure_complete (closure, closure->user_list, NULL))
+            emit_user_received (client, closure->user_list, handle);
+        }
+    }
+
+  g_object_unref (closure->user_list);
+  client_closure_clear (closure);
+
+  g_free (closure);
+}
+
+static gulong
+twitter_client_queue_user_list (TwitterClient      *client,
+                                ClientAction        action,
+                                SoupMessage        *msg,
+                                gboolean            requires_auth,
+                                GSimpleAsyncResult *result,
+                                GCancellable       *cancellable)
+{
+  GetUserListClosure *clos;
+
+  clos = g_new0 (GetUserListClosure, 1);
+  clos->user_list = twitter_user_list_new ();
+  clos->closure.object = clos->user_list;
+  clos->closure.load = (ClientLoadFunc) twitter_user_list_load_from_data;
+
+  return twitter_client_queue_closure (client, (ClientClosure *) clos,
+                                       action, msg, requires_auth,
+                                       get_user_list_cb,
+                                       result, cancellable);
+}
+
+gulong
+twitter_client_add_friend (TwitterClient *client,
+                           const gchar   *user)
+{
+  SoupMessage *msg;
+
+  g_return_val_if_fail (TWITTER_IS_CLIENT (client), 0);
+  g_return_val_if_fail (user != NULL, 0);
+
+  msg = twitter_api_create_friend (client->priv->base_url, user);
+
+  return twitter_client_queue_user (client, FRIEND_CREATE, msg, TRUE,
+                                    NULL, NULL);
+}
+
+gulong
+twitter_client_remove_friend (TwitterClient *client,
+                              const gchar   *user)
+{
+  SoupMessage *msg;
+
+  g_return_val_if_fail (TWITTER_IS_CLIENT (client), 0);
+  g_return_val_if_fail (user != NULL, 0);
+
+  msg = twitter_api_destroy_friend (client->priv->base_url, user);
+
+  return twitter_client_queue_user (client, FRIEND_DESTROY, msg, TRUE,
+                                    NULL, NULL);
+}
+
+gulong
+twitter_client_follow_user (TwitterClient *client,
+                            const gchar   *user)
+{
+  SoupMessage *msg;
+
+  g_return_val_if_fail (TWITTER_IS_CLIENT (client), 0);
+  g_return_val_if_fail (user != NULL, 0);
+
+  msg = twitter_api_follow (client->priv->base_url, user);
+
+  return twitter_client_queue_user (client, NOTIFICATION_FOLLOW, msg, TRUE,
+                                    NULL, NULL);
+}
+
+gulong
+twitter_client_leave_user (TwitterClient  *client,
+                           const gchar    *user)
+{
+  SoupMessage *msg;
+
+  g_return_val_if_fail (TWITTER_IS_CLIENT (client), 0);
+  g_return_val_if_fail (user != NULL, 0);
+
+  msg = twitter_api_leave (client->priv->base_url, user);
+
+  return twitter_client_queue_user (client, NOTIFICATION_LEAVE, msg, TRUE,
+                                    NULL, NULL);
+}
+
+gulong
+twitter_client_add_favorite (TwitterClient  *client,
+                             guint           status_id)
+{
+  SoupMessage *msg;
+
+  g_return_val_if_fail (TWITTER_IS_CLIENT (client), 0);
+  g_return_val_if_fail (status_id > 0, 0);
+
+  msg = twitter_api_create_favorite (client->priv->base_url, status_id);
+
+  return twitter_client_queue_status (client, FAVORITE_CREATE, msg, TRUE,
+                                      NULL, NULL);
+}
+
+gulong
+twitter_client_remove_favorite (TwitterClient  *client,
+                                guint           status_id)
+{
+  SoupMessage *msg;
+
+  g_return_val_if_fail (TWITTER_IS_CLIENT (client), 0);
+  g_return_val_if_fail (status_id > 0, 0);
+
+  msg = twitter_api_destroy_favorite (client->priv->base_url, status_id);
+
+  return twitter_client_queue_status (client, FAVORITE_DESTROY, msg, TRUE,
+                                      NULL, NULL);
+}
+
+/**
+ * twitter_client_get_friends:
+ * @client: a #TwitterClient
+ * @user: the user id or screen name
+ * @page: the page number of the friends list
+ * @omit_status: %TRUE if the #TwitterUser should not have
+ *   the last status associated to them
+ *
+ * Requests the provider used by @client for a (paged) list
+ * of the people followed by the #TwitterClient authenticated
+ * user.
+ *
+ * The #TwitterClient::user-received signal will be emitted
+ * for each followed user.
+ *
+ * Return value: the handle of the request, or 0
+ */
+gulong
+twitter_client_get_friends (TwitterClient *client,
+                            const gchar   *user,
+                            gint           page,
+                            gboolean       omit_status)
+{
+  SoupMessage *msg;
+
+  g_return_val_if_fail (TWITTER_IS_CLIENT (client), 0);
+
+  msg = twitter_api_friends (client->priv->base_url, user, page, omit_status);
+
+  return twitter_client_queue_user_list (client, FRIENDS, msg, TRUE,
+                                         NULL, NULL);
+}
+
+/**
+ * twitter_client_get_followers:
+ * @client: a #TwitterClient
+ * @page: the page number of the followers list
+ * @omit_status: %TRUE if the #TwitterUser should not have
+ *   the last status associated to them
+ *
+ * Requests the provider used by @client for a (paged) list
+ * of the people following the #TwitterClient authenticated
+ * user.
+ *
+ * The #TwitterClient::user-received signal will be emitted
+ * for each follower.
+ *
+ * Return value: the handle of the request, or 0
+ */
+gulong
+twitter_client_get_followers (TwitterClient *client,
+                              gint           page,
+                              gboolean       omit_status)
+{
+  SoupMessage *msg;
+
+  g_return_val_if_fail (TWITTER_IS_CLIENT (client), 0);
+
+  msg = twitter_api_followers (client->priv->base_url, page, omit_status);
+
+  return twitter_client_queue_user_list (client, FOLLOWERS, msg, TRUE,
+                                         NULL, NULL);
+}
+
+/**
+ * twitter_client_show_user_from_email:
+ * @client: a #TwitterClient
+ * @email: E-mail address of the user
+ *
+ * Requests the provider used by @client to "show" the user
+ * matching the @email string.
+ *
+ * The #TwitterClient::user-received signal will be emitted
+ * with the requested #TwitterUser
+ *
+ * Return value: the handle of the request, or 0
+ *
+ * Deprecated: 0.9.10: Use twitter_client_show_user_from_id() instead
+ */
+gulong
+twitter_client_show_user_from_email (TwitterClient *client,
+                                     const gchar   *email)
+{
+  SoupMessage *msg;
+
+  g_return_val_if_fail (TWITTER_IS_CLIENT (client), 0);
+  g_return_val_if_fail (email != NULL, 0);
+
+  msg = twitter_api_user_show (client->priv->base_url, email);
+
+  return twitter_client_queue_user (client, USER_SHOW, msg, TRUE,
+                                    NULL, NULL);
+}
+
+/**
+ * twitter_client_show_user_from_id:
+ * @client: a #TwitterClient
+ * @id_or_screen_name: user ID or screen name
+ *
+ * Requests the provider used by @client to "show" the user
+ * matching the @user string.
+ *
+ * The @user string is either the user id as returned by
+ * twitter_user_get_id(), or the screen name as returned
+ * by twitter_user_get_screen_name().
+ *
+ * The #TwitterClient::user-received signal will be emitted
+ * with the requested #TwitterUser
+ *
+ * Return value: the handle of the request, or 0
+ */
+gulong
+twitter_client_show_user_from_id (TwitterClient *client,
+                                  const gchar   *id_or_screen_name)
+{
+  SoupMessage *msg;
+
+  g_return_val_if_fail (TWITTER_IS_CLIENT (client), 0);
+  g_return_val_if_fail (id_or_screen_name != NULL, 0);
+
+  msg = twitter_api_user_show (client->priv->base_url, id_or_screen_name);
+
+  return twitter_client_queue_user (client, USER_SHOW, msg, TRUE,
+                                    NULL, NULL);
+}
+
+/**
+ * twitter_client_get_public_timeline_async:
+ * @client: a #TwitterClient
+ * @since_id: the id of the oldest status, or 0
+ * @cancellable: (allow-none): a #GCancellable, or %NULL
+ * @callback: function to call when the request is complete
+ * @user_data: data to pass to @callback
+ *
+ * Asynchronous variant of twitter_client_get_public_timeline().
+ * Retrieves the public timeline.
+ *
+ * When the request is complete, @callback will be invoked and
+ * it should call twitter_client_get_timeline_finish() to
+ * retrieve the #TwitterTimeline. No signal is emitted.
+ *
+ * Since: 0.9.10
+ */
+void
+twitter_client_get_public_timeline_async (TwitterClient       *client,
+                                          guint                since_id,
+                                          GCancellable        *cancellable,
+                                          GAsyncReadyCallback  callback,
+                                          gpointer             user_data)
+{
+  GSimpleAsyncResult *result;
+  SoupMessage *msg;
+
+  g_return_if_fail (TWITTER_IS_CLIENT (client));
+
+  result = g_simple_async_result_new (G_OBJECT (client),
+                                      callback, user_data,
+                                      twitter_client_get_timeline_finish);
+
+  msg = twitter_api_public_timeline (client->priv->base_url, since_id);
+
+  twitter_client_queue_timeline (client, PUBLIC_TIMELINE, msg, FALSE,
+                                 TRUE,
+                                 result, cancellable);
+}
+
+/**
+ * twitter_client_get_friends_timeline_async:
+ * @client: a #TwitterClient
+ * @friend_: (allow-none): a user id or screen name, or %NULL
+ * @since_date: a timestamp, or 0
+ * @cancellable: (allow-none): a #GCancellable, or %NULL
+ * @callback: function to call when the request is complete
+ * @user_data: data to pass to @callback
+ *
+ * Asynchronous variant of twitter_client_get_friends_timeline().
+ * Retrieves the timeline of the people followed by @friend_.
+ *
+ * When the request is complete, @callback will be invoked and
+ * it should call twitter_client_get_timeline_finish() to
+ * retrieve the #TwitterTimeline. No signal is emitted.
+ *
+ * Since: 0.9.10
+ */
+void
+twitter_client_get_friends_timeline_async (TwitterClient       *client,
+                                           const gchar         *friend_,
+                                           gint64               since_date,
+                                           GCancellable        *cancellable,
+                                           GAsyncReadyCallback  callback,
+                                           gpointer             user_data)
+{
+  GSimpleAsyncResult *result;
+  SoupMessage *msg;
+
+  g_return_if_fail (TWITTER_IS_CLIENT (client));
+
+  result = g_simple_async_result_new (G_OBJECT (client),
+                                      callback, user_data,
+                                      twitter_client_get_timeline_finish);
+
+  msg = twitter_api_friends_timeline (client->priv->base_url,
+                                      friend_,
+                                      since_date);
+
+  twitter_client_queue_timeline (client, FRIENDS_TIMELINE, msg, TRUE,
+                                 IS_DEFAULT_USER (friend_),
+                                 result, cancellable);
+}
+
+/**
+ * twitter_client_get_user_timeline_async:
+ * @client: a #TwitterClient
+ * @user: (allow-none): a user id or screen name, or %NULL
+ * @count: the number of statuses, or 0
+ * @since_date: a timestamp, or 0
+ * @cancellable: (allow-none): a #GCancellable, or %NULL
+ * @callback: function to call when the request is complete
+ * @user_data: data to pass to @callback
+ *
+ * Asynchronous variant of twitter_client_get_user_timeline().
+ * Retrieves the timeline of @user.
+ *
+ * When the request is complete, @callback will be invoked and
+ * it should call twitter_client_get_timeline_finish() to
+ * retrieve the #TwitterTimeline. No signal is emitted.
+ *
+ * Since: 0.9.10
+ */
+void
+twitter_client_get_user_timeline_async (TwitterClient       *client,
+                                        const gchar         *user,
+                                        guint                count,
+                                        gint64               since_date,
+                                        GCancellable        *cancellable,
+                                        GAsyncReadyCallback  callback,
+                                        gpointer             user_data)
+{
+  GSimpleAsyncResult *result;
+  SoupMessage *msg;
+
+  g_return_if_fail (TWITTER_IS_CLIENT (client));
+
+  result = g_simple_async_result_new (G_OBJECT (client),
+                                      callback, user_data,
+                                      twitter_client_get_timeline_finish);
+
+  msg = twitter_api_user_timeline (client->priv->base_url,
+                                   user, count,
+                                   since_date);
+
+  twitter_client_queue_timeline (client, USER_TIMELINE, msg, TRUE,
+                                 IS_DEFAULT_USER (user),
+                                 result, cancellable);
+}
+
+/**
+ * twitter_client_get_replies_async:
+ * @client: a #TwitterClient
+ * @cancellable: (allow-none): a #GCancellable, or %NULL
+ * @callback: function to call when the request is complete
+ * @user_data: data to pass to @callback
+ *
+ * Asynchronous variant of twitter_client_get_replies().
+ * Retrieves the replies to the authenticated user.
+ *
+ * When the request is complete, @callback will be invoked and
+ * it should call twitter_client_get_timeline_finish() to
+ * retrieve the #TwitterTimeline. No signal is emitted.
+ *
+ * Since: 0.9.10
+ */
+void
+twitter_client_get_replies_async (TwitterClient       *client,
+                                  GCancellable        *cancellable,
+                                  GAsyncReadyCallback  callback,
+                                  gpointer             user_data)
+{
+  GSimpleAsyncResult *result;
+  SoupMessage *msg;
+
+  g_return_if_fail (TWITTER_IS_CLIENT (client));
+
+  result = g_simple_async_result_new (G_OBJECT (client),
+                                      callback, user_data,
+                                      twitter_client_get_timeline_finish);
+
+  msg = twitter_api_replies (client->priv->base_url);
+
+  twitter_client_queue_timeline (client, STATUS_REPLIES, msg, TRUE,
+                                 TRUE,
+                                 result, cancellable);
+}
+
+/**
+ * twitter_client_get_favorites_async:
+ * @client: a #TwitterClient
+ * @user: (allow-none): a user id or screen name, or %NULL
+ * @page: the page number
+ * @cancellable: (allow-none): a #GCancellable, or %NULL
+ * @callback: function to call when the request is complete
+ * @user_data: data to pass to @callback
+ *
+ * Asynchronous variant of twitter_client_get_favorites().
+ * Retrieves the favorite statuses of @user.
+ *
+ * When the request is complete, @callback will be invoked and
+ * it should call twitter_client_get_timeline_finish() to
+ * retrieve the #TwitterTimeline. No signal is emitted.
+ *
+ * Since: 0.9.10
+ */
+void
+twitter_client_get_favorites_async (TwitterClient       *client,
+                                    const gchar         *user,
+                                    gint                 page,
+                                    GCancellable        *cancellable,
+                                    GAsyncReadyCallback  callback,
+                                    gpointer             user_data)
+{
+  GSimpleAsyncResult *result;
+  SoupMessage *msg;
+
+  g_return_if_fail (TWITTER_IS_CLIENT (client));
+
+  result = g_simple_async_result_new (G_OBJECT (client),
+                                      callback, user_data,
+                                      twitter_client_get_timeline_finish);
+
+  msg = twitter_api_favorites (client->priv->base_url, user, page);
+
+  twitter_client_queue_timeline (client, FAVORITES, msg, TRUE,
+                                 IS_DEFAULT_USER (user) && IS_FIRST_PAGE (page),
+                                 result, cancellable);
+}
+
+/**
+ * twitter_client_get_archive_async:
+ * @client: a #TwitterClient
+ * @page: the page number
+ * @cancellable: (allow-none): a #GCancellable, or %NULL
+ * @callback: function to call when the request is complete
+ * @user_data: data to pass to @callback
+ *
+ * Asynchronous variant of twitter_client_get_archive().
+ * Retrieves the archive of the authenticated user.
+ *
+ * When the request is complete, @callback will be invoked and
+ * it should call twitter_client_get_timeline_finish() to
+ * retrieve the #TwitterTimeline. No signal is emitted.
+ *
+ * Since: 0.9.10
+ */
+void
+twitter_client_get_archive_async (TwitterClient       *client,
+                                  gint                 page,
+                                  GCancellable        *cancellable,
+                                  GAsyncReadyCallback  callback,
+                                  gpointer             user_data)
+{
+  GSimpleAsyncResult *result;
+  SoupMessage *msg;
+
+  g_return_if_fail (TWITTER_IS_CLIENT (client));
+
+  result = g_simple_async_result_new (G_OBJECT (client),
+                                      callback, user_data,
+                                      twitter_client_get_timeline_finish);
+
+  msg = twitter_api_archive (client->priv->base_url, page);
+
+  twitter_client_queue_timeline (client, ARCHIVE, msg, TRUE,
+                                 IS_FIRST_PAGE (page),
+                                 result, cancellable);
+}
+
+/**
+ * twitter_client_get_timeline_finish:
+ * @client: a #TwitterClient
+ * @result: the #GAsyncResult passed to the callback
+ * @error: return location for a #GError, or %NULL
+ *
+ * Finishes an asynchronous timeline request started with
+ * one of the twitter_client_get_*_timeline_async() functions,
+ * twitter_client_get_replies_async(),
+ * twitter_client_get_favorites_async() or
+ * twitter_client_get_archive_async().
+ *
+ * If the request was cancelled, @error will be set to
+ * %G_IO_ERROR_CANCELLED.
+ *
+ * Return value: (transfer full): a #TwitterTimeline; use
+ *   g_object_unref() when done. On error, %NULL is returned
+ *   and @error is set
+ *
+ * Since: 0.9.10
+ */
+TwitterTimeline *
+twitter_client_get_timeline_finish (TwitterClient  *client,
+                                    GAsyncResult   *result,
+                                    GError        **error)
+{
+  return twitter_client_finish (client, result,
+                                twitter_client_get_timeline_finish,
+                                error);
+}
+
+/**
+ * twitter_client_get_friends_async:
+ * @client: a #TwitterClient
+ * @user: (allow-none): the user id or screen name, or %NULL
+ * @page: the page number of the friends list
+ * @omit_status: %TRUE if the #TwitterUser should not have
+ *   the last status associated to them
+ * @cancellable: (allow-none): a #GCancellable, or %NULL
+ * @callback: function to call when the request is complete
+ * @user_data: data to pass to @callback
+ *
+ * Asynchronous variant of twitter_client_get_friends().
+ *
+ * When the request is complete, @callback will be invoked and
+ * it should call twitter_client_get_user_list_finish() to
+ * retrieve the #TwitterUserList. No signal is emitted.
+ *
+ * Since: 0.9.10
+ */
+void
+twitter_client_get_friends_async (TwitterClient       *client,
+                                  const gchar         *user,
+                                  gint                 page,
+                                  gboolean             omit_status,
+                                  GCancellable        *cancellable,
+                                  GAsyncReadyCallback  callback,
+                                  gpointer             user_data)
+{
+  GSimpleAsyncResult *result;
+  SoupMessage *msg;
+
+  g_return_if_fail (TWITTER_IS_CLIENT (client));
+
+  result = g_simple_async_result_new (G_OBJECT (client),
+                                      callback, user_data,
+                                      twitter_client_get_user_list_finish);
+
+  msg = twitter_api_friends (client->priv->base_url, user, page, omit_status);
+
+  twitter_client_queue_user_list (client, FRIENDS, msg, TRUE,
+                                  result, cancellable);
+}
+
+/**
+ * twitter_client_get_followers_async:
+ * @client: a #TwitterClient
+ * @page: the page number of the followers list
+ * @omit_status: %TRUE if the #TwitterUser should not have
+ *   the last status associated to them
+ * @cancellable: (allow-none): a #GCancellable, or %NULL
+ * @callback: function to call when the request is complete
+ * @user_data: data to pass to @callback
+ *
+ * Asynchronous variant of twitter_client_get_followers().
+ *
+ * When the request is complete, @callback will be invoked and
+ * it should call twitter_client_get_user_list_finish() to
+ * retrieve the #TwitterUserList. No signal is emitted.
+ *
+ * Since: 0.9.10
+ */
+void
+twitter_client_get_followers_async (TwitterClient       *client,
+                                    gint                 page,
+                                    gboolean             omit_status,
+                                    GCancellable        *cancellable,
+                                    GAsyncReadyCallback  callback,
+                                    gpointer             user_data)
+{
+  GSimpleAsyncResult *result;
+  SoupMessage *msg;
+
+  g_return_if_fail (TWITTER_IS_CLIENT (client));
+
+  result = g_simple_async_result_new (G_OBJECT (client),
+                                      callback, user_data,
+                                      twitter_client_get_user_list_finish);
+
+  msg = twitter_api_followers (client->priv->base_url, page, omit_status);
+
+  twitter_client_queue_user_list (client, FOLLOWERS, msg, TRUE,
+                                  result, cancellable);
+}
+
+/**
+ * twitter_client_get_user_list_finish:
+ * @client: a #TwitterClient
+ * @result: the #GAsyncResult passed to the callback
+ * @error: return location for a #GError, or %NULL
+ *
+ * Finishes an asynchronous request started with
+ * twitter_client_get_friends_async() or
+ * twitter_client_get_followers_async().
+ *
+ * Return value: (transfer full): a #TwitterUserList; use
+ *   g_object_unref() when done. On error, %NULL is returned
+ *   and @error is set
+ *
+ * Since: 0.9.10
+ */
+TwitterUserList *
+twitter_client_get_user_list_finish (TwitterClient  *client,
+                                     GAsyncResult   *result,
+                                     GError        **error)
+{
+  return twitter_client_finish (client, result,
+                                twitter_client_get_user_list_finish,
+                                error);
+}
+
+/**
+ * twitter_client_get_status_async:
+ * @client: a #TwitterClient
+ * @status_id: the id of the status
+ * @cancellable: (allow-none): a #GCancellable, or %NULL
+ * @callback: function to call when the request is complete
+ * @user_data: data to pass to @callback
+ *
+ * Asynchronous variant of twitter_client_get_status().
+ *
+ * When the request is complete, @callback will be invoked and
+ * it should call twitter_client_get_status_finish() to
+ * retrieve the #TwitterStatus. No signal is emitted.
+ *
+ * Since: 0.9.10
+ */
+void
+twitter_client_get_status_async (TwitterClient       *client,
+                                 guint                status_id,
+                                 GCancellable        *cancellable,
+                                 GAsyncReadyCallback  callback,
+                                 gpointer             user_data)
+{
+  GSimpleAsyncResult *result;
+  SoupMessage *msg;
+
+  g_return_if_fail (TWITTER_IS_CLIENT (client));
+  g_return_if_fail (status_id > 0);
+
+  result = g_simple_async_result_new (G_OBJECT (client),
+                                      callback, user_data,
+                                      twitter_client_get_status_finish);
+
+  msg = twitter_api_status_show (client->priv->base_url, status_id);
+
+  twitter_client_queue_status (client, STATUS_SHOW, msg, FALSE,
+                               result, cancellable);
+}
+
+/**
+ * twitter_client_get_status_finish:
+ * @client: a #TwitterClient
+ * @result: the #GAsyncResult passed to the callback
+ * @error: return location for a #GError, or %NULL
+ *
+ * Finishes an asynchronous request started with
+ * twitter_client_get_status_async().
+ *
+ * Return value: (transfer full): a #TwitterStatus; use
+ *   g_object_unref() when done. On error, %NULL is returned
+ *   and @error is set
+ *
+ * Since: 0.9.10
+ */
+TwitterStatus *
+twitter_client_get_status_finish (TwitterClient  *client,
+                                  GAsyncResult   *result,
+                                  GError        **error)
+{
+  return twitter_client_finish (client, result,
+                                twitter_client_get_status_finish,
+                                error);
+}
+
+/**
+ * twitter_client_show_user_from_id_async:
+ * @client: a #TwitterClient
+ * @id_or_screen_name: user ID or screen name
+ * @cancellable: (allow-none): a #GCancellable, or %NULL
+ * @callback: function to call when the request is complete
+ * @user_data: data to pass to @callback
+ *
+ * Asynchronous variant of twitter_client_show_user_from_id().
+ *
+ * When the request is complete, @callback will be invoked and
+ * it should call twitter_client_show_user_from_id_finish() to
+ * retrieve the #TwitterUser. No signal is emitted.
+ *
+ * Since: 0.9.10
+ */
+void
+twitter_client_show_user_from_id_async (TwitterClient       *client,
+                                        const gchar         *id_or_screen_name,
+                                        GCancellable        *cancellable,
+                                        GAsyncReadyCallback  callback,
+                                        gpointer             user_data)
+{
+  GSimpleAsyncResult *result;
+  SoupMessage *msg;
+
+  g_return_if_fail (TWITTER_IS_CLIENT (client));
+  g_return_if_fail (id_or_screen_name != NULL);
+
+  result = g_simple_async_result_new (G_OBJECT (client),
+                                      callback, user_data,
+                                      twitter_client_show_user_from_id_finish);
+
+  msg = twitter_api_user_show (client->priv->base_url, id_or_screen_name);
+
+  twitter_client_queue_user (client, USER_SHOW, msg, TRUE,
+                             result, cancellable);
+}
+
+/**
+ * twitter_client_show_user_from_id_finish:
+ * @client: a #TwitterClient
+ * @result: the #GAsyncResult passed to the callback
+ * @error: return location for a #GError, or %NULL
+ *
+ * Finishes an asynchronous request started with
+ * twitter_client_show_user_from_id_async().
+ *
+ * Return value: (transfer full): a #TwitterUser; use
+ *   g_object_unref() when done. On error, %NULL is returned
+ *   and @error is set
+ *
+ * Since: 0.9.10
+ */
+TwitterUser *
+twitter_client_show_user_from_id_finish (TwitterClient  *client,
+                                         GAsyncResult   *result,
+                                         GError        **error)
+{
+  return twitter_client_finish (client, result,
+                                twitter_client_show_user_from_id_finish,
+                                error);
+}
+
+/**
+ * twitter_client_get_provider:
+ * @client: a #TwitterClient
+ *
+ * Retrieves the type of provider used by @client
+ *
+ * Return value: the provider logical id
+ */
+TwitterProvider
+twitter_client_get_provider (TwitterClient *client)
+{
+  g_return_val_if_fail (TWITTER_IS_CLIENT (client), TWITTER_DEFAULT_PROVIDER);
+
+  return client->priv->provider;
+}
+
+/**
+ * twitter_client_get_base_url:
+ * @client: a #TwitterClient
+ *
+ * Retrieves the base URL of the service provider used by @client
+ *
+ * Return value: the base URL. The returned string is owned by
+ *   the #TwitterClient and should never be modified of freed
+ */
+G_CONST_RETURN gchar *
+twitter_client_get_base_url (TwitterClient *client)
+{
+  g_return_val_if_fail (TWITTER_IS_CLIENT (client), NULL);
+
+  return client->priv->base_url;
+}
+
+/**
+ * twitter_client_get_rate_limit:
+ * @client: a #TwitterClient
+ * @limit: (out): return location for the current cap on requests
+ * @remaining: (out): return location for the current remaining requests
+ *
+ * Retrieves the current state of the rate limitation that Twitter
+ * uses to avoid excessive load.
+ *
+ * If you want to monitor the rate limitation you should monitor
+ * notifications on the #TwitterClient:remaining-requests and
+ * #TwitterClient:max-requests.
+ *
+ * Since: 0.9.10
+ */
+void
+twitter_client_get_rate_limit (TwitterClient *client,
+                               gint          *limit,
+                               gint          *remaining)
+{
+  g_return_if_fail (TWITTER_IS_CLIENT (client));
+
+  if (limit)
+    *limit = client->priv->rate_limit;
+
+  if (remaining)
+    *remaining = client->priv->rate_limit_remaining;
+}
+
+/**
+ * twitter_client_get_transfer_stats:
+ * @client: a #TwitterClient
+ * @wire_bytes: (out): return location for the amount of bytes received
+ *   from the provider, or %NULL
+ * @decoded_bytes: (out): return location for the amount of bytes after
+ *   decoding compressed responses, or %NULL
+ *
+ * Retrieves the amount of data received by @client. If the
+ * #TwitterClient:compression property is set, @wire_bytes will
+ * be smaller than @decoded_bytes for compressed responses.
+ *
+ * Since: 0.9.10
+ */
+void
+twitter_client_get_transfer_stats (TwitterClient *client,
+                                   guint64       *wire_bytes,
+                                   guint64       *decoded_bytes)
+{
+  g_return_if_fail (TWITTER_IS_CLIENT (client));
+
+  if (wire_bytes)
+    *wire_bytes = client->priv->bytes_received;
+
+  if (decoded_bytes)
+    *decoded_bytes = client->priv->bytes_decoded;
+}
+
+/**
+ * twitter_client_set_compression:
+ * @client: a #TwitterClient
+ * @compression: whether to request compressed responses
+ *
+ * Sets whether @client should request compressed responses from
+ * the provider. See #TwitterClient:compression.
+ *
+ * Since: 0.9.10
+ */
+void
+twitter_client_set_compression (TwitterClient *client,
+                                gboolean       compression)
+{
+  TwitterClientPrivate *priv;
+
+  g_return_if_fail (TWITTER_IS_CLIENT (client));
+
+  priv = client->priv;
+
+  compression = !!compression;
+  if (priv->compression == compression)
+    return;
+
+  priv->compression = compression;
+
+  g_object_notify (G_OBJECT (client), "compression");
+}
+
+/**
+ * twitter_client_get_compression:
+ * @client: a #TwitterClient
+ *
+ * Retrieves whether @client requests compressed responses.
+ *
+ * Return value: %TRUE if compressed responses are requested
+ *
+ * Since: 0.9.10
+ */
+gboolean
+twitter_client_get_compression (TwitterClient *client)
+{
+  g_return_val_if_fail (TWITTER_IS_CLIENT (client), FALSE);
+
+  return client->priv->compression;
+}
+
+/**
+ * twitter_client_get_endpoint_timeline:
+ * @client: a #TwitterClient
+ * @endpoint: a #TwitterEndpoint
+ *
+ * Retrieves the timeline holding the statuses received by @client
+ * from @endpoint, newest first, including the statuses loaded by
+ * twitter_client_restore_state(). Only the latest 200 statuses
+ * are kept.
+ *
+ * The timeline is updated each time a response from @endpoint is
+ * received, before the signals of @client are emitted. Only the
+ * responses for the authenticated user are added: the timelines
+ * requested for another user, or for a page other than the first,
+ * are not.
+ *
+ * Return value: (transfer none): a #TwitterTimeline, owned by @client
+ *
+ * Since: 0.9.10
+ */
+TwitterTimeline *
+twitter_client_get_endpoint_timeline (TwitterClient   *client,
+                                      TwitterEndpoint  endpoint)
+{
+  g_return_val_if_fail (TWITTER_IS_CLIENT (client), NULL);
+  g_return_val_if_fail (endpoint < N_ENDPOINTS, NULL);
+
+  return twitter_client_ensure_endpoint (client, endpoint);
+}
+
+/**
+ * twitter_client_get_last_status_id:
+ * @client: a #TwitterClient
+ * @endpoint: a #TwitterEndpoint
+ *
+ * Retrieves the id of the newest status received by @client from
+ * @endpoint, which can be used to request only the statuses posted
+ * afterwards, for instance with twitter_client_get_public_timeline()
  *
- * The #TwitterClient::user-received signal will be emitted
- * for each followed user.
+ * Return value: the id of the newest status, or 0
  *
- * Return value: the handle of the request, or 0
+ * Since: 0.9.10
  */
-gulong
-twitter_client_get_friends (TwitterClient *client,
-                            const gchar   *user,
-                            gint           page,
-                            gboolean       omit_status)
+guint
+twitter_client_get_last_status_id (TwitterClient   *client,
+                                   TwitterEndpoint  endpoint)
 {
-  GetUserListClosure *clos;
-  SoupMessage *msg;
+  TwitterTimeline *timeline;
 
   g_return_val_if_fail (TWITTER_IS_CLIENT (client), 0);
+  g_return_val_if_fail (endpoint < N_ENDPOINTS, 0);
 
-  msg = twitter_api_friends (client->priv->base_url, user, page, omit_status);
+  timeline = client->priv->endpoints[endpoint];
+  if (timeline == NULL || twitter_timeline_get_count (timeline) == 0)
+    return 0;
 
-  clos = g_new0 (GetUserListClosure, 1);
-  closure_set_action (clos, FRIENDS);
-  closure_set_client (clos, g_object_ref (client));
-  closure_set_requires_auth (clos, TRUE);
-  closure_set_handle (clos, client->priv->last_handle_id);
-  clos->user_list = twitter_user_list_new ();
+  return twitter_status_get_id (twitter_timeline_get_pos (timeline, 0));
+}
 
-  return twitter_client_queue_message (client, msg, TRUE,
-                                       get_user_list_cb,
-                                       clos);
+static gchar *
+endpoint_group (GEnumClass      *enum_class,
+                TwitterEndpoint  endpoint)
+{
+  GEnumValue *enum_value = g_enum_get_value (enum_class, endpoint);
+
+  return g_strconcat ("Endpoint ", enum_value->value_nick, NULL);
 }
 
-/**
- * twitter_client_get_followers:
- * @client: a #TwitterClient
- * @page: the page number of the followers list
- * @omit_status: %TRUE if the #TwitterUser should not have
- *   the last status associated to them
- *
- * Requests the provider used by @client for a (paged) list
- * of the people following the #TwitterClient authenticated
- * user.
- *
- * The #TwitterClient::user-received signal will be emitted
- * for each follower.
- *
- * Return value: the handle of the request, or 0
+static gint64
+state_get_now (void)
+{
+  GTimeVal now;
+
+  g_get_current_time (&now);
+
+  return now.tv_sec;
+}
+
+/* the times are stored as strings, since GKeyFile has no 64 bit
+ * integers before GLib 2.26
  */
-gulong
-twitter_client_get_followers (TwitterClient *client,
-                              gint           page,
-                              gboolean       omit_status)
+static void
+state_set_time (GKeyFile    *key_file,
+                const gchar *key,
+                gint64       value)
 {
-  GetUserListClosure *clos;
-  SoupMessage *msg;
+  gchar buf[32];
 
-  g_return_val_if_fail (TWITTER_IS_CLIENT (client), 0);
+  g_snprintf (buf, sizeof (buf), "%" G_GINT64_FORMAT, value);
+  g_key_file_set_string (key_file, STATE_GROUP, key, buf);
+}
 
-  msg = twitter_api_followers (client->priv->base_url, page, omit_status);
+static gint64
+state_get_time (GKeyFile    *key_file,
+                const gchar *key)
+{
+  gchar *value;
+  gint64 retval;
 
-  clos = g_new0 (GetUserListClosure, 1);
-  closure_set_action (clos, FOLLOWERS);
-  closure_set_client (clos, g_object_ref (client));
-  closure_set_requires_auth (clos, TRUE);
-  closure_set_handle (clos, client->priv->last_handle_id);
-  clos->user_list = twitter_user_list_new ();
+  value = g_key_file_get_string (key_file, STATE_GROUP, key, NULL);
+  if (value == NULL)
+    return 0;
 
-  return twitter_client_queue_message (client, msg, TRUE,
-                                       get_user_list_cb,
-                                       clos);
+  retval = g_ascii_strtoll (value, NULL, 10);
+  g_free (value);
+
+  return retval;
+}
+
+/* whether the rate limit counters saved in @key_file still apply */
+static gboolean
+state_rate_limit_is_valid (GKeyFile *key_file)
+{
+  gint64 now, saved, reset;
+
+  now = state_get_now ();
+
+  reset = state_get_time (key_file, "RateLimitReset");
+  if (reset > 0)
+    return reset > now;
+
+  saved = state_get_time (key_file, "RateLimitTime");
+  if (saved <= 0 || saved > now)
+    return FALSE;
+
+  return now - saved < RATE_LIMIT_WINDOW;
 }
 
 /**
- * twitter_client_show_user_from_email:
+ * twitter_client_save_state:
  * @client: a #TwitterClient
- * @email: E-mail address of the user
+ * @filename: the file to save the state into
+ * @error: return location for a #GError, or %NULL
  *
- * Requests the provider used by @client to "show" the user
- * matching the @email string.
+ * Saves the state of @client into @filename: the rate limitation,
+ * whether the user was authenticated, and the statuses received
+ * from each #TwitterEndpoint. The state can be loaded back using
+ * twitter_client_restore_state(), so that an application can
+ * display the timelines and request only the newer statuses right
+ * after starting.
  *
- * The #TwitterClient::user-received signal will be emitted
- * with the requested #TwitterUser
+ * The password of the user is not saved.
  *
- * Return value: the handle of the request, or 0
+ * Return value: %TRUE if the state was saved
  *
- * Deprecated: 0.9.10: Use twitter_client_show_user_from_id() instead
+ * Since: 0.9.10
  */
-gulong
-twitter_client_show_user_from_email (TwitterClient *client,
-                                     const gchar   *email)
+gboolean
+twitter_client_save_state (TwitterClient  *client,
+                           const gchar    *filename,
+                           GError        **error)
 {
-  GetUserClosure *clos;
-  SoupMessage *msg;
+  TwitterClientPrivate *priv;
+  GEnumClass *enum_class;
+  GKeyFile *key_file;
+  gchar *data;
+  gsize length;
+  gboolean retval;
+  guint i;
 
-  g_return_val_if_fail (TWITTER_IS_CLIENT (client), 0);
-  g_return_val_if_fail (email != NULL, 0);
+  g_return_val_if_fail (TWITTER_IS_CLIENT (client), FALSE);
+  g_return_val_if_fail (filename != NULL, FALSE);
 
-  msg = twitter_api_user_show (client->priv->base_url, email);
+  priv = client->priv;
 
-  clos = g_new0 (GetUserClosure, 1);
-  closure_set_action (clos, USER_SHOW);
-  closure_set_client (clos, g_object_ref (client));
-  closure_set_requires_auth (clos, TRUE);
-  closure_set_handle (clos, client->priv->last_handle_id);
-  clos->user = twitter_user_new ();
+  key_file = g_key_file_new ();
 
-  return twitter_client_queue_message (client, msg, TRUE,
-                                       get_user_cb,
-                                       clos);
+  g_key_file_set_integer (key_file, STATE_GROUP, "Version", STATE_VERSION);
+  g_key_file_set_string (key_file, STATE_GROUP, "BaseURL", priv->base_url);
+
+  if (priv->email != NULL)
+    {
+      g_key_file_set_string (key_file, STATE_GROUP, "Email", priv->email);
+      g_key_file_set_boolean (key_file, STATE_GROUP, "Authenticated",
+                              priv->auth_complete);
+    }
+
+  /* the counters are only valid until the provider resets them */
+  g_key_file_set_integer (key_file, STATE_GROUP, "RateLimit",
+                          priv->rate_limit);
+  g_key_file_set_integer (key_file, STATE_GROUP, "RateLimitRemaining",
+                          priv->rate_limit_remaining);
+  state_set_time (key_file, "RateLimitTime", state_get_now ());
+
+  if (priv->rate_limit_reset > 0)
+    state_set_time (key_file, "RateLimitReset", priv->rate_limit_reset);
+
+  /* the timelines use the binary format, which is faster to load */
+  enum_class = g_type_class_ref (TWITTER_TYPE_ENDPOINT);
+
+  for (i = 0; i < N_ENDPOINTS; i++)
+    {
+      gchar *group, *binary, *encoded;
+      gsize binary_len;
+
+      if (priv->endpoints[i] == NULL ||
+          twitter_timeline_get_count (priv->endpoints[i]) == 0)
+        continue;
+
+      binary = twitter_timeline_to_binary (priv->endpoints[i], &binary_len);
+      encoded = g_base64_encode ((const guchar *) binary, binary_len);
+
+      group = endpoint_group (enum_class, i);
+      g_key_file_set_string (key_file, group, "Timeline", encoded);
+
+      g_free (group);
+      g_free (encoded);
+      g_free (binary);
+    }
+
+  g_type_class_unref (enum_class);
+
+  data = g_key_file_to_data (key_file, &length, NULL);
+  retval = g_file_set_contents (filename, data, length, error);
+
+  g_free (data);
+  g_key_file_free (key_file);
+
+  return retval;
 }
 
 /**
- * twitter_client_show_user_from_id:
+ * twitter_client_restore_state:
  * @client: a #TwitterClient
- * @id_or_screen_name: user ID or screen name
+ * @filename: the file saved by twitter_client_save_state()
+ * @error: return location for a #GError, or %NULL
  *
- * Requests the provider used by @client to "show" the user
- * matching the @user string.
+ * Restores the state of @client saved by twitter_client_save_state().
+ * The statuses of each #TwitterEndpoint are added to the timelines
+ * returned by twitter_client_get_endpoint_timeline().
  *
- * The @user string is either the user id as returned by
- * twitter_user_get_id(), or the screen name as returned
- * by twitter_user_get_screen_name().
+ * The state must have been saved by a client using the same provider;
+ * the authentication state is restored only if the user of @client
+ * is the same. The rate limitation is not restored if the provider
+ * reset it since the state was saved.
  *
- * The #TwitterClient::user-received signal will be emitted
- * with the requested #TwitterUser
+ * If any part of the state cannot be read, @client is left unchanged.
  *
- * Return value: the handle of the request, or 0
+ * Return value: %TRUE if the state was restored
+ *
+ * Since: 0.9.10
  */
-gulong
-twitter_client_show_user_from_id (TwitterClient *client,
-                                  const gchar   *id_or_screen_name)
+gboolean
+twitter_client_restore_state (TwitterClient  *client,
+                              const gchar    *filename,
+                              GError        **error)
 {
-  GetUserClosure *clos;
-  SoupMessage *msg;
+  TwitterClientPrivate *priv;
+  TwitterTimeline *pages[N_ENDPOINTS] = { NULL, };
+  GEnumClass *enum_class;
+  GKeyFile *key_file;
+  gchar *base_url, *email;
+  gint rate_limit = -1, rate_limit_remaining = -1;
+  gboolean has_rate_limit = FALSE;
+  gboolean retval = FALSE;
+  gint version;
+  guint i;
 
-  g_return_val_if_fail (TWITTER_IS_CLIENT (client), 0);
-  g_return_val_if_fail (id_or_screen_name != NULL, 0);
+  g_return_val_if_fail (TWITTER_IS_CLIENT (client), FALSE);
+  g_return_val_if_fail (filename != NULL, FALSE);
 
-  msg = twitter_api_user_show (client->priv->base_url, id_or_screen_name);
+  priv = client->priv;
 
-  clos = g_new0 (GetUserClosure, 1);
-  closure_set_action (clos, USER_SHOW);
-  closure_set_client (clos, g_object_ref (client));
-  closure_set_requires_auth (clos, FALSE);
-  closure_set_handle (clos, client->priv->last_handle_id);
-  clos->user = twitter_user_new ();
+  key_file = g_key_file_new ();
+  if (!g_key_file_load_from_file (key_file, filename, G_KEY_FILE_NONE, error))
+    {
+      g_key_file_free (key_file);
+      return FALSE;
+    }
 
-  return twitter_client_queue_message (client, msg, TRUE,
-                                       get_user_cb,
-                                       clos);
+  version = g_key_file_get_integer (key_file, STATE_GROUP, "Version", NULL);
+  if (version < 1 || version > STATE_VERSION)
+    {
+      g_set_error (error, TWITTER_ERROR,
+                   TWITTER_ERROR_PARSE_ERROR,
+                   "Unsupported version of the state in '%s'",
+                   filename);
+      g_key_file_free (key_file);
+      return FALSE;
+    }
+
+  base_url = g_key_file_get_string (key_file, STATE_GROUP, "BaseURL", NULL);
+  if (g_strcmp0 (base_url, priv->base_url) != 0)
+    {
+      g_set_error (error, TWITTER_ERROR,
+                   TWITTER_ERROR_FAILED,
+                   "The state in '%s' belongs to a different provider",
+                   filename);
+      g_free (base_url);
+      g_key_file_free (key_file);
+      return FALSE;
+    }
+
+  g_free (base_url);
+
+  /* everything is read and validated before changing the client, so
+   * that a broken state does not leave it half restored
+   */
+  if (state_rate_limit_is_valid (key_file))
+    {
+      GError *key_error = NULL;
+
+      if (g_key_file_has_key (key_file, STATE_GROUP, "RateLimit", NULL))
+        {
+          rate_limit = g_key_file_get_integer (key_file, STATE_GROUP,
+                                               "RateLimit",
+                                               &key_error);
+          has_rate_limit = TRUE;
+        }
+
+      if (key_error == NULL &&
+          g_key_file_has_key (key_file, STATE_GROUP, "RateLimitRemaining", NULL))
+        {
+          rate_limit_remaining = g_key_file_get_integer (key_file, STATE_GROUP,
+                                                         "RateLimitRemaining",
+                                                         &key_error);
+          has_rate_limit = TRUE;
+        }
+
+      if (key_error != NULL)
+        {
+          g_set_error (error, TWITTER_ERROR,
+                       TWITTER_ERROR_PARSE_ERROR,
+                       "Invalid rate limitation in '%s': %s",
+                       filename,
+                       key_error->message);
+          g_error_free (key_error);
+          g_key_file_free (key_file);
+          return FALSE;
+        }
+    }
+
+  enum_class = g_type_class_ref (TWITTER_TYPE_ENDPOINT);
+
+  for (retval = TRUE, i = 0; i < N_ENDPOINTS && retval; i++)
+    {
+      gchar *group, *encoded;
+      guchar *binary;
+      gsize binary_len;
+
+      group = endpoint_group (enum_class, i);
+      encoded = g_key_file_get_string (key_file, group, "Timeline", NULL);
+      g_free (group);
+
+      if (encoded == NULL || *encoded == '\0')
+        {
+          g_free (encoded);
+          continue;
+        }
+
+      binary = g_base64_decode (encoded, &binary_len);
+
+      pages[i] = twitter_timeline_new ();
+      retval = twitter_timeline_load_from_binary (pages[i],
+                                                  (const gchar *) binary,
+                                                  binary_len,
+                                                  error);
+
+      g_free (binary);
+      g_free (encoded);
+    }
+
+  g_type_class_unref (enum_class);
+
+  if (retval)
+    {
+      email = g_key_file_get_string (key_file, STATE_GROUP, "Email", NULL);
+      if (email != NULL && g_strcmp0 (email, priv->email) == 0)
+        priv->auth_complete = g_key_file_get_boolean (key_file, STATE_GROUP,
+                                                      "Authenticated",
+                                                      NULL);
+
+      g_free (email);
+
+      if (has_rate_limit)
+        {
+          g_object_freeze_notify (G_OBJECT (client));
+
+          priv->rate_limit = rate_limit;
+          g_object_notify (G_OBJECT (client), "max-requests");
+
+          priv->rate_limit_remaining = rate_limit_remaining;
+          g_object_notify (G_OBJECT (client), "remaining-requests");
+
+          priv->rate_limit_reset = state_get_time (key_file, "RateLimitReset");
+
+          g_object_thaw_notify (G_OBJECT (client));
+        }
+
+      for (i = 0; i < N_ENDPOINTS; i++)
+        {
+          if (pages[i] != NULL)
+            twitter_timeline_merge (twitter_client_ensure_endpoint (client, i),
+                                    pages[i]);
+        }
+    }
+
+  for (i = 0; i < N_ENDPOINTS; i++)
+    {
+      if (pages[i] != NULL)
+        g_object_unref (pages[i]);
+    }
+
+  g_key_file_free (key_file);
+
+  return retval;
 }
 
-/**
- * twitter_client_get_provider:
- * @client: a #TwitterClient
- *
- * Retrieves the type of provider used by @client
- *
- * Return value: the provider logical id
- */
-TwitterProvider
-twitter_client_get_provider (TwitterClient *client)
+void
+_twitter_client_set_pool (TwitterClient     *client,
+                          TwitterClientPool *pool)
 {
-  g_return_val_if_fail (TWITTER_IS_CLIENT (client), TWITTER_DEFAULT_PROVIDER);
+  g_return_if_fail (TWITTER_IS_CLIENT (client));
 
-  return client->priv->provider;
+  /* the pool owns the client, so we don't keep a reference on it */
+  client->priv->pool = pool;
 }
 
 /**
- * twitter_client_get_base_url:
+ * twitter_client_set_filter:
  * @client: a #TwitterClient
+ * @filter: (allow-none): a #TwitterFilter, or %NULL
  *
- * Retrieves the base URL of the service provider used by @client
+ * Sets the filter of the statuses received by @client. Only the
+ * statuses of a timeline matching @filter will be emitted with the
+ * #TwitterClient::status-received signal, and their matches can be
+ * retrieved using twitter_filter_get_matches(). The statuses
+ * requested individually, like with twitter_client_get_status(),
+ * are always emitted.
  *
- * Return value: the base URL. The returned string is owned by
- *   the #TwitterClient and should never be modified of freed
+ * The timelines returned by twitter_client_get_endpoint_timeline()
+ * still contain every status.
+ *
+ * Since: 0.9.10
  */
-G_CONST_RETURN gchar *
-twitter_client_get_base_url (TwitterClient *client)
+void
+twitter_client_set_filter (TwitterClient *client,
+                           TwitterFilter *filter)
 {
-  g_return_val_if_fail (TWITTER_IS_CLIENT (client), NULL);
+  TwitterClientPrivate *priv;
 
-  return client->priv->base_url;
+  g_return_if_fail (TWITTER_IS_CLIENT (client));
+  g_return_if_fail (filter == NULL || TWITTER_IS_FILTER (filter));
+
+  priv = client->priv;
+
+  if (priv->filter == filter)
+    return;
+
+  if (priv->filter != NULL)
+    g_object_unref (priv->filter);
+
+  priv->filter = filter != NULL ? g_object_ref (filter) : NULL;
+
+  g_object_notify (G_OBJECT (client), "filter");
 }
 
 /**
- * twitter_client_get_rate_limit:
+ * twitter_client_get_filter:
  * @client: a #TwitterClient
- * @limit: (out): return location for the current cap on requests
- * @remaining: (out): return location for the current remaining requests
  *
- * Retrieves the current state of the rate limitation that Twitter
- * uses to avoid excessive load.
+ * Retrieves the filter set using twitter_client_set_filter()
  *
- * If you want to monitor the rate limitation you should monitor
- * notifications on the #TwitterClient:remaining-requests and
- * #TwitterClient:max-requests.
+ * Return value: (transfer none): a #TwitterFilter, or %NULL
  *
  * Since: 0.9.10
  */
-void
-twitter_client_get_rate_limit (TwitterClient *client,
-                               gint          *limit,
-                               gint          *remaining)
+TwitterFilter *
+twitter_client_get_filter (TwitterClient *client)
 {
-  g_return_if_fail (TWITTER_IS_CLIENT (client));
-
-  if (limit)
-    *limit = client->priv->rate_limit;
+  g_return_val_if_fail (TWITTER_IS_CLIENT (client), NULL);
 
-  if (remaining)
-    *remaining = client->priv->rate_limit_remaining;
+  return client->priv->filter;
 }
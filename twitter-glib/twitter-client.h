@@ -20,9 +20,13 @@
 #define __TWITTER_CLIENT_H__
 
 #include <glib-object.h>
+#include <gio/gio.h>
 
+#include <twitter-glib/twitter-filter.h>
 #include <twitter-glib/twitter-status.h>
+#include <twitter-glib/twitter-timeline.h>
 #include <twitter-glib/twitter-user.h>
+#include <twitter-glib/twitter-user-list.h>
 
 G_BEGIN_DECLS
 
@@ -79,6 +83,28 @@ typedef enum { /*< prefix=TWITTER >*/
   TWITTER_IDENTI_CA
 } TwitterProvider;
 
+/**
+ * TwitterEndpoint:
+ * @TWITTER_ENDPOINT_PUBLIC_TIMELINE: The public timeline
+ * @TWITTER_ENDPOINT_FRIENDS_TIMELINE: The timeline of the friends
+ * @TWITTER_ENDPOINT_USER_TIMELINE: The timeline of a user
+ * @TWITTER_ENDPOINT_REPLIES: The replies to the user
+ * @TWITTER_ENDPOINT_FAVORITES: The favorite statuses of a user
+ * @TWITTER_ENDPOINT_ARCHIVE: The archive of the user
+ *
+ * The endpoints of the provider returning timelines.
+ *
+ * Since: 0.9.10
+ */
+typedef enum {
+  TWITTER_ENDPOINT_PUBLIC_TIMELINE,
+  TWITTER_ENDPOINT_FRIENDS_TIMELINE,
+  TWITTER_ENDPOINT_USER_TIMELINE,
+  TWITTER_ENDPOINT_REPLIES,
+  TWITTER_ENDPOINT_FAVORITES,
+  TWITTER_ENDPOINT_ARCHIVE
+} TwitterEndpoint;
+
 /**
  * TwitterClient:
  *
@@ -221,10 +247,104 @@ gulong                twitter_client_add_favorite         (TwitterClient   *clie
 gulong                twitter_client_remove_favorite      (TwitterClient   *client,
                                                            guint            status_id);
 
+void                  twitter_client_get_public_timeline_async  (TwitterClient        *client,
+                                                                 guint                 since_id,
+                                                                 GCancellable         *cancellable,
+                                                                 GAsyncReadyCallback   callback,
+                                                                 gpointer              user_data);
+void                  twitter_client_get_friends_timeline_async (TwitterClient        *client,
+                                                                 const gchar          *friend_,
+                                                                 gint64                since_date,
+                                                                 GCancellable         *cancellable,
+                                                                 GAsyncReadyCallback   callback,
+                                                                 gpointer              user_data);
+void                  twitter_client_get_user_timeline_async    (TwitterClient        *client,
+                                                                 const gchar          *user,
+                                                                 guint                 count,
+                                                                 gint64                since_date,
+                                                                 GCancellable         *cancellable,
+                                                                 GAsyncReadyCallback   callback,
+                                                                 gpointer              user_data);
+void                  twitter_client_get_replies_async          (TwitterClient        *client,
+                                                                 GCancellable         *cancellable,
+                                                                 GAsyncReadyCallback   callback,
+                                                                 gpointer              user_data);
+void                  twitter_client_get_favorites_async        (TwitterClient        *client,
+                                                                 const gchar          *user,
+                                                                 gint                  page,
+                                                                 GCancellable         *cancellable,
+                                                                 GAsyncReadyCallback   callback,
+                                                                 gpointer              user_data);
+void                  twitter_client_get_archive_async          (TwitterClient        *client,
+                                                                 gint                  page,
+                                                                 GCancellable         *cancellable,
+                                                                 GAsyncReadyCallback   callback,
+                                                                 gpointer              user_data);
+TwitterTimeline *     twitter_client_get_timeline_finish        (TwitterClient        *client,
+                                                                 GAsyncResult         *result,
+                                                                 GError              **error);
+
+void                  twitter_client_get_friends_async          (TwitterClient        *client,
+                                                                 const gchar          *user,
+                                                                 gint                  page,
+                                                                 gboolean              omit_status,
+                                                                 GCancellable         *cancellable,
+                                                                 GAsyncReadyCallback   callback,
+                                                                 gpointer              user_data);
+void                  twitter_client_get_followers_async        (TwitterClient        *client,
+                                                                 gint                  page,
+                                                                 gboolean              omit_status,
+                                                                 GCancellable         *cancellable,
+                                                                 GAsyncReadyCallback   callback,
+                                                                 gpointer              user_data);
+TwitterUserList *     twitter_client_get_user_list_finish       (TwitterClient        *client,
+                                                                 GAsyncResult         *result,
+                                                                 GError              **error);
+
+void                  twitter_client_get_status_async           (TwitterClient        *client,
+                                                                 guint                 status_id,
+                                                                 GCancellable         *cancellable,
+                                                                 GAsyncReadyCallback   callback,
+                                                                 gpointer              user_data);
+TwitterStatus *       twitter_client_get_status_finish          (TwitterClient        *client,
+                                                                 GAsyncResult         *result,
+                                                                 GError              **error);
+
+void                  twitter_client_show_user_from_id_async    (TwitterClient        *client,
+                                                                 const gchar          *id_or_screen_name,
+                                                                 GCancellable         *cancellable,
+                                                                 GAsyncReadyCallback   callback,
+                                                                 gpointer              user_data);
+TwitterUser *         twitter_client_show_user_from_id_finish   (TwitterClient        *client,
+                                                                 GAsyncResult         *result,
+                                                                 GError              **error);
+
 void                  twitter_client_get_rate_limit       (TwitterClient   *client,
                                                            gint            *limit,
                                                            gint            *remaining);
 
+void                  twitter_client_set_compression      (TwitterClient   *client,
+                                                           gboolean         compression);
+gboolean              twitter_client_get_compression      (TwitterClient   *client);
+void                  twitter_client_get_transfer_stats   (TwitterClient   *client,
+                                                           guint64         *wire_bytes,
+                                                           guint64         *decoded_bytes);
+
+TwitterTimeline *     twitter_client_get_endpoint_timeline (TwitterClient   *client,
+                                                            TwitterEndpoint  endpoint);
+guint                 twitter_client_get_last_status_id   (TwitterClient   *client,
+                                                           TwitterEndpoint  endpoint);
+gboolean              twitter_client_save_state           (TwitterClient   *client,
+                                                           const gchar     *filename,
+                                                           GError         **error);
+gboolean              twitter_client_restore_state        (TwitterClient   *client,
+                                                           const gchar     *filename,
+                                                           GError         **error);
+
+void                  twitter_client_set_filter           (TwitterClient   *client,
+                                                           TwitterFilter   *filter);
+TwitterFilter *       twitter_client_get_filter           (TwitterClient   *client);
+
 G_END_DECLS
 
 #endif /* __TWITTER_CLIENT_H__ */
@@ -38,6 +38,8 @@
 #include <libsoup/soup.h>
 
 #include "twitter-common.h"
+#include "twitter-intern-pool.h"
+#include "twitter-private.h"
 
 /**
  * twitter_error_from_status:
@@ -85,6 +87,85 @@ twitter_error_quark (void)
   return g_quark_from_static_string ("twitter-error-quark");
 }
 
+static volatile gint parse_flags = TWITTER_PARSE_DEFAULT;
+
+/**
+ * twitter_set_parse_flags:
+ * @flags: a bitmask of #TwitterParseFlags
+ *
+ * Sets the flags controlling how the JSON data coming from the
+ * provider is parsed by every #TwitterStatus, #TwitterUser,
+ * #TwitterTimeline and #TwitterUserList.
+ *
+ * By default, Twitter-GLib uses a built-in decoder that reads the
+ * data in a single pass, and falls back to json-glib if the decoder
+ * fails. Setting %TWITTER_PARSE_USE_JSON_GLIB will make Twitter-GLib
+ * always use json-glib.
+ *
+ * Setting %TWITTER_PARSE_LAZY will make the built-in decoder skip
+ * the strings that are rarely used, like the source of a #TwitterStatus
+ * or the description of a #TwitterUser, and decode them only when
+ * their accessor is called. Objects decoded lazily should not be
+ * accessed from more than one thread at the same time.
+ *
+ * The built-in decoder scans strings using the vector instructions
+ * supported by the CPU, which are detected at run time; the
+ * %TWITTER_PARSE_NO_AVX2 and %TWITTER_PARSE_NO_SIMD flags restrict
+ * the instructions being used, which is mostly useful to compare
+ * the results.
+ *
+ * This function can be called from any thread.
+ *
+ * Since: 0.9.10
+ */
+void
+twitter_set_parse_flags (TwitterParseFlags flags)
+{
+  g_atomic_int_set (&parse_flags, flags);
+}
+
+/**
+ * twitter_get_parse_flags:
+ *
+ * Retrieves the flags set using twitter_set_parse_flags()
+ *
+ * Return value: a bitmask of #TwitterParseFlags
+ *
+ * Since: 0.9.10
+ */
+TwitterParseFlags
+twitter_get_parse_flags (void)
+{
+  return g_atomic_int_get (&parse_flags);
+}
+
+/**
+ * twitter_get_string_pool_stats:
+ * @n_strings: (out): return location for the number of distinct
+ *   strings in the pool, or %NULL
+ * @n_references: (out): return location for the number of fields
+ *   pointing to a string of the pool, or %NULL
+ * @bytes_saved: (out): return location for the amount of memory
+ *   saved by sharing the strings, in bytes, or %NULL
+ *
+ * Retrieves statistics about the pool of strings shared between
+ * statuses and users. Fields with few distinct values, like the
+ * source of a #TwitterStatus or the location, time zone and profile
+ * image URL of a #TwitterUser, hold a reference on a single copy of
+ * each value instead of their own copy.
+ *
+ * This function can be called from any thread.
+ *
+ * Since: 0.9.10
+ */
+void
+twitter_get_string_pool_stats (guint *n_strings,
+                               guint *n_references,
+                               gsize *bytes_saved)
+{
+  _twitter_intern_pool_get_stats (n_strings, n_references, bytes_saved);
+}
+
 /**
  * twitter_http_date_from_time_t:
  * @time_: timestamp, expressed in seconds from the epoch
@@ -175,6 +256,162 @@ twitter_http_date_to_delta (const gchar *date)
   return (now - res);
 }
 
+/* the number of days between the epoch and the given date of the
+ * proleptic Gregorian calendar; @month is in the [1, 12] range
+ */
+static gint64
+days_from_civil (gint year,
+                 gint month,
+                 gint day)
+{
+  gint era, year_of_era, day_of_year, day_of_era;
+
+  year -= month <= 2;
+  era = (year >= 0 ? year : year - 399) / 400;
+  year_of_era = year - era * 400;
+  day_of_year = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+  day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+
+  return (gint64) era * 146097 + day_of_era - 719468;
+}
+
+static inline gboolean
+read_digits (const gchar **p,
+             const gchar  *end,
+             guint         n_digits,
+             gint         *value)
+{
+  const gchar *cursor = *p;
+  gint res = 0;
+
+  if ((gsize) (end - cursor) < n_digits)
+    return FALSE;
+
+  while (n_digits--)
+    {
+      if (!g_ascii_isdigit (*cursor))
+        return FALSE;
+
+      res = res * 10 + (*cursor++ - '0');
+    }
+
+  *p = cursor;
+  *value = res;
+
+  return TRUE;
+}
+
+/*
+ * _twitter_date_parse:
+ * @date: a timestamp coming from Twitter
+ * @len: the length of @date, or -1 if it is nul-terminated
+ * @timestamp: return location for the seconds from the epoch
+ *
+ * Parses the "%a %b %d %T %z %Y" format used by Twitter, without
+ * going through the locale dependent strptime().
+ *
+ * Return value: %TRUE if @date was in the expected format
+ */
+gboolean
+_twitter_date_parse (const gchar *date,
+                     gssize       len,
+                     gint64      *timestamp)
+{
+  static const gchar months[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+  const gchar *p = date, *end;
+  gint month, day, hour, minute, second, offset, year;
+  gint sign;
+
+  if (len < 0)
+    len = strlen (date);
+
+  end = date + len;
+
+  /* "Sat May 09 10:08:10 +0000 2009" */
+  if (len < 30)
+    return FALSE;
+
+  /* the day of the week is implied by the date */
+  if (!g_ascii_isalpha (p[0]) || !g_ascii_isalpha (p[1]) ||
+      !g_ascii_isalpha (p[2]) || p[3] != ' ')
+    return FALSE;
+
+  p += 4;
+
+  for (month = 0; month < 12; month++)
+    {
+      if (memcmp (p, months + month * 3, 3) == 0)
+        break;
+    }
+
+  if (month == 12 || p[3] != ' ')
+    return FALSE;
+
+  p += 4;
+
+  if (!read_digits (&p, end, 2, &day) || *p++ != ' ')
+    return FALSE;
+
+  if (!read_digits (&p, end, 2, &hour) || *p++ != ':' ||
+      !read_digits (&p, end, 2, &minute) || *p++ != ':' ||
+      !read_digits (&p, end, 2, &second) || *p++ != ' ')
+    return FALSE;
+
+  if (*p != '+' && *p != '-')
+    return FALSE;
+
+  sign = (*p++ == '-') ? -1 : 1;
+
+  if (!read_digits (&p, end, 4, &offset) || *p++ != ' ')
+    return FALSE;
+
+  if (!read_digits (&p, end, 4, &year) || p != end)
+    return FALSE;
+
+  if (day < 1 || day > 31 || hour > 23 || minute > 59 || second > 60)
+    return FALSE;
+
+  *timestamp = days_from_civil (year, month + 1, day) * 86400
+             + hour * 3600 + minute * 60 + second
+             - sign * ((offset / 100) * 3600 + (offset % 100) * 60);
+
+  return TRUE;
+}
+
+/*
+ * _twitter_date_to_timestamp:
+ * @date: a timestamp coming from Twitter, or %NULL
+ * @len: the length of @date, or -1 if it is nul-terminated
+ *
+ * Converts @date into seconds from the epoch, falling back to
+ * twitter_date_to_time_val() for unexpected formats
+ *
+ * Return value: the seconds from the epoch, or 0 on failure
+ */
+gint64
+_twitter_date_to_timestamp (const gchar *date,
+                            gssize       len)
+{
+  GTimeVal time_ = { 0, };
+  gint64 retval;
+  gchar *tmp;
+
+  if (date == NULL)
+    return 0;
+
+  if (_twitter_date_parse (date, len, &retval))
+    return retval;
+
+  tmp = len < 0 ? g_strdup (date) : g_strndup (date, len);
+
+  if (!twitter_date_to_time_val (tmp, &time_))
+    time_.tv_sec = 0;
+
+  g_free (tmp);
+
+  return time_.tv_sec;
+}
+
 #ifndef HAVE_TIMEGM
 /* used by the fake timegm() implementation */
 static const gint days_before[] = { 0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334 };
@@ -196,10 +433,19 @@ twitter_date_to_time_val (const gchar *date,
 {
   time_t res;
   SoupDate *soup_date;
+  gint64 timestamp;
 
   g_return_val_if_fail (date != NULL, FALSE);
   g_return_val_if_fail (time_ != NULL, FALSE);
 
+  if (_twitter_date_parse (date, -1, &timestamp))
+    {
+      time_->tv_sec = timestamp;
+      time_->tv_usec = 0;
+
+      return TRUE;
+    }
+
   /* XXX - this code is here in case there's a sudden onset of sanity
    * at Twitter and they switch to using any format supported by libsoup
    */
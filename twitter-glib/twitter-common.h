@@ -78,6 +78,39 @@ gint     twitter_http_date_to_delta    (const gchar *date);
 gboolean twitter_date_to_time_val      (const gchar *date,
                                         GTimeVal    *time_);
 
+/**
+ * TwitterParseFlags:
+ * @TWITTER_PARSE_DEFAULT: Use the default parser
+ * @TWITTER_PARSE_USE_JSON_GLIB: Always use json-glib to parse the
+ *   data coming from the provider, instead of the built-in decoder
+ * @TWITTER_PARSE_LAZY: Only decode the less used strings of statuses
+ *   and users the first time they are retrieved; the built-in decoder
+ *   will keep a copy of the data until every object built out of it
+ *   is finalized
+ * @TWITTER_PARSE_NO_AVX2: Do not use AVX2 instructions in the built-in
+ *   decoder, even if the CPU supports them
+ * @TWITTER_PARSE_NO_SIMD: Do not use any vector instruction in the
+ *   built-in decoder
+ *
+ * Flags controlling how the data coming from the provider is parsed
+ *
+ * Since: 0.9.10
+ */
+typedef enum { /*< prefix=TWITTER_PARSE >*/
+  TWITTER_PARSE_DEFAULT        = 0,
+  TWITTER_PARSE_USE_JSON_GLIB  = 1 << 0,
+  TWITTER_PARSE_LAZY           = 1 << 1,
+  TWITTER_PARSE_NO_AVX2        = 1 << 2,
+  TWITTER_PARSE_NO_SIMD        = 1 << 3
+} TwitterParseFlags;
+
+void              twitter_set_parse_flags (TwitterParseFlags flags);
+TwitterParseFlags twitter_get_parse_flags (void);
+
+void              twitter_get_string_pool_stats (guint *n_strings,
+                                                 guint *n_references,
+                                                 gsize *bytes_saved);
+
 G_END_DECLS
 
 #endif /* __TWITTER_COMMON_H__ */
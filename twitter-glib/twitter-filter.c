@@ -0,0 +1,487 @@
+/* twitter-filter.c: Keyword and screen name filter
+ *
+ * This file is part of Twitter-GLib.
+ * Copyright (C) 2008  Emmanuele Bassi  <ebassi@gnome.org>
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:twitter-filter
+ * @short_description: A filter for keywords and screen names
+ *
+ * #TwitterFilter matches statuses against a set of keywords and
+ * screen names, ignoring their case. Every pattern is compiled into a
+ * single automaton, so the text of a status is scanned only once
+ * however many patterns the filter holds.
+ *
+ * Keywords match whole words: the keyword "gnome" matches "GNOME
+ * rocks" but not "gnomes". Screen names match both the mentions of
+ * the user inside the text and the statuses written by the user.
+ *
+ * A filter can be attached to a #TwitterClient using
+ * twitter_client_set_filter(), so that only the matching statuses of
+ * a timeline are emitted with the #TwitterClient::status-received
+ * signal; the matches can then be retrieved using
+ * twitter_filter_get_matches().
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include <glib.h>
+
+#include "twitter-filter.h"
+#include "twitter-pattern-set.h"
+#include "twitter-status.h"
+#include "twitter-user.h"
+
+#define TWITTER_FILTER_GET_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE ((obj), TWITTER_TYPE_FILTER, TwitterFilterPrivate))
+
+struct _TwitterFilterPrivate
+{
+  /* the keywords, and the screen names prefixed by '@' */
+  TwitterPatternSet *patterns;
+
+  /* folded screen name -> pattern id */
+  GHashTable *screen_names;
+
+  /* identifies the matches of the filter among the ones attached to
+   * a status; unlike the address of the filter, it is never reused
+   */
+  guint serial;
+};
+
+typedef struct {
+  const gchar *text;
+
+  GArray *matches;
+} MatchClosure;
+
+/* the matches of one filter on a status */
+typedef struct {
+  guint serial;
+
+  GArray *matches;
+} FilterMatches;
+
+G_DEFINE_TYPE (TwitterFilter, twitter_filter, G_TYPE_OBJECT);
+
+static volatile gint filter_serial = 0;
+
+/* the matches of every filter are attached to a status under a single
+ * quark, as an array of FilterMatches
+ */
+static GQuark matches_quark = 0;
+G_LOCK_DEFINE_STATIC (filter_matches);
+
+static void
+status_matches_free (gpointer data)
+{
+  GArray *table = data;
+  guint i;
+
+  for (i = 0; i < table->len; i++)
+    g_array_free (g_array_index (table, FilterMatches, i).matches, TRUE);
+
+  g_array_free (table, TRUE);
+}
+
+static FilterMatches *
+status_matches_lookup (GArray *table,
+                       guint   serial)
+{
+  guint i;
+
+  if (table == NULL)
+    return NULL;
+
+  for (i = 0; i < table->len; i++)
+    {
+      FilterMatches *entry = &g_array_index (table, FilterMatches, i);
+
+      if (entry->serial == serial)
+        return entry;
+    }
+
+  return NULL;
+}
+
+/* replaces the matches of @filter on @status; %NULL removes them */
+static void
+twitter_filter_set_matches (TwitterFilter *filter,
+                            TwitterStatus *status,
+                            GArray        *matches)
+{
+  guint serial = filter->priv->serial;
+  FilterMatches *entry;
+  GArray *table;
+
+  G_LOCK (filter_matches);
+
+  table = g_object_get_qdata (G_OBJECT (status), matches_quark);
+
+  entry = status_matches_lookup (table, serial);
+  if (entry != NULL)
+    {
+      g_array_free (entry->matches, TRUE);
+
+      if (matches != NULL)
+        entry->matches = matches;
+      else
+        g_array_remove_index_fast (table, entry - (FilterMatches *) table->data);
+    }
+  else if (matches != NULL)
+    {
+      FilterMatches new_entry;
+
+      if (table == NULL)
+        {
+          table = g_array_sized_new (FALSE, FALSE, sizeof (FilterMatches), 1);
+          g_object_set_qdata_full (G_OBJECT (status), matches_quark,
+                                   table,
+                                   status_matches_free);
+        }
+
+      new_entry.serial = serial;
+      new_entry.matches = matches;
+      g_array_append_val (table, new_entry);
+    }
+
+  G_UNLOCK (filter_matches);
+}
+
+static void
+twitter_filter_finalize (GObject *gobject)
+{
+  TwitterFilterPrivate *priv = TWITTER_FILTER (gobject)->priv;
+
+  _twitter_pattern_set_free (priv->patterns);
+  g_hash_table_destroy (priv->screen_names);
+
+  G_OBJECT_CLASS (twitter_filter_parent_class)->finalize (gobject);
+}
+
+static void
+twitter_filter_class_init (TwitterFilterClass *klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  g_type_class_add_private (klass, sizeof (TwitterFilterPrivate));
+
+  gobject_class->finalize = twitter_filter_finalize;
+
+  matches_quark = g_quark_from_static_string ("twitter-filter-matches");
+}
+
+static void
+twitter_filter_init (TwitterFilter *filter)
+{
+  TwitterFilterPrivate *priv;
+
+  filter->priv = priv = TWITTER_FILTER_GET_PRIVATE (filter);
+
+  priv->patterns = _twitter_pattern_set_new ();
+  priv->screen_names = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                              g_free,
+                                              NULL);
+
+  priv->serial = g_atomic_int_exchange_and_add (&filter_serial, 1);
+}
+
+/**
+ * twitter_filter_new:
+ *
+ * Creates a new, empty #TwitterFilter
+ *
+ * Return value: the newly created #TwitterFilter. Use
+ *   g_object_unref() to free the allocated resources
+ *
+ * Since: 0.9.10
+ */
+TwitterFilter *
+twitter_filter_new (void)
+{
+  return g_object_new (TWITTER_TYPE_FILTER, NULL);
+}
+
+/**
+ * twitter_filter_add_keyword:
+ * @filter: a #TwitterFilter
+ * @keyword: the keyword to match
+ *
+ * Adds @keyword to the patterns matched by @filter. The keyword may
+ * contain more than one word, and will only match whole words.
+ *
+ * Return value: the id of the pattern, used by #TwitterFilterMatch;
+ *   adding the same keyword twice returns the same id. If @keyword
+ *   is empty, 0 is returned
+ *
+ * Since: 0.9.10
+ */
+guint
+twitter_filter_add_keyword (TwitterFilter *filter,
+                            const gchar   *keyword)
+{
+  g_return_val_if_fail (TWITTER_IS_FILTER (filter), 0);
+  g_return_val_if_fail (keyword != NULL, 0);
+
+  return _twitter_pattern_set_add (filter->priv->patterns, keyword);
+}
+
+/**
+ * twitter_filter_add_screen_name:
+ * @filter: a #TwitterFilter
+ * @screen_name: the screen name of a user, with or without the
+ *   leading '@'
+ *
+ * Adds @screen_name to the patterns matched by @filter. The statuses
+ * mentioning the user, like "@ebassi", or written by the user will
+ * match.
+ *
+ * Return value: the id of the pattern, used by #TwitterFilterMatch.
+ *   If @screen_name is empty, 0 is returned
+ *
+ * Since: 0.9.10
+ */
+guint
+twitter_filter_add_screen_name (TwitterFilter *filter,
+                                const gchar   *screen_name)
+{
+  TwitterFilterPrivate *priv;
+  gchar *pattern;
+  guint pattern_id;
+
+  g_return_val_if_fail (TWITTER_IS_FILTER (filter), 0);
+  g_return_val_if_fail (screen_name != NULL, 0);
+
+  priv = filter->priv;
+
+  if (*screen_name == '@')
+    screen_name += 1;
+
+  if (*screen_name == '\0')
+    return 0;
+
+  pattern = g_strconcat ("@", screen_name, NULL);
+  pattern_id = _twitter_pattern_set_add (priv->patterns, pattern);
+  g_free (pattern);
+
+  if (pattern_id != 0)
+    g_hash_table_replace (priv->screen_names,
+                          g_utf8_casefold (screen_name, -1),
+                          GUINT_TO_POINTER (pattern_id));
+
+  return pattern_id;
+}
+
+/**
+ * twitter_filter_clear:
+ * @filter: a #TwitterFilter
+ *
+ * Removes every pattern from @filter. The ids returned afterwards
+ * by twitter_filter_add_keyword() and twitter_filter_add_screen_name()
+ * will start again from 1.
+ *
+ * Since: 0.9.10
+ */
+void
+twitter_filter_clear (TwitterFilter *filter)
+{
+  TwitterFilterPrivate *priv;
+
+  g_return_if_fail (TWITTER_IS_FILTER (filter));
+
+  priv = filter->priv;
+
+  _twitter_pattern_set_free (priv->patterns);
+  priv->patterns = _twitter_pattern_set_new ();
+
+  g_hash_table_remove_all (priv->screen_names);
+}
+
+/**
+ * twitter_filter_get_n_patterns:
+ * @filter: a #TwitterFilter
+ *
+ * Retrieves the number of distinct patterns inside @filter
+ *
+ * Return value: the number of patterns
+ *
+ * Since: 0.9.10
+ */
+guint
+twitter_filter_get_n_patterns (TwitterFilter *filter)
+{
+  g_return_val_if_fail (TWITTER_IS_FILTER (filter), 0);
+
+  return _twitter_pattern_set_size (filter->priv->patterns);
+}
+
+static inline gboolean
+is_word_char (gunichar c)
+{
+  return c == '_' || g_unichar_isalnum (c);
+}
+
+static void
+collect_match (guint    pattern_id,
+               gsize    start,
+               gsize    end,
+               gpointer data)
+{
+  MatchClosure *closure = data;
+  const gchar *text = closure->text;
+  TwitterFilterMatch match;
+
+  /* only whole words match */
+  if (start > 0 &&
+      is_word_char (g_utf8_get_char (g_utf8_prev_char (text + start))))
+    return;
+
+  if (text[end] != '\0' &&
+      is_word_char (g_utf8_get_char (text + end)))
+    return;
+
+  match.pattern_id = pattern_id;
+  match.offset = start;
+  match.length = end - start;
+
+  g_array_append_val (closure->matches, match);
+}
+
+/**
+ * twitter_filter_match_status:
+ * @filter: a #TwitterFilter
+ * @status: a #TwitterStatus
+ *
+ * Matches @status against the patterns of @filter. The matches are
+ * attached to @status, and can be retrieved using
+ * twitter_filter_get_matches().
+ *
+ * Return value: %TRUE if at least a pattern matched
+ *
+ * Since: 0.9.10
+ */
+gboolean
+twitter_filter_match_status (TwitterFilter *filter,
+                             TwitterStatus *status)
+{
+  TwitterFilterPrivate *priv;
+  MatchClosure closure;
+  TwitterUser *user;
+  const gchar *text;
+
+  g_return_val_if_fail (TWITTER_IS_FILTER (filter), FALSE);
+  g_return_val_if_fail (TWITTER_IS_STATUS (status), FALSE);
+
+  priv = filter->priv;
+
+  closure.matches = g_array_new (FALSE, FALSE, sizeof (TwitterFilterMatch));
+
+  user = twitter_status_get_user (status);
+  if (user != NULL &&
+      twitter_user_get_screen_name (user) != NULL &&
+      g_hash_table_size (priv->screen_names) != 0)
+    {
+      gchar *folded;
+      gpointer pattern_id;
+
+      folded = g_utf8_casefold (twitter_user_get_screen_name (user), -1);
+      pattern_id = g_hash_table_lookup (priv->screen_names, folded);
+      g_free (folded);
+
+      if (pattern_id != NULL)
+        {
+          TwitterFilterMatch match;
+
+          match.pattern_id = GPOINTER_TO_UINT (pattern_id);
+          match.offset = -1;
+          match.length = 0;
+
+          g_array_append_val (closure.matches, match);
+        }
+    }
+
+  text = twitter_status_get_text (status);
+  if (text != NULL)
+    {
+      closure.text = text;
+      _twitter_pattern_set_match (priv->patterns, text,
+                                  collect_match,
+                                  &closure);
+    }
+
+  if (closure.matches->len == 0)
+    {
+      g_array_free (closure.matches, TRUE);
+      twitter_filter_set_matches (filter, status, NULL);
+
+      return FALSE;
+    }
+
+  twitter_filter_set_matches (filter, status, closure.matches);
+
+  return TRUE;
+}
+
+/**
+ * twitter_filter_get_matches:
+ * @filter: a #TwitterFilter
+ * @status: a #TwitterStatus
+ * @n_matches: (out): return location for the number of matches
+ *
+ * Retrieves the matches found by the last call of
+ * twitter_filter_match_status() with @filter on @status; the
+ * matches of other filters on the same status are kept separately.
+ * The matches of the author come first, followed by the matches
+ * inside the text, by ascending end offset.
+ *
+ * Return value: (array length=n_matches): the matches, owned by
+ *   @status, or %NULL if @status was not matched by @filter
+ *
+ * Since: 0.9.10
+ */
+const TwitterFilterMatch *
+twitter_filter_get_matches (TwitterFilter *filter,
+                            TwitterStatus *status,
+                            guint         *n_matches)
+{
+  FilterMatches *entry;
+  GArray *matches;
+
+  g_return_val_if_fail (TWITTER_IS_FILTER (filter), NULL);
+  g_return_val_if_fail (TWITTER_IS_STATUS (status), NULL);
+  g_return_val_if_fail (n_matches != NULL, NULL);
+
+  G_LOCK (filter_matches);
+  entry = status_matches_lookup (g_object_get_qdata (G_OBJECT (status),
+                                                     matches_quark),
+                                 filter->priv->serial);
+  matches = entry != NULL ? entry->matches : NULL;
+  G_UNLOCK (filter_matches);
+
+  if (matches == NULL)
+    {
+      *n_matches = 0;
+      return NULL;
+    }
+
+  *n_matches = matches->len;
+
+  return (const TwitterFilterMatch *) matches->data;
+}
@@ -0,0 +1,102 @@
+/* twitter-filter.h: Keyword and screen name filter
+ *
+ * This file is part of Twitter-GLib.
+ * Copyright (C) 2008  Emmanuele Bassi  <ebassi@gnome.org>
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef __TWITTER_FILTER_H__
+#define __TWITTER_FILTER_H__
+
+#include <glib-object.h>
+
+#include <twitter-glib/twitter-status.h>
+
+G_BEGIN_DECLS
+
+#define TWITTER_TYPE_FILTER             (twitter_filter_get_type ())
+#define TWITTER_FILTER(obj)             (G_TYPE_CHECK_INSTANCE_CAST ((obj), TWITTER_TYPE_FILTER, TwitterFilter))
+#define TWITTER_IS_FILTER(obj)          (G_TYPE_CHECK_INSTANCE_TYPE ((obj), TWITTER_TYPE_FILTER))
+#define TWITTER_FILTER_CLASS(klass)     (G_TYPE_CHECK_CLASS_CAST ((klass), TWITTER_TYPE_FILTER, TwitterFilterClass))
+#define TWITTER_IS_FILTER_CLASS(klass)  (G_TYPE_CHECK_CLASS_TYPE ((klass), TWITTER_TYPE_FILTER))
+#define TWITTER_FILTER_GET_CLASS(obj)   (G_TYPE_INSTANCE_GET_CLASS ((obj), TWITTER_TYPE_FILTER, TwitterFilterClass))
+
+typedef struct _TwitterFilter           TwitterFilter;
+typedef struct _TwitterFilterPrivate    TwitterFilterPrivate;
+typedef struct _TwitterFilterClass      TwitterFilterClass;
+
+/**
+ * TwitterFilterMatch:
+ * @pattern_id: the id of the keyword or screen name, as returned by
+ *   twitter_filter_add_keyword() or twitter_filter_add_screen_name()
+ * @offset: the offset of the match inside the text of the status, in
+ *   bytes, or -1 if the author of the status matched
+ * @length: the length of the match, in bytes
+ *
+ * An occurrence of a pattern of a #TwitterFilter inside a status.
+ *
+ * Since: 0.9.10
+ */
+typedef struct {
+  guint pattern_id;
+
+  gint offset;
+  gint length;
+} TwitterFilterMatch;
+
+/**
+ * TwitterFilter:
+ *
+ * The #TwitterFilter struct contains private data only, and
+ * should only be accessed using the functions below.
+ */
+struct _TwitterFilter
+{
+  /*< private >*/
+  GObject parent_instance;
+
+  TwitterFilterPrivate *priv;
+};
+
+/**
+ * TwitterFilterClass:
+ *
+ * The #TwitterFilterClass struct contains only private data
+ */
+struct _TwitterFilterClass
+{
+  /*< private >*/
+  GObjectClass parent_class;
+};
+
+GType                     twitter_filter_get_type        (void) G_GNUC_CONST;
+
+TwitterFilter *           twitter_filter_new             (void);
+
+guint                     twitter_filter_add_keyword     (TwitterFilter *filter,
+                                                          const gchar   *keyword);
+guint                     twitter_filter_add_screen_name (TwitterFilter *filter,
+                                                          const gchar   *screen_name);
+void                      twitter_filter_clear           (TwitterFilter *filter);
+guint                     twitter_filter_get_n_patterns  (TwitterFilter *filter);
+
+gboolean                  twitter_filter_match_status    (TwitterFilter *filter,
+                                                          TwitterStatus *status);
+const TwitterFilterMatch *twitter_filter_get_matches     (TwitterFilter *filter,
+                                                          TwitterStatus *status,
+                                                          guint         *n_matches);
+
+G_END_DECLS
+
+#endif /* __TWITTER_FILTER_H__ */
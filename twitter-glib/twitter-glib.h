@@ -2,10 +2,17 @@
 #define __TWITTER_GLIB_H__
 
 #include <twitter-glib/twitter-client.h>
+#include <twitter-glib/twitter-client-pool.h>
 #include <twitter-glib/twitter-common.h>
 #include <twitter-glib/twitter-enum-types.h>
+#include <twitter-glib/twitter-filter.h>
 #include <twitter-glib/twitter-status.h>
+#include <twitter-glib/twitter-status-batch.h>
+#include <twitter-glib/twitter-status-index.h>
+#include <twitter-glib/twitter-store.h>
+#include <twitter-glib/twitter-thread-resolver.h>
 #include <twitter-glib/twitter-timeline.h>
+#include <twitter-glib/twitter-timeline-stats.h>
 #include <twitter-glib/twitter-user.h>
 #include <twitter-glib/twitter-version.h>
 
@@ -0,0 +1,158 @@
+/* twitter-intern-pool.c: Shared copies of repeated strings
+ *
+ * This file is part of Twitter-GLib.
+ * Copyright (C) 2008  Emmanuele Bassi  <ebassi@gnome.org>
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Some fields have very few distinct values across all the statuses
+ * and users an application sees: the source of a status is usually
+ * "web" or the link of a handful of clients, and the time zone,
+ * location and profile image of a user repeat in every status of
+ * the user. The intern pool keeps a single reference counted copy
+ * of each of those values.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include "twitter-intern-pool.h"
+
+typedef struct {
+  guint ref_count;
+  gsize len;
+
+  /* the string handed out to the callers */
+  gchar str[1];
+} InternEntry;
+
+#define INTERN_ENTRY(s) \
+  ((InternEntry *) ((s) - G_STRUCT_OFFSET (InternEntry, str)))
+
+G_LOCK_DEFINE_STATIC (intern_pool);
+static GHashTable *intern_pool = NULL;
+static guint intern_pool_n_references = 0;
+static gsize intern_pool_bytes_saved = 0;
+
+/* returns the pooled copy of the first @len bytes of @str, or of the
+ * whole string if @len is negative, acquiring a reference on it
+ */
+const gchar *
+_twitter_intern_pool_acquire (const gchar *str,
+                              gssize       len)
+{
+  gchar key_buffer[256];
+  InternEntry *entry;
+  gchar *key;
+
+  if (str == NULL)
+    return NULL;
+
+  /* the hash table needs a terminated string to look up */
+  if (len < 0)
+    {
+      key = (gchar *) str;
+      len = strlen (str);
+    }
+  else if ((gsize) len < sizeof (key_buffer))
+    {
+      key = key_buffer;
+      memcpy (key, str, len);
+      key[len] = '\0';
+    }
+  else
+    key = g_strndup (str, len);
+
+  G_LOCK (intern_pool);
+
+  if (G_UNLIKELY (intern_pool == NULL))
+    intern_pool = g_hash_table_new (g_str_hash, g_str_equal);
+
+  entry = g_hash_table_lookup (intern_pool, key);
+  if (entry != NULL)
+    {
+      entry->ref_count += 1;
+      intern_pool_bytes_saved += entry->len + 1;
+    }
+  else
+    {
+      entry = g_malloc (G_STRUCT_OFFSET (InternEntry, str) + len + 1);
+      entry->ref_count = 1;
+      entry->len = len;
+
+      memcpy (entry->str, str, len);
+      entry->str[len] = '\0';
+
+      g_hash_table_insert (intern_pool, entry->str, entry);
+    }
+
+  intern_pool_n_references += 1;
+
+  G_UNLOCK (intern_pool);
+
+  if (key != str && key != key_buffer)
+    g_free (key);
+
+  return entry->str;
+}
+
+/* releases a reference acquired with _twitter_intern_pool_acquire() */
+void
+_twitter_intern_pool_release (const gchar *str)
+{
+  InternEntry *entry;
+
+  if (str == NULL)
+    return;
+
+  entry = INTERN_ENTRY (str);
+
+  G_LOCK (intern_pool);
+
+  intern_pool_n_references -= 1;
+
+  entry->ref_count -= 1;
+  if (entry->ref_count > 0)
+    intern_pool_bytes_saved -= entry->len + 1;
+  else
+    {
+      g_hash_table_remove (intern_pool, entry->str);
+      g_free (entry);
+    }
+
+  G_UNLOCK (intern_pool);
+}
+
+void
+_twitter_intern_pool_get_stats (guint *n_strings,
+                                guint *n_references,
+                                gsize *bytes_saved)
+{
+  G_LOCK (intern_pool);
+
+  if (n_strings)
+    *n_strings = intern_pool != NULL ? g_hash_table_size (intern_pool) : 0;
+
+  if (n_references)
+    *n_references = intern_pool_n_references;
+
+  if (bytes_saved)
+    *bytes_saved = intern_pool_bytes_saved;
+
+  G_UNLOCK (intern_pool);
+}
@@ -0,0 +1,40 @@
+/* twitter-intern-pool.h: Shared copies of repeated strings
+ *
+ * This file is part of Twitter-GLib.
+ * Copyright (C) 2008  Emmanuele Bassi  <ebassi@gnome.org>
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef __TWITTER_INTERN_POOL_H__
+#define __TWITTER_INTERN_POOL_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/* strings shared by every object holding the same value; each call
+ * to _twitter_intern_pool_acquire() must be balanced by a call to
+ * _twitter_intern_pool_release(). Both are thread safe
+ */
+const gchar *_twitter_intern_pool_acquire   (const gchar *str,
+                                             gssize       len);
+void         _twitter_intern_pool_release   (const gchar *str);
+
+void         _twitter_intern_pool_get_stats (guint       *n_strings,
+                                             guint       *n_references,
+                                             gsize       *bytes_saved);
+
+G_END_DECLS
+
+#endif /* __TWITTER_INTERN_POOL_H__ */
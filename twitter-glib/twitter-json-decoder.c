@@ -0,0 +1,1067 @@
+/* twitter-json-decoder.c: Single pass JSON decoder
+ *
+ * This file is part of Twitter-GLib.
+ * Copyright (C) 2008  Emmanuele Bassi  <ebassi@gnome.org>
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* The decoder is used to build statuses and users straight from the
+ * buffer received from the provider: the callers know the schema of
+ * the objects they are decoding, so they can pull the members they
+ * are interested in and skip everything else, without building a
+ * JsonNode tree and without copying the strings more than once.
+ *
+ * The decoder is strict about the syntax, but it does not try to
+ * report where an error happened: the callers will fall back to
+ * json-glib to get a meaningful error message.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+
+/* the AVX2 scanner is compiled regardless of the compiler flags, and
+ * only used if the CPU supports it
+ */
+#ifndef TWITTER_DISABLE_SIMD
+# if defined(__SSE2__)
+#  include <emmintrin.h>
+#  define HAVE_SSE2     1
+# endif
+# if defined(HAVE_AVX2_DISPATCH)
+#  include <immintrin.h>
+#  define HAVE_AVX2     1
+# endif
+#endif
+
+#include "twitter-common.h"
+#include "twitter-intern-pool.h"
+#include "twitter-json-decoder.h"
+
+/* the maximum nesting level of objects and arrays */
+#define MAX_DEPTH       64
+
+static inline void
+decoder_fail (TwitterJsonDecoder *decoder)
+{
+  decoder->failed = TRUE;
+  decoder->cursor = decoder->end;
+}
+
+static inline void
+skip_whitespace (TwitterJsonDecoder *decoder)
+{
+  const gchar *p = decoder->cursor;
+
+  while (p < decoder->end &&
+         (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t'))
+    p++;
+
+  decoder->cursor = p;
+}
+
+static inline gboolean
+decoder_expect (TwitterJsonDecoder *decoder,
+                const gchar        *literal,
+                gsize               len)
+{
+  if ((gsize) (decoder->end - decoder->cursor) < len ||
+      memcmp (decoder->cursor, literal, len) != 0)
+    {
+      decoder_fail (decoder);
+      return FALSE;
+    }
+
+  decoder->cursor += len;
+
+  return TRUE;
+}
+
+/* returns the first byte between @p and @end that needs attention
+ * inside a string: a quote, a backslash or a control character; or
+ * @end if there is none. Most of the time is spent here, since the
+ * text of a status is far longer than everything else, so whole
+ * blocks are checked at once when the CPU allows it; the variant in
+ * use is chosen by select_find_string_special()
+ */
+static const gchar *
+find_string_special_scalar (const gchar *p,
+                            const gchar *end)
+{
+  while (p < end && *p != '"' && *p != '\\' && (guchar) *p >= 0x20)
+    p++;
+
+  return p;
+}
+
+#ifdef HAVE_SSE2
+static const gchar *
+find_string_special_sse2 (const gchar *p,
+                          const gchar *end)
+{
+  const __m128i quote = _mm_set1_epi8 ('"');
+  const __m128i backslash = _mm_set1_epi8 ('\\');
+  const __m128i control = _mm_set1_epi8 (0x1f);
+
+  while (end - p >= 16)
+    {
+      __m128i block = _mm_loadu_si128 ((const __m128i *) p);
+      __m128i special;
+      guint mask;
+
+      /* a byte is a control character if max(byte, 0x1f) == 0x1f */
+      special = _mm_or_si128 (_mm_cmpeq_epi8 (block, quote),
+                              _mm_cmpeq_epi8 (block, backslash));
+      special = _mm_or_si128 (special,
+                              _mm_cmpeq_epi8 (_mm_max_epu8 (block, control),
+                                              control));
+
+      mask = (guint) _mm_movemask_epi8 (special);
+      if (mask != 0)
+        return p + __builtin_ctz (mask);
+
+      p += 16;
+    }
+
+  return find_string_special_scalar (p, end);
+}
+#endif /* HAVE_SSE2 */
+
+#ifdef HAVE_AVX2
+__attribute__ ((target ("avx2")))
+static const gchar *
+find_string_special_avx2 (const gchar *p,
+                          const gchar *end)
+{
+  const __m256i quote = _mm256_set1_epi8 ('"');
+  const __m256i backslash = _mm256_set1_epi8 ('\\');
+  const __m256i control = _mm256_set1_epi8 (0x1f);
+
+  while (end - p >= 32)
+    {
+      __m256i block = _mm256_loadu_si256 ((const __m256i *) p);
+      __m256i special;
+      guint mask;
+
+      /* a byte is a control character if max(byte, 0x1f) == 0x1f */
+      special = _mm256_or_si256 (_mm256_cmpeq_epi8 (block, quote),
+                                 _mm256_cmpeq_epi8 (block, backslash));
+      special = _mm256_or_si256 (special,
+                                 _mm256_cmpeq_epi8 (_mm256_max_epu8 (block, control),
+                                                    control));
+
+      mask = (guint) _mm256_movemask_epi8 (special);
+      if (mask != 0)
+        return p + __builtin_ctz (mask);
+
+      p += 32;
+    }
+
+  return find_string_special_scalar (p, end);
+}
+#endif /* HAVE_AVX2 */
+
+/* picks the widest variant supported by the CPU and allowed by the
+ * parse flags
+ */
+static TwitterJsonScanFunc
+select_find_string_special (void)
+{
+  TwitterParseFlags flags = twitter_get_parse_flags ();
+
+  if (flags & TWITTER_PARSE_NO_SIMD)
+    return find_string_special_scalar;
+
+#ifdef HAVE_AVX2
+  if (!(flags & TWITTER_PARSE_NO_AVX2) && __builtin_cpu_supports ("avx2"))
+    return find_string_special_avx2;
+#endif
+
+#ifdef HAVE_SSE2
+  return find_string_special_sse2;
+#else
+  return find_string_special_scalar;
+#endif
+}
+
+/* moves the cursor past the closing quote of a string; the cursor
+ * must be positioned after the opening quote
+ */
+static gboolean
+scan_string (TwitterJsonDecoder *decoder)
+{
+  const gchar *p = decoder->cursor;
+
+  while (p < decoder->end)
+    {
+      p = decoder->find_special (p, decoder->end);
+      if (p == decoder->end)
+        break;
+
+      if (*p == '"')
+        {
+          decoder->cursor = p + 1;
+          return TRUE;
+        }
+
+      if ((guchar) *p < 0x20)
+        break;
+
+      if (*p == '\\')
+        {
+          p += 1;
+
+          if (p == decoder->end || *p == '\0' ||
+              strchr ("\"\\/bfnrtu", *p) == NULL)
+            break;
+        }
+
+      p += 1;
+    }
+
+  decoder_fail (decoder);
+
+  return FALSE;
+}
+
+/* copies @data, which is terminated so that it can also be handed
+ * to json-glib
+ */
+TwitterJsonBuffer *
+_twitter_json_buffer_new (const gchar *data,
+                          gsize        length)
+{
+  TwitterJsonBuffer *buffer;
+
+  buffer = g_malloc (G_STRUCT_OFFSET (TwitterJsonBuffer, data) + length + 1);
+  buffer->ref_count = 1;
+  buffer->length = length;
+
+  memcpy (buffer->data, data, length);
+  buffer->data[length] = '\0';
+
+  return buffer;
+}
+
+/* buffers are shared between the threads of the parse pool */
+TwitterJsonBuffer *
+_twitter_json_buffer_ref (TwitterJsonBuffer *buffer)
+{
+  g_atomic_int_inc (&buffer->ref_count);
+
+  return buffer;
+}
+
+void
+_twitter_json_buffer_unref (TwitterJsonBuffer *buffer)
+{
+  if (g_atomic_int_dec_and_test (&buffer->ref_count))
+    g_free (buffer);
+}
+
+void
+_twitter_json_decoder_init (TwitterJsonDecoder *decoder,
+                            const gchar        *buffer,
+                            gsize               length)
+{
+  decoder->cursor = buffer;
+  decoder->end = buffer + length;
+  decoder->buffer = NULL;
+  decoder->arena = NULL;
+  decoder->depth = 0;
+  decoder->first = FALSE;
+  decoder->failed = FALSE;
+  decoder->find_special = select_find_string_special ();
+}
+
+/* like _twitter_json_decoder_init(), but decoding the @length bytes
+ * at @start inside @buffer, and allowing strings to be read lazily
+ * with _twitter_json_decoder_read_lazy_string()
+ */
+void
+_twitter_json_decoder_init_lazy (TwitterJsonDecoder *decoder,
+                                 TwitterJsonBuffer  *buffer,
+                                 const gchar        *start,
+                                 gsize               length)
+{
+  _twitter_json_decoder_init (decoder, start, length);
+
+  decoder->buffer = buffer;
+}
+
+/* initializes @decoder to decode a value read by @parent using
+ * _twitter_json_decoder_read_span(), sharing its buffer and arena
+ */
+void
+_twitter_json_decoder_init_from_span (TwitterJsonDecoder       *decoder,
+                                      const TwitterJsonDecoder *parent,
+                                      const TwitterJsonSpan    *span)
+{
+  _twitter_json_decoder_init (decoder, span->start, span->length);
+
+  decoder->buffer = parent->buffer;
+  decoder->arena = parent->arena;
+}
+
+gboolean
+_twitter_json_decoder_failed (TwitterJsonDecoder *decoder)
+{
+  return decoder->failed;
+}
+
+/* whether the whole buffer was consumed without errors */
+gboolean
+_twitter_json_decoder_at_end (TwitterJsonDecoder *decoder)
+{
+  if (decoder->failed)
+    return FALSE;
+
+  skip_whitespace (decoder);
+
+  return decoder->cursor == decoder->end;
+}
+
+TwitterJsonType
+_twitter_json_decoder_peek (TwitterJsonDecoder *decoder)
+{
+  if (decoder->failed)
+    return TWITTER_JSON_INVALID;
+
+  skip_whitespace (decoder);
+
+  if (decoder->cursor == decoder->end)
+    return TWITTER_JSON_INVALID;
+
+  switch (*decoder->cursor)
+    {
+    case '{':
+      return TWITTER_JSON_OBJECT;
+
+    case '[':
+      return TWITTER_JSON_ARRAY;
+
+    case '"':
+      return TWITTER_JSON_STRING;
+
+    case 't':
+    case 'f':
+      return TWITTER_JSON_BOOLEAN;
+
+    case 'n':
+      return TWITTER_JSON_NULL;
+
+    case '-':
+    case '0': case '1': case '2': case '3': case '4':
+    case '5': case '6': case '7': case '8': case '9':
+      return TWITTER_JSON_NUMBER;
+
+    default:
+      break;
+    }
+
+  return TWITTER_JSON_INVALID;
+}
+
+/* enters the object at the cursor; returns %FALSE, without moving
+ * the cursor, if the next value is not an object
+ */
+gboolean
+_twitter_json_decoder_begin_object (TwitterJsonDecoder *decoder)
+{
+  if (_twitter_json_decoder_peek (decoder) != TWITTER_JSON_OBJECT)
+    return FALSE;
+
+  if (++decoder->depth > MAX_DEPTH)
+    {
+      decoder_fail (decoder);
+      return FALSE;
+    }
+
+  decoder->cursor += 1;
+  decoder->first = TRUE;
+
+  return TRUE;
+}
+
+/* reads the name of the next member of the current object, and
+ * leaves the cursor on its value; returns %FALSE at the end of
+ * the object, or on error. The name is not unescaped
+ */
+gboolean
+_twitter_json_decoder_next_member (TwitterJsonDecoder  *decoder,
+                                   const gchar        **key,
+                                   gsize               *key_len)
+{
+  const gchar *start;
+
+  if (decoder->failed)
+    return FALSE;
+
+  skip_whitespace (decoder);
+
+  if (decoder->cursor == decoder->end)
+    {
+      decoder_fail (decoder);
+      return FALSE;
+    }
+
+  if (*decoder->cursor == '}')
+    {
+      decoder->cursor += 1;
+      decoder->depth -= 1;
+      decoder->first = FALSE;
+
+      return FALSE;
+    }
+
+  if (!decoder->first)
+    {
+      if (!decoder_expect (decoder, ",", 1))
+        return FALSE;
+
+      skip_whitespace (decoder);
+    }
+
+  decoder->first = FALSE;
+
+  if (!decoder_expect (decoder, "\"", 1))
+    return FALSE;
+
+  start = decoder->cursor;
+  if (!scan_string (decoder))
+    return FALSE;
+
+  *key = start;
+  *key_len = decoder->cursor - start - 1;
+
+  skip_whitespace (decoder);
+
+  return decoder_expect (decoder, ":", 1);
+}
+
+gboolean
+_twitter_json_decoder_begin_array (TwitterJsonDecoder *decoder)
+{
+  if (_twitter_json_decoder_peek (decoder) != TWITTER_JSON_ARRAY)
+    return FALSE;
+
+  if (++decoder->depth > MAX_DEPTH)
+    {
+      decoder_fail (decoder);
+      return FALSE;
+    }
+
+  decoder->cursor += 1;
+  decoder->first = TRUE;
+
+  return TRUE;
+}
+
+/* leaves the cursor on the next element of the current array;
+ * returns %FALSE at the end of the array, or on error
+ */
+gboolean
+_twitter_json_decoder_next_element (TwitterJsonDecoder *decoder)
+{
+  if (decoder->failed)
+    return FALSE;
+
+  skip_whitespace (decoder);
+
+  if (decoder->cursor == decoder->end)
+    {
+      decoder_fail (decoder);
+      return FALSE;
+    }
+
+  if (*decoder->cursor == ']')
+    {
+      decoder->cursor += 1;
+      decoder->depth -= 1;
+      decoder->first = FALSE;
+
+      return FALSE;
+    }
+
+  if (!decoder->first)
+    {
+      if (!decoder_expect (decoder, ",", 1))
+        return FALSE;
+    }
+
+  decoder->first = FALSE;
+
+  return TRUE;
+}
+
+static gint
+hex_value (gchar c)
+{
+  if (c >= '0' && c <= '9')
+    return c - '0';
+
+  if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+
+  if (c >= 'A' && c <= 'F')
+    return c - 'A' + 10;
+
+  return -1;
+}
+
+/* reads the four hexadecimal digits of a \u escape */
+static gboolean
+read_hex4 (const gchar *p,
+           const gchar *end,
+           gunichar    *value)
+{
+  gunichar retval = 0;
+  gint i;
+
+  if (end - p < 4)
+    return FALSE;
+
+  for (i = 0; i < 4; i++)
+    {
+      gint digit = hex_value (p[i]);
+
+      if (digit < 0)
+        return FALSE;
+
+      retval = (retval << 4) | digit;
+    }
+
+  *value = retval;
+
+  return TRUE;
+}
+
+/* unescapes the rest of a string containing escape sequences; the
+ * cursor must be positioned on the first backslash
+ */
+static gchar *
+read_escaped_string (TwitterJsonDecoder *decoder,
+                     const gchar        *start,
+                     TwitterStringArena *arena)
+{
+  const gchar *p = decoder->cursor;
+  GString *str;
+
+  str = g_string_sized_new ((p - start) + 16);
+  g_string_append_len (str, start, p - start);
+
+  while (p < decoder->end && *p != '"')
+    {
+      if ((guchar) *p < 0x20)
+        goto error;
+
+      if (*p != '\\')
+        {
+          const gchar *run = p;
+
+          p = decoder->find_special (p, decoder->end);
+
+          g_string_append_len (str, run, p - run);
+          continue;
+        }
+
+      p += 1;
+      if (p == decoder->end)
+        goto error;
+
+      switch (*p)
+        {
+        case '"':  g_string_append_c (str, '"'); break;
+        case '\\': g_string_append_c (str, '\\'); break;
+        case '/':  g_string_append_c (str, '/'); break;
+        case 'b':  g_string_append_c (str, '\b'); break;
+        case 'f':  g_string_append_c (str, '\f'); break;
+        case 'n':  g_string_append_c (str, '\n'); break;
+        case 'r':  g_string_append_c (str, '\r'); break;
+        case 't':  g_string_append_c (str, '\t'); break;
+
+        case 'u':
+          {
+            gunichar ch, low;
+
+            if (!read_hex4 (p + 1, decoder->end, &ch))
+              goto error;
+
+            p += 4;
+
+            /* characters outside the BMP are encoded as a
+             * surrogate pair
+             */
+            if (ch >= 0xd800 && ch <= 0xdbff)
+              {
+                if (decoder->end - p < 7 || p[1] != '\\' || p[2] != 'u' ||
+                    !read_hex4 (p + 3, decoder->end, &low) ||
+                    low < 0xdc00 || low > 0xdfff)
+                  goto error;
+
+                ch = 0x10000 + ((ch - 0xd800) << 10) + (low - 0xdc00);
+                p += 6;
+              }
+            else if (ch >= 0xdc00 && ch <= 0xdfff)
+              goto error;
+
+            if (ch == 0)
+              goto error;
+
+            g_string_append_unichar (str, ch);
+          }
+          break;
+
+        default:
+          goto error;
+        }
+
+      p += 1;
+    }
+
+  if (p == decoder->end)
+    goto error;
+
+  decoder->cursor = p + 1;
+
+  if (!g_utf8_validate (str->str, str->len, NULL))
+    goto error;
+
+  if (arena != NULL)
+    {
+      gchar *retval = _twitter_string_arena_insert_len (arena, str->str, str->len);
+
+      g_string_free (str, TRUE);
+
+      return retval;
+    }
+
+  return g_string_free (str, FALSE);
+
+error:
+  g_string_free (str, TRUE);
+  decoder_fail (decoder);
+
+  return NULL;
+}
+
+/* copies the string at the cursor, either in @arena or in a newly
+ * allocated buffer
+ */
+static gchar *
+read_string (TwitterJsonDecoder *decoder,
+             TwitterStringArena *arena)
+{
+  const gchar *start, *p;
+
+  if (_twitter_json_decoder_peek (decoder) != TWITTER_JSON_STRING)
+    {
+      _twitter_json_decoder_skip (decoder);
+      return NULL;
+    }
+
+  start = decoder->cursor + 1;
+  p = decoder->find_special (start, decoder->end);
+
+  if (p < decoder->end && *p == '"')
+    {
+      if (!g_utf8_validate (start, p - start, NULL))
+        {
+          decoder_fail (decoder);
+          return NULL;
+        }
+
+      decoder->cursor = p + 1;
+
+      if (arena != NULL)
+        return _twitter_string_arena_insert_len (arena, start, p - start);
+
+      return g_strndup (start, p - start);
+    }
+
+  if (p == decoder->end || *p != '\\')
+    {
+      decoder_fail (decoder);
+      return NULL;
+    }
+
+  decoder->cursor = p;
+
+  return read_escaped_string (decoder, start, arena);
+}
+
+/* returns a newly allocated copy of the string at the cursor, or
+ * %NULL if the value is not a string
+ */
+gchar *
+_twitter_json_decoder_read_string (TwitterJsonDecoder *decoder)
+{
+  return read_string (decoder, NULL);
+}
+
+/* replaces @field with the string at the cursor; the string is
+ * stored in @arena, the arena owning the strings of the object
+ * holding @field, in which case the previous value of @field is
+ * owned by the arena as well. If @arena is %NULL the strings of the
+ * object are allocated with g_malloc(). Returns %FALSE if the value
+ * is not a string
+ */
+gboolean
+_twitter_json_decoder_read_field (TwitterJsonDecoder  *decoder,
+                                  TwitterStringArena  *arena,
+                                  gchar              **field)
+{
+  if (arena == NULL)
+    g_free (*field);
+
+  *field = read_string (decoder, arena);
+
+  return *field != NULL;
+}
+
+static gboolean
+scan_number (TwitterJsonDecoder *decoder,
+             gint64             *integer,
+             gboolean           *is_integer)
+{
+  const gchar *p = decoder->cursor;
+  gboolean negative = FALSE;
+  guint64 value = 0, limit;
+
+  if (*p == '-')
+    {
+      negative = TRUE;
+      p++;
+    }
+
+  if (p == decoder->end || !g_ascii_isdigit (*p))
+    {
+      decoder_fail (decoder);
+      return FALSE;
+    }
+
+  /* out of range values saturate, like g_ascii_strtoll() does */
+  limit = negative ? (guint64) G_MAXINT64 + 1 : (guint64) G_MAXINT64;
+
+  while (p < decoder->end && g_ascii_isdigit (*p))
+    {
+      guint digit = *p - '0';
+
+      if (value > (limit - digit) / 10)
+        value = limit;
+      else
+        value = value * 10 + digit;
+
+      p++;
+    }
+
+  *is_integer = TRUE;
+
+  if (p < decoder->end && (*p == '.' || *p == 'e' || *p == 'E'))
+    {
+      *is_integer = FALSE;
+
+      while (p < decoder->end &&
+             (g_ascii_isdigit (*p) ||
+              *p == '.' || *p == 'e' || *p == 'E' ||
+              *p == '+' || *p == '-'))
+        p++;
+    }
+
+  if (!negative)
+    *integer = (gint64) value;
+  else if (value > (guint64) G_MAXINT64)
+    *integer = G_MININT64;
+  else
+    *integer = - (gint64) value;
+
+  decoder->cursor = p;
+
+  return TRUE;
+}
+
+/* returns the integer at the cursor, or 0 if the value is not
+ * a number; floating point values are truncated
+ */
+gint64
+_twitter_json_decoder_read_int (TwitterJsonDecoder *decoder)
+{
+  const gchar *start;
+  gboolean is_integer;
+  gint64 retval;
+
+  if (_twitter_json_decoder_peek (decoder) != TWITTER_JSON_NUMBER)
+    {
+      _twitter_json_decoder_skip (decoder);
+      return 0;
+    }
+
+  start = decoder->cursor;
+
+  if (!scan_number (decoder, &retval, &is_integer))
+    return 0;
+
+  if (!is_integer)
+    {
+      gchar buf[G_ASCII_DTOSTR_BUF_SIZE];
+      gsize len = MIN ((gsize) (decoder->cursor - start), sizeof (buf) - 1);
+
+      memcpy (buf, start, len);
+      buf[len] = '\0';
+
+      retval = (gint64) g_ascii_strtod (buf, NULL);
+    }
+
+  return retval;
+}
+
+/* returns the boolean at the cursor, or %FALSE if the value is not
+ * a boolean
+ */
+gboolean
+_twitter_json_decoder_read_boolean (TwitterJsonDecoder *decoder)
+{
+  if (_twitter_json_decoder_peek (decoder) != TWITTER_JSON_BOOLEAN)
+    {
+      _twitter_json_decoder_skip (decoder);
+      return FALSE;
+    }
+
+  if (*decoder->cursor == 't')
+    return decoder_expect (decoder, "true", 4);
+
+  decoder_expect (decoder, "false", 5);
+
+  return FALSE;
+}
+
+/* moves the cursor past the value at the cursor */
+void
+_twitter_json_decoder_skip (TwitterJsonDecoder *decoder)
+{
+  const gchar *key;
+  gsize key_len;
+  gint64 integer;
+  gboolean is_integer;
+
+  switch (_twitter_json_decoder_peek (decoder))
+    {
+    case TWITTER_JSON_NULL:
+      decoder_expect (decoder, "null", 4);
+      break;
+
+    case TWITTER_JSON_BOOLEAN:
+      _twitter_json_decoder_read_boolean (decoder);
+      break;
+
+    case TWITTER_JSON_NUMBER:
+      scan_number (decoder, &integer, &is_integer);
+      break;
+
+    case TWITTER_JSON_STRING:
+      decoder->cursor += 1;
+      scan_string (decoder);
+      break;
+
+    case TWITTER_JSON_OBJECT:
+      _twitter_json_decoder_begin_object (decoder);
+      while (_twitter_json_decoder_next_member (decoder, &key, &key_len))
+        _twitter_json_decoder_skip (decoder);
+      break;
+
+    case TWITTER_JSON_ARRAY:
+      _twitter_json_decoder_begin_array (decoder);
+      while (_twitter_json_decoder_next_element (decoder))
+        _twitter_json_decoder_skip (decoder);
+      break;
+
+    case TWITTER_JSON_INVALID:
+      decoder_fail (decoder);
+      break;
+    }
+}
+
+/* skips the value at the cursor, and stores its position */
+gboolean
+_twitter_json_decoder_read_span (TwitterJsonDecoder *decoder,
+                                 TwitterJsonSpan    *span)
+{
+  const gchar *start;
+
+  skip_whitespace (decoder);
+
+  start = decoder->cursor;
+
+  _twitter_json_decoder_skip (decoder);
+  if (decoder->failed)
+    return FALSE;
+
+  span->start = start;
+  span->length = decoder->cursor - start;
+
+  return TRUE;
+}
+
+/* stores the span of the string at the cursor, validating it */
+static gboolean
+read_string_span (TwitterJsonDecoder *decoder,
+                  TwitterJsonSpan    *span)
+{
+  if (_twitter_json_decoder_peek (decoder) != TWITTER_JSON_STRING)
+    {
+      _twitter_json_decoder_skip (decoder);
+      return FALSE;
+    }
+
+  if (!_twitter_json_decoder_read_span (decoder, span))
+    return FALSE;
+
+  /* escape sequences are plain ASCII, so validating the raw bytes
+   * catches everything but lone surrogates
+   */
+  if (!g_utf8_validate (span->start, span->length, NULL))
+    {
+      span->start = NULL;
+      span->length = 0;
+
+      decoder_fail (decoder);
+
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+/* replaces @field with the string at the cursor. If the decoder is
+ * lazy, the string is only validated and its span stored in @span,
+ * to be read by _twitter_json_span_materialize() when needed; the
+ * caller must then hold a reference on the decoder buffer for as
+ * long as @span is set. Returns %TRUE if @span was set
+ */
+gboolean
+_twitter_json_decoder_read_lazy_string (TwitterJsonDecoder  *decoder,
+                                        TwitterStringArena  *arena,
+                                        gchar              **field,
+                                        TwitterJsonSpan     *span)
+{
+  span->start = NULL;
+  span->length = 0;
+
+  if (decoder->buffer == NULL)
+    {
+      _twitter_json_decoder_read_field (decoder, arena, field);
+      return FALSE;
+    }
+
+  if (arena == NULL)
+    g_free (*field);
+
+  *field = NULL;
+
+  return read_string_span (decoder, span);
+}
+
+/* like _twitter_json_decoder_read_lazy_string(), but for fields
+ * holding strings of the intern pool: the previous value of @field
+ * is released, and the new one is acquired from the pool
+ */
+gboolean
+_twitter_json_decoder_read_interned (TwitterJsonDecoder  *decoder,
+                                     const gchar        **field,
+                                     TwitterJsonSpan     *span)
+{
+  const gchar *start, *p;
+  gchar *str;
+
+  _twitter_intern_pool_release (*field);
+  *field = NULL;
+
+  span->start = NULL;
+  span->length = 0;
+
+  if (decoder->buffer != NULL)
+    return read_string_span (decoder, span);
+
+  if (_twitter_json_decoder_peek (decoder) != TWITTER_JSON_STRING)
+    {
+      _twitter_json_decoder_skip (decoder);
+      return FALSE;
+    }
+
+  /* strings without escapes are looked up in place */
+  start = decoder->cursor + 1;
+  p = decoder->find_special (start, decoder->end);
+
+  if (p < decoder->end && *p == '"')
+    {
+      if (!g_utf8_validate (start, p - start, NULL))
+        {
+          decoder_fail (decoder);
+          return FALSE;
+        }
+
+      decoder->cursor = p + 1;
+      *field = _twitter_intern_pool_acquire (start, p - start);
+
+      return FALSE;
+    }
+
+  str = read_string (decoder, NULL);
+  *field = _twitter_intern_pool_acquire (str, -1);
+  g_free (str);
+
+  return FALSE;
+}
+
+/* decodes the string in @span into @field, the first time a lazily
+ * read string is needed; @arena is the arena owning the strings of
+ * the object, or %NULL
+ */
+const gchar *
+_twitter_json_span_materialize (gchar              **field,
+                                TwitterJsonSpan     *span,
+                                TwitterStringArena  *arena)
+{
+  if (*field == NULL && span->start != NULL)
+    {
+      TwitterJsonDecoder decoder;
+
+      _twitter_json_decoder_init (&decoder, span->start, span->length);
+      *field = read_string (&decoder, arena);
+
+      span->start = NULL;
+      span->length = 0;
+    }
+
+  return *field;
+}
+
+/* like _twitter_json_span_materialize(), for interned fields */
+const gchar *
+_twitter_json_span_materialize_interned (const gchar     **field,
+                                         TwitterJsonSpan  *span)
+{
+  if (*field == NULL && span->start != NULL)
+    {
+      TwitterJsonDecoder decoder;
+
+      _twitter_json_decoder_init (&decoder, span->start, span->length);
+      _twitter_json_decoder_read_interned (&decoder, field, span);
+    }
+
+  return *field;
+}
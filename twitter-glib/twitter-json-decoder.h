@@ -0,0 +1,156 @@
+/* twitter-json-decoder.h: Single pass JSON decoder
+ *
+ * This file is part of Twitter-GLib.
+ * Copyright (C) 2008  Emmanuele Bassi  <ebassi@gnome.org>
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef __TWITTER_JSON_DECODER_H__
+#define __TWITTER_JSON_DECODER_H__
+
+#include <string.h>
+#include <glib.h>
+
+#include "twitter-string-arena.h"
+
+G_BEGIN_DECLS
+
+typedef enum {
+  TWITTER_JSON_INVALID,
+  TWITTER_JSON_NULL,
+  TWITTER_JSON_BOOLEAN,
+  TWITTER_JSON_NUMBER,
+  TWITTER_JSON_STRING,
+  TWITTER_JSON_OBJECT,
+  TWITTER_JSON_ARRAY
+} TwitterJsonType;
+
+/*
+ * TwitterJsonBuffer:
+ *
+ * A reference counted copy of a buffer, kept alive by the objects
+ * with lazily decoded strings pointing inside it
+ */
+typedef struct {
+  volatile gint ref_count;
+
+  gsize length;
+  gchar data[1];
+} TwitterJsonBuffer;
+
+/* returns the first byte between @p and @end needing attention inside
+ * a JSON string, or @end
+ */
+typedef const gchar *(* TwitterJsonScanFunc) (const gchar *p,
+                                              const gchar *end);
+
+/*
+ * TwitterJsonDecoder:
+ *
+ * A pull decoder reading a JSON buffer in a single pass, without
+ * building an intermediate tree. The decoder does not copy the
+ * buffer, which must be valid for as long as the decoder is used.
+ *
+ * Once an error is found the decoder will refuse to read any
+ * further, and _twitter_json_decoder_failed() will return %TRUE.
+ */
+typedef struct {
+  const gchar *cursor;
+  const gchar *end;
+
+  /* set if strings may be read lazily out of the buffer */
+  TwitterJsonBuffer *buffer;
+
+  /* set if the strings of the decoded objects should be stored in
+   * an arena; objects already holding other strings keep their own
+   * allocator
+   */
+  TwitterStringArena *arena;
+
+  /* the string scanner chosen for the CPU and the parse flags */
+  TwitterJsonScanFunc find_special;
+
+  guint depth;
+
+  guint first  : 1;
+  guint failed : 1;
+} TwitterJsonDecoder;
+
+/*
+ * TwitterJsonSpan:
+ *
+ * The portion of a buffer containing a single JSON value
+ */
+typedef struct {
+  const gchar *start;
+  gsize length;
+} TwitterJsonSpan;
+
+/* matches a member name with a string literal */
+#define TWITTER_JSON_KEY_IS(key,len,str) \
+  ((len) == sizeof (str) - 1 && memcmp ((key), (str), (len)) == 0)
+
+TwitterJsonBuffer *_twitter_json_buffer_new   (const gchar       *data,
+                                               gsize              length);
+TwitterJsonBuffer *_twitter_json_buffer_ref   (TwitterJsonBuffer *buffer);
+void               _twitter_json_buffer_unref (TwitterJsonBuffer *buffer);
+
+void            _twitter_json_decoder_init          (TwitterJsonDecoder  *decoder,
+                                                     const gchar         *buffer,
+                                                     gsize                length);
+void            _twitter_json_decoder_init_lazy     (TwitterJsonDecoder  *decoder,
+                                                     TwitterJsonBuffer   *buffer,
+                                                     const gchar         *start,
+                                                     gsize                length);
+void            _twitter_json_decoder_init_from_span (TwitterJsonDecoder       *decoder,
+                                                      const TwitterJsonDecoder *parent,
+                                                      const TwitterJsonSpan    *span);
+gboolean        _twitter_json_decoder_failed        (TwitterJsonDecoder  *decoder);
+gboolean        _twitter_json_decoder_at_end        (TwitterJsonDecoder  *decoder);
+
+TwitterJsonType _twitter_json_decoder_peek          (TwitterJsonDecoder  *decoder);
+
+gboolean        _twitter_json_decoder_begin_object  (TwitterJsonDecoder  *decoder);
+gboolean        _twitter_json_decoder_next_member   (TwitterJsonDecoder  *decoder,
+                                                     const gchar        **key,
+                                                     gsize               *key_len);
+gboolean        _twitter_json_decoder_begin_array   (TwitterJsonDecoder  *decoder);
+gboolean        _twitter_json_decoder_next_element  (TwitterJsonDecoder  *decoder);
+
+gchar *         _twitter_json_decoder_read_string   (TwitterJsonDecoder  *decoder);
+gint64          _twitter_json_decoder_read_int      (TwitterJsonDecoder  *decoder);
+gboolean        _twitter_json_decoder_read_boolean  (TwitterJsonDecoder  *decoder);
+void            _twitter_json_decoder_skip          (TwitterJsonDecoder  *decoder);
+gboolean        _twitter_json_decoder_read_span     (TwitterJsonDecoder  *decoder,
+                                                     TwitterJsonSpan     *span);
+gboolean        _twitter_json_decoder_read_field    (TwitterJsonDecoder  *decoder,
+                                                     TwitterStringArena  *arena,
+                                                     gchar              **field);
+gboolean        _twitter_json_decoder_read_lazy_string (TwitterJsonDecoder *decoder,
+                                                        TwitterStringArena *arena,
+                                                        gchar             **field,
+                                                        TwitterJsonSpan    *span);
+gboolean        _twitter_json_decoder_read_interned (TwitterJsonDecoder  *decoder,
+                                                     const gchar        **field,
+                                                     TwitterJsonSpan     *span);
+
+const gchar *   _twitter_json_span_materialize      (gchar              **field,
+                                                     TwitterJsonSpan     *span,
+                                                     TwitterStringArena  *arena);
+const gchar *   _twitter_json_span_materialize_interned (const gchar    **field,
+                                                         TwitterJsonSpan *span);
+
+G_END_DECLS
+
+#endif /* __TWITTER_JSON_DECODER_H__ */
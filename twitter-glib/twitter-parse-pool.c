@@ -0,0 +1,558 @@
+/* twitter-parse-pool.c: Parallel building of JSON arrays
+ *
+ * This file is part of Twitter-GLib.
+ * Copyright (C) 2008  Emmanuele Bassi  <ebassi@gnome.org>
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* The parse pool splits the elements of a JSON array, or the spans
+ * of a buffer holding the elements of an array, into ranges
+ * and builds the objects of each range on a shared thread pool; the
+ * calling thread builds the first range itself, and then waits for
+ * the other ranges to complete. The results are stored in the same
+ * order as the elements of the array.
+ *
+ * Small arrays, like the usual timeline page, are not worth the
+ * synchronization and are built inline.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#ifdef HAVE_UNISTD_H
+#include <unistd.h>
+#endif
+
+#include <string.h>
+
+#include "twitter-common.h"
+#include "twitter-parse-pool.h"
+
+/* arrays with fewer elements are built by the calling thread */
+#define PARSE_POOL_MIN_ELEMENTS 64
+
+/* buffers with fewer bytes are decoded by the calling thread */
+#define PARSE_POOL_MIN_BYTES    (128 * 1024)
+
+/* the minimum amount of elements built by each thread */
+#define PARSE_POOL_MIN_RANGE    32
+
+typedef struct {
+  /* either the elements of a JSON array... */
+  JsonArray *array;
+  TwitterParseFunc parse_func;
+
+  /* ... or the spans of a buffer */
+  const TwitterJsonSpan *spans;
+  const TwitterJsonDecoder *parent;
+  TwitterNewFunc new_func;
+  TwitterDecodeFunc decode_func;
+  volatile gint failed;
+
+  gpointer *results;
+
+  GMutex *lock;
+  GCond *cond;
+  guint n_pending;
+} ParseJob;
+
+typedef struct {
+  ParseJob *job;
+
+  guint start;
+  guint end;
+} ParseRange;
+
+G_LOCK_DEFINE_STATIC (parse_pool);
+static GThreadPool *parse_pool = NULL;
+static guint parse_pool_n_threads = 0;
+
+static void
+unref_object (gpointer data,
+              gpointer user_data)
+{
+  if (data != NULL)
+    g_object_unref (data);
+}
+
+/* decodes the object inside @span; returns %FALSE if the span
+ * does not contain valid JSON
+ */
+static gboolean
+decode_span (ParseJob              *job,
+             const TwitterJsonSpan *span,
+             gpointer              *result)
+{
+  TwitterJsonDecoder decoder;
+  gpointer object;
+
+  _twitter_json_decoder_init_from_span (&decoder, job->parent, span);
+
+  if (_twitter_json_decoder_peek (&decoder) != TWITTER_JSON_OBJECT)
+    return TRUE;
+
+  object = job->new_func ();
+  job->decode_func (object, &decoder);
+
+  if (!_twitter_json_decoder_at_end (&decoder))
+    {
+      g_object_unref (object);
+      return FALSE;
+    }
+
+  *result = object;
+
+  return TRUE;
+}
+
+static void
+parse_range (ParseJob *job,
+             guint     start,
+             guint     end)
+{
+  guint i;
+
+  if (job->spans != NULL)
+    {
+      for (i = start; i < end; i++)
+        {
+          if (!decode_span (job, &job->spans[i], &job->results[i]))
+            {
+              g_atomic_int_set (&job->failed, TRUE);
+              break;
+            }
+        }
+
+      return;
+    }
+
+  for (i = start; i < end; i++)
+    {
+      JsonNode *element = json_array_get_element (job->array, i);
+
+      if (JSON_NODE_TYPE (element) == JSON_NODE_OBJECT)
+        job->results[i] = job->parse_func (element);
+    }
+}
+
+static void
+parse_pool_worker (gpointer data,
+                   gpointer user_data)
+{
+  ParseRange *range = data;
+  ParseJob *job = range->job;
+
+  parse_range (job, range->start, range->end);
+
+  g_mutex_lock (job->lock);
+
+  job->n_pending -= 1;
+  if (job->n_pending == 0)
+    g_cond_signal (job->cond);
+
+  g_mutex_unlock (job->lock);
+}
+
+static guint
+get_n_processors (void)
+{
+#if defined(HAVE_UNISTD_H) && defined(_SC_NPROCESSORS_ONLN)
+  glong n_cpus = sysconf (_SC_NPROCESSORS_ONLN);
+
+  if (n_cpus > 0)
+    return n_cpus;
+#endif
+
+  return 1;
+}
+
+/* returns the shared thread pool, or %NULL if the pool cannot
+ * be used
+ */
+static GThreadPool *
+parse_pool_get_default (void)
+{
+  GThreadPool *retval;
+
+  if (!g_thread_supported ())
+    return NULL;
+
+  G_LOCK (parse_pool);
+
+  if (parse_pool == NULL && parse_pool_n_threads == 0)
+    {
+      GError *error = NULL;
+
+      /* the calling thread takes care of one range */
+      parse_pool_n_threads = get_n_processors () - 1;
+      if (parse_pool_n_threads > 0)
+        {
+          parse_pool = g_thread_pool_new (parse_pool_worker, NULL,
+                                          parse_pool_n_threads,
+                                          FALSE,
+                                          &error);
+          if (error != NULL)
+            {
+              g_warning ("Unable to create the parse pool: %s",
+                         error->message);
+              g_error_free (error);
+
+              parse_pool = NULL;
+            }
+        }
+
+      /* do not try again */
+      if (parse_pool == NULL)
+        parse_pool_n_threads = G_MAXUINT;
+    }
+
+  retval = parse_pool;
+
+  G_UNLOCK (parse_pool);
+
+  return retval;
+}
+
+static void
+parse_pool_run (ParseJob *job,
+                guint     n_elements)
+{
+  GThreadPool *pool = NULL;
+  ParseRange *ranges;
+  guint n_ranges, range_size, i;
+
+  if (n_elements >= PARSE_POOL_MIN_ELEMENTS)
+    pool = parse_pool_get_default ();
+
+  if (pool == NULL)
+    {
+      parse_range (job, 0, n_elements);
+      return;
+    }
+
+  n_ranges = MIN (parse_pool_n_threads + 1,
+                  n_elements / PARSE_POOL_MIN_RANGE);
+  range_size = (n_elements + n_ranges - 1) / n_ranges;
+
+  job->lock = g_mutex_new ();
+  job->cond = g_cond_new ();
+  job->n_pending = n_ranges - 1;
+
+  ranges = g_new0 (ParseRange, n_ranges);
+  for (i = 0; i < n_ranges; i++)
+    {
+      ranges[i].job = job;
+      ranges[i].start = i * range_size;
+      ranges[i].end = MIN (n_elements, (i + 1) * range_size);
+    }
+
+  for (i = 1; i < n_ranges; i++)
+    g_thread_pool_push (pool, &ranges[i], NULL);
+
+  parse_range (job, ranges[0].start, ranges[0].end);
+
+  g_mutex_lock (job->lock);
+  while (job->n_pending > 0)
+    g_cond_wait (job->cond, job->lock);
+  g_mutex_unlock (job->lock);
+
+  g_free (ranges);
+  g_cond_free (job->cond);
+  g_mutex_free (job->lock);
+}
+
+/*
+ * _twitter_parse_pool_build:
+ * @array: a #JsonArray
+ * @func: the function used to build each object element
+ *
+ * Calls @func on every element of @array of type %JSON_NODE_OBJECT,
+ * possibly using more than one thread.
+ *
+ * Return value: a #GPtrArray with the same length as @array,
+ *   containing the objects built by @func, or %NULL for the elements
+ *   that are not objects. Use g_ptr_array_free() to free the array
+ */
+GPtrArray *
+_twitter_parse_pool_build (JsonArray        *array,
+                           TwitterParseFunc  func)
+{
+  GPtrArray *retval;
+  ParseJob job = { 0, };
+  guint n_elements;
+
+  g_return_val_if_fail (array != NULL, NULL);
+  g_return_val_if_fail (func != NULL, NULL);
+
+  n_elements = json_array_get_length (array);
+
+  retval = g_ptr_array_sized_new (n_elements);
+  g_ptr_array_set_size (retval, n_elements);
+
+  job.array = array;
+  job.parse_func = func;
+  job.results = retval->pdata;
+
+  parse_pool_run (&job, n_elements);
+
+  return retval;
+}
+
+/* calls the decoding functions of @job on every span, possibly
+ * using more than one thread; if any span fails to decode, @failed
+ * will be set to %TRUE and the returned array will contain only some
+ * of the objects
+ */
+static GPtrArray *
+parse_pool_decode_spans (ParseJob              *job,
+                         const TwitterJsonSpan *spans,
+                         guint                  n_spans,
+                         gboolean              *failed)
+{
+  GPtrArray *retval;
+
+  retval = g_ptr_array_sized_new (n_spans);
+  g_ptr_array_set_size (retval, n_spans);
+
+  job->spans = spans;
+  job->results = retval->pdata;
+
+  parse_pool_run (job, n_spans);
+
+  *failed = g_atomic_int_get (&job->failed);
+
+  return retval;
+}
+
+/*
+ * _twitter_parse_pool_decode_data:
+ * @buffer: a NUL-terminated buffer containing a JSON array
+ * @new_func: the function used to create each object
+ * @decode_func: the function used to fill each object
+ *
+ * Decodes the object elements of the array in @buffer using the
+ * single pass decoder; large buffers are decoded using more than
+ * one thread. Anything but an array is decoded as an empty array.
+ *
+ * Return value: a #GPtrArray containing the objects, in the same
+ *   order as the array, with %NULL for the elements that are not
+ *   objects; or %NULL if json-glib should be used instead, because
+ *   the application asked for it or @buffer could not be decoded.
+ *   Use g_ptr_array_free() to free the array
+ */
+GPtrArray *
+_twitter_parse_pool_decode_data (const gchar       *buffer,
+                                 TwitterNewFunc     new_func,
+                                 TwitterDecodeFunc  decode_func)
+{
+  TwitterParseFlags flags = twitter_get_parse_flags ();
+  TwitterJsonBuffer *raw = NULL;
+  TwitterJsonDecoder decoder;
+  ParseJob job = { 0, };
+  GPtrArray *objects;
+  gboolean failed = FALSE;
+  gsize length;
+
+  g_return_val_if_fail (buffer != NULL, NULL);
+  g_return_val_if_fail (new_func != NULL, NULL);
+  g_return_val_if_fail (decode_func != NULL, NULL);
+
+  if (flags & TWITTER_PARSE_USE_JSON_GLIB)
+    return NULL;
+
+  length = strlen (buffer);
+
+  /* the lazily decoded strings of every element point inside the
+   * same copy of the buffer
+   */
+  if (flags & TWITTER_PARSE_LAZY)
+    {
+      raw = _twitter_json_buffer_new (buffer, length);
+      _twitter_json_decoder_init_lazy (&decoder, raw, raw->data, raw->length);
+    }
+  else
+    _twitter_json_decoder_init (&decoder, buffer, length);
+
+  /* and every string of the page is stored in one arena */
+  decoder.arena = _twitter_string_arena_new (length);
+
+  job.parent = &decoder;
+  job.new_func = new_func;
+  job.decode_func = decode_func;
+
+  /* anything but an array is an empty list */
+  if (!_twitter_json_decoder_begin_array (&decoder))
+    {
+      _twitter_json_decoder_skip (&decoder);
+
+      failed = !_twitter_json_decoder_at_end (&decoder);
+      objects = g_ptr_array_new ();
+
+      goto out;
+    }
+
+  if (length >= PARSE_POOL_MIN_BYTES)
+    {
+      GArray *spans;
+      TwitterJsonSpan span;
+
+      spans = g_array_new (FALSE, FALSE, sizeof (TwitterJsonSpan));
+
+      while (_twitter_json_decoder_next_element (&decoder))
+        {
+          if (_twitter_json_decoder_read_span (&decoder, &span))
+            g_array_append_val (spans, span);
+        }
+
+      if (_twitter_json_decoder_at_end (&decoder))
+        objects = parse_pool_decode_spans (&job,
+                                           (TwitterJsonSpan *) spans->data,
+                                           spans->len,
+                                           &failed);
+      else
+        {
+          objects = NULL;
+          failed = TRUE;
+        }
+
+      g_array_free (spans, TRUE);
+    }
+  else
+    {
+      objects = g_ptr_array_new ();
+
+      while (_twitter_json_decoder_next_element (&decoder))
+        {
+          gpointer object;
+
+          if (_twitter_json_decoder_peek (&decoder) != TWITTER_JSON_OBJECT)
+            {
+              _twitter_json_decoder_skip (&decoder);
+              continue;
+            }
+
+          object = new_func ();
+          decode_func (object, &decoder);
+
+          g_ptr_array_add (objects, object);
+        }
+
+      failed = !_twitter_json_decoder_at_end (&decoder);
+    }
+
+out:
+  if (raw != NULL)
+    _twitter_json_buffer_unref (raw);
+
+  _twitter_string_arena_unref (decoder.arena);
+
+  if (failed && objects != NULL)
+    {
+      g_ptr_array_foreach (objects, unref_object, NULL);
+      g_ptr_array_free (objects, TRUE);
+
+      objects = NULL;
+    }
+
+  return objects;
+}
+
+/* every thread keeps a parser around, instead of creating one for
+ * each buffer it parses
+ */
+typedef struct {
+  JsonParser *parser;
+} ParserSlot;
+
+static GStaticPrivate parser_slot_key = G_STATIC_PRIVATE_INIT;
+
+static void
+parser_slot_free (gpointer data)
+{
+  ParserSlot *slot = data;
+
+  if (slot->parser != NULL)
+    g_object_unref (slot->parser);
+
+  g_slice_free (ParserSlot, slot);
+}
+
+static ParserSlot *
+parser_slot_get (void)
+{
+  ParserSlot *slot = g_static_private_get (&parser_slot_key);
+
+  if (G_UNLIKELY (slot == NULL))
+    {
+      slot = g_slice_new0 (ParserSlot);
+      g_static_private_set (&parser_slot_key, slot, parser_slot_free);
+    }
+
+  return slot;
+}
+
+/*
+ * _twitter_parse_pool_get_parser:
+ *
+ * Retrieves the #JsonParser of the calling thread, creating it if
+ * needed. The parser must be handed back with
+ * _twitter_parse_pool_put_parser() once done with it; until then,
+ * nested calls will return a new parser.
+ *
+ * Return value: a #JsonParser
+ */
+JsonParser *
+_twitter_parse_pool_get_parser (void)
+{
+  ParserSlot *slot = parser_slot_get ();
+  JsonParser *parser;
+
+  if (slot->parser == NULL)
+    return json_parser_new ();
+
+  /* the slot stays empty while the parser is in use */
+  parser = slot->parser;
+  slot->parser = NULL;
+
+  return parser;
+}
+
+/*
+ * _twitter_parse_pool_put_parser:
+ * @parser: a #JsonParser returned by _twitter_parse_pool_get_parser()
+ *
+ * Releases the data parsed by @parser, and keeps @parser for the
+ * next call to _twitter_parse_pool_get_parser() from the same thread
+ */
+void
+_twitter_parse_pool_put_parser (JsonParser *parser)
+{
+  ParserSlot *slot = parser_slot_get ();
+
+  if (slot->parser != NULL)
+    {
+      g_object_unref (parser);
+      return;
+    }
+
+  /* JsonParser has no way to drop its tree other than parsing
+   * something else; a whole page of statuses should not be kept
+   * alive until the next load
+   */
+  json_parser_load_from_data (parser, "[]", 2, NULL);
+
+  slot->parser = parser;
+}
@@ -0,0 +1,69 @@
+/* twitter-parse-pool.h: Parallel building of JSON arrays
+ *
+ * This file is part of Twitter-GLib.
+ * Copyright (C) 2008  Emmanuele Bassi  <ebassi@gnome.org>
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef __TWITTER_PARSE_POOL_H__
+#define __TWITTER_PARSE_POOL_H__
+
+#include <glib.h>
+#include <json-glib/json-glib.h>
+
+#include "twitter-json-decoder.h"
+
+G_BEGIN_DECLS
+
+/*
+ * TwitterParseFunc:
+ * @node: a #JsonNode of type %JSON_NODE_OBJECT
+ *
+ * Builds an object out of @node. The function might be called
+ * from a thread different than the one calling
+ * _twitter_parse_pool_build()
+ */
+typedef gpointer (* TwitterParseFunc) (JsonNode *node);
+
+/*
+ * TwitterNewFunc:
+ *
+ * Creates an empty object, to be filled by a #TwitterDecodeFunc
+ */
+typedef gpointer (* TwitterNewFunc) (void);
+
+/*
+ * TwitterDecodeFunc:
+ * @object: the object created by a #TwitterNewFunc
+ * @decoder: a #TwitterJsonDecoder positioned on a JSON object
+ *
+ * Fills @object with the JSON object read by @decoder. The function
+ * might be called from a thread different than the one calling
+ * _twitter_parse_pool_decode_data()
+ */
+typedef void (* TwitterDecodeFunc) (gpointer            object,
+                                    TwitterJsonDecoder *decoder);
+
+GPtrArray *_twitter_parse_pool_build  (JsonArray             *array,
+                                       TwitterParseFunc       func);
+GPtrArray *_twitter_parse_pool_decode_data (const gchar       *buffer,
+                                            TwitterNewFunc     new_func,
+                                            TwitterDecodeFunc  decode_func);
+
+JsonParser *_twitter_parse_pool_get_parser (void);
+void        _twitter_parse_pool_put_parser (JsonParser *parser);
+
+G_END_DECLS
+
+#endif /* __TWITTER_PARSE_POOL_H__ */
@@ -0,0 +1,396 @@
+/* twitter-pattern-set.c: Multi-pattern string matching
+ *
+ * This file is part of Twitter-GLib.
+ * Copyright (C) 2008  Emmanuele Bassi  <ebassi@gnome.org>
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* The patterns are case folded and stored, byte by byte, inside a
+ * trie; each state of the trie also has a failure link to the state
+ * matching the longest proper suffix of its prefix, and an output
+ * link to the nearest state through the failure links ending a
+ * pattern. The failure links are computed lazily, the first time a
+ * text is matched after adding patterns.
+ *
+ * The text is case folded as well before being scanned; the offsets
+ * of the matches are translated back to offsets inside the original
+ * text, and the matches not starting and ending on a character of
+ * the original text are discarded.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include "twitter-pattern-set.h"
+
+/* the edges are keyed by the state and the byte */
+#define MAX_STATES      (1 << 24)
+#define EDGE_KEY(state,byte)    GUINT_TO_POINTER (((state) << 8) | (byte))
+
+typedef struct {
+  /* the children of the state, through the edges */
+  guint first_child;
+  guint next_sibling;
+
+  guint fail;
+  guint output;
+
+  /* the pattern ending in this state, or 0 */
+  guint pattern_id;
+
+  /* the length of the prefix matched by the state */
+  guint depth;
+
+  guchar byte;
+} PatternState;
+
+struct _TwitterPatternSet
+{
+  /* PatternState; the first is the root */
+  GArray *states;
+
+  /* the edges of the root, which are the most used */
+  guint root_edges[256];
+
+  /* EDGE_KEY -> state, for every other state */
+  GHashTable *edges;
+
+  guint n_patterns;
+
+  guint compiled : 1;
+};
+
+#define STATE(set,i)    (&g_array_index ((set)->states, PatternState, (i)))
+
+TwitterPatternSet *
+_twitter_pattern_set_new (void)
+{
+  TwitterPatternSet *retval = g_slice_new0 (TwitterPatternSet);
+  PatternState root = { 0, };
+
+  retval->states = g_array_new (FALSE, FALSE, sizeof (PatternState));
+  g_array_append_val (retval->states, root);
+
+  retval->edges = g_hash_table_new (NULL, NULL);
+
+  retval->compiled = TRUE;
+
+  return retval;
+}
+
+void
+_twitter_pattern_set_free (TwitterPatternSet *set)
+{
+  if (set == NULL)
+    return;
+
+  g_array_free (set->states, TRUE);
+  g_hash_table_destroy (set->edges);
+
+  g_slice_free (TwitterPatternSet, set);
+}
+
+static inline guint
+pattern_set_next (TwitterPatternSet *set,
+                  guint              state,
+                  guchar             byte)
+{
+  if (state == 0)
+    return set->root_edges[byte];
+
+  return GPOINTER_TO_UINT (g_hash_table_lookup (set->edges,
+                                                EDGE_KEY (state, byte)));
+}
+
+/* folds @text, returning for each byte of the folded text the offset
+ * of the character of @text it comes from; the map is %NULL if the
+ * offsets are the same
+ */
+static gchar *
+fold_text (const gchar  *text,
+           gsize        *length,
+           gsize       **map)
+{
+  const gchar *p;
+  GString *folded;
+  GArray *offsets;
+  gsize text_len;
+
+  for (p = text; *p != '\0'; p++)
+    {
+      if ((guchar) *p >= 0x80)
+        break;
+    }
+
+  /* plain ASCII, which is the common case */
+  if (*p == '\0')
+    {
+      gchar *retval;
+      gsize i;
+
+      text_len = p - text;
+      retval = g_malloc (text_len + 1);
+
+      for (i = 0; i < text_len; i++)
+        retval[i] = g_ascii_tolower (text[i]);
+
+      retval[text_len] = '\0';
+
+      *length = text_len;
+      *map = NULL;
+
+      return retval;
+    }
+
+  text_len = strlen (text);
+
+  folded = g_string_sized_new (text_len);
+  offsets = g_array_sized_new (FALSE, FALSE, sizeof (gsize), text_len + 1);
+
+  for (p = text; *p != '\0'; p = g_utf8_next_char (p))
+    {
+      gsize offset = p - text;
+
+      if ((guchar) *p < 0x80)
+        {
+          g_string_append_c (folded, g_ascii_tolower (*p));
+          g_array_append_val (offsets, offset);
+        }
+      else
+        {
+          gchar *c = g_utf8_casefold (p, g_utf8_next_char (p) - p);
+          gsize i, c_len = strlen (c);
+
+          g_string_append_len (folded, c, c_len);
+
+          for (i = 0; i < c_len; i++)
+            g_array_append_val (offsets, offset);
+
+          g_free (c);
+        }
+    }
+
+  g_array_append_val (offsets, text_len);
+
+  *length = folded->len;
+  *map = (gsize *) g_array_free (offsets, FALSE);
+
+  return g_string_free (folded, FALSE);
+}
+
+guint
+_twitter_pattern_set_add (TwitterPatternSet *set,
+                          const gchar       *pattern)
+{
+  gchar *folded;
+  gsize length, i;
+  gsize *map;
+  guint state;
+
+  g_return_val_if_fail (set != NULL, 0);
+  g_return_val_if_fail (pattern != NULL, 0);
+
+  folded = fold_text (pattern, &length, &map);
+  g_free (map);
+
+  if (length == 0)
+    {
+      g_free (folded);
+      return 0;
+    }
+
+  if (set->states->len + length > MAX_STATES)
+    {
+      g_warning ("Too many patterns; unable to add '%s'", pattern);
+      g_free (folded);
+      return 0;
+    }
+
+  state = 0;
+  for (i = 0; i < length; i++)
+    {
+      guchar byte = folded[i];
+      guint next = pattern_set_next (set, state, byte);
+
+      if (next == 0)
+        {
+          PatternState child = { 0, };
+
+          next = set->states->len;
+
+          child.byte = byte;
+          child.depth = STATE (set, state)->depth + 1;
+          child.next_sibling = STATE (set, state)->first_child;
+          g_array_append_val (set->states, child);
+
+          STATE (set, state)->first_child = next;
+
+          if (state == 0)
+            set->root_edges[byte] = next;
+          else
+            g_hash_table_insert (set->edges,
+                                 EDGE_KEY (state, byte),
+                                 GUINT_TO_POINTER (next));
+
+          set->compiled = FALSE;
+        }
+
+      state = next;
+    }
+
+  g_free (folded);
+
+  if (STATE (set, state)->pattern_id == 0)
+    {
+      STATE (set, state)->pattern_id = ++set->n_patterns;
+      set->compiled = FALSE;
+    }
+
+  return STATE (set, state)->pattern_id;
+}
+
+guint
+_twitter_pattern_set_size (TwitterPatternSet *set)
+{
+  g_return_val_if_fail (set != NULL, 0);
+
+  return set->n_patterns;
+}
+
+/* computes the failure and output links, breadth first */
+static void
+pattern_set_compile (TwitterPatternSet *set)
+{
+  GArray *queue;
+  guint head, child;
+
+  queue = g_array_sized_new (FALSE, FALSE, sizeof (guint), set->states->len);
+
+  for (child = STATE (set, 0)->first_child;
+       child != 0;
+       child = STATE (set, child)->next_sibling)
+    {
+      STATE (set, child)->fail = 0;
+      STATE (set, child)->output = 0;
+      g_array_append_val (queue, child);
+    }
+
+  for (head = 0; head < queue->len; head++)
+    {
+      guint state = g_array_index (queue, guint, head);
+
+      for (child = STATE (set, state)->first_child;
+           child != 0;
+           child = STATE (set, child)->next_sibling)
+        {
+          guchar byte = STATE (set, child)->byte;
+          guint fail = STATE (set, state)->fail;
+          PatternState *fail_state;
+
+          while (fail != 0 && pattern_set_next (set, fail, byte) == 0)
+            fail = STATE (set, fail)->fail;
+
+          fail = pattern_set_next (set, fail, byte);
+          fail_state = STATE (set, fail);
+
+          STATE (set, child)->fail = fail;
+          STATE (set, child)->output = fail_state->pattern_id != 0
+                                     ? fail
+                                     : fail_state->output;
+
+          g_array_append_val (queue, child);
+        }
+    }
+
+  g_array_free (queue, TRUE);
+
+  set->compiled = TRUE;
+}
+
+/* whether @offset of the folded text is the boundary of a character */
+static inline gboolean
+is_boundary (const gsize *map,
+             gsize        length,
+             gsize        offset)
+{
+  return map == NULL ||
+         offset == 0 ||
+         offset == length ||
+         map[offset] != map[offset - 1];
+}
+
+void
+_twitter_pattern_set_match (TwitterPatternSet  *set,
+                            const gchar        *text,
+                            TwitterPatternFunc  func,
+                            gpointer            data)
+{
+  gchar *folded;
+  gsize length, i;
+  gsize *map;
+  guint state;
+
+  g_return_if_fail (set != NULL);
+  g_return_if_fail (text != NULL);
+  g_return_if_fail (func != NULL);
+
+  if (set->n_patterns == 0)
+    return;
+
+  if (!set->compiled)
+    pattern_set_compile (set);
+
+  folded = fold_text (text, &length, &map);
+
+  state = 0;
+  for (i = 0; i < length; i++)
+    {
+      guchar byte = folded[i];
+      guint match;
+
+      while (state != 0 && pattern_set_next (set, state, byte) == 0)
+        state = STATE (set, state)->fail;
+
+      state = pattern_set_next (set, state, byte);
+
+      match = STATE (set, state)->pattern_id != 0
+            ? state
+            : STATE (set, state)->output;
+
+      while (match != 0)
+        {
+          PatternState *match_state = STATE (set, match);
+          gsize start = i + 1 - match_state->depth;
+          gsize end = i + 1;
+
+          if (is_boundary (map, length, start) &&
+              is_boundary (map, length, end))
+            {
+              if (map != NULL)
+                func (match_state->pattern_id, map[start], map[end], data);
+              else
+                func (match_state->pattern_id, start, end, data);
+            }
+
+          match = match_state->output;
+        }
+    }
+
+  g_free (map);
+  g_free (folded);
+}
@@ -0,0 +1,61 @@
+/* twitter-pattern-set.h: Multi-pattern string matching
+ *
+ * This file is part of Twitter-GLib.
+ * Copyright (C) 2008  Emmanuele Bassi  <ebassi@gnome.org>
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef __TWITTER_PATTERN_SET_H__
+#define __TWITTER_PATTERN_SET_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/*
+ * TwitterPatternSet:
+ *
+ * A set of case insensitive patterns, compiled into an Aho-Corasick
+ * automaton so that a text is scanned only once, however many
+ * patterns are in the set.
+ */
+typedef struct _TwitterPatternSet       TwitterPatternSet;
+
+/*
+ * TwitterPatternFunc:
+ * @pattern_id: the id of the matching pattern
+ * @start: the byte offset of the match inside the text
+ * @end: the byte offset of the end of the match
+ * @data: the data passed to _twitter_pattern_set_match()
+ *
+ * Called for each occurrence of a pattern inside the text
+ */
+typedef void (* TwitterPatternFunc) (guint    pattern_id,
+                                     gsize    start,
+                                     gsize    end,
+                                     gpointer data);
+
+TwitterPatternSet *_twitter_pattern_set_new   (void);
+void               _twitter_pattern_set_free  (TwitterPatternSet  *set);
+guint              _twitter_pattern_set_add   (TwitterPatternSet  *set,
+                                               const gchar        *pattern);
+guint              _twitter_pattern_set_size  (TwitterPatternSet  *set);
+void               _twitter_pattern_set_match (TwitterPatternSet  *set,
+                                               const gchar        *text,
+                                               TwitterPatternFunc  func,
+                                               gpointer            data);
+
+G_END_DECLS
+
+#endif /* __TWITTER_PATTERN_SET_H__ */
@@ -20,8 +20,16 @@
 #define __TWITTER_PRIVATE_H__
 
 #include <json-glib/json-glib.h>
+#include <libsoup/soup.h>
+
+#include "twitter-client.h"
+#include "twitter-client-pool.h"
+#include "twitter-json-decoder.h"
+#include "twitter-record.h"
 #include "twitter-status.h"
+#include "twitter-timeline.h"
 #include "twitter-user.h"
+#include "twitter-user-list.h"
 
 G_BEGIN_DECLS
 
@@ -33,6 +41,46 @@ TwitterUser   *twitter_user_new_from_node   (JsonNode *node);
 void           _twitter_status_set_user     (TwitterStatus *status,
                                              TwitterUser   *user);
 
+void           _twitter_status_decode        (TwitterStatus         *status,
+                                              TwitterJsonDecoder    *decoder);
+void           _twitter_user_decode          (TwitterUser           *user,
+                                              TwitterJsonDecoder    *decoder);
+
+void           _twitter_status_write_record  (TwitterStatus       *status,
+                                              TwitterRecordWriter *record);
+gboolean       _twitter_status_read_record   (TwitterStatus       *status,
+                                              TwitterRecordReader *reader,
+                                              guint               *user_id);
+void           _twitter_user_write_record    (TwitterUser         *user,
+                                              TwitterRecordWriter *record);
+gboolean       _twitter_user_read_record     (TwitterUser         *user,
+                                              TwitterRecordReader *reader);
+
+void           _twitter_timeline_add_statuses (TwitterTimeline     *timeline,
+                                               GPtrArray           *statuses);
+void           _twitter_user_list_replace     (TwitterUserList     *user_list,
+                                               guint                index_,
+                                               TwitterUser         *user);
+
+void           _twitter_user_set_session         (TwitterUser   *user,
+                                                  SoupSession   *session);
+void           _twitter_user_update              (TwitterUser   *user,
+                                                  TwitterUser   *source);
+
+gboolean       _twitter_date_parse               (const gchar   *date,
+                                                  gssize         len,
+                                                  gint64        *timestamp);
+gint64         _twitter_date_to_timestamp        (const gchar   *date,
+                                                  gssize         len);
+
+void           _twitter_client_set_pool          (TwitterClient     *client,
+                                                  TwitterClientPool *pool);
+void           _twitter_client_authenticate      (SoupMessage       *msg,
+                                                  SoupAuth          *auth,
+                                                  gboolean           retrying);
+TwitterUser *  _twitter_client_pool_cache_user   (TwitterClientPool *pool,
+                                                  TwitterUser       *user);
+
 G_END_DECLS
 
 #endif /* __TWITTER_PRIVATE_H__ */
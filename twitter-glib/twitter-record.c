@@ -0,0 +1,391 @@
+/* twitter-record.c: Compact binary records
+ *
+ * This file is part of Twitter-GLib.
+ * Copyright (C) 2008  Emmanuele Bassi  <ebassi@gnome.org>
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* The records are a sequence of fields without any framing: integers
+ * are stored in little endian order with a fixed width, and strings
+ * are prefixed by their length, with a length of G_MAXUINT32 marking
+ * a %NULL string.
+ *
+ * The binary format used to save statuses, users and their containers
+ * wraps the records inside a versioned header, and stores each string
+ * once inside a table, so that the strings repeated by many statuses
+ * (sources, users, profile images) only take four bytes each:
+ *
+ *   magic      "TWGB"
+ *   version    uint32
+ *   kind       uint32, a TwitterRecordKind
+ *   n_strings  uint32
+ *   strings    n_strings times: length uint32, bytes
+ *   records    strings are stored as the uint32 index in the table,
+ *              G_MAXUINT32 for %NULL
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include "twitter-common.h"
+#include "twitter-intern-pool.h"
+#include "twitter-record.h"
+
+#define NULL_STRING     G_MAXUINT32
+
+#define BINARY_MAGIC            "TWGB"
+#define BINARY_MAGIC_SIZE       4
+
+void
+_twitter_record_writer_init (TwitterRecordWriter *writer,
+                             gboolean             use_string_table)
+{
+  writer->buffer = g_string_sized_new (256);
+
+  if (use_string_table)
+    {
+      writer->string_ids = g_hash_table_new (g_str_hash, g_str_equal);
+      writer->strings = g_ptr_array_new ();
+    }
+  else
+    {
+      writer->string_ids = NULL;
+      writer->strings = NULL;
+    }
+}
+
+void
+_twitter_record_writer_clear (TwitterRecordWriter *writer)
+{
+  if (writer->buffer != NULL)
+    g_string_free (writer->buffer, TRUE);
+
+  if (writer->string_ids != NULL)
+    {
+      g_hash_table_destroy (writer->string_ids);
+      g_ptr_array_free (writer->strings, TRUE);
+    }
+
+  writer->buffer = NULL;
+  writer->string_ids = NULL;
+  writer->strings = NULL;
+}
+
+static void
+append_uint32 (GString *buffer,
+               guint32  value)
+{
+  guint32 le_value = GUINT32_TO_LE (value);
+
+  g_string_append_len (buffer, (const gchar *) &le_value, sizeof (le_value));
+}
+
+static void
+append_string (GString     *buffer,
+               const gchar *str)
+{
+  gsize len = strlen (str);
+
+  append_uint32 (buffer, len);
+  g_string_append_len (buffer, str, len);
+}
+
+/* returns the header, the string table and the records written by
+ * @writer, which must use a string table, and clears @writer
+ */
+gchar *
+_twitter_record_writer_finish (TwitterRecordWriter *writer,
+                               TwitterRecordKind    kind,
+                               gsize               *length)
+{
+  GString *retval;
+  guint i;
+
+  g_assert (writer->strings != NULL);
+
+  retval = g_string_sized_new (writer->buffer->len + 256);
+
+  g_string_append_len (retval, BINARY_MAGIC, BINARY_MAGIC_SIZE);
+  append_uint32 (retval, TWITTER_RECORD_VERSION);
+  append_uint32 (retval, kind);
+
+  append_uint32 (retval, writer->strings->len);
+  for (i = 0; i < writer->strings->len; i++)
+    append_string (retval, g_ptr_array_index (writer->strings, i));
+
+  g_string_append_len (retval, writer->buffer->str, writer->buffer->len);
+
+  _twitter_record_writer_clear (writer);
+
+  *length = retval->len;
+
+  return g_string_free (retval, FALSE);
+}
+
+void
+_twitter_record_write_uint32 (TwitterRecordWriter *writer,
+                              guint32              value)
+{
+  append_uint32 (writer->buffer, value);
+}
+
+void
+_twitter_record_write_int64 (TwitterRecordWriter *writer,
+                             gint64               value)
+{
+  gint64 le_value = GINT64_TO_LE (value);
+
+  g_string_append_len (writer->buffer,
+                       (const gchar *) &le_value,
+                       sizeof (le_value));
+}
+
+void
+_twitter_record_write_string (TwitterRecordWriter *writer,
+                              const gchar         *str)
+{
+  guint index_;
+
+  if (str == NULL)
+    {
+      append_uint32 (writer->buffer, NULL_STRING);
+      return;
+    }
+
+  if (writer->string_ids == NULL)
+    {
+      append_string (writer->buffer, str);
+      return;
+    }
+
+  index_ = GPOINTER_TO_UINT (g_hash_table_lookup (writer->string_ids, str));
+  if (index_ == 0)
+    {
+      g_ptr_array_add (writer->strings, (gpointer) str);
+      index_ = writer->strings->len;
+
+      g_hash_table_insert (writer->string_ids,
+                           (gpointer) str,
+                           GUINT_TO_POINTER (index_));
+    }
+
+  append_uint32 (writer->buffer, index_ - 1);
+}
+
+void
+_twitter_record_reader_init (TwitterRecordReader *reader,
+                             const gchar         *data,
+                             gsize                length)
+{
+  reader->cursor = data;
+  reader->end = data + length;
+  reader->strings = NULL;
+  reader->n_strings = 0;
+  reader->failed = FALSE;
+}
+
+/* checks the header of the binary data in @data, and reads its
+ * string table; the strings point inside @data, which must stay
+ * valid while @reader is used. Use _twitter_record_reader_clear()
+ * to release the table
+ */
+gboolean
+_twitter_record_reader_init_binary (TwitterRecordReader  *reader,
+                                    const gchar          *data,
+                                    gsize                 length,
+                                    TwitterRecordKind     kind,
+                                    GError              **error)
+{
+  TwitterRecordString *strings;
+  guint32 version, n_strings;
+  guint i;
+
+  _twitter_record_reader_init (reader, data, length);
+
+  if (length < BINARY_MAGIC_SIZE ||
+      memcmp (data, BINARY_MAGIC, BINARY_MAGIC_SIZE) != 0)
+    goto invalid;
+
+  reader->cursor += BINARY_MAGIC_SIZE;
+
+  version = _twitter_record_read_uint32 (reader);
+  if (version > TWITTER_RECORD_VERSION)
+    {
+      g_set_error (error, TWITTER_ERROR,
+                   TWITTER_ERROR_PARSE_ERROR,
+                   "Unsupported version %u of the binary format",
+                   version);
+      return FALSE;
+    }
+
+  if (_twitter_record_read_uint32 (reader) != kind)
+    goto invalid;
+
+  n_strings = _twitter_record_read_uint32 (reader);
+
+  /* each string takes at least four bytes */
+  if (reader->failed || n_strings > (reader->end - reader->cursor) / 4)
+    goto invalid;
+
+  strings = g_new (TwitterRecordString, n_strings);
+
+  for (i = 0; i < n_strings; i++)
+    {
+      strings[i].data = _twitter_record_read_string_data (reader,
+                                                          &strings[i].length);
+      if (strings[i].data == NULL)
+        {
+          g_free (strings);
+          goto invalid;
+        }
+    }
+
+  reader->strings = strings;
+  reader->n_strings = n_strings;
+
+  return TRUE;
+
+invalid:
+  g_set_error (error, TWITTER_ERROR,
+               TWITTER_ERROR_PARSE_ERROR,
+               "Invalid binary data");
+
+  return FALSE;
+}
+
+void
+_twitter_record_reader_clear (TwitterRecordReader *reader)
+{
+  g_free (reader->strings);
+  reader->strings = NULL;
+  reader->n_strings = 0;
+}
+
+gboolean
+_twitter_record_reader_failed (TwitterRecordReader *reader)
+{
+  return reader->failed;
+}
+
+/* returns the next @length bytes of the record, or %NULL */
+static const gchar *
+read_bytes (TwitterRecordReader *reader,
+            gsize                length)
+{
+  const gchar *retval;
+
+  if (reader->failed || (gsize) (reader->end - reader->cursor) < length)
+    {
+      reader->failed = TRUE;
+      return NULL;
+    }
+
+  retval = reader->cursor;
+  reader->cursor += length;
+
+  return retval;
+}
+
+guint32
+_twitter_record_read_uint32 (TwitterRecordReader *reader)
+{
+  const gchar *data = read_bytes (reader, sizeof (guint32));
+  guint32 value;
+
+  if (data == NULL)
+    return 0;
+
+  memcpy (&value, data, sizeof (value));
+
+  return GUINT32_FROM_LE (value);
+}
+
+gint64
+_twitter_record_read_int64 (TwitterRecordReader *reader)
+{
+  const gchar *data = read_bytes (reader, sizeof (gint64));
+  gint64 value;
+
+  if (data == NULL)
+    return 0;
+
+  memcpy (&value, data, sizeof (value));
+
+  return GINT64_FROM_LE (value);
+}
+
+/* returns the data of the next string, which is not nul terminated,
+ * or %NULL
+ */
+const gchar *
+_twitter_record_read_string_data (TwitterRecordReader *reader,
+                                  gsize               *len)
+{
+  guint32 value;
+
+  value = _twitter_record_read_uint32 (reader);
+  if (reader->failed || value == NULL_STRING)
+    return NULL;
+
+  if (reader->strings != NULL)
+    {
+      if (value >= reader->n_strings)
+        {
+          reader->failed = TRUE;
+          return NULL;
+        }
+
+      *len = reader->strings[value].length;
+
+      return reader->strings[value].data;
+    }
+
+  *len = value;
+
+  return read_bytes (reader, value);
+}
+
+/* returns a newly allocated copy of the next string */
+gchar *
+_twitter_record_read_string (TwitterRecordReader *reader)
+{
+  const gchar *data;
+  gsize len = 0;
+
+  data = _twitter_record_read_string_data (reader, &len);
+  if (data == NULL)
+    return NULL;
+
+  return g_strndup (data, len);
+}
+
+/* returns the next string out of the intern pool; use
+ * _twitter_intern_pool_release() to release it
+ */
+const gchar *
+_twitter_record_read_interned (TwitterRecordReader *reader)
+{
+  const gchar *data;
+  gsize len = 0;
+
+  data = _twitter_record_read_string_data (reader, &len);
+  if (data == NULL)
+    return NULL;
+
+  return _twitter_intern_pool_acquire (data, len);
+}
@@ -0,0 +1,112 @@
+/* twitter-record.h: Compact binary records
+ *
+ * This file is part of Twitter-GLib.
+ * Copyright (C) 2008  Emmanuele Bassi  <ebassi@gnome.org>
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef __TWITTER_RECORD_H__
+#define __TWITTER_RECORD_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/* the version of the binary format written by
+ * _twitter_record_writer_finish()
+ */
+#define TWITTER_RECORD_VERSION  1
+
+typedef enum {
+  TWITTER_RECORD_STATUS = 1,
+  TWITTER_RECORD_USER,
+  TWITTER_RECORD_TIMELINE,
+  TWITTER_RECORD_USER_LIST
+} TwitterRecordKind;
+
+typedef struct {
+  const gchar *data;
+  gsize length;
+} TwitterRecordString;
+
+/*
+ * TwitterRecordWriter:
+ *
+ * Appends fields to a buffer. Strings are either written inline, or
+ * stored once inside a table and referenced by their index; the
+ * table is written by _twitter_record_writer_finish(), and the
+ * strings must stay valid until then.
+ */
+typedef struct {
+  GString *buffer;
+
+  /* string -> index + 1, if strings are stored in a table */
+  GHashTable *string_ids;
+  GPtrArray *strings;
+} TwitterRecordWriter;
+
+/*
+ * TwitterRecordReader:
+ *
+ * Reads the fields written by a #TwitterRecordWriter out of a buffer,
+ * in the same order. Every read is bounds checked: reading past the
+ * end of the buffer sets the failed flag, and any following read
+ * returns zero or %NULL.
+ */
+typedef struct {
+  const gchar *cursor;
+  const gchar *end;
+
+  /* the string table, if strings are referenced by index */
+  TwitterRecordString *strings;
+  guint n_strings;
+
+  guint failed : 1;
+} TwitterRecordReader;
+
+void         _twitter_record_writer_init    (TwitterRecordWriter *writer,
+                                             gboolean             use_string_table);
+void         _twitter_record_writer_clear   (TwitterRecordWriter *writer);
+gchar *      _twitter_record_writer_finish  (TwitterRecordWriter *writer,
+                                             TwitterRecordKind    kind,
+                                             gsize               *length);
+
+void         _twitter_record_write_uint32   (TwitterRecordWriter *writer,
+                                             guint32              value);
+void         _twitter_record_write_int64    (TwitterRecordWriter *writer,
+                                             gint64               value);
+void         _twitter_record_write_string   (TwitterRecordWriter *writer,
+                                             const gchar         *str);
+
+void         _twitter_record_reader_init    (TwitterRecordReader *reader,
+                                             const gchar         *data,
+                                             gsize                length);
+gboolean     _twitter_record_reader_init_binary (TwitterRecordReader *reader,
+                                                 const gchar         *data,
+                                                 gsize                length,
+                                                 TwitterRecordKind    kind,
+                                                 GError             **error);
+void         _twitter_record_reader_clear   (TwitterRecordReader *reader);
+gboolean     _twitter_record_reader_failed  (TwitterRecordReader *reader);
+
+guint32      _twitter_record_read_uint32    (TwitterRecordReader *reader);
+gint64       _twitter_record_read_int64     (TwitterRecordReader *reader);
+const gchar *_twitter_record_read_string_data (TwitterRecordReader *reader,
+                                               gsize               *len);
+gchar *      _twitter_record_read_string    (TwitterRecordReader *reader);
+const gchar *_twitter_record_read_interned  (TwitterRecordReader *reader);
+
+G_END_DECLS
+
+#endif /* __TWITTER_RECORD_H__ */
@@ -0,0 +1,556 @@
+/* twitter-status-batch.c: Columnar storage of statuses
+ *
+ * This file is part of Twitter-GLib.
+ * Copyright (C) 2008  Emmanuele Bassi  <ebassi@gnome.org>
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:twitter-status-batch
+ * @short_description: Columnar storage of statuses
+ *
+ * #TwitterStatusBatch stores the statuses of one or more pages of a
+ * timeline without creating a #TwitterStatus for each of them. The
+ * ids, the ids of the authors and the timestamps of the statuses are
+ * kept inside arrays, which can be scanned directly; the texts are
+ * kept inside a single buffer.
+ *
+ * A #TwitterStatus is only created when requested using
+ * twitter_status_batch_get_status(), by decoding again the JSON
+ * description of that status alone.
+ *
+ * |[
+ *   const guint *user_ids = twitter_status_batch_get_user_ids (batch);
+ *   guint i, n_statuses = twitter_status_batch_get_count (batch);
+ *
+ *   for (i = 0; i &lt; n_statuses; i++)
+ *     {
+ *       if (user_ids[i] == user_id)
+ *         n_posted += 1;
+ *     }
+ * ]|
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include <glib.h>
+
+#include "twitter-common.h"
+#include "twitter-private.h"
+#include "twitter-status.h"
+#include "twitter-status-batch.h"
+
+#define TWITTER_STATUS_BATCH_GET_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE ((obj), TWITTER_TYPE_STATUS_BATCH, TwitterStatusBatchPrivate))
+
+/* the text offset of the statuses without a text */
+#define NO_TEXT         G_MAXUINT
+
+struct _TwitterStatusBatchPrivate
+{
+  /* the copies of the pages, and the index of the first status of
+   * each of them
+   */
+  GPtrArray *pages;
+  GArray *page_starts;
+
+  /* one element for each status */
+  GArray *ids;
+  GArray *user_ids;
+  GArray *timestamps;
+  GArray *text_offsets;
+
+  /* the JSON object of each status, inside its page */
+  GArray *spans;
+
+  /* every text, nul-terminated */
+  GString *text;
+};
+
+G_DEFINE_TYPE (TwitterStatusBatch, twitter_status_batch, G_TYPE_OBJECT);
+
+static void
+unref_page (gpointer data,
+            gpointer user_data)
+{
+  _twitter_json_buffer_unref (data);
+}
+
+static void
+twitter_status_batch_finalize (GObject *gobject)
+{
+  TwitterStatusBatchPrivate *priv = TWITTER_STATUS_BATCH (gobject)->priv;
+
+  g_ptr_array_foreach (priv->pages, unref_page, NULL);
+  g_ptr_array_free (priv->pages, TRUE);
+  g_array_free (priv->page_starts, TRUE);
+
+  g_array_free (priv->ids, TRUE);
+  g_array_free (priv->user_ids, TRUE);
+  g_array_free (priv->timestamps, TRUE);
+  g_array_free (priv->text_offsets, TRUE);
+  g_array_free (priv->spans, TRUE);
+
+  g_string_free (priv->text, TRUE);
+
+  G_OBJECT_CLASS (twitter_status_batch_parent_class)->finalize (gobject);
+}
+
+static void
+twitter_status_batch_class_init (TwitterStatusBatchClass *klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  g_type_class_add_private (klass, sizeof (TwitterStatusBatchPrivate));
+
+  gobject_class->finalize = twitter_status_batch_finalize;
+}
+
+static void
+twitter_status_batch_init (TwitterStatusBatch *batch)
+{
+  TwitterStatusBatchPrivate *priv;
+
+  batch->priv = priv = TWITTER_STATUS_BATCH_GET_PRIVATE (batch);
+
+  priv->pages = g_ptr_array_new ();
+  priv->page_starts = g_array_new (FALSE, FALSE, sizeof (guint));
+
+  priv->ids = g_array_new (FALSE, FALSE, sizeof (guint));
+  priv->user_ids = g_array_new (FALSE, FALSE, sizeof (guint));
+  priv->timestamps = g_array_new (FALSE, FALSE, sizeof (gint64));
+  priv->text_offsets = g_array_new (FALSE, FALSE, sizeof (guint));
+  priv->spans = g_array_new (FALSE, FALSE, sizeof (TwitterJsonSpan));
+
+  priv->text = g_string_new (NULL);
+}
+
+/**
+ * twitter_status_batch_new:
+ *
+ * Creates a new, empty #TwitterStatusBatch
+ *
+ * Return value: the newly created #TwitterStatusBatch. Use
+ *   g_object_unref() to free the allocated resources
+ *
+ * Since: 0.9.10
+ */
+TwitterStatusBatch *
+twitter_status_batch_new (void)
+{
+  return g_object_new (TWITTER_TYPE_STATUS_BATCH, NULL);
+}
+
+/* reads the id of the user object at the cursor */
+static guint
+decode_user_id (TwitterJsonDecoder *decoder)
+{
+  const gchar *key;
+  gsize len;
+  guint retval = 0;
+
+  if (!_twitter_json_decoder_begin_object (decoder))
+    {
+      _twitter_json_decoder_skip (decoder);
+      return 0;
+    }
+
+  while (_twitter_json_decoder_next_member (decoder, &key, &len))
+    {
+      if (TWITTER_JSON_KEY_IS (key, len, "id"))
+        retval = _twitter_json_decoder_read_int (decoder);
+      else
+        _twitter_json_decoder_skip (decoder);
+    }
+
+  return retval;
+}
+
+/* appends the status whose JSON object is @span to the columns;
+ * only the fields stored inside the columns are decoded
+ */
+static gboolean
+twitter_status_batch_decode_status (TwitterStatusBatch       *batch,
+                                    const TwitterJsonDecoder *parent,
+                                    const TwitterJsonSpan    *span)
+{
+  TwitterStatusBatchPrivate *priv = batch->priv;
+  TwitterJsonDecoder decoder;
+  const gchar *key;
+  gsize len;
+  guint id = 0, user_id = 0, text_offset = NO_TEXT;
+  gint64 timestamp = 0;
+
+  _twitter_json_decoder_init_from_span (&decoder, parent, span);
+
+  if (!_twitter_json_decoder_begin_object (&decoder))
+    return FALSE;
+
+  while (_twitter_json_decoder_next_member (&decoder, &key, &len))
+    {
+      if (TWITTER_JSON_KEY_IS (key, len, "id"))
+        id = _twitter_json_decoder_read_int (&decoder);
+      else if (TWITTER_JSON_KEY_IS (key, len, "user"))
+        user_id = decode_user_id (&decoder);
+      else if (TWITTER_JSON_KEY_IS (key, len, "text"))
+        {
+          gchar *text = _twitter_json_decoder_read_string (&decoder);
+
+          if (text != NULL)
+            {
+              text_offset = priv->text->len;
+              g_string_append_len (priv->text, text, strlen (text) + 1);
+              g_free (text);
+            }
+        }
+      else if (TWITTER_JSON_KEY_IS (key, len, "created_at") &&
+               _twitter_json_decoder_peek (&decoder) == TWITTER_JSON_STRING)
+        {
+          TwitterJsonSpan date;
+
+          /* the span of the string is still quoted */
+          if (_twitter_json_decoder_read_span (&decoder, &date))
+            timestamp = _twitter_date_to_timestamp (date.start + 1,
+                                                    date.length - 2);
+        }
+      else
+        _twitter_json_decoder_skip (&decoder);
+    }
+
+  if (!_twitter_json_decoder_at_end (&decoder))
+    return FALSE;
+
+  g_array_append_val (priv->ids, id);
+  g_array_append_val (priv->user_ids, user_id);
+  g_array_append_val (priv->timestamps, timestamp);
+  g_array_append_val (priv->text_offsets, text_offset);
+  g_array_append_val (priv->spans, *span);
+
+  return TRUE;
+}
+
+/* removes the statuses starting from @n_statuses, and the text
+ * starting from @text_len
+ */
+static void
+twitter_status_batch_truncate (TwitterStatusBatch *batch,
+                               guint               n_statuses,
+                               gsize               text_len)
+{
+  TwitterStatusBatchPrivate *priv = batch->priv;
+
+  g_array_set_size (priv->ids, n_statuses);
+  g_array_set_size (priv->user_ids, n_statuses);
+  g_array_set_size (priv->timestamps, n_statuses);
+  g_array_set_size (priv->text_offsets, n_statuses);
+  g_array_set_size (priv->spans, n_statuses);
+
+  g_string_truncate (priv->text, text_len);
+}
+
+/**
+ * twitter_status_batch_add_from_data:
+ * @batch: a #TwitterStatusBatch
+ * @buffer: a %NULL-terminated string containing the JSON description
+ *   of a timeline
+ * @error: return location for a #GError, or %NULL
+ *
+ * Adds the statuses described by @buffer to @batch, after the
+ * statuses already inside @batch. On error, @batch is not modified
+ * and @error will be set accordingly.
+ *
+ * Return value: %TRUE if @buffer was successfully parsed, %FALSE
+ *   otherwise
+ *
+ * Since: 0.9.10
+ */
+gboolean
+twitter_status_batch_add_from_data (TwitterStatusBatch  *batch,
+                                    const gchar         *buffer,
+                                    GError             **error)
+{
+  TwitterStatusBatchPrivate *priv;
+  TwitterJsonBuffer *page;
+  TwitterJsonDecoder decoder;
+  guint n_statuses;
+  gsize text_len;
+  gboolean failed = FALSE;
+
+  g_return_val_if_fail (TWITTER_IS_STATUS_BATCH (batch), FALSE);
+  g_return_val_if_fail (buffer != NULL, FALSE);
+
+  priv = batch->priv;
+
+  n_statuses = priv->ids->len;
+  text_len = priv->text->len;
+
+  /* the spans point inside our copy of the page */
+  page = _twitter_json_buffer_new (buffer, strlen (buffer));
+  _twitter_json_decoder_init_lazy (&decoder, page, page->data, page->length);
+
+  /* anything but an array is an empty list */
+  if (!_twitter_json_decoder_begin_array (&decoder))
+    {
+      _twitter_json_decoder_skip (&decoder);
+      failed = !_twitter_json_decoder_at_end (&decoder);
+    }
+  else
+    {
+      while (!failed && _twitter_json_decoder_next_element (&decoder))
+        {
+          TwitterJsonSpan span;
+
+          if (_twitter_json_decoder_peek (&decoder) != TWITTER_JSON_OBJECT)
+            {
+              _twitter_json_decoder_skip (&decoder);
+              continue;
+            }
+
+          if (!_twitter_json_decoder_read_span (&decoder, &span) ||
+              !twitter_status_batch_decode_status (batch, &decoder, &span))
+            failed = TRUE;
+        }
+
+      if (!failed)
+        failed = !_twitter_json_decoder_at_end (&decoder);
+    }
+
+  if (failed)
+    {
+      twitter_status_batch_truncate (batch, n_statuses, text_len);
+      _twitter_json_buffer_unref (page);
+
+      g_set_error (error, TWITTER_ERROR,
+                   TWITTER_ERROR_PARSE_ERROR,
+                   "Parse error (invalid timeline)");
+
+      return FALSE;
+    }
+
+  if (priv->ids->len == n_statuses)
+    _twitter_json_buffer_unref (page);
+  else
+    {
+      g_ptr_array_add (priv->pages, page);
+      g_array_append_val (priv->page_starts, n_statuses);
+    }
+
+  return TRUE;
+}
+
+/**
+ * twitter_status_batch_clear:
+ * @batch: a #TwitterStatusBatch
+ *
+ * Removes every status from @batch
+ *
+ * Since: 0.9.10
+ */
+void
+twitter_status_batch_clear (TwitterStatusBatch *batch)
+{
+  TwitterStatusBatchPrivate *priv;
+
+  g_return_if_fail (TWITTER_IS_STATUS_BATCH (batch));
+
+  priv = batch->priv;
+
+  twitter_status_batch_truncate (batch, 0, 0);
+
+  g_ptr_array_foreach (priv->pages, unref_page, NULL);
+  g_ptr_array_set_size (priv->pages, 0);
+  g_array_set_size (priv->page_starts, 0);
+}
+
+/**
+ * twitter_status_batch_get_count:
+ * @batch: a #TwitterStatusBatch
+ *
+ * Retrieves the number of statuses inside @batch, which is the
+ * length of the arrays returned by twitter_status_batch_get_ids(),
+ * twitter_status_batch_get_user_ids() and
+ * twitter_status_batch_get_timestamps()
+ *
+ * Return value: the number of statuses
+ *
+ * Since: 0.9.10
+ */
+guint
+twitter_status_batch_get_count (TwitterStatusBatch *batch)
+{
+  g_return_val_if_fail (TWITTER_IS_STATUS_BATCH (batch), 0);
+
+  return batch->priv->ids->len;
+}
+
+/**
+ * twitter_status_batch_get_ids:
+ * @batch: a #TwitterStatusBatch
+ *
+ * Retrieves the ids of the statuses inside @batch, in the order of
+ * the pages they were added from
+ *
+ * Return value: (array): the ids of the statuses, owned by @batch
+ *   and valid until @batch is modified
+ *
+ * Since: 0.9.10
+ */
+const guint *
+twitter_status_batch_get_ids (TwitterStatusBatch *batch)
+{
+  g_return_val_if_fail (TWITTER_IS_STATUS_BATCH (batch), NULL);
+
+  return (const guint *) batch->priv->ids->data;
+}
+
+/**
+ * twitter_status_batch_get_user_ids:
+ * @batch: a #TwitterStatusBatch
+ *
+ * Retrieves the ids of the authors of the statuses inside @batch;
+ * the id is 0 for statuses without an author
+ *
+ * Return value: (array): the ids of the authors, owned by @batch
+ *   and valid until @batch is modified
+ *
+ * Since: 0.9.10
+ */
+const guint *
+twitter_status_batch_get_user_ids (TwitterStatusBatch *batch)
+{
+  g_return_val_if_fail (TWITTER_IS_STATUS_BATCH (batch), NULL);
+
+  return (const guint *) batch->priv->user_ids->data;
+}
+
+/**
+ * twitter_status_batch_get_timestamps:
+ * @batch: a #TwitterStatusBatch
+ *
+ * Retrieves the creation times of the statuses inside @batch, in
+ * seconds from the epoch, like twitter_status_get_timestamp()
+ *
+ * Return value: (array): the timestamps, owned by @batch and valid
+ *   until @batch is modified
+ *
+ * Since: 0.9.10
+ */
+const gint64 *
+twitter_status_batch_get_timestamps (TwitterStatusBatch *batch)
+{
+  g_return_val_if_fail (TWITTER_IS_STATUS_BATCH (batch), NULL);
+
+  return (const gint64 *) batch->priv->timestamps->data;
+}
+
+/**
+ * twitter_status_batch_get_text:
+ * @batch: a #TwitterStatusBatch
+ * @index_: the position of a status
+ *
+ * Retrieves the text of the status at @index_
+ *
+ * Return value: the text of the status, owned by @batch and valid
+ *   until @batch is modified, or %NULL
+ *
+ * Since: 0.9.10
+ */
+const gchar *
+twitter_status_batch_get_text (TwitterStatusBatch *batch,
+                               guint               index_)
+{
+  TwitterStatusBatchPrivate *priv;
+  guint offset;
+
+  g_return_val_if_fail (TWITTER_IS_STATUS_BATCH (batch), NULL);
+
+  priv = batch->priv;
+
+  g_return_val_if_fail (index_ < priv->ids->len, NULL);
+
+  offset = g_array_index (priv->text_offsets, guint, index_);
+  if (offset == NO_TEXT)
+    return NULL;
+
+  return priv->text->str + offset;
+}
+
+/* finds the page containing the status at @index_ */
+static TwitterJsonBuffer *
+twitter_status_batch_lookup_page (TwitterStatusBatch *batch,
+                                  guint               index_)
+{
+  TwitterStatusBatchPrivate *priv = batch->priv;
+  const guint *starts = (const guint *) priv->page_starts->data;
+  guint low = 0, high = priv->page_starts->len;
+
+  /* the last page starting before @index_ */
+  while (high - low > 1)
+    {
+      guint middle = low + (high - low) / 2;
+
+      if (starts[middle] <= index_)
+        low = middle;
+      else
+        high = middle;
+    }
+
+  return g_ptr_array_index (priv->pages, low);
+}
+
+/**
+ * twitter_status_batch_get_status:
+ * @batch: a #TwitterStatusBatch
+ * @index_: the position of a status
+ *
+ * Creates a #TwitterStatus for the status at @index_, with all the
+ * fields of its JSON description; the less used strings are decoded
+ * lazily, as with %TWITTER_PARSE_LAZY.
+ *
+ * Return value: a newly created #TwitterStatus, with a floating
+ *   reference
+ *
+ * Since: 0.9.10
+ */
+TwitterStatus *
+twitter_status_batch_get_status (TwitterStatusBatch *batch,
+                                 guint               index_)
+{
+  TwitterStatusBatchPrivate *priv;
+  TwitterJsonDecoder decoder;
+  TwitterJsonSpan *span;
+  TwitterJsonBuffer *page;
+  TwitterStatus *retval;
+
+  g_return_val_if_fail (TWITTER_IS_STATUS_BATCH (batch), NULL);
+
+  priv = batch->priv;
+
+  g_return_val_if_fail (index_ < priv->ids->len, NULL);
+
+  span = &g_array_index (priv->spans, TwitterJsonSpan, index_);
+  page = twitter_status_batch_lookup_page (batch, index_);
+
+  /* the lazy strings hold a reference on the page */
+  _twitter_json_decoder_init_lazy (&decoder, page, span->start, span->length);
+
+  retval = twitter_status_new ();
+  _twitter_status_decode (retval, &decoder);
+
+  return retval;
+}
@@ -0,0 +1,85 @@
+/* twitter-status-batch.h: Columnar storage of statuses
+ *
+ * This file is part of Twitter-GLib.
+ * Copyright (C) 2008  Emmanuele Bassi  <ebassi@gnome.org>
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef __TWITTER_STATUS_BATCH_H__
+#define __TWITTER_STATUS_BATCH_H__
+
+#include <glib-object.h>
+
+#include <twitter-glib/twitter-status.h>
+
+G_BEGIN_DECLS
+
+#define TWITTER_TYPE_STATUS_BATCH               (twitter_status_batch_get_type ())
+#define TWITTER_STATUS_BATCH(obj)               (G_TYPE_CHECK_INSTANCE_CAST ((obj), TWITTER_TYPE_STATUS_BATCH, TwitterStatusBatch))
+#define TWITTER_IS_STATUS_BATCH(obj)            (G_TYPE_CHECK_INSTANCE_TYPE ((obj), TWITTER_TYPE_STATUS_BATCH))
+#define TWITTER_STATUS_BATCH_CLASS(klass)       (G_TYPE_CHECK_CLASS_CAST ((klass), TWITTER_TYPE_STATUS_BATCH, TwitterStatusBatchClass))
+#define TWITTER_IS_STATUS_BATCH_CLASS(klass)    (G_TYPE_CHECK_CLASS_TYPE ((klass), TWITTER_TYPE_STATUS_BATCH))
+#define TWITTER_STATUS_BATCH_GET_CLASS(obj)     (G_TYPE_INSTANCE_GET_CLASS ((obj), TWITTER_TYPE_STATUS_BATCH, TwitterStatusBatchClass))
+
+typedef struct _TwitterStatusBatch              TwitterStatusBatch;
+typedef struct _TwitterStatusBatchPrivate       TwitterStatusBatchPrivate;
+typedef struct _TwitterStatusBatchClass         TwitterStatusBatchClass;
+
+/**
+ * TwitterStatusBatch:
+ *
+ * The #TwitterStatusBatch struct contains private data only, and
+ * should only be accessed using the functions below.
+ */
+struct _TwitterStatusBatch
+{
+  /*< private >*/
+  GObject parent_instance;
+
+  TwitterStatusBatchPrivate *priv;
+};
+
+/**
+ * TwitterStatusBatchClass:
+ *
+ * The #TwitterStatusBatchClass struct contains only private data
+ */
+struct _TwitterStatusBatchClass
+{
+  /*< private >*/
+  GObjectClass parent_class;
+};
+
+GType               twitter_status_batch_get_type       (void) G_GNUC_CONST;
+
+TwitterStatusBatch *twitter_status_batch_new            (void);
+
+gboolean            twitter_status_batch_add_from_data  (TwitterStatusBatch  *batch,
+                                                         const gchar         *buffer,
+                                                         GError             **error);
+void                twitter_status_batch_clear          (TwitterStatusBatch  *batch);
+guint               twitter_status_batch_get_count      (TwitterStatusBatch  *batch);
+
+const guint *       twitter_status_batch_get_ids        (TwitterStatusBatch  *batch);
+const guint *       twitter_status_batch_get_user_ids   (TwitterStatusBatch  *batch);
+const gint64 *      twitter_status_batch_get_timestamps (TwitterStatusBatch  *batch);
+const gchar *       twitter_status_batch_get_text       (TwitterStatusBatch  *batch,
+                                                         guint                index_);
+
+TwitterStatus *     twitter_status_batch_get_status     (TwitterStatusBatch  *batch,
+                                                         guint                index_);
+
+G_END_DECLS
+
+#endif /* __TWITTER_STATUS_BATCH_H__ */
@@ -0,0 +1,695 @@
+/* twitter-status-index.c: Indexed collection of statuses
+ *
+ * This file is part of Twitter-GLib.
+ * Copyright (C) 2008  Emmanuele Bassi  <ebassi@gnome.org>
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:twitter-status-index
+ * @short_description: An indexed collection of statuses
+ *
+ * #TwitterStatusIndex collects the statuses of many timelines, for
+ * instance the pages retrieved from the provider over time, and
+ * indexes them by author, by the users they mention, by the status
+ * they reply to and by their creation date.
+ *
+ * The indexes are updated each time statuses are added using
+ * twitter_status_index_add_timeline(), so the queries never scan
+ * the whole collection.
+ *
+ * The text of the statuses is indexed as well, and can be searched
+ * using twitter_status_index_search().
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include <glib.h>
+
+#include "twitter-status.h"
+#include "twitter-status-index.h"
+#include "twitter-text-index.h"
+#include "twitter-timeline.h"
+#include "twitter-user.h"
+
+#define TWITTER_STATUS_INDEX_GET_PRIVATE(obj)   (G_TYPE_INSTANCE_GET_PRIVATE ((obj), TWITTER_TYPE_STATUS_INDEX, TwitterStatusIndexPrivate))
+
+struct _TwitterStatusIndexPrivate
+{
+  /* status id -> status; owns a reference on each status */
+  GHashTable *status_by_id;
+
+  /* user id -> GPtrArray of statuses, by ascending id */
+  GHashTable *by_user;
+
+  /* status id -> GPtrArray of the replies, by ascending id */
+  GHashTable *by_reply;
+
+  /* lower case screen name -> GPtrArray of the statuses mentioning
+   * the user, by ascending id
+   */
+  GHashTable *by_mention;
+
+  /* every status, by ascending timestamp and id; new statuses
+   * are usually appended
+   */
+  GPtrArray *by_time;
+
+  /* the words of the text of each status */
+  TwitterTextIndex *text_index;
+};
+
+G_DEFINE_TYPE (TwitterStatusIndex, twitter_status_index, G_TYPE_OBJECT);
+
+static void
+posting_list_free (gpointer data)
+{
+  g_ptr_array_free (data, TRUE);
+}
+
+static void
+twitter_status_index_finalize (GObject *gobject)
+{
+  TwitterStatusIndexPrivate *priv = TWITTER_STATUS_INDEX (gobject)->priv;
+
+  g_hash_table_destroy (priv->by_user);
+  g_hash_table_destroy (priv->by_reply);
+  g_hash_table_destroy (priv->by_mention);
+  g_ptr_array_free (priv->by_time, TRUE);
+  _twitter_text_index_free (priv->text_index);
+
+  /* drops the references on the statuses */
+  g_hash_table_destroy (priv->status_by_id);
+
+  G_OBJECT_CLASS (twitter_status_index_parent_class)->finalize (gobject);
+}
+
+static void
+twitter_status_index_class_init (TwitterStatusIndexClass *klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  g_type_class_add_private (klass, sizeof (TwitterStatusIndexPrivate));
+
+  gobject_class->finalize = twitter_status_index_finalize;
+}
+
+static void
+twitter_status_index_init (TwitterStatusIndex *status_index)
+{
+  TwitterStatusIndexPrivate *priv;
+
+  status_index->priv = priv = TWITTER_STATUS_INDEX_GET_PRIVATE (status_index);
+
+  priv->status_by_id = g_hash_table_new_full (NULL, NULL,
+                                              NULL,
+                                              g_object_unref);
+  priv->by_user = g_hash_table_new_full (NULL, NULL,
+                                         NULL,
+                                         posting_list_free);
+  priv->by_reply = g_hash_table_new_full (NULL, NULL,
+                                          NULL,
+                                          posting_list_free);
+  priv->by_mention = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                            g_free,
+                                            posting_list_free);
+  priv->by_time = g_ptr_array_new ();
+  priv->text_index = _twitter_text_index_new ();
+}
+
+/* orders by ascending timestamp, then by ascending id */
+static gint
+compare_status_time (TwitterStatus *a,
+                     TwitterStatus *b)
+{
+  gint64 timestamp_a = twitter_status_get_timestamp (a);
+  gint64 timestamp_b = twitter_status_get_timestamp (b);
+  guint id_a, id_b;
+
+  if (timestamp_a != timestamp_b)
+    return timestamp_a < timestamp_b ? -1 : 1;
+
+  id_a = twitter_status_get_id (a);
+  id_b = twitter_status_get_id (b);
+
+  if (id_a != id_b)
+    return id_a < id_b ? -1 : 1;
+
+  return 0;
+}
+
+static gint
+compare_status_time_ptr (gconstpointer a,
+                         gconstpointer b)
+{
+  return compare_status_time (*((TwitterStatus **) a),
+                              *((TwitterStatus **) b));
+}
+
+/* adds @status to @list, keeping the list sorted by ascending id */
+static void
+posting_list_add (GPtrArray     *list,
+                  TwitterStatus *status)
+{
+  guint status_id, low, high;
+
+  status_id = twitter_status_get_id (status);
+
+  /* the first status that is newer than @status */
+  low = 0;
+  high = list->len;
+  while (low < high)
+    {
+      guint mid = (low + high) / 2;
+
+      if (twitter_status_get_id (g_ptr_array_index (list, mid)) < status_id)
+        low = mid + 1;
+      else
+        high = mid;
+    }
+
+  /* a status mentioning the same user twice */
+  if (low < list->len &&
+      g_ptr_array_index (list, low) == status)
+    return;
+
+  g_ptr_array_add (list, NULL);
+
+  if (low < list->len - 1)
+    g_memmove (list->pdata + low + 1,
+               list->pdata + low,
+               (list->len - 1 - low) * sizeof (gpointer));
+
+  list->pdata[low] = status;
+}
+
+/* adds @status to the list of statuses under @key */
+static void
+posting_list_insert (GHashTable    *table,
+                     guint          key,
+                     TwitterStatus *status)
+{
+  GPtrArray *list;
+
+  list = g_hash_table_lookup (table, GUINT_TO_POINTER (key));
+  if (list == NULL)
+    {
+      list = g_ptr_array_sized_new (4);
+      g_hash_table_insert (table, GUINT_TO_POINTER (key), list);
+    }
+
+  posting_list_add (list, status);
+}
+
+/* adds @status to the lists of the users it mentions */
+static void
+twitter_status_index_add_mentions (TwitterStatusIndex *status_index,
+                                   TwitterStatus      *status)
+{
+  const TwitterEntity *entities;
+  const gchar *text;
+  guint n_entities, i;
+
+  entities = twitter_status_get_entities (status, &n_entities);
+  if (n_entities == 0)
+    return;
+
+  text = twitter_status_get_text (status);
+
+  for (i = 0; i < n_entities; i++)
+    {
+      GPtrArray *list;
+      gchar *screen_name;
+
+      if (entities[i].type != TWITTER_ENTITY_MENTION)
+        continue;
+
+      /* skip the '@' */
+      screen_name = g_ascii_strdown (text + entities[i].offset + 1,
+                                     entities[i].length - 1);
+
+      list = g_hash_table_lookup (status_index->priv->by_mention, screen_name);
+      if (list == NULL)
+        {
+          list = g_ptr_array_sized_new (4);
+          g_hash_table_insert (status_index->priv->by_mention,
+                               screen_name,
+                               list);
+        }
+      else
+        g_free (screen_name);
+
+      posting_list_add (list, status);
+    }
+}
+
+/* merges the new statuses, sorted by time, into the time index */
+static void
+twitter_status_index_merge_time (TwitterStatusIndex *status_index,
+                                 GPtrArray          *statuses)
+{
+  TwitterStatusIndexPrivate *priv = status_index->priv;
+  GPtrArray *merged;
+  guint i, j;
+
+  if (statuses->len == 0)
+    return;
+
+  /* the common case: the statuses are newer than the others */
+  if (priv->by_time->len == 0 ||
+      compare_status_time (g_ptr_array_index (priv->by_time, priv->by_time->len - 1),
+                           g_ptr_array_index (statuses, 0)) < 0)
+    {
+      for (i = 0; i < statuses->len; i++)
+        g_ptr_array_add (priv->by_time, g_ptr_array_index (statuses, i));
+
+      return;
+    }
+
+  merged = g_ptr_array_sized_new (priv->by_time->len + statuses->len);
+
+  i = j = 0;
+  while (i < priv->by_time->len || j < statuses->len)
+    {
+      if (j == statuses->len ||
+          (i < priv->by_time->len &&
+           compare_status_time (g_ptr_array_index (priv->by_time, i),
+                                g_ptr_array_index (statuses, j)) < 0))
+        g_ptr_array_add (merged, g_ptr_array_index (priv->by_time, i++));
+      else
+        g_ptr_array_add (merged, g_ptr_array_index (statuses, j++));
+    }
+
+  g_ptr_array_free (priv->by_time, TRUE);
+  priv->by_time = merged;
+}
+
+static gint
+compare_status_id_ptr (gconstpointer a,
+                       gconstpointer b)
+{
+  guint id_a = twitter_status_get_id (*((TwitterStatus **) a));
+  guint id_b = twitter_status_get_id (*((TwitterStatus **) b));
+
+  if (id_a != id_b)
+    return id_a < id_b ? -1 : 1;
+
+  return 0;
+}
+
+/* adds the statuses that are not yet indexed */
+static void
+twitter_status_index_add_statuses (TwitterStatusIndex  *status_index,
+                                   TwitterStatus      **statuses,
+                                   guint                n_statuses)
+{
+  TwitterStatusIndexPrivate *priv = status_index->priv;
+  GPtrArray *added;
+  guint i;
+
+  added = g_ptr_array_sized_new (n_statuses);
+
+  for (i = 0; i < n_statuses; i++)
+    {
+      TwitterStatus *status = statuses[i];
+      guint status_id;
+
+      status_id = twitter_status_get_id (status);
+      if (status_id == 0 ||
+          g_hash_table_lookup (priv->status_by_id,
+                               GUINT_TO_POINTER (status_id)) != NULL)
+        continue;
+
+      g_hash_table_insert (priv->status_by_id,
+                           GUINT_TO_POINTER (status_id),
+                           g_object_ref_sink (status));
+
+      g_ptr_array_add (added, status);
+    }
+
+  /* timelines are newest first; the posting lists, and the postings
+   * of the text index, are cheap to extend with newer ids but have to
+   * be moved, or encoded again, to insert older ones
+   */
+  g_ptr_array_sort (added, compare_status_id_ptr);
+
+  for (i = 0; i < added->len; i++)
+    {
+      TwitterStatus *status = g_ptr_array_index (added, i);
+      TwitterUser *user;
+      guint reply_id;
+
+      user = twitter_status_get_user (status);
+      if (user != NULL && twitter_user_get_id (user) != 0)
+        posting_list_insert (priv->by_user, twitter_user_get_id (user), status);
+
+      reply_id = twitter_status_get_reply_to_status (status);
+      if (reply_id != 0)
+        posting_list_insert (priv->by_reply, reply_id, status);
+
+      twitter_status_index_add_mentions (status_index, status);
+
+      _twitter_text_index_add (priv->text_index,
+                               twitter_status_get_id (status),
+                               twitter_status_get_text (status));
+    }
+
+  g_ptr_array_sort (added, compare_status_time_ptr);
+  twitter_status_index_merge_time (status_index, added);
+
+  g_ptr_array_free (added, TRUE);
+}
+
+/* returns the statuses of @list, newest first */
+static GList *
+posting_list_to_list (GPtrArray *list)
+{
+  GList *retval = NULL;
+  guint i;
+
+  if (list == NULL)
+    return NULL;
+
+  for (i = 0; i < list->len; i++)
+    retval = g_list_prepend (retval, g_ptr_array_index (list, i));
+
+  return retval;
+}
+
+/* the position of the first status created at, or after, @timestamp */
+static guint
+twitter_status_index_find_time (TwitterStatusIndex *status_index,
+                                gint64              timestamp)
+{
+  GPtrArray *by_time = status_index->priv->by_time;
+  guint low, high;
+
+  low = 0;
+  high = by_time->len;
+  while (low < high)
+    {
+      guint mid = (low + high) / 2;
+      TwitterStatus *status = g_ptr_array_index (by_time, mid);
+
+      if (twitter_status_get_timestamp (status) < timestamp)
+        low = mid + 1;
+      else
+        high = mid;
+    }
+
+  return low;
+}
+
+/**
+ * twitter_status_index_new:
+ *
+ * Creates a new, empty #TwitterStatusIndex
+ *
+ * Return value: the newly created #TwitterStatusIndex. Use
+ *   g_object_unref() to release the resources it allocates
+ *
+ * Since: 0.9.10
+ */
+TwitterStatusIndex *
+twitter_status_index_new (void)
+{
+  return g_object_new (TWITTER_TYPE_STATUS_INDEX, NULL);
+}
+
+/**
+ * twitter_status_index_add_status:
+ * @status_index: a #TwitterStatusIndex
+ * @status: a #TwitterStatus
+ *
+ * Adds @status to @status_index, unless a status with the same id
+ * has already been added. The index will hold a reference on @status
+ *
+ * Since: 0.9.10
+ */
+void
+twitter_status_index_add_status (TwitterStatusIndex *status_index,
+                                 TwitterStatus      *status)
+{
+  g_return_if_fail (TWITTER_IS_STATUS_INDEX (status_index));
+  g_return_if_fail (TWITTER_IS_STATUS (status));
+
+  twitter_status_index_add_statuses (status_index, &status, 1);
+}
+
+/**
+ * twitter_status_index_add_timeline:
+ * @status_index: a #TwitterStatusIndex
+ * @timeline: a #TwitterTimeline
+ *
+ * Adds the statuses of @timeline to @status_index; the statuses
+ * that have already been added are skipped. The statuses are
+ * shared with @timeline
+ *
+ * Since: 0.9.10
+ */
+void
+twitter_status_index_add_timeline (TwitterStatusIndex *status_index,
+                                   TwitterTimeline    *timeline)
+{
+  TwitterStatus **statuses;
+  guint n_statuses, i;
+
+  g_return_if_fail (TWITTER_IS_STATUS_INDEX (status_index));
+  g_return_if_fail (TWITTER_IS_TIMELINE (timeline));
+
+  n_statuses = twitter_timeline_get_count (timeline);
+  if (n_statuses == 0)
+    return;
+
+  statuses = g_new (TwitterStatus *, n_statuses);
+  for (i = 0; i < n_statuses; i++)
+    statuses[i] = twitter_timeline_get_pos (timeline, i);
+
+  twitter_status_index_add_statuses (status_index, statuses, n_statuses);
+
+  g_free (statuses);
+}
+
+/**
+ * twitter_status_index_get_count:
+ * @status_index: a #TwitterStatusIndex
+ *
+ * Retrieves the number of statuses inside @status_index
+ *
+ * Return value: the number of statuses
+ *
+ * Since: 0.9.10
+ */
+guint
+twitter_status_index_get_count (TwitterStatusIndex *status_index)
+{
+  g_return_val_if_fail (TWITTER_IS_STATUS_INDEX (status_index), 0);
+
+  return g_hash_table_size (status_index->priv->status_by_id);
+}
+
+/**
+ * twitter_status_index_get_status:
+ * @status_index: a #TwitterStatusIndex
+ * @status_id: the id of a status
+ *
+ * Retrieves the status with @status_id
+ *
+ * Return value: the #TwitterStatus, owned by @status_index, or %NULL
+ *
+ * Since: 0.9.10
+ */
+TwitterStatus *
+twitter_status_index_get_status (TwitterStatusIndex *status_index,
+                                 guint               status_id)
+{
+  g_return_val_if_fail (TWITTER_IS_STATUS_INDEX (status_index), NULL);
+
+  return g_hash_table_lookup (status_index->priv->status_by_id,
+                              GUINT_TO_POINTER (status_id));
+}
+
+/**
+ * twitter_status_index_get_by_user:
+ * @status_index: a #TwitterStatusIndex
+ * @user_id: the id of a user
+ *
+ * Retrieves the statuses posted by the user with @user_id
+ *
+ * Return value: a list of #TwitterStatus, newest first. The statuses
+ *   are owned by @status_index; use g_list_free() to free the list
+ *
+ * Since: 0.9.10
+ */
+GList *
+twitter_status_index_get_by_user (TwitterStatusIndex *status_index,
+                                  guint               user_id)
+{
+  g_return_val_if_fail (TWITTER_IS_STATUS_INDEX (status_index), NULL);
+
+  return posting_list_to_list (g_hash_table_lookup (status_index->priv->by_user,
+                                                    GUINT_TO_POINTER (user_id)));
+}
+
+/**
+ * twitter_status_index_get_mentions:
+ * @status_index: a #TwitterStatusIndex
+ * @screen_name: the screen name of a user, with or without the
+ *   leading '@'
+ *
+ * Retrieves the statuses mentioning the user with @screen_name
+ * inside their text, ignoring the case
+ *
+ * Return value: a list of #TwitterStatus, newest first. The statuses
+ *   are owned by @status_index; use g_list_free() to free the list
+ *
+ * Since: 0.9.10
+ */
+GList *
+twitter_status_index_get_mentions (TwitterStatusIndex *status_index,
+                                   const gchar        *screen_name)
+{
+  GPtrArray *list;
+  gchar *key;
+
+  g_return_val_if_fail (TWITTER_IS_STATUS_INDEX (status_index), NULL);
+  g_return_val_if_fail (screen_name != NULL, NULL);
+
+  if (*screen_name == '@')
+    screen_name += 1;
+
+  key = g_ascii_strdown (screen_name, -1);
+  list = g_hash_table_lookup (status_index->priv->by_mention, key);
+  g_free (key);
+
+  return posting_list_to_list (list);
+}
+
+/**
+ * twitter_status_index_get_replies:
+ * @status_index: a #TwitterStatusIndex
+ * @status_id: the id of a status
+ *
+ * Retrieves the statuses replying to the status with @status_id; the
+ * replied status does not need to be inside @status_index
+ *
+ * Return value: a list of #TwitterStatus, newest first. The statuses
+ *   are owned by @status_index; use g_list_free() to free the list
+ *
+ * Since: 0.9.10
+ */
+GList *
+twitter_status_index_get_replies (TwitterStatusIndex *status_index,
+                                  guint               status_id)
+{
+  g_return_val_if_fail (TWITTER_IS_STATUS_INDEX (status_index), NULL);
+
+  return posting_list_to_list (g_hash_table_lookup (status_index->priv->by_reply,
+                                                    GUINT_TO_POINTER (status_id)));
+}
+
+/**
+ * twitter_status_index_get_range:
+ * @status_index: a #TwitterStatusIndex
+ * @since: the start of the range, in seconds from the epoch
+ * @until: the end of the range, in seconds from the epoch
+ *
+ * Retrieves the statuses created at, or after, @since and before
+ * @until, as returned by twitter_status_get_timestamp()
+ *
+ * Return value: a list of #TwitterStatus, newest first. The statuses
+ *   are owned by @status_index; use g_list_free() to free the list
+ *
+ * Since: 0.9.10
+ */
+GList *
+twitter_status_index_get_range (TwitterStatusIndex *status_index,
+                                gint64              since,
+                                gint64              until)
+{
+  GPtrArray *by_time;
+  GList *retval = NULL;
+  guint start, end, i;
+
+  g_return_val_if_fail (TWITTER_IS_STATUS_INDEX (status_index), NULL);
+
+  if (since >= until)
+    return NULL;
+
+  by_time = status_index->priv->by_time;
+
+  start = twitter_status_index_find_time (status_index, since);
+  end = twitter_status_index_find_time (status_index, until);
+
+  for (i = start; i < end; i++)
+    retval = g_list_prepend (retval, g_ptr_array_index (by_time, i));
+
+  return retval;
+}
+
+/**
+ * twitter_status_index_search:
+ * @status_index: a #TwitterStatusIndex
+ * @query: the words to search
+ *
+ * Searches the statuses containing every word of @query inside
+ * their text. The search ignores the case of the words, and the
+ * punctuation: "#guadec" and "@ebassi" will match "GUADEC" and
+ * "ebassi" respectively.
+ *
+ * The words inside double quotes must appear in sequence, and the
+ * OR keyword separates alternatives: the query
+ * <literal>"see you" guadec OR berlin</literal> matches the statuses
+ * containing "see you" and "guadec", or "berlin".
+ *
+ * Return value: a list of #TwitterStatus, by descending id. The
+ *   statuses are owned by @status_index; use g_list_free() to free
+ *   the list
+ *
+ * Since: 0.9.10
+ */
+GList *
+twitter_status_index_search (TwitterStatusIndex *status_index,
+                             const gchar        *query)
+{
+  TwitterStatusIndexPrivate *priv;
+  GList *retval = NULL;
+  GArray *ids;
+  guint i;
+
+  g_return_val_if_fail (TWITTER_IS_STATUS_INDEX (status_index), NULL);
+  g_return_val_if_fail (query != NULL, NULL);
+
+  priv = status_index->priv;
+
+  ids = _twitter_text_index_search (priv->text_index, query);
+
+  for (i = 0; i < ids->len; i++)
+    {
+      guint status_id = g_array_index (ids, guint, i);
+
+      retval = g_list_prepend (retval,
+                               g_hash_table_lookup (priv->status_by_id,
+                                                    GUINT_TO_POINTER (status_id)));
+    }
+
+  g_array_free (ids, TRUE);
+
+  return retval;
+}
@@ -0,0 +1,91 @@
+/* twitter-status-index.h: Indexed collection of statuses
+ *
+ * This file is part of Twitter-GLib.
+ * Copyright (C) 2008  Emmanuele Bassi  <ebassi@gnome.org>
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef __TWITTER_STATUS_INDEX_H__
+#define __TWITTER_STATUS_INDEX_H__
+
+#include <glib-object.h>
+
+#include <twitter-glib/twitter-status.h>
+#include <twitter-glib/twitter-timeline.h>
+
+G_BEGIN_DECLS
+
+#define TWITTER_TYPE_STATUS_INDEX               (twitter_status_index_get_type ())
+#define TWITTER_STATUS_INDEX(obj)               (G_TYPE_CHECK_INSTANCE_CAST ((obj), TWITTER_TYPE_STATUS_INDEX, TwitterStatusIndex))
+#define TWITTER_IS_STATUS_INDEX(obj)            (G_TYPE_CHECK_INSTANCE_TYPE ((obj), TWITTER_TYPE_STATUS_INDEX))
+#define TWITTER_STATUS_INDEX_CLASS(klass)       (G_TYPE_CHECK_CLASS_CAST ((klass), TWITTER_TYPE_STATUS_INDEX, TwitterStatusIndexClass))
+#define TWITTER_IS_STATUS_INDEX_CLASS(klass)    (G_TYPE_CHECK_CLASS_TYPE ((klass), TWITTER_TYPE_STATUS_INDEX))
+#define TWITTER_STATUS_INDEX_GET_CLASS(obj)     (G_TYPE_INSTANCE_GET_CLASS ((obj), TWITTER_TYPE_STATUS_INDEX, TwitterStatusIndexClass))
+
+typedef struct _TwitterStatusIndex              TwitterStatusIndex;
+typedef struct _TwitterStatusIndexPrivate       TwitterStatusIndexPrivate;
+typedef struct _TwitterStatusIndexClass         TwitterStatusIndexClass;
+
+/**
+ * TwitterStatusIndex:
+ *
+ * The #TwitterStatusIndex struct contains private data only, and
+ * should only be accessed using the functions below.
+ */
+struct _TwitterStatusIndex
+{
+  /*< private >*/
+  GObject parent_instance;
+
+  TwitterStatusIndexPrivate *priv;
+};
+
+/**
+ * TwitterStatusIndexClass:
+ *
+ * The #TwitterStatusIndexClass struct contains only private data
+ */
+struct _TwitterStatusIndexClass
+{
+  /*< private >*/
+  GObjectClass parent_class;
+};
+
+GType               twitter_status_index_get_type     (void) G_GNUC_CONST;
+
+TwitterStatusIndex *twitter_status_index_new          (void);
+
+void                twitter_status_index_add_status   (TwitterStatusIndex *status_index,
+                                                       TwitterStatus      *status);
+void                twitter_status_index_add_timeline (TwitterStatusIndex *status_index,
+                                                       TwitterTimeline    *timeline);
+
+guint               twitter_status_index_get_count    (TwitterStatusIndex *status_index);
+TwitterStatus *     twitter_status_index_get_status   (TwitterStatusIndex *status_index,
+                                                       guint               status_id);
+GList *             twitter_status_index_get_by_user  (TwitterStatusIndex *status_index,
+                                                       guint               user_id);
+GList *             twitter_status_index_get_mentions (TwitterStatusIndex *status_index,
+                                                       const gchar        *screen_name);
+GList *             twitter_status_index_get_replies  (TwitterStatusIndex *status_index,
+                                                       guint               status_id);
+GList *             twitter_status_index_get_range    (TwitterStatusIndex *status_index,
+                                                       gint64              since,
+                                                       gint64              until);
+GList *             twitter_status_index_search       (TwitterStatusIndex *status_index,
+                                                       const gchar        *query);
+
+G_END_DECLS
+
+#endif /* __TWITTER_STATUS_INDEX_H__ */
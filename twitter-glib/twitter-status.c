@@ -39,7 +39,9 @@
 
 #include "twitter-api.h"
 #include "twitter-common.h"
+#include "twitter-intern-pool.h"
 #include "twitter-marshal.h"
+#include "twitter-parse-pool.h"
 #include "twitter-private.h"
 #include "twitter-status.h"
 
@@ -51,16 +53,35 @@ struct _TwitterStatusPrivate
   guint user_changed_id;
 
   gchar *url;
-  gchar *source;
+  const gchar *source;
   gchar *created_at;
   gchar *text;
 
   guint id;
 
+  /* created_at, in seconds from the epoch */
+  gint64 timestamp;
+
   guint in_reply_to_user_id;
   guint in_reply_to_status_id;
 
   guint truncated : 1;
+
+  /* the mentions, hashtags and links inside the text */
+  TwitterEntity *entities;
+  guint n_entities;
+
+  /* owns created_at and text when set; the URL is always
+   * allocated separately, and the source is interned
+   */
+  TwitterStringArena *arena;
+
+  /* strings decoded on demand, see TWITTER_PARSE_LAZY */
+  TwitterJsonBuffer *raw;
+  TwitterJsonSpan source_span;
+  TwitterJsonSpan created_at_span;
+
+  guint lazy_url : 1;
 };
 
 enum
@@ -75,7 +96,8 @@ enum
   PROP_TRUNCATED,
   PROP_REPLY_TO_USER,
   PROP_REPLY_TO_STATUS,
-  PROP_URL
+  PROP_URL,
+  PROP_TIMESTAMP
 };
 
 enum
@@ -95,9 +117,20 @@ twitter_status_finalize (GObject *gobject)
   TwitterStatusPrivate *priv = TWITTER_STATUS (gobject)->priv;
 
   g_free (priv->url);
-  g_free (priv->source);
-  g_free (priv->created_at);
-  g_free (priv->text);
+  _twitter_intern_pool_release (priv->source);
+
+  if (priv->arena)
+    _twitter_string_arena_unref (priv->arena);
+  else
+    {
+      g_free (priv->created_at);
+      g_free (priv->text);
+    }
+
+  if (priv->raw)
+    _twitter_json_buffer_unref (priv->raw);
+
+  g_free (priv->entities);
 
   G_OBJECT_CLASS (twitter_status_parent_class)->finalize (gobject);
 }
@@ -116,7 +149,8 @@ twitter_status_get_property (GObject    *gobject,
                              GValue     *value,
                              GParamSpec *pspec)
 {
-  TwitterStatusPrivate *priv = TWITTER_STATUS (gobject)->priv;
+  TwitterStatus *status = TWITTER_STATUS (gobject);
+  TwitterStatusPrivate *priv = status->priv;
 
   switch (prop_id)
     {
@@ -125,11 +159,11 @@ twitter_status_get_property (GObject    *gobject,
       break;
 
     case PROP_SOURCE:
-      g_value_set_string (value, priv->source);
+      g_value_set_string (value, twitter_status_get_source (status));
       break;
 
     case PROP_CREATED_AT:
-      g_value_set_string (value, priv->created_at);
+      g_value_set_string (value, twitter_status_get_created_at (status));
       break;
 
     case PROP_TEXT:
@@ -153,7 +187,11 @@ twitter_status_get_property (GObject    *gobject,
       break;
 
     case PROP_URL:
-      g_value_set_string (value, priv->url);
+      g_value_set_string (value, twitter_status_get_url (status));
+      break;
+
+    case PROP_TIMESTAMP:
+      g_value_set_int64 (value, priv->timestamp);
       break;
 
     default:
@@ -237,6 +275,21 @@ twitter_status_class_init (TwitterStatusClass *klass)
                                                         NULL,
                                                         G_PARAM_READABLE));
 
+  /**
+   * TwitterStatus:timestamp:
+   *
+   * The creation date of the status, in seconds from the epoch
+   *
+   * Since: 0.9.10
+   */
+  g_object_class_install_property (gobject_class,
+                                   PROP_TIMESTAMP,
+                                   g_param_spec_int64 ("timestamp",
+                                                       "Timestamp",
+                                                       "The creation date of the status",
+                                                       G_MININT64, G_MAXINT64, 0,
+                                                       G_PARAM_READABLE));
+
   /**
    * TwitterStatus::changed:
    * @status: the #TwitterStatus that emitted the signal
@@ -273,13 +326,209 @@ twitter_status_clean (TwitterStatus *status)
   TwitterStatusPrivate *priv = status->priv;
 
   g_free (priv->url);
-  g_free (priv->source);
-  g_free (priv->created_at);
-  g_free (priv->text);
+  priv->url = NULL;
+
+  if (priv->arena)
+    {
+      _twitter_string_arena_unref (priv->arena);
+      priv->arena = NULL;
+    }
+  else
+    {
+      g_free (priv->created_at);
+      g_free (priv->text);
+    }
+
+  _twitter_intern_pool_release (priv->source);
+  priv->source = NULL;
+  priv->created_at = NULL;
+  priv->text = NULL;
+
+  priv->timestamp = 0;
+
+  g_free (priv->entities);
+  priv->entities = NULL;
+  priv->n_entities = 0;
+
+  memset (&priv->source_span, 0, sizeof (TwitterJsonSpan));
+  memset (&priv->created_at_span, 0, sizeof (TwitterJsonSpan));
+  priv->lazy_url = FALSE;
+
+  if (priv->raw)
+    {
+      _twitter_json_buffer_unref (priv->raw);
+      priv->raw = NULL;
+    }
 
   _twitter_status_set_user (status, NULL);
 }
 
+/* keeps alive the buffer lazily decoded strings point into */
+static void
+twitter_status_hold_buffer (TwitterStatus     *status,
+                            TwitterJsonBuffer *buffer)
+{
+  TwitterStatusPrivate *priv = status->priv;
+
+  if (priv->raw == buffer)
+    return;
+
+  if (priv->raw)
+    _twitter_json_buffer_unref (priv->raw);
+
+  priv->raw = _twitter_json_buffer_ref (buffer);
+}
+
+#define MAX_SCREEN_NAME_LEN     20
+
+static inline gboolean
+is_word_char (gunichar c)
+{
+  return c == '_' || g_unichar_isalnum (c);
+}
+
+/* the end of the screen name starting at @p, or @p */
+static const gchar *
+scan_screen_name (const gchar *p)
+{
+  const gchar *end = p;
+
+  while (g_ascii_isalnum (*end) || *end == '_')
+    end++;
+
+  if (end - p > MAX_SCREEN_NAME_LEN)
+    return p;
+
+  return end;
+}
+
+/* the end of the hashtag starting at @p, or @p; a hashtag must
+ * contain at least a character that is not a digit
+ */
+static const gchar *
+scan_hashtag (const gchar *p)
+{
+  gboolean has_letter = FALSE;
+  const gchar *end = p;
+
+  while (*end != '\0')
+    {
+      gunichar c = g_utf8_get_char (end);
+
+      if (!is_word_char (c))
+        break;
+
+      if (!g_unichar_isdigit (c))
+        has_letter = TRUE;
+
+      end = g_utf8_next_char (end);
+    }
+
+  return has_letter ? end : p;
+}
+
+/* the end of the link starting at @p, or @p */
+static const gchar *
+scan_url (const gchar *p)
+{
+  const gchar *start, *end;
+
+  if (g_ascii_strncasecmp (p, "http://", 7) == 0)
+    start = p + 7;
+  else if (g_ascii_strncasecmp (p, "https://", 8) == 0)
+    start = p + 8;
+  else if (g_ascii_strncasecmp (p, "www.", 4) == 0)
+    start = p + 4;
+  else
+    return p;
+
+  end = start;
+  while (*end != '\0' && !g_ascii_isspace (*end))
+    end++;
+
+  /* the punctuation at the end belongs to the sentence */
+  while (end > start && strchr (".,;:!?'\")", end[-1]) != NULL)
+    end--;
+
+  return end > start ? end : p;
+}
+
+/* finds the entities inside the text in a single pass; a mention or
+ * a hashtag cannot follow a letter, so that email addresses and
+ * things like "C#" are skipped
+ */
+static void
+twitter_status_extract_entities (TwitterStatus *status)
+{
+  TwitterStatusPrivate *priv = status->priv;
+  GArray *entities = NULL;
+  gboolean after_word = FALSE;
+  const gchar *p;
+
+  g_free (priv->entities);
+  priv->entities = NULL;
+  priv->n_entities = 0;
+
+  if (priv->text == NULL)
+    return;
+
+  p = priv->text;
+  while (*p != '\0')
+    {
+      TwitterEntity entity;
+      const gchar *end = p;
+      gunichar c;
+
+      c = (guchar) *p < 0x80 ? (gunichar) *p : g_utf8_get_char (p);
+
+      if (!after_word)
+        {
+          if (c == '@')
+            {
+              entity.type = TWITTER_ENTITY_MENTION;
+              end = scan_screen_name (p + 1);
+              if (end == p + 1)
+                end = p;
+            }
+          else if (c == '#')
+            {
+              entity.type = TWITTER_ENTITY_HASHTAG;
+              end = scan_hashtag (p + 1);
+              if (end == p + 1)
+                end = p;
+            }
+          else if (c == 'h' || c == 'H' || c == 'w' || c == 'W')
+            {
+              entity.type = TWITTER_ENTITY_URL;
+              end = scan_url (p);
+            }
+        }
+
+      if (end != p)
+        {
+          if (entities == NULL)
+            entities = g_array_new (FALSE, FALSE, sizeof (TwitterEntity));
+
+          entity.offset = p - priv->text;
+          entity.length = end - p;
+          g_array_append_val (entities, entity);
+
+          p = end;
+          after_word = TRUE;
+          continue;
+        }
+
+      after_word = is_word_char (c);
+      p = g_utf8_next_char (p);
+    }
+
+  if (entities != NULL)
+    {
+      priv->n_entities = entities->len;
+      priv->entities = (TwitterEntity *) g_array_free (entities, FALSE);
+    }
+}
+
 static void
 twitter_status_build (TwitterStatus *status,
                       JsonNode      *node)
@@ -303,11 +552,14 @@ twitter_status_build (TwitterStatus *status,
 
   member = json_object_get_member (obj, "source");
   if (member)
-    priv->source = json_node_dup_string (member);
+    priv->source = _twitter_intern_pool_acquire (json_node_get_string (member), -1);
 
   member = json_object_get_member (obj, "created_at");
   if (member)
-    priv->created_at = json_node_dup_string (member);
+    {
+      priv->created_at = json_node_dup_string (member);
+      priv->timestamp = _twitter_date_to_timestamp (priv->created_at, -1);
+    }
 
   member = json_object_get_member (obj, "id");
   if (member)
@@ -319,7 +571,10 @@ twitter_status_build (TwitterStatus *status,
 
   member = json_object_get_member (obj, "text");
   if (member)
-    priv->text = json_node_dup_string (member);
+    {
+      priv->text = json_node_dup_string (member);
+      twitter_status_extract_entities (status);
+    }
 
   member = json_object_get_member (obj, "in_reply_to_user_id");
   if (member)
@@ -336,6 +591,246 @@ twitter_status_build (TwitterStatus *status,
                                  priv->id);
 }
 
+/* the single pass equivalent of twitter_status_build(), decoding
+ * the object at the cursor of @decoder into an empty @status
+ */
+void
+_twitter_status_decode (TwitterStatus      *status,
+                        TwitterJsonDecoder *decoder)
+{
+  TwitterStatusPrivate *priv = status->priv;
+  const gchar *key;
+  gsize len;
+
+  if (!_twitter_json_decoder_begin_object (decoder))
+    {
+      _twitter_json_decoder_skip (decoder);
+      return;
+    }
+
+  /* the strings already allocated with g_malloc() must be freed
+   * the same way, so we only move to the arena of the decoder if
+   * there are none
+   */
+  if (decoder->arena != NULL && priv->arena == NULL &&
+      priv->created_at == NULL &&
+      priv->text == NULL)
+    priv->arena = _twitter_string_arena_ref (decoder->arena);
+
+  while (_twitter_json_decoder_next_member (decoder, &key, &len))
+    {
+      switch (len)
+        {
+        case 2:
+          if (TWITTER_JSON_KEY_IS (key, len, "id"))
+            {
+              priv->id = _twitter_json_decoder_read_int (decoder);
+              continue;
+            }
+          break;
+
+        case 4:
+          if (TWITTER_JSON_KEY_IS (key, len, "user"))
+            {
+              TwitterUser *user = twitter_user_new ();
+
+              _twitter_user_decode (user, decoder);
+              _twitter_status_set_user (status, user);
+              continue;
+            }
+          else if (TWITTER_JSON_KEY_IS (key, len, "text"))
+            {
+              _twitter_json_decoder_read_field (decoder, priv->arena,
+                                                &priv->text);
+              continue;
+            }
+          break;
+
+        case 6:
+          if (TWITTER_JSON_KEY_IS (key, len, "source"))
+            {
+              if (_twitter_json_decoder_read_interned (decoder,
+                                                       &priv->source,
+                                                       &priv->source_span))
+                twitter_status_hold_buffer (status, decoder->buffer);
+              continue;
+            }
+          break;
+
+        case 9:
+          if (TWITTER_JSON_KEY_IS (key, len, "truncated"))
+            {
+              priv->truncated = _twitter_json_decoder_read_boolean (decoder);
+              continue;
+            }
+          break;
+
+        case 10:
+          if (TWITTER_JSON_KEY_IS (key, len, "created_at"))
+            {
+              if (_twitter_json_decoder_read_lazy_string (decoder,
+                                                          priv->arena,
+                                                          &priv->created_at,
+                                                          &priv->created_at_span))
+                twitter_status_hold_buffer (status, decoder->buffer);
+              continue;
+            }
+          break;
+
+        case 19:
+          if (TWITTER_JSON_KEY_IS (key, len, "in_reply_to_user_id"))
+            {
+              priv->in_reply_to_user_id =
+                _twitter_json_decoder_read_int (decoder);
+              continue;
+            }
+          break;
+
+        case 21:
+          if (TWITTER_JSON_KEY_IS (key, len, "in_reply_to_status_id"))
+            {
+              priv->in_reply_to_status_id =
+                _twitter_json_decoder_read_int (decoder);
+              continue;
+            }
+          break;
+
+        default:
+          break;
+        }
+
+      _twitter_json_decoder_skip (decoder);
+    }
+
+  twitter_status_extract_entities (status);
+
+  /* the raw span of a lazy string is still quoted */
+  if (priv->created_at != NULL)
+    priv->timestamp = _twitter_date_to_timestamp (priv->created_at, -1);
+  else if (priv->created_at_span.start != NULL)
+    priv->timestamp =
+      _twitter_date_to_timestamp (priv->created_at_span.start + 1,
+                                  priv->created_at_span.length - 2);
+
+  g_free (priv->url);
+  priv->url = NULL;
+
+  /* the URL is built by twitter_status_get_url() */
+  if (decoder->buffer != NULL)
+    priv->lazy_url = TRUE;
+  else if (priv->user && priv->id != 0)
+    priv->url = g_strdup_printf ("%s/%s/statuses/%u",
+                                 TWITTER_DEFAULT_HOST,
+                                 twitter_user_get_screen_name (priv->user),
+                                 priv->id);
+}
+
+/* appends the fields of @status to @record; the user is not
+ * written, only its id
+ */
+void
+_twitter_status_write_record (TwitterStatus       *status,
+                              TwitterRecordWriter *record)
+{
+  TwitterStatusPrivate *priv = status->priv;
+
+  _twitter_record_write_uint32 (record, priv->id);
+  _twitter_record_write_uint32 (record, priv->user != NULL
+                                          ? twitter_user_get_id (priv->user)
+                                          : 0);
+  _twitter_record_write_uint32 (record, priv->in_reply_to_user_id);
+  _twitter_record_write_uint32 (record, priv->in_reply_to_status_id);
+  _twitter_record_write_int64 (record, priv->timestamp);
+  _twitter_record_write_uint32 (record, priv->truncated ? 1 : 0);
+
+  _twitter_record_write_string (record, priv->text);
+  _twitter_record_write_string (record, twitter_status_get_source (status));
+  _twitter_record_write_string (record, twitter_status_get_created_at (status));
+}
+
+/* reads the fields written by _twitter_status_write_record() into an
+ * empty @status, and the id of its user into @user_id; the caller is
+ * responsible for setting the user. Returns %FALSE if the record is
+ * truncated
+ */
+gboolean
+_twitter_status_read_record (TwitterStatus       *status,
+                             TwitterRecordReader *reader,
+                             guint               *user_id)
+{
+  TwitterStatusPrivate *priv = status->priv;
+
+  priv->id = _twitter_record_read_uint32 (reader);
+  *user_id = _twitter_record_read_uint32 (reader);
+  priv->in_reply_to_user_id = _twitter_record_read_uint32 (reader);
+  priv->in_reply_to_status_id = _twitter_record_read_uint32 (reader);
+  priv->timestamp = _twitter_record_read_int64 (reader);
+  priv->truncated = (_twitter_record_read_uint32 (reader) & 1) != 0;
+
+  priv->text = _twitter_record_read_string (reader);
+  priv->source = _twitter_record_read_interned (reader);
+  priv->created_at = _twitter_record_read_string (reader);
+
+  if (_twitter_record_reader_failed (reader))
+    {
+      twitter_status_clean (status);
+      return FALSE;
+    }
+
+  twitter_status_extract_entities (status);
+
+  /* the URL is built by twitter_status_get_url(), once the user
+   * has been set
+   */
+  priv->lazy_url = TRUE;
+
+  return TRUE;
+}
+
+/* decodes @buffer using the single pass decoder, unless the
+ * application asked for json-glib; returns %FALSE if json-glib
+ * should be used instead
+ */
+static gboolean
+twitter_status_decode_data (TwitterStatus *status,
+                            const gchar   *buffer)
+{
+  TwitterParseFlags flags = twitter_get_parse_flags ();
+  TwitterJsonDecoder decoder;
+  gboolean retval;
+
+  if (flags & TWITTER_PARSE_USE_JSON_GLIB)
+    return FALSE;
+
+  if (flags & TWITTER_PARSE_LAZY)
+    {
+      TwitterJsonBuffer *raw;
+
+      raw = _twitter_json_buffer_new (buffer, strlen (buffer));
+      _twitter_json_decoder_init_lazy (&decoder, raw, raw->data, raw->length);
+      _twitter_status_decode (status, &decoder);
+
+      retval = _twitter_json_decoder_at_end (&decoder);
+
+      _twitter_json_buffer_unref (raw);
+    }
+  else
+    {
+      _twitter_json_decoder_init (&decoder, buffer, strlen (buffer));
+      _twitter_status_decode (status, &decoder);
+
+      retval = _twitter_json_decoder_at_end (&decoder);
+    }
+
+  if (retval)
+    return TRUE;
+
+  /* json-glib will report the error */
+  twitter_status_clean (status);
+
+  return FALSE;
+}
+
 TwitterStatus *
 twitter_status_new (void)
 {
@@ -353,7 +848,10 @@ twitter_status_new_from_data (const gchar *buffer)
 
   retval = twitter_status_new ();
 
-  parser = json_parser_new ();
+  if (twitter_status_decode_data (retval, buffer))
+    return retval;
+
+  parser = _twitter_parse_pool_get_parser ();
   parse_error = NULL;
   json_parser_load_from_data (parser, buffer, -1, &parse_error);
   if (parse_error)
@@ -365,7 +863,7 @@ twitter_status_new_from_data (const gchar *buffer)
   else
     twitter_status_build (retval, json_parser_get_root (parser));
 
-  g_object_unref (parser);
+  _twitter_parse_pool_put_parser (parser);
 
   return retval;
 }
@@ -397,7 +895,10 @@ twitter_status_load_from_data (TwitterStatus  *status,
 
   twitter_status_clean (status);
 
-  parser = json_parser_new ();
+  if (twitter_status_decode_data (status, buffer))
+    return TRUE;
+
+  parser = _twitter_parse_pool_get_parser ();
   parse_error = NULL;
   json_parser_load_from_data (parser, buffer, -1, &parse_error);
   if (parse_error)
@@ -414,11 +915,115 @@ twitter_status_load_from_data (TwitterStatus  *status,
   else
     twitter_status_build (status, json_parser_get_root (parser));
 
-  g_object_unref (parser);
+  _twitter_parse_pool_put_parser (parser);
 
   return retval;
 }
 
+/**
+ * twitter_status_to_binary:
+ * @status: a #TwitterStatus
+ * @length: return location for the length of the data
+ *
+ * Saves @status, and the user who posted it, using a compact binary
+ * format. Unlike the JSON representation, the binary format stores
+ * ids and timestamps using a fixed width, and it is faster to load
+ * back using twitter_status_load_from_binary().
+ *
+ * The binary format is versioned, and data saved by a version of
+ * Twitter-GLib can be loaded by any newer version.
+ *
+ * Return value: a newly allocated buffer. Use g_free() to free it
+ *
+ * Since: 0.9.10
+ */
+gchar *
+twitter_status_to_binary (TwitterStatus *status,
+                          gsize         *length)
+{
+  TwitterRecordWriter writer;
+  TwitterUser *user;
+
+  g_return_val_if_fail (TWITTER_IS_STATUS (status), NULL);
+  g_return_val_if_fail (length != NULL, NULL);
+
+  _twitter_record_writer_init (&writer, TRUE);
+
+  user = status->priv->user;
+
+  _twitter_record_write_uint32 (&writer, user != NULL ? 1 : 0);
+  if (user != NULL)
+    _twitter_user_write_record (user, &writer);
+
+  _twitter_status_write_record (status, &writer);
+
+  return _twitter_record_writer_finish (&writer, TWITTER_RECORD_STATUS, length);
+}
+
+/**
+ * twitter_status_load_from_binary:
+ * @status: a #TwitterStatus
+ * @data: the data saved by twitter_status_to_binary()
+ * @length: the length of @data
+ * @error: return location for a #GError, or %NULL
+ *
+ * Loads the contents of @status, and of the user who posted it,
+ * out of the binary data saved by twitter_status_to_binary()
+ *
+ * Return value: %TRUE if the data was loaded
+ *
+ * Since: 0.9.10
+ */
+gboolean
+twitter_status_load_from_binary (TwitterStatus  *status,
+                                 const gchar    *data,
+                                 gsize           length,
+                                 GError        **error)
+{
+  TwitterRecordReader reader;
+  TwitterUser *user = NULL;
+  guint user_id;
+
+  g_return_val_if_fail (TWITTER_IS_STATUS (status), FALSE);
+  g_return_val_if_fail (data != NULL, FALSE);
+
+  twitter_status_clean (status);
+
+  if (!_twitter_record_reader_init_binary (&reader, data, length,
+                                           TWITTER_RECORD_STATUS,
+                                           error))
+    return FALSE;
+
+  if (_twitter_record_read_uint32 (&reader) != 0)
+    {
+      user = twitter_user_new ();
+      if (!_twitter_user_read_record (user, &reader))
+        goto invalid;
+    }
+
+  if (!_twitter_status_read_record (status, &reader, &user_id))
+    goto invalid;
+
+  if (user != NULL)
+    _twitter_status_set_user (status, user);
+
+  _twitter_record_reader_clear (&reader);
+
+  return TRUE;
+
+invalid:
+  if (user != NULL)
+    g_object_unref (user);
+
+  _twitter_record_reader_clear (&reader);
+
+  g_set_error (error, TWITTER_ERROR,
+               TWITTER_ERROR_PARSE_ERROR,
+               "Invalid binary data");
+
+  return FALSE;
+}
+
 TwitterUser *
 twitter_status_get_user (TwitterStatus *status)
 {
@@ -432,7 +1037,8 @@ twitter_status_get_source (TwitterStatus *status)
 {
   g_return_val_if_fail (TWITTER_IS_STATUS (status), NULL);
 
-  return status->priv->source;
+  return _twitter_json_span_materialize_interned (&status->priv->source,
+                                                  &status->priv->source_span);
 }
 
 G_CONST_RETURN gchar *
@@ -440,7 +1046,9 @@ twitter_status_get_created_at (TwitterStatus *status)
 {
   g_return_val_if_fail (TWITTER_IS_STATUS (status), NULL);
 
-  return status->priv->created_at;
+  return _twitter_json_span_materialize (&status->priv->created_at,
+                                         &status->priv->created_at_span,
+                                         status->priv->arena);
 }
 
 guint
@@ -483,12 +1091,75 @@ twitter_status_get_reply_to_status (TwitterStatus *status)
   return status->priv->in_reply_to_status_id;
 }
 
+/**
+ * twitter_status_get_timestamp:
+ * @status: a #TwitterStatus
+ *
+ * Retrieves the creation date of @status, as parsed when @status
+ * was loaded; unlike using twitter_date_to_time_val() on the result
+ * of twitter_status_get_created_at(), this function is cheap enough
+ * to be used when sorting many statuses
+ *
+ * Return value: the seconds from the epoch, or 0 if the date is
+ *   not known
+ *
+ * Since: 0.9.10
+ */
+gint64
+twitter_status_get_timestamp (TwitterStatus *status)
+{
+  g_return_val_if_fail (TWITTER_IS_STATUS (status), 0);
+
+  return status->priv->timestamp;
+}
+
+/**
+ * twitter_status_get_entities:
+ * @status: a #TwitterStatus
+ * @n_entities: (out): return location for the number of entities
+ *
+ * Retrieves the mentions, hashtags and links inside the text of
+ * @status, in the order they appear. The entities are found once,
+ * when @status is loaded.
+ *
+ * Return value: (array length=n_entities): the entities, owned by
+ *   @status, or %NULL if the text does not contain any
+ *
+ * Since: 0.9.10
+ */
+const TwitterEntity *
+twitter_status_get_entities (TwitterStatus *status,
+                             guint         *n_entities)
+{
+  g_return_val_if_fail (TWITTER_IS_STATUS (status), NULL);
+  g_return_val_if_fail (n_entities != NULL, NULL);
+
+  *n_entities = status->priv->n_entities;
+
+  return status->priv->entities;
+}
+
 G_CONST_RETURN gchar *
 twitter_status_get_url (TwitterStatus *status)
 {
+  TwitterStatusPrivate *priv;
+
   g_return_val_if_fail (TWITTER_IS_STATUS (status), NULL);
 
-  return status->priv->url;
+  priv = status->priv;
+
+  if (priv->lazy_url)
+    {
+      if (priv->user && priv->id != 0)
+        priv->url = g_strdup_printf ("%s/%s/statuses/%u",
+                                     TWITTER_DEFAULT_HOST,
+                                     twitter_user_get_screen_name (priv->user),
+                                     priv->id);
+
+      priv->lazy_url = FALSE;
+    }
+
+  return priv->url;
 }
 
 /* The TwitterUser has been finalized, so self-destruct the status */
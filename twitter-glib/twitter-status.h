@@ -33,6 +33,40 @@ G_BEGIN_DECLS
 
 /* TwitterStatus is declared inside twitter-common.h */
 
+/**
+ * TwitterEntityType:
+ * @TWITTER_ENTITY_MENTION: A mention of a user, like "@ebassi"
+ * @TWITTER_ENTITY_HASHTAG: A hashtag, like "#guadec"
+ * @TWITTER_ENTITY_URL: A link, like "http://www.gnome.org"
+ *
+ * The type of an entity inside the text of a #TwitterStatus.
+ *
+ * Since: 0.9.10
+ */
+typedef enum {
+  TWITTER_ENTITY_MENTION,
+  TWITTER_ENTITY_HASHTAG,
+  TWITTER_ENTITY_URL
+} TwitterEntityType;
+
+/**
+ * TwitterEntity:
+ * @type: the type of the entity
+ * @offset: the offset of the entity inside the text, in bytes
+ * @length: the length of the entity, in bytes; mentions and hashtags
+ *   include their leading '@' and '#'
+ *
+ * An entity found inside the text of a #TwitterStatus.
+ *
+ * Since: 0.9.10
+ */
+typedef struct {
+  TwitterEntityType type;
+
+  gint offset;
+  gint length;
+} TwitterEntity;
+
 /**
  * TwitterStatus:
  *
@@ -70,6 +104,12 @@ TwitterStatus *       twitter_status_new_from_data       (const gchar    *buffer
 gboolean              twitter_status_load_from_data      (TwitterStatus  *status,
                                                           const gchar    *buffer,
                                                           GError        **error);
+gchar *               twitter_status_to_binary           (TwitterStatus  *status,
+                                                          gsize          *length);
+gboolean              twitter_status_load_from_binary    (TwitterStatus  *status,
+                                                          const gchar    *data,
+                                                          gsize           length,
+                                                          GError        **error);
 
 TwitterUser *         twitter_status_get_user            (TwitterStatus  *status);
 G_CONST_RETURN gchar *twitter_status_get_source          (TwitterStatus  *status);
@@ -80,6 +120,9 @@ G_CONST_RETURN gchar *twitter_status_get_text            (TwitterStatus  *status
 guint                 twitter_status_get_reply_to_user   (TwitterStatus  *status);
 guint                 twitter_status_get_reply_to_status (TwitterStatus  *status);
 G_CONST_RETURN gchar *twitter_status_get_url             (TwitterStatus  *status);
+gint64                twitter_status_get_timestamp       (TwitterStatus  *status);
+const TwitterEntity * twitter_status_get_entities        (TwitterStatus  *status,
+                                                          guint          *n_entities);
 
 G_END_DECLS
 
@@ -0,0 +1,1004 @@
+/* twitter-store.c: Persistent storage of statuses
+ *
+ * This file is part of Twitter-GLib.
+ * Copyright (C) 2008  Emmanuele Bassi  <ebassi@gnome.org>
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:twitter-store
+ * @short_description: A persistent log of statuses
+ *
+ * #TwitterStore keeps the statuses received from the provider inside
+ * a file, so that timelines can be rebuilt after a restart without
+ * fetching them again.
+ *
+ * The statuses are stored under a key chosen by the application,
+ * usually identifying the account and the timeline they were
+ * retrieved from, using twitter_store_add_timeline(); a timeline
+ * holding every status stored under a key can be retrieved using
+ * twitter_store_get_timeline().
+ *
+ * The file is an append-only log of compact binary records: each
+ * status is written once for every key, and each user is written
+ * again only when its data changes. The file is memory mapped to be
+ * read, and only the records appended since the last read are
+ * scanned.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+#include <errno.h>
+#include <stdio.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <gio/gio.h>
+
+#include "twitter-common.h"
+#include "twitter-private.h"
+#include "twitter-record.h"
+#include "twitter-store.h"
+#include "twitter-timeline.h"
+
+#define TWITTER_STORE_GET_PRIVATE(obj)  (G_TYPE_INSTANCE_GET_PRIVATE ((obj), TWITTER_TYPE_STORE, TwitterStorePrivate))
+
+/* the file starts with the magic string, including the nul
+ * terminator, and the version of the format
+ */
+#define STORE_MAGIC             "TWSTORE"
+#define STORE_MAGIC_SIZE        8
+#define STORE_VERSION           1
+#define STORE_HEADER_SIZE       (STORE_MAGIC_SIZE + 4)
+
+/* each record starts with the length of its payload and its kind */
+#define RECORD_HEADER_SIZE      8
+
+enum
+{
+  RECORD_USER   = 1,
+
+  /* the key, followed by the status */
+  RECORD_STATUS = 2
+};
+
+typedef struct {
+  /* the offsets of the payloads of the status records */
+  GArray *offsets;
+
+  /* the ids of the statuses stored under the key */
+  GHashTable *ids;
+} StoreTimeline;
+
+typedef struct {
+  /* the offset of the payload of the latest user record */
+  gsize offset;
+
+  /* used to skip writing a user that did not change */
+  guint32 digest;
+} StoreUser;
+
+struct _TwitterStorePrivate
+{
+  gchar *filename;
+
+  GMappedFile *map;
+
+  /* the bytes of the file that have been scanned; records appended
+   * past this point are scanned on the next read
+   */
+  gsize indexed_length;
+
+  /* key -> StoreTimeline */
+  GHashTable *timelines;
+
+  /* user id -> StoreUser */
+  GHashTable *users;
+
+  FILE *log;
+
+  guint dirty : 1;
+};
+
+enum
+{
+  PROP_0,
+
+  PROP_FILENAME
+};
+
+G_DEFINE_TYPE (TwitterStore, twitter_store, G_TYPE_OBJECT);
+
+static void
+store_timeline_free (gpointer data)
+{
+  StoreTimeline *timeline = data;
+
+  g_array_free (timeline->offsets, TRUE);
+  g_hash_table_destroy (timeline->ids);
+
+  g_slice_free (StoreTimeline, timeline);
+}
+
+static void
+store_user_free (gpointer data)
+{
+  g_slice_free (StoreUser, data);
+}
+
+static void
+twitter_store_finalize (GObject *gobject)
+{
+  TwitterStorePrivate *priv = TWITTER_STORE (gobject)->priv;
+
+  if (priv->log != NULL)
+    fclose (priv->log);
+
+  if (priv->map != NULL)
+    g_mapped_file_unref (priv->map);
+
+  g_hash_table_destroy (priv->timelines);
+  g_hash_table_destroy (priv->users);
+
+  g_free (priv->filename);
+
+  G_OBJECT_CLASS (twitter_store_parent_class)->finalize (gobject);
+}
+
+static void
+twitter_store_set_property (GObject      *gobject,
+                            guint         prop_id,
+                            const GValue *value,
+                            GParamSpec   *pspec)
+{
+  TwitterStorePrivate *priv = TWITTER_STORE (gobject)->priv;
+
+  switch (prop_id)
+    {
+    case PROP_FILENAME:
+      g_free (priv->filename);
+      priv->filename = g_value_dup_string (value);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+twitter_store_get_property (GObject    *gobject,
+                            guint       prop_id,
+                            GValue     *value,
+                            GParamSpec *pspec)
+{
+  TwitterStorePrivate *priv = TWITTER_STORE (gobject)->priv;
+
+  switch (prop_id)
+    {
+    case PROP_FILENAME:
+      g_value_set_string (value, priv->filename);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+twitter_store_class_init (TwitterStoreClass *klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  GParamSpec *pspec;
+
+  g_type_class_add_private (klass, sizeof (TwitterStorePrivate));
+
+  gobject_class->set_property = twitter_store_set_property;
+  gobject_class->get_property = twitter_store_get_property;
+  gobject_class->finalize = twitter_store_finalize;
+
+  /**
+   * TwitterStore:filename:
+   *
+   * The path of the file used by the store
+   *
+   * Since: 0.9.10
+   */
+  pspec = g_param_spec_string ("filename",
+                               "Filename",
+                               "The path of the file used by the store",
+                               NULL,
+                               G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE);
+  g_object_class_install_property (gobject_class, PROP_FILENAME, pspec);
+}
+
+static void
+twitter_store_init (TwitterStore *store)
+{
+  TwitterStorePrivate *priv;
+
+  store->priv = priv = TWITTER_STORE_GET_PRIVATE (store);
+
+  priv->timelines = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                           g_free,
+                                           store_timeline_free);
+  priv->users = g_hash_table_new_full (NULL, NULL,
+                                       NULL,
+                                       store_user_free);
+
+  /* nothing has been read yet */
+  priv->dirty = TRUE;
+}
+
+/* FNV-1a */
+static guint32
+record_digest (const gchar *data,
+               gsize        length)
+{
+  guint32 digest = 2166136261U;
+  gsize i;
+
+  for (i = 0; i < length; i++)
+    {
+      digest ^= (guchar) data[i];
+      digest *= 16777619U;
+    }
+
+  return digest;
+}
+
+static StoreTimeline *
+twitter_store_get_store_timeline (TwitterStore *store,
+                                  const gchar  *key,
+                                  gsize         key_len)
+{
+  TwitterStorePrivate *priv = store->priv;
+  StoreTimeline *timeline;
+  gchar *real_key;
+
+  real_key = g_strndup (key, key_len);
+
+  timeline = g_hash_table_lookup (priv->timelines, real_key);
+  if (timeline == NULL)
+    {
+      timeline = g_slice_new (StoreTimeline);
+      timeline->offsets = g_array_new (FALSE, FALSE, sizeof (gsize));
+      timeline->ids = g_hash_table_new (NULL, NULL);
+
+      g_hash_table_insert (priv->timelines, real_key, timeline);
+    }
+  else
+    g_free (real_key);
+
+  return timeline;
+}
+
+static void
+twitter_store_index_record (TwitterStore *store,
+                            guint32       kind,
+                            const gchar  *payload,
+                            gsize         offset,
+                            gsize         length)
+{
+  TwitterStorePrivate *priv = store->priv;
+  TwitterRecordReader reader;
+
+  _twitter_record_reader_init (&reader, payload, length);
+
+  switch (kind)
+    {
+    case RECORD_USER:
+      {
+        StoreUser *user;
+        guint user_id;
+
+        user_id = _twitter_record_read_uint32 (&reader);
+        if (_twitter_record_reader_failed (&reader) || user_id == 0)
+          break;
+
+        user = g_hash_table_lookup (priv->users, GUINT_TO_POINTER (user_id));
+        if (user == NULL)
+          {
+            user = g_slice_new (StoreUser);
+            g_hash_table_insert (priv->users, GUINT_TO_POINTER (user_id), user);
+          }
+
+        user->offset = offset;
+        user->digest = record_digest (payload, length);
+      }
+      break;
+
+    case RECORD_STATUS:
+      {
+        StoreTimeline *timeline;
+        const gchar *key;
+        gsize key_len = 0;
+        guint status_id;
+
+        key = _twitter_record_read_string_data (&reader, &key_len);
+        status_id = _twitter_record_read_uint32 (&reader);
+        if (key == NULL || _twitter_record_reader_failed (&reader))
+          break;
+
+        timeline = twitter_store_get_store_timeline (store, key, key_len);
+        g_array_append_val (timeline->offsets, offset);
+        g_hash_table_insert (timeline->ids,
+                             GUINT_TO_POINTER (status_id),
+                             GUINT_TO_POINTER (status_id));
+      }
+      break;
+
+    /* records of unknown kinds are skipped */
+    default:
+      break;
+    }
+}
+
+/* maps the file again, and scans the records appended since the
+ * last time the file was read
+ */
+static gboolean
+twitter_store_refresh (TwitterStore  *store,
+                       GError       **error)
+{
+  TwitterStorePrivate *priv = store->priv;
+  GError *internal_error;
+  const gchar *contents;
+  gsize length, offset;
+
+  if (!priv->dirty)
+    return TRUE;
+
+  if (priv->map != NULL)
+    {
+      g_mapped_file_unref (priv->map);
+      priv->map = NULL;
+    }
+
+  internal_error = NULL;
+  priv->map = g_mapped_file_new (priv->filename, FALSE, &internal_error);
+  if (internal_error != NULL)
+    {
+      /* a missing file is an empty store */
+      if (g_error_matches (internal_error, G_FILE_ERROR, G_FILE_ERROR_NOENT))
+        {
+          g_error_free (internal_error);
+          priv->indexed_length = 0;
+          priv->dirty = FALSE;
+
+          return TRUE;
+        }
+
+      g_propagate_error (error, internal_error);
+
+      return FALSE;
+    }
+
+  contents = g_mapped_file_get_contents (priv->map);
+  length = g_mapped_file_get_length (priv->map);
+
+  if (priv->indexed_length == 0)
+    {
+      guint32 version;
+
+      /* a file without a complete header is an empty store, and
+       * will be overwritten by the next append
+       */
+      if (length < STORE_HEADER_SIZE)
+        {
+          priv->dirty = FALSE;
+          return TRUE;
+        }
+
+      memcpy (&version, contents + STORE_MAGIC_SIZE, sizeof (version));
+
+      if (memcmp (contents, STORE_MAGIC, STORE_MAGIC_SIZE) != 0 ||
+          GUINT32_FROM_LE (version) != STORE_VERSION)
+        {
+          g_set_error (error, TWITTER_ERROR,
+                       TWITTER_ERROR_PARSE_ERROR,
+                       "The file '%s' is not a valid store",
+                       priv->filename);
+          return FALSE;
+        }
+
+      priv->indexed_length = STORE_HEADER_SIZE;
+    }
+
+  offset = priv->indexed_length;
+
+  /* a truncated record at the end of the file, left by an interrupted
+   * write, is ignored and will be overwritten by the next append
+   */
+  while (length >= offset && length - offset >= RECORD_HEADER_SIZE)
+    {
+      guint32 record_length, kind;
+
+      memcpy (&record_length, contents + offset, sizeof (guint32));
+      memcpy (&kind, contents + offset + 4, sizeof (guint32));
+
+      record_length = GUINT32_FROM_LE (record_length);
+      kind = GUINT32_FROM_LE (kind);
+
+      if (length - offset - RECORD_HEADER_SIZE < record_length)
+        break;
+
+      offset += RECORD_HEADER_SIZE;
+
+      twitter_store_index_record (store, kind,
+                                  contents + offset,
+                                  offset,
+                                  record_length);
+
+      offset += record_length;
+    }
+
+  priv->indexed_length = offset;
+  priv->dirty = FALSE;
+
+  return TRUE;
+}
+
+/* truncate() is not available everywhere, so we go through GIO */
+static gboolean
+store_truncate_file (const gchar  *filename,
+                     goffset       length,
+                     GError      **error)
+{
+  GFile *file;
+  GFileIOStream *stream;
+  gboolean retval = FALSE;
+
+  file = g_file_new_for_path (filename);
+
+  stream = g_file_open_readwrite (file, NULL, error);
+  if (stream != NULL)
+    {
+      retval = g_seekable_truncate (G_SEEKABLE (stream), length, NULL, error);
+
+      if (!g_io_stream_close (G_IO_STREAM (stream), NULL, retval ? error : NULL))
+        retval = FALSE;
+
+      g_object_unref (stream);
+    }
+
+  g_object_unref (file);
+
+  return retval;
+}
+
+static gboolean
+twitter_store_open_log (TwitterStore  *store,
+                        GError       **error)
+{
+  TwitterStorePrivate *priv = store->priv;
+  struct stat stat_buf;
+  int saved_errno;
+
+  if (priv->log != NULL)
+    return TRUE;
+
+  if (priv->indexed_length == 0)
+    {
+      priv->log = g_fopen (priv->filename, "wb");
+      if (priv->log != NULL)
+        {
+          guint32 version = GUINT32_TO_LE (STORE_VERSION);
+          gchar header[STORE_HEADER_SIZE];
+
+          memcpy (header, STORE_MAGIC, STORE_MAGIC_SIZE);
+          memcpy (header + STORE_MAGIC_SIZE, &version, sizeof (version));
+
+          /* the header must be on disk before any record is
+           * appended, or the file could not be read back
+           */
+          if (fwrite (header, STORE_HEADER_SIZE, 1, priv->log) == 1 &&
+              fflush (priv->log) == 0)
+            priv->indexed_length = STORE_HEADER_SIZE;
+        }
+    }
+  else
+    {
+      /* drop the truncated record of an interrupted write */
+      if (g_stat (priv->filename, &stat_buf) == 0 &&
+          (gsize) stat_buf.st_size > priv->indexed_length)
+        {
+          if (!store_truncate_file (priv->filename, priv->indexed_length, error))
+            {
+              g_prefix_error (error, "Unable to open the store '%s': ",
+                              priv->filename);
+              return FALSE;
+            }
+        }
+
+      priv->log = g_fopen (priv->filename, "ab");
+    }
+
+  if (priv->log != NULL && priv->indexed_length != 0)
+    return TRUE;
+
+  saved_errno = errno;
+
+  g_set_error (error, G_FILE_ERROR,
+               g_file_error_from_errno (saved_errno),
+               "Unable to open the store '%s': %s",
+               priv->filename,
+               g_strerror (saved_errno));
+
+  if (priv->log != NULL)
+    {
+      fclose (priv->log);
+      priv->log = NULL;
+    }
+
+  return FALSE;
+}
+
+/* closes the log after a failed write; the records that did not
+ * reach the file are forgotten, and anything past the last complete
+ * record is truncated away when the log is opened again
+ */
+static void
+twitter_store_discard_log (TwitterStore  *store,
+                           StoreTimeline *store_timeline,
+                           GArray        *status_ids,
+                           GArray        *user_ids)
+{
+  TwitterStorePrivate *priv = store->priv;
+  guint i;
+
+  fclose (priv->log);
+  priv->log = NULL;
+
+  for (i = 0; i < status_ids->len; i++)
+    g_hash_table_remove (store_timeline->ids,
+                         GUINT_TO_POINTER (g_array_index (status_ids, guint, i)));
+
+  /* the records that did reach the file set the digest again
+   * when they are scanned
+   */
+  for (i = 0; i < user_ids->len; i++)
+    {
+      StoreUser *store_user;
+
+      store_user = g_hash_table_lookup (priv->users,
+                                        GUINT_TO_POINTER (g_array_index (user_ids, guint, i)));
+      if (store_user != NULL)
+        store_user->digest = 0;
+    }
+}
+
+static gboolean
+twitter_store_write_record (TwitterStore  *store,
+                            guint32        kind,
+                            GString       *payload,
+                            GError       **error)
+{
+  TwitterStorePrivate *priv = store->priv;
+  guint32 header[2];
+
+  header[0] = GUINT32_TO_LE (payload->len);
+  header[1] = GUINT32_TO_LE (kind);
+
+  if (fwrite (header, sizeof (header), 1, priv->log) != 1 ||
+      fwrite (payload->str, payload->len, 1, priv->log) != 1)
+    {
+      int saved_errno = errno;
+
+      g_set_error (error, G_FILE_ERROR,
+                   g_file_error_from_errno (saved_errno),
+                   "Unable to write to the store '%s': %s",
+                   priv->filename,
+                   g_strerror (saved_errno));
+
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+/* writes @user, unless the latest record of the user is the same */
+static gboolean
+twitter_store_write_user (TwitterStore        *store,
+                          TwitterUser         *user,
+                          TwitterRecordWriter *writer,
+                          GArray              *user_ids,
+                          GError             **error)
+{
+  TwitterStorePrivate *priv = store->priv;
+  GString *payload = writer->buffer;
+  StoreUser *store_user;
+  guint32 digest;
+  guint user_id;
+
+  user_id = twitter_user_get_id (user);
+  if (user_id == 0)
+    return TRUE;
+
+  g_string_truncate (payload, 0);
+  _twitter_user_write_record (user, writer);
+
+  digest = record_digest (payload->str, payload->len);
+
+  store_user = g_hash_table_lookup (priv->users, GUINT_TO_POINTER (user_id));
+  if (store_user != NULL && store_user->digest == digest)
+    return TRUE;
+
+  if (!twitter_store_write_record (store, RECORD_USER, payload, error))
+    return FALSE;
+
+  /* the offset is set when the record is scanned */
+  if (store_user == NULL)
+    {
+      store_user = g_slice_new0 (StoreUser);
+      g_hash_table_insert (priv->users, GUINT_TO_POINTER (user_id), store_user);
+    }
+
+  store_user->digest = digest;
+  g_array_append_val (user_ids, user_id);
+
+  return TRUE;
+}
+
+/**
+ * twitter_store_new:
+ * @filename: the path of the file used by the store
+ *
+ * Creates a new #TwitterStore using @filename. The file is not
+ * accessed until the store is used, and will be created if it
+ * does not exist.
+ *
+ * Return value: the newly created #TwitterStore. Use g_object_unref()
+ *   to free the resources it allocates
+ *
+ * Since: 0.9.10
+ */
+TwitterStore *
+twitter_store_new (const gchar *filename)
+{
+  g_return_val_if_fail (filename != NULL, NULL);
+
+  return g_object_new (TWITTER_TYPE_STORE, "filename", filename, NULL);
+}
+
+/**
+ * twitter_store_get_filename:
+ * @store: a #TwitterStore
+ *
+ * Retrieves the path of the file used by @store
+ *
+ * Return value: the path of the file
+ *
+ * Since: 0.9.10
+ */
+G_CONST_RETURN gchar *
+twitter_store_get_filename (TwitterStore *store)
+{
+  g_return_val_if_fail (TWITTER_IS_STORE (store), NULL);
+
+  return store->priv->filename;
+}
+
+/**
+ * twitter_store_load:
+ * @store: a #TwitterStore
+ * @error: return location for a #GError, or %NULL
+ *
+ * Reads the contents of the file used by @store. Calling this
+ * function is not required, as the file is read the first time
+ * the store is used, but it allows to report errors, and to read
+ * the file before it is needed.
+ *
+ * A missing file is considered an empty store.
+ *
+ * Return value: %TRUE if the file was read, %FALSE otherwise
+ *
+ * Since: 0.9.10
+ */
+gboolean
+twitter_store_load (TwitterStore  *store,
+                    GError       **error)
+{
+  g_return_val_if_fail (TWITTER_IS_STORE (store), FALSE);
+
+  return twitter_store_refresh (store, error);
+}
+
+/**
+ * twitter_store_add_timeline:
+ * @store: a #TwitterStore
+ * @key: the key to store the statuses under
+ * @timeline: a #TwitterTimeline
+ * @error: return location for a #GError, or %NULL
+ *
+ * Appends the statuses of @timeline, and their users, to the file
+ * used by @store. The statuses already stored under @key are not
+ * written again, so the same timeline can be added after each
+ * refresh.
+ *
+ * The @key is chosen by the application, and should identify the
+ * account and the timeline the statuses were retrieved from, for
+ * instance "user@example.com/friends".
+ *
+ * Return value: %TRUE if the statuses were stored, %FALSE otherwise
+ *
+ * Since: 0.9.10
+ */
+gboolean
+twitter_store_add_timeline (TwitterStore     *store,
+                            const gchar      *key,
+                            TwitterTimeline  *timeline,
+                            GError          **error)
+{
+  TwitterStorePrivate *priv;
+  StoreTimeline *store_timeline;
+  TwitterRecordWriter writer;
+  GArray *status_ids, *user_ids;
+  GList *statuses, *l;
+  gboolean retval = TRUE;
+
+  g_return_val_if_fail (TWITTER_IS_STORE (store), FALSE);
+  g_return_val_if_fail (key != NULL, FALSE);
+  g_return_val_if_fail (TWITTER_IS_TIMELINE (timeline), FALSE);
+
+  priv = store->priv;
+
+  if (!twitter_store_refresh (store, error))
+    return FALSE;
+
+  if (!twitter_store_open_log (store, error))
+    return FALSE;
+
+  store_timeline = twitter_store_get_store_timeline (store, key, strlen (key));
+
+  _twitter_record_writer_init (&writer, FALSE);
+
+  /* what was written by this call, to be forgotten on failure */
+  status_ids = g_array_new (FALSE, FALSE, sizeof (guint));
+  user_ids = g_array_new (FALSE, FALSE, sizeof (guint));
+
+  statuses = twitter_timeline_get_all (timeline);
+  for (l = statuses; l != NULL && retval; l = l->next)
+    {
+      TwitterStatus *status = l->data;
+      TwitterUser *user;
+      guint status_id;
+
+      status_id = twitter_status_get_id (status);
+      if (g_hash_table_lookup (store_timeline->ids,
+                               GUINT_TO_POINTER (status_id)) != NULL)
+        continue;
+
+      user = twitter_status_get_user (status);
+      if (user != NULL &&
+          !twitter_store_write_user (store, user, &writer, user_ids, error))
+        {
+          retval = FALSE;
+          break;
+        }
+
+      g_string_truncate (writer.buffer, 0);
+      _twitter_record_write_string (&writer, key);
+      _twitter_status_write_record (status, &writer);
+
+      retval = twitter_store_write_record (store, RECORD_STATUS,
+                                           writer.buffer,
+                                           error);
+      if (retval)
+        {
+          g_hash_table_insert (store_timeline->ids,
+                               GUINT_TO_POINTER (status_id),
+                               GUINT_TO_POINTER (status_id));
+          g_array_append_val (status_ids, status_id);
+        }
+    }
+
+  g_list_free (statuses);
+  _twitter_record_writer_clear (&writer);
+
+  if (fflush (priv->log) != 0 && retval)
+    {
+      int saved_errno = errno;
+
+      g_set_error (error, G_FILE_ERROR,
+                   g_file_error_from_errno (saved_errno),
+                   "Unable to write to the store '%s': %s",
+                   priv->filename,
+                   g_strerror (saved_errno));
+
+      retval = FALSE;
+    }
+
+  if (!retval)
+    twitter_store_discard_log (store, store_timeline, status_ids, user_ids);
+
+  g_array_free (status_ids, TRUE);
+  g_array_free (user_ids, TRUE);
+
+  /* the new records are scanned on the next read */
+  priv->dirty = TRUE;
+
+  return retval;
+}
+
+/* builds the user out of its latest record */
+static TwitterUser *
+twitter_store_build_user (TwitterStore *store,
+                          GHashTable   *users,
+                          guint         user_id)
+{
+  TwitterStorePrivate *priv = store->priv;
+  const gchar *contents;
+  TwitterRecordReader reader;
+  StoreUser *store_user;
+  TwitterUser *user;
+  guint32 length;
+
+  user = g_hash_table_lookup (users, GUINT_TO_POINTER (user_id));
+  if (user != NULL)
+    return user;
+
+  store_user = g_hash_table_lookup (priv->users, GUINT_TO_POINTER (user_id));
+  if (store_user == NULL || store_user->offset == 0)
+    return NULL;
+
+  contents = g_mapped_file_get_contents (priv->map);
+
+  memcpy (&length, contents + store_user->offset - RECORD_HEADER_SIZE,
+          sizeof (guint32));
+
+  _twitter_record_reader_init (&reader,
+                               contents + store_user->offset,
+                               GUINT32_FROM_LE (length));
+
+  user = twitter_user_new ();
+  if (!_twitter_user_read_record (user, &reader))
+    {
+      g_object_unref (user);
+      return NULL;
+    }
+
+  g_hash_table_insert (users, GUINT_TO_POINTER (user_id), user);
+
+  return user;
+}
+
+/**
+ * twitter_store_get_timeline:
+ * @store: a #TwitterStore
+ * @key: the key the statuses were stored under
+ *
+ * Builds a #TwitterTimeline containing every status stored under
+ * @key, without any access to the network. The users of the
+ * statuses will be built out of their latest stored copy, and
+ * shared among the statuses.
+ *
+ * Return value: a newly created #TwitterTimeline, or %NULL if no
+ *   status was stored under @key. Use g_object_unref() to free the
+ *   resources it allocates
+ *
+ * Since: 0.9.10
+ */
+TwitterTimeline *
+twitter_store_get_timeline (TwitterStore *store,
+                            const gchar  *key)
+{
+  TwitterStorePrivate *priv;
+  StoreTimeline *store_timeline;
+  TwitterTimeline *retval;
+  const gchar *contents;
+  GHashTable *users;
+  GPtrArray *statuses;
+  GError *error;
+  guint i;
+
+  g_return_val_if_fail (TWITTER_IS_STORE (store), NULL);
+  g_return_val_if_fail (key != NULL, NULL);
+
+  priv = store->priv;
+
+  error = NULL;
+  if (!twitter_store_refresh (store, &error))
+    {
+      g_warning ("Unable to read the store: %s", error->message);
+      g_error_free (error);
+
+      return NULL;
+    }
+
+  store_timeline = g_hash_table_lookup (priv->timelines, key);
+  if (store_timeline == NULL || store_timeline->offsets->len == 0)
+    return NULL;
+
+  contents = g_mapped_file_get_contents (priv->map);
+
+  users = g_hash_table_new (NULL, NULL);
+  statuses = g_ptr_array_sized_new (store_timeline->offsets->len);
+
+  for (i = 0; i < store_timeline->offsets->len; i++)
+    {
+      gsize offset = g_array_index (store_timeline->offsets, gsize, i);
+      TwitterRecordReader reader;
+      TwitterStatus *status;
+      guint32 length;
+      guint user_id;
+      gsize key_len;
+
+      memcpy (&length, contents + offset - RECORD_HEADER_SIZE, sizeof (guint32));
+
+      _twitter_record_reader_init (&reader, contents + offset,
+                                   GUINT32_FROM_LE (length));
+      _twitter_record_read_string_data (&reader, &key_len);
+
+      status = twitter_status_new ();
+      if (!_twitter_status_read_record (status, &reader, &user_id))
+        {
+          g_object_unref (status);
+          continue;
+        }
+
+      if (user_id != 0)
+        {
+          TwitterUser *user = twitter_store_build_user (store, users, user_id);
+
+          if (user != NULL)
+            _twitter_status_set_user (status, user);
+        }
+
+      g_ptr_array_add (statuses, status);
+    }
+
+  retval = twitter_timeline_new ();
+  _twitter_timeline_add_statuses (retval, statuses);
+
+  g_ptr_array_free (statuses, TRUE);
+  g_hash_table_destroy (users);
+
+  return retval;
+}
+
+/**
+ * twitter_store_get_keys:
+ * @store: a #TwitterStore
+ *
+ * Retrieves the keys the statuses inside @store were stored under
+ *
+ * Return value: a list of keys. The keys are owned by @store and
+ *   should not be modified or freed. Use g_list_free() to free
+ *   the resources allocated by the list
+ *
+ * Since: 0.9.10
+ */
+GList *
+twitter_store_get_keys (TwitterStore *store)
+{
+  GError *error = NULL;
+
+  g_return_val_if_fail (TWITTER_IS_STORE (store), NULL);
+
+  if (!twitter_store_refresh (store, &error))
+    {
+      g_warning ("Unable to read the store: %s", error->message);
+      g_error_free (error);
+
+      return NULL;
+    }
+
+  return g_hash_table_get_keys (store->priv->timelines);
+}
@@ -0,0 +1,82 @@
+/* twitter-store.h: Persistent storage of statuses
+ *
+ * This file is part of Twitter-GLib.
+ * Copyright (C) 2008  Emmanuele Bassi  <ebassi@gnome.org>
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef __TWITTER_STORE_H__
+#define __TWITTER_STORE_H__
+
+#include <glib-object.h>
+
+#include <twitter-glib/twitter-timeline.h>
+
+G_BEGIN_DECLS
+
+#define TWITTER_TYPE_STORE              (twitter_store_get_type ())
+#define TWITTER_STORE(obj)              (G_TYPE_CHECK_INSTANCE_CAST ((obj), TWITTER_TYPE_STORE, TwitterStore))
+#define TWITTER_IS_STORE(obj)           (G_TYPE_CHECK_INSTANCE_TYPE ((obj), TWITTER_TYPE_STORE))
+#define TWITTER_STORE_CLASS(klass)      (G_TYPE_CHECK_CLASS_CAST ((klass), TWITTER_TYPE_STORE, TwitterStoreClass))
+#define TWITTER_IS_STORE_CLASS(klass)   (G_TYPE_CHECK_CLASS_TYPE ((klass), TWITTER_TYPE_STORE))
+#define TWITTER_STORE_GET_CLASS(obj)    (G_TYPE_INSTANCE_GET_CLASS ((obj), TWITTER_TYPE_STORE, TwitterStoreClass))
+
+typedef struct _TwitterStore            TwitterStore;
+typedef struct _TwitterStorePrivate     TwitterStorePrivate;
+typedef struct _TwitterStoreClass       TwitterStoreClass;
+
+/**
+ * TwitterStore:
+ *
+ * The #TwitterStore struct contains private data only, and
+ * should only be accessed using the functions below.
+ */
+struct _TwitterStore
+{
+  /*< private >*/
+  GObject parent_instance;
+
+  TwitterStorePrivate *priv;
+};
+
+/**
+ * TwitterStoreClass:
+ *
+ * The #TwitterStoreClass struct contains only private data
+ */
+struct _TwitterStoreClass
+{
+  /*< private >*/
+  GObjectClass parent_class;
+};
+
+GType                 twitter_store_get_type     (void) G_GNUC_CONST;
+
+TwitterStore *        twitter_store_new          (const gchar     *filename);
+
+G_CONST_RETURN gchar *twitter_store_get_filename (TwitterStore    *store);
+
+gboolean              twitter_store_load         (TwitterStore    *store,
+                                                  GError         **error);
+gboolean              twitter_store_add_timeline (TwitterStore    *store,
+                                                  const gchar     *key,
+                                                  TwitterTimeline *timeline,
+                                                  GError         **error);
+TwitterTimeline *     twitter_store_get_timeline (TwitterStore    *store,
+                                                  const gchar     *key);
+GList *               twitter_store_get_keys     (TwitterStore    *store);
+
+G_END_DECLS
+
+#endif /* __TWITTER_STORE_H__ */
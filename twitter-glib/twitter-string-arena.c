@@ -0,0 +1,99 @@
+/* twitter-string-arena.c: Shared storage for decoded strings
+ *
+ * This file is part of Twitter-GLib.
+ * Copyright (C) 2008  Emmanuele Bassi  <ebassi@gnome.org>
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Decoding a page of statuses used to allocate a dozen strings for
+ * every status and every embedded user, which fragments the heap of
+ * long running applications polling the provider, and makes releasing
+ * a timeline a long list of g_free() calls. The arena stores all the
+ * strings of a page in a few large chunks instead.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "twitter-string-arena.h"
+
+/* the size of the chunks, if the caller has no better idea */
+#define ARENA_DEFAULT_SIZE      (16 * 1024)
+
+struct _TwitterStringArena
+{
+  volatile gint ref_count;
+
+  /* the parse pool inserts strings from many threads */
+  GMutex *lock;
+
+  GStringChunk *chunk;
+};
+
+/* @size_hint is the expected amount of bytes needed by the strings,
+ * for instance the size of the buffer that is being decoded
+ */
+TwitterStringArena *
+_twitter_string_arena_new (gsize size_hint)
+{
+  TwitterStringArena *arena;
+
+  arena = g_slice_new (TwitterStringArena);
+  arena->ref_count = 1;
+  arena->lock = g_mutex_new ();
+  arena->chunk = g_string_chunk_new (CLAMP (size_hint, 1024, ARENA_DEFAULT_SIZE * 8));
+
+  return arena;
+}
+
+TwitterStringArena *
+_twitter_string_arena_ref (TwitterStringArena *arena)
+{
+  g_atomic_int_inc (&arena->ref_count);
+
+  return arena;
+}
+
+void
+_twitter_string_arena_unref (TwitterStringArena *arena)
+{
+  if (!g_atomic_int_dec_and_test (&arena->ref_count))
+    return;
+
+  g_string_chunk_free (arena->chunk);
+
+  if (arena->lock != NULL)
+    g_mutex_free (arena->lock);
+
+  g_slice_free (TwitterStringArena, arena);
+}
+
+/* copies the @len bytes of @str into the arena, adding a terminating
+ * nul character; the returned string must not be freed
+ */
+gchar *
+_twitter_string_arena_insert_len (TwitterStringArena *arena,
+                                  const gchar        *str,
+                                  gsize               len)
+{
+  gchar *retval;
+
+  g_mutex_lock (arena->lock);
+  retval = g_string_chunk_insert_len (arena->chunk, str, len);
+  g_mutex_unlock (arena->lock);
+
+  return retval;
+}
@@ -0,0 +1,48 @@
+/* twitter-string-arena.h: Shared storage for decoded strings
+ *
+ * This file is part of Twitter-GLib.
+ * Copyright (C) 2008  Emmanuele Bassi  <ebassi@gnome.org>
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef __TWITTER_STRING_ARENA_H__
+#define __TWITTER_STRING_ARENA_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/*
+ * TwitterStringArena:
+ *
+ * A reference counted store for the strings decoded while loading
+ * a whole timeline or user list. Each object decoded into the arena
+ * holds a reference on it, and the strings are released all at once
+ * when the last object goes away.
+ *
+ * Inserting strings is thread safe.
+ */
+typedef struct _TwitterStringArena      TwitterStringArena;
+
+TwitterStringArena *_twitter_string_arena_new        (gsize               size_hint);
+TwitterStringArena *_twitter_string_arena_ref        (TwitterStringArena *arena);
+void                _twitter_string_arena_unref      (TwitterStringArena *arena);
+
+gchar *             _twitter_string_arena_insert_len (TwitterStringArena *arena,
+                                                      const gchar        *str,
+                                                      gsize               len);
+
+G_END_DECLS
+
+#endif /* __TWITTER_STRING_ARENA_H__ */
@@ -0,0 +1,653 @@
+/* twitter-text-index.c: Inverted index over the text of statuses
+ *
+ * This file is part of Twitter-GLib.
+ * Copyright (C) 2008  Emmanuele Bassi  <ebassi@gnome.org>
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* The text is split into words made of letters, digits and
+ * underscores, so "@ebassi" and "#guadec" are indexed as "ebassi"
+ * and "guadec"; each word is case folded.
+ *
+ * Each word has a posting list: for each document containing it, by
+ * ascending id, the difference from the previous id, the number of
+ * times the word appears, and the differences between the positions
+ * of the word inside the document, all encoded as variable length
+ * integers. Most differences fit in a single byte.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include "twitter-text-index.h"
+
+typedef struct {
+  GByteArray *data;
+
+  guint last_id;
+  guint n_docs;
+} TextPostings;
+
+/* a posting list decoded for a query */
+typedef struct {
+  GArray *ids;
+
+  /* for each document, the index of its first position; the
+   * positions are only decoded for phrases
+   */
+  GArray *offsets;
+  GArray *positions;
+} DecodedPostings;
+
+struct _TwitterTextIndex
+{
+  /* folded word -> TextPostings */
+  GHashTable *terms;
+};
+
+static void
+text_postings_free (gpointer data)
+{
+  TextPostings *postings = data;
+
+  g_byte_array_free (postings->data, TRUE);
+
+  g_slice_free (TextPostings, postings);
+}
+
+TwitterTextIndex *
+_twitter_text_index_new (void)
+{
+  TwitterTextIndex *retval = g_slice_new (TwitterTextIndex);
+
+  retval->terms = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                         g_free,
+                                         text_postings_free);
+
+  return retval;
+}
+
+void
+_twitter_text_index_free (TwitterTextIndex *index_)
+{
+  if (index_ == NULL)
+    return;
+
+  g_hash_table_destroy (index_->terms);
+
+  g_slice_free (TwitterTextIndex, index_);
+}
+
+/* returns the folded words of @text, in order */
+static GPtrArray *
+tokenize (const gchar *text)
+{
+  GPtrArray *retval = g_ptr_array_new ();
+  const gchar *p, *start = NULL;
+
+  for (p = text; ; p = g_utf8_next_char (p))
+    {
+      gunichar c = g_utf8_get_char (p);
+
+      if (c != 0 && (g_unichar_isalnum (c) || c == '_'))
+        {
+          if (start == NULL)
+            start = p;
+
+          continue;
+        }
+
+      if (start != NULL)
+        {
+          g_ptr_array_add (retval, g_utf8_casefold (start, p - start));
+          start = NULL;
+        }
+
+      if (c == 0)
+        break;
+    }
+
+  return retval;
+}
+
+static void
+free_tokens (GPtrArray *tokens)
+{
+  g_ptr_array_foreach (tokens, (GFunc) g_free, NULL);
+  g_ptr_array_free (tokens, TRUE);
+}
+
+static void
+append_varint (GByteArray *data,
+               guint       value)
+{
+  guint8 byte;
+
+  while (value >= 0x80)
+    {
+      byte = (value & 0x7f) | 0x80;
+      g_byte_array_append (data, &byte, 1);
+      value >>= 7;
+    }
+
+  byte = value;
+  g_byte_array_append (data, &byte, 1);
+}
+
+static guint
+read_varint (const guint8 **cursor,
+             const guint8  *end)
+{
+  guint value = 0, shift = 0;
+
+  while (*cursor < end && shift < 32)
+    {
+      guint8 byte = *(*cursor)++;
+
+      value |= (guint) (byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0)
+        break;
+
+      shift += 7;
+    }
+
+  return value;
+}
+
+static void
+skip_positions (const guint8 **cursor,
+                const guint8  *end)
+{
+  guint n_positions = read_varint (cursor, end);
+
+  while (n_positions-- > 0 && *cursor < end)
+    read_varint (cursor, end);
+}
+
+/* appends the number of positions and their differences */
+static void
+append_positions (GByteArray *data,
+                  GArray     *positions)
+{
+  guint i, last = 0;
+
+  append_varint (data, positions->len);
+
+  for (i = 0; i < positions->len; i++)
+    {
+      guint position = g_array_index (positions, guint, i);
+
+      append_varint (data, position - last);
+      last = position;
+    }
+}
+
+/* adds a document with an id lower than the last one, rewriting the
+ * difference of the following document
+ */
+static void
+text_postings_insert (TextPostings *postings,
+                      guint         doc_id,
+                      GArray       *positions)
+{
+  const guint8 *start = postings->data->data;
+  const guint8 *end = start + postings->data->len;
+  const guint8 *cursor = start;
+  const guint8 *entry = start;
+  guint prev_id = 0, id = 0;
+  GByteArray *data;
+
+  while (cursor < end)
+    {
+      entry = cursor;
+      id = prev_id + read_varint (&cursor, end);
+      if (id >= doc_id)
+        break;
+
+      skip_positions (&cursor, end);
+      prev_id = id;
+    }
+
+  if (id == doc_id)
+    return;
+
+  data = g_byte_array_sized_new (postings->data->len + 16);
+
+  g_byte_array_append (data, start, entry - start);
+  append_varint (data, doc_id - prev_id);
+  append_positions (data, positions);
+
+  /* the cursor is past the difference of the next document */
+  append_varint (data, id - doc_id);
+  g_byte_array_append (data, cursor, end - cursor);
+
+  g_byte_array_free (postings->data, TRUE);
+  postings->data = data;
+  postings->n_docs += 1;
+}
+
+static void
+twitter_text_index_add_term (TwitterTextIndex *index_,
+                             const gchar      *term,
+                             guint             doc_id,
+                             GArray           *positions)
+{
+  TextPostings *postings;
+
+  postings = g_hash_table_lookup (index_->terms, term);
+  if (postings == NULL)
+    {
+      postings = g_slice_new (TextPostings);
+      postings->data = g_byte_array_new ();
+      postings->last_id = 0;
+      postings->n_docs = 0;
+
+      g_hash_table_insert (index_->terms, g_strdup (term), postings);
+    }
+
+  if (doc_id > postings->last_id)
+    {
+      append_varint (postings->data, doc_id - postings->last_id);
+      append_positions (postings->data, positions);
+
+      postings->last_id = doc_id;
+      postings->n_docs += 1;
+    }
+  else
+    text_postings_insert (postings, doc_id, positions);
+}
+
+static void
+free_positions (gpointer data)
+{
+  g_array_free (data, TRUE);
+}
+
+void
+_twitter_text_index_add (TwitterTextIndex *index_,
+                         guint             doc_id,
+                         const gchar      *text)
+{
+  GHashTable *doc_terms;
+  GHashTableIter iter;
+  gpointer key, value;
+  GPtrArray *tokens;
+  guint i;
+
+  g_return_if_fail (doc_id != 0);
+
+  if (text == NULL)
+    return;
+
+  tokens = tokenize (text);
+
+  /* folded word -> positions inside the document */
+  doc_terms = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                     NULL,
+                                     free_positions);
+
+  for (i = 0; i < tokens->len; i++)
+    {
+      const gchar *term = g_ptr_array_index (tokens, i);
+      GArray *positions;
+
+      positions = g_hash_table_lookup (doc_terms, term);
+      if (positions == NULL)
+        {
+          positions = g_array_new (FALSE, FALSE, sizeof (guint));
+          g_hash_table_insert (doc_terms, (gpointer) term, positions);
+        }
+
+      g_array_append_val (positions, i);
+    }
+
+  g_hash_table_iter_init (&iter, doc_terms);
+  while (g_hash_table_iter_next (&iter, &key, &value))
+    twitter_text_index_add_term (index_, key, doc_id, value);
+
+  g_hash_table_destroy (doc_terms);
+  free_tokens (tokens);
+}
+
+static void
+decoded_postings_init (DecodedPostings *decoded,
+                       TextPostings    *postings,
+                       gboolean         with_positions)
+{
+  const guint8 *cursor, *end;
+  guint id = 0;
+
+  decoded->ids = g_array_sized_new (FALSE, FALSE, sizeof (guint),
+                                    postings != NULL ? postings->n_docs : 0);
+  decoded->offsets = NULL;
+  decoded->positions = NULL;
+
+  if (with_positions)
+    {
+      decoded->offsets = g_array_new (FALSE, FALSE, sizeof (guint));
+      decoded->positions = g_array_new (FALSE, FALSE, sizeof (guint));
+    }
+
+  if (postings == NULL)
+    return;
+
+  cursor = postings->data->data;
+  end = cursor + postings->data->len;
+
+  while (cursor < end)
+    {
+      id += read_varint (&cursor, end);
+      g_array_append_val (decoded->ids, id);
+
+      if (with_positions)
+        {
+          guint n_positions, position = 0;
+
+          g_array_append_val (decoded->offsets, decoded->positions->len);
+
+          n_positions = read_varint (&cursor, end);
+          while (n_positions-- > 0 && cursor < end)
+            {
+              position += read_varint (&cursor, end);
+              g_array_append_val (decoded->positions, position);
+            }
+        }
+      else
+        skip_positions (&cursor, end);
+    }
+
+  if (with_positions)
+    g_array_append_val (decoded->offsets, decoded->positions->len);
+}
+
+static void
+decoded_postings_clear (DecodedPostings *decoded)
+{
+  g_array_free (decoded->ids, TRUE);
+
+  if (decoded->offsets != NULL)
+    {
+      g_array_free (decoded->offsets, TRUE);
+      g_array_free (decoded->positions, TRUE);
+    }
+}
+
+/* the ids of both @a and @b; frees both */
+static GArray *
+intersect_ids (GArray *a,
+               GArray *b)
+{
+  GArray *retval;
+  guint i = 0, j = 0;
+
+  retval = g_array_sized_new (FALSE, FALSE, sizeof (guint), MIN (a->len, b->len));
+
+  while (i < a->len && j < b->len)
+    {
+      guint id_a = g_array_index (a, guint, i);
+      guint id_b = g_array_index (b, guint, j);
+
+      if (id_a < id_b)
+        i++;
+      else if (id_a > id_b)
+        j++;
+      else
+        {
+          g_array_append_val (retval, id_a);
+          i++;
+          j++;
+        }
+    }
+
+  g_array_free (a, TRUE);
+  g_array_free (b, TRUE);
+
+  return retval;
+}
+
+/* the ids of either @a or @b; frees both */
+static GArray *
+union_ids (GArray *a,
+           GArray *b)
+{
+  GArray *retval;
+  guint i = 0, j = 0;
+
+  retval = g_array_sized_new (FALSE, FALSE, sizeof (guint), a->len + b->len);
+
+  while (i < a->len || j < b->len)
+    {
+      guint id;
+
+      if (j == b->len ||
+          (i < a->len && g_array_index (a, guint, i) < g_array_index (b, guint, j)))
+        id = g_array_index (a, guint, i++);
+      else if (i == a->len ||
+               g_array_index (b, guint, j) < g_array_index (a, guint, i))
+        id = g_array_index (b, guint, j++);
+      else
+        {
+          id = g_array_index (a, guint, i++);
+          j++;
+        }
+
+      g_array_append_val (retval, id);
+    }
+
+  g_array_free (a, TRUE);
+  g_array_free (b, TRUE);
+
+  return retval;
+}
+
+static gboolean
+has_position (DecodedPostings *decoded,
+              guint            doc,
+              guint            position)
+{
+  guint low = g_array_index (decoded->offsets, guint, doc);
+  guint high = g_array_index (decoded->offsets, guint, doc + 1);
+
+  while (low < high)
+    {
+      guint mid = (low + high) / 2;
+      guint value = g_array_index (decoded->positions, guint, mid);
+
+      if (value == position)
+        return TRUE;
+
+      if (value < position)
+        low = mid + 1;
+      else
+        high = mid;
+    }
+
+  return FALSE;
+}
+
+/* the documents containing the words of @terms next to each other */
+static GArray *
+twitter_text_index_search_phrase (TwitterTextIndex *index_,
+                                  GPtrArray        *terms)
+{
+  DecodedPostings *decoded;
+  guint *cursors;
+  GArray *retval;
+  guint n_terms = terms->len;
+  guint i, doc;
+
+  retval = g_array_new (FALSE, FALSE, sizeof (guint));
+
+  decoded = g_new (DecodedPostings, n_terms);
+  cursors = g_new0 (guint, n_terms);
+
+  for (i = 0; i < n_terms; i++)
+    decoded_postings_init (&decoded[i],
+                           g_hash_table_lookup (index_->terms,
+                                                g_ptr_array_index (terms, i)),
+                           TRUE);
+
+  /* walk the documents of the first word, and look for them in the
+   * posting lists of the others, which are sorted as well
+   */
+  for (doc = 0; doc < decoded[0].ids->len; doc++)
+    {
+      guint doc_id = g_array_index (decoded[0].ids, guint, doc);
+      guint first, last, p;
+      gboolean found = TRUE;
+
+      for (i = 1; i < n_terms && found; i++)
+        {
+          GArray *ids = decoded[i].ids;
+
+          while (cursors[i] < ids->len &&
+                 g_array_index (ids, guint, cursors[i]) < doc_id)
+            cursors[i] += 1;
+
+          found = cursors[i] < ids->len &&
+                  g_array_index (ids, guint, cursors[i]) == doc_id;
+        }
+
+      if (!found)
+        continue;
+
+      first = g_array_index (decoded[0].offsets, guint, doc);
+      last = g_array_index (decoded[0].offsets, guint, doc + 1);
+
+      for (p = first, found = FALSE; p < last && !found; p++)
+        {
+          guint position = g_array_index (decoded[0].positions, guint, p);
+
+          for (i = 1, found = TRUE; i < n_terms && found; i++)
+            found = has_position (&decoded[i], cursors[i], position + i);
+        }
+
+      if (found)
+        g_array_append_val (retval, doc_id);
+    }
+
+  for (i = 0; i < n_terms; i++)
+    decoded_postings_clear (&decoded[i]);
+
+  g_free (decoded);
+  g_free (cursors);
+
+  return retval;
+}
+
+/* the documents matching a word of the query, or a quoted phrase */
+static GArray *
+twitter_text_index_search_chunk (TwitterTextIndex *index_,
+                                 const gchar      *chunk,
+                                 gsize             len)
+{
+  GArray *retval = NULL;
+  GPtrArray *terms;
+  gchar *text;
+
+  text = g_strndup (chunk, len);
+  terms = tokenize (text);
+  g_free (text);
+
+  /* a word made of many tokens, like "don't", is a phrase */
+  if (terms->len == 1)
+    {
+      DecodedPostings decoded;
+
+      decoded_postings_init (&decoded,
+                             g_hash_table_lookup (index_->terms,
+                                                  g_ptr_array_index (terms, 0)),
+                             FALSE);
+
+      retval = decoded.ids;
+    }
+  else if (terms->len > 1)
+    retval = twitter_text_index_search_phrase (index_, terms);
+
+  free_tokens (terms);
+
+  return retval;
+}
+
+/* returns the ids of the documents matching @query, by ascending id.
+ *
+ * The words of the query must all be found inside a document; the
+ * words inside double quotes must be found in sequence; the OR
+ * keyword separates alternative sets of words
+ */
+GArray *
+_twitter_text_index_search (TwitterTextIndex *index_,
+                            const gchar      *query)
+{
+  GArray *retval, *group = NULL;
+  const gchar *p = query;
+
+  retval = g_array_new (FALSE, FALSE, sizeof (guint));
+
+  while (TRUE)
+    {
+      const gchar *start;
+      GArray *ids;
+
+      while (g_ascii_isspace (*p))
+        p++;
+
+      if (*p == '\0')
+        break;
+
+      if (*p == '"')
+        {
+          start = ++p;
+          while (*p != '\0' && *p != '"')
+            p++;
+
+          ids = twitter_text_index_search_chunk (index_, start, p - start);
+
+          if (*p == '"')
+            p++;
+        }
+      else
+        {
+          start = p;
+          while (*p != '\0' && !g_ascii_isspace (*p))
+            p++;
+
+          if (p - start == 2 && strncmp (start, "OR", 2) == 0)
+            {
+              if (group != NULL)
+                retval = union_ids (retval, group);
+
+              group = NULL;
+              continue;
+            }
+
+          ids = twitter_text_index_search_chunk (index_, start, p - start);
+        }
+
+      /* words without any letter are ignored */
+      if (ids == NULL)
+        continue;
+
+      group = group != NULL ? intersect_ids (group, ids) : ids;
+    }
+
+  if (group != NULL)
+    retval = union_ids (retval, group);
+
+  return retval;
+}
@@ -0,0 +1,48 @@
+/* twitter-text-index.h: Inverted index over the text of statuses
+ *
+ * This file is part of Twitter-GLib.
+ * Copyright (C) 2008  Emmanuele Bassi  <ebassi@gnome.org>
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef __TWITTER_TEXT_INDEX_H__
+#define __TWITTER_TEXT_INDEX_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/*
+ * TwitterTextIndex:
+ *
+ * An inverted index mapping the words of a set of documents, each
+ * identified by a non-zero id, to the documents containing them.
+ *
+ * Documents can be added in any order, but adding them by ascending
+ * id is the fastest.
+ */
+typedef struct _TwitterTextIndex        TwitterTextIndex;
+
+TwitterTextIndex *_twitter_text_index_new      (void);
+void              _twitter_text_index_free     (TwitterTextIndex *index_);
+
+void              _twitter_text_index_add      (TwitterTextIndex *index_,
+                                                guint             doc_id,
+                                                const gchar      *text);
+GArray *          _twitter_text_index_search   (TwitterTextIndex *index_,
+                                                const gchar      *query);
+
+G_END_DECLS
+
+#endif /* __TWITTER_TEXT_INDEX_H__ */
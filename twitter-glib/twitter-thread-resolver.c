@@ -0,0 +1,670 @@
+/* twitter-thread-resolver.c: Reconstruction of conversation threads
+ *
+ * This file is part of Twitter-GLib.
+ * Copyright (C) 2008  Emmanuele Bassi  <ebassi@gnome.org>
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:twitter-thread-resolver
+ * @short_description: Reconstruction of conversation threads
+ *
+ * #TwitterThreadResolver rebuilds the conversation containing a
+ * status, by following the chain of replies up to the status that
+ * started it.
+ *
+ * The statuses are looked up inside a #TwitterStatusIndex and inside
+ * the timelines of the #TwitterClient first; only the statuses that
+ * are not available locally are requested to the provider, and then
+ * added to the index so that later threads can reuse them.
+ *
+ * Every resolution waiting for the same status shares a single
+ * request, and at most #TwitterThreadResolver:max-requests requests
+ * are in flight at any time; the others are queued.
+ *
+ * Once the first status of the conversation has been reached, the
+ * #TwitterThreadResolver::thread-resolved signal is emitted with the
+ * whole thread.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <glib.h>
+
+#include "twitter-client.h"
+#include "twitter-common.h"
+#include "twitter-marshal.h"
+#include "twitter-private.h"
+#include "twitter-status.h"
+#include "twitter-status-index.h"
+#include "twitter-thread-resolver.h"
+#include "twitter-timeline.h"
+
+#define TWITTER_THREAD_RESOLVER_GET_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE ((obj), TWITTER_TYPE_THREAD_RESOLVER, TwitterThreadResolverPrivate))
+
+#define DEFAULT_MAX_REQUESTS    4
+
+typedef struct _ThreadRequest   ThreadRequest;
+
+struct _ThreadRequest
+{
+  gulong handle;
+
+  /* the status of the thread to look up next */
+  guint current_id;
+
+  /* the oldest status of the thread found so far, or 0 */
+  guint root_id;
+
+  /* set if a status of the thread could not be retrieved */
+  GError *error;
+};
+
+typedef struct {
+  TwitterThreadResolver *resolver;
+
+  guint status_id;
+} FetchClosure;
+
+struct _TwitterThreadResolverPrivate
+{
+  TwitterClient *client;
+  TwitterStatusIndex *status_index;
+
+  guint max_requests;
+
+  gulong last_handle;
+
+  /* status id -> GSList of the ThreadRequests waiting for it;
+   * a status is requested only once, however many threads need it
+   */
+  GHashTable *fetches;
+
+  /* the ids of the statuses waiting for a free request slot */
+  GQueue *pending;
+  guint n_requests;
+
+  /* the requests ready to be delivered */
+  GQueue *resolved;
+  guint resolved_id;
+};
+
+enum
+{
+  PROP_0,
+
+  PROP_CLIENT,
+  PROP_STATUS_INDEX,
+  PROP_MAX_REQUESTS
+};
+
+enum
+{
+  THREAD_RESOLVED,
+
+  LAST_SIGNAL
+};
+
+static guint resolver_signals[LAST_SIGNAL] = { 0, };
+
+G_DEFINE_TYPE (TwitterThreadResolver, twitter_thread_resolver, G_TYPE_OBJECT);
+
+static void twitter_thread_resolver_pump (TwitterThreadResolver *resolver);
+
+static void
+thread_request_free (ThreadRequest *request)
+{
+  if (request->error != NULL)
+    g_error_free (request->error);
+
+  g_free (request);
+}
+
+static void
+twitter_thread_resolver_dispose (GObject *gobject)
+{
+  TwitterThreadResolverPrivate *priv = TWITTER_THREAD_RESOLVER (gobject)->priv;
+
+  if (priv->resolved_id != 0)
+    {
+      g_source_remove (priv->resolved_id);
+      priv->resolved_id = 0;
+    }
+
+  if (priv->client != NULL)
+    {
+      g_object_unref (priv->client);
+      priv->client = NULL;
+    }
+
+  if (priv->status_index != NULL)
+    {
+      g_object_unref (priv->status_index);
+      priv->status_index = NULL;
+    }
+
+  G_OBJECT_CLASS (twitter_thread_resolver_parent_class)->dispose (gobject);
+}
+
+static void
+twitter_thread_resolver_finalize (GObject *gobject)
+{
+  TwitterThreadResolverPrivate *priv = TWITTER_THREAD_RESOLVER (gobject)->priv;
+  ThreadRequest *request;
+
+  /* every fetch holds a reference on the resolver, so the only
+   * requests left are the ones waiting to be delivered
+   */
+  while ((request = g_queue_pop_head (priv->resolved)) != NULL)
+    thread_request_free (request);
+
+  g_queue_free (priv->resolved);
+  g_queue_free (priv->pending);
+  g_hash_table_destroy (priv->fetches);
+
+  G_OBJECT_CLASS (twitter_thread_resolver_parent_class)->finalize (gobject);
+}
+
+static void
+twitter_thread_resolver_set_property (GObject      *gobject,
+                                      guint         prop_id,
+                                      const GValue *value,
+                                      GParamSpec   *pspec)
+{
+  TwitterThreadResolver *resolver = TWITTER_THREAD_RESOLVER (gobject);
+  TwitterThreadResolverPrivate *priv = resolver->priv;
+
+  switch (prop_id)
+    {
+    case PROP_CLIENT:
+      priv->client = g_value_dup_object (value);
+      break;
+
+    case PROP_STATUS_INDEX:
+      priv->status_index = g_value_dup_object (value);
+      break;
+
+    case PROP_MAX_REQUESTS:
+      priv->max_requests = g_value_get_uint (value);
+      twitter_thread_resolver_pump (resolver);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+twitter_thread_resolver_get_property (GObject    *gobject,
+                                      guint       prop_id,
+                                      GValue     *value,
+                                      GParamSpec *pspec)
+{
+  TwitterThreadResolverPrivate *priv = TWITTER_THREAD_RESOLVER (gobject)->priv;
+
+  switch (prop_id)
+    {
+    case PROP_CLIENT:
+      g_value_set_object (value, priv->client);
+      break;
+
+    case PROP_STATUS_INDEX:
+      g_value_set_object (value, priv->status_index);
+      break;
+
+    case PROP_MAX_REQUESTS:
+      g_value_set_uint (value, priv->max_requests);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+twitter_thread_resolver_constructed (GObject *gobject)
+{
+  TwitterThreadResolverPrivate *priv = TWITTER_THREAD_RESOLVER (gobject)->priv;
+
+  if (priv->status_index == NULL)
+    priv->status_index = twitter_status_index_new ();
+}
+
+static void
+twitter_thread_resolver_class_init (TwitterThreadResolverClass *klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  GParamSpec *pspec;
+
+  g_type_class_add_private (klass, sizeof (TwitterThreadResolverPrivate));
+
+  gobject_class->constructed = twitter_thread_resolver_constructed;
+  gobject_class->set_property = twitter_thread_resolver_set_property;
+  gobject_class->get_property = twitter_thread_resolver_get_property;
+  gobject_class->dispose = twitter_thread_resolver_dispose;
+  gobject_class->finalize = twitter_thread_resolver_finalize;
+
+  pspec = g_param_spec_object ("client",
+                               "Client",
+                               "The client requesting the missing statuses",
+                               TWITTER_TYPE_CLIENT,
+                               G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE);
+  g_object_class_install_property (gobject_class, PROP_CLIENT, pspec);
+
+  pspec = g_param_spec_object ("status-index",
+                               "Status Index",
+                               "The index holding the known statuses",
+                               TWITTER_TYPE_STATUS_INDEX,
+                               G_PARAM_CONSTRUCT_ONLY | G_PARAM_READWRITE);
+  g_object_class_install_property (gobject_class, PROP_STATUS_INDEX, pspec);
+
+  /**
+   * TwitterThreadResolver:max-requests:
+   *
+   * The maximum number of statuses requested to the provider at
+   * the same time.
+   *
+   * Since: 0.9.10
+   */
+  pspec = g_param_spec_uint ("max-requests",
+                             "Max Requests",
+                             "The maximum number of concurrent requests",
+                             1, G_MAXUINT, DEFAULT_MAX_REQUESTS,
+                             G_PARAM_READWRITE);
+  g_object_class_install_property (gobject_class, PROP_MAX_REQUESTS, pspec);
+
+  /**
+   * TwitterThreadResolver::thread-resolved:
+   * @resolver: the #TwitterThreadResolver that emitted the signal
+   * @handle: the handle returned by twitter_thread_resolver_resolve()
+   * @thread: a #GNode holding the first #TwitterStatus of the thread,
+   *   or %NULL
+   * @error: set to a #GError in case of error
+   *
+   * The ::thread-resolved signal is emitted once the first status
+   * of a thread has been found.
+   *
+   * Each node of @thread holds a #TwitterStatus, and its children
+   * are the known replies to it, by ascending id. The tree is freed
+   * after the emission, while the statuses are owned by the
+   * #TwitterStatusIndex of @resolver.
+   *
+   * If a status of the thread could not be retrieved, @error will
+   * be set and @thread will start from the oldest status available;
+   * @thread is %NULL if even the requested status is not available.
+   *
+   * Since: 0.9.10
+   */
+  resolver_signals[THREAD_RESOLVED] =
+    g_signal_new (I_("thread-resolved"),
+                  G_TYPE_FROM_CLASS (gobject_class),
+                  G_SIGNAL_RUN_LAST,
+                  G_STRUCT_OFFSET (TwitterThreadResolverClass, thread_resolved),
+                  NULL, NULL,
+                  _twitter_marshal_VOID__ULONG_POINTER_POINTER,
+                  G_TYPE_NONE, 3,
+                  G_TYPE_ULONG,
+                  G_TYPE_POINTER,
+                  G_TYPE_POINTER);
+}
+
+static void
+twitter_thread_resolver_init (TwitterThreadResolver *resolver)
+{
+  TwitterThreadResolverPrivate *priv;
+
+  resolver->priv = priv = TWITTER_THREAD_RESOLVER_GET_PRIVATE (resolver);
+
+  priv->max_requests = DEFAULT_MAX_REQUESTS;
+
+  priv->fetches = g_hash_table_new (NULL, NULL);
+  priv->pending = g_queue_new ();
+  priv->resolved = g_queue_new ();
+}
+
+/* builds the tree of the known replies to @status */
+static GNode *
+build_thread (TwitterStatusIndex *status_index,
+              TwitterStatus      *status)
+{
+  GNode *node = g_node_new (status);
+  guint status_id = twitter_status_get_id (status);
+  GList *replies, *l;
+
+  /* the replies are newest first; a reply is always newer than the
+   * status it replies to, which also protects us from loops
+   */
+  replies = twitter_status_index_get_replies (status_index, status_id);
+  for (l = replies; l != NULL; l = l->next)
+    {
+      if (twitter_status_get_id (l->data) > status_id)
+        g_node_prepend (node, build_thread (status_index, l->data));
+    }
+
+  g_list_free (replies);
+
+  return node;
+}
+
+static gboolean
+deliver_resolved (gpointer data)
+{
+  TwitterThreadResolver *resolver = data;
+  TwitterThreadResolverPrivate *priv = resolver->priv;
+  ThreadRequest *request;
+
+  priv->resolved_id = 0;
+
+  g_object_ref (resolver);
+
+  while ((request = g_queue_pop_head (priv->resolved)) != NULL)
+    {
+      TwitterStatus *root;
+      GNode *thread = NULL;
+
+      root = twitter_status_index_get_status (priv->status_index,
+                                              request->root_id);
+      if (root != NULL)
+        thread = build_thread (priv->status_index, root);
+
+      g_signal_emit (resolver, resolver_signals[THREAD_RESOLVED], 0,
+                     request->handle,
+                     thread,
+                     request->error);
+
+      if (thread != NULL)
+        g_node_destroy (thread);
+
+      thread_request_free (request);
+    }
+
+  g_object_unref (resolver);
+
+  return FALSE;
+}
+
+static void
+thread_request_complete (TwitterThreadResolver *resolver,
+                         ThreadRequest         *request)
+{
+  TwitterThreadResolverPrivate *priv = resolver->priv;
+
+  g_queue_push_tail (priv->resolved, request);
+
+  if (priv->resolved_id == 0)
+    priv->resolved_id = g_idle_add (deliver_resolved, resolver);
+}
+
+/* looks up a status inside the index, and then inside the
+ * timelines already retrieved by the client
+ */
+static TwitterStatus *
+twitter_thread_resolver_lookup (TwitterThreadResolver *resolver,
+                                guint                  status_id)
+{
+  TwitterThreadResolverPrivate *priv = resolver->priv;
+  TwitterStatus *status;
+  gint endpoint;
+
+  status = twitter_status_index_get_status (priv->status_index, status_id);
+  if (status != NULL)
+    return status;
+
+  for (endpoint = TWITTER_ENDPOINT_PUBLIC_TIMELINE;
+       endpoint <= TWITTER_ENDPOINT_ARCHIVE;
+       endpoint++)
+    {
+      TwitterTimeline *timeline;
+
+      timeline = twitter_client_get_endpoint_timeline (priv->client, endpoint);
+      status = twitter_timeline_get_id (timeline, status_id);
+      if (status != NULL)
+        {
+          twitter_status_index_add_status (priv->status_index, status);
+          return status;
+        }
+    }
+
+  return NULL;
+}
+
+static void
+fetch_status_cb (GObject      *source,
+                 GAsyncResult *result,
+                 gpointer      user_data);
+
+static void
+twitter_thread_resolver_pump (TwitterThreadResolver *resolver)
+{
+  TwitterThreadResolverPrivate *priv = resolver->priv;
+
+  while (priv->n_requests < priv->max_requests &&
+         !g_queue_is_empty (priv->pending))
+    {
+      FetchClosure *closure;
+
+      closure = g_new0 (FetchClosure, 1);
+      closure->resolver = g_object_ref (resolver);
+      closure->status_id = GPOINTER_TO_UINT (g_queue_pop_head (priv->pending));
+
+      priv->n_requests += 1;
+
+      twitter_client_get_status_async (priv->client, closure->status_id,
+                                       NULL,
+                                       fetch_status_cb,
+                                       closure);
+    }
+}
+
+/* waits for @status_id to be retrieved, unless it has already
+ * been requested for another thread
+ */
+static void
+twitter_thread_resolver_fetch (TwitterThreadResolver *resolver,
+                               ThreadRequest         *request)
+{
+  TwitterThreadResolverPrivate *priv = resolver->priv;
+  gpointer key = GUINT_TO_POINTER (request->current_id);
+  GSList *waiting;
+
+  waiting = g_hash_table_lookup (priv->fetches, key);
+  if (waiting == NULL)
+    g_queue_push_tail (priv->pending, key);
+
+  g_hash_table_insert (priv->fetches, key, g_slist_prepend (waiting, request));
+
+  twitter_thread_resolver_pump (resolver);
+}
+
+/* follows the replies of @request as far as the local statuses go */
+static void
+twitter_thread_resolver_walk (TwitterThreadResolver *resolver,
+                              ThreadRequest         *request)
+{
+  while (TRUE)
+    {
+      TwitterStatus *status;
+      guint reply_id;
+
+      status = twitter_thread_resolver_lookup (resolver, request->current_id);
+      if (status == NULL)
+        {
+          twitter_thread_resolver_fetch (resolver, request);
+          return;
+        }
+
+      request->root_id = request->current_id;
+
+      reply_id = twitter_status_get_reply_to_status (status);
+      if (reply_id == 0 || reply_id >= request->current_id)
+        break;
+
+      request->current_id = reply_id;
+    }
+
+  thread_request_complete (resolver, request);
+}
+
+static void
+fetch_status_cb (GObject      *source,
+                 GAsyncResult *result,
+                 gpointer      user_data)
+{
+  FetchClosure *closure = user_data;
+  TwitterThreadResolver *resolver = closure->resolver;
+  TwitterThreadResolverPrivate *priv = resolver->priv;
+  gpointer key = GUINT_TO_POINTER (closure->status_id);
+  TwitterStatus *status;
+  GError *error = NULL;
+  GSList *waiting, *l;
+
+  priv->n_requests -= 1;
+
+  status = twitter_client_get_status_finish (TWITTER_CLIENT (source),
+                                             result,
+                                             &error);
+  if (status != NULL)
+    {
+      if (twitter_status_get_id (status) == closure->status_id)
+        twitter_status_index_add_status (priv->status_index, status);
+      else
+        g_set_error (&error, TWITTER_ERROR,
+                     TWITTER_ERROR_PARSE_ERROR,
+                     "Unexpected status %u received instead of %u",
+                     twitter_status_get_id (status),
+                     closure->status_id);
+
+      g_object_unref (status);
+    }
+
+  waiting = g_hash_table_lookup (priv->fetches, key);
+  g_hash_table_remove (priv->fetches, key);
+
+  /* the requests were prepended as they arrived */
+  waiting = g_slist_reverse (waiting);
+
+  for (l = waiting; l != NULL; l = l->next)
+    {
+      ThreadRequest *request = l->data;
+
+      if (error == NULL)
+        twitter_thread_resolver_walk (resolver, request);
+      else
+        {
+          request->error = g_error_copy (error);
+          thread_request_complete (resolver, request);
+        }
+    }
+
+  g_slist_free (waiting);
+
+  if (error != NULL)
+    g_error_free (error);
+
+  twitter_thread_resolver_pump (resolver);
+
+  g_object_unref (closure->resolver);
+  g_free (closure);
+}
+
+/**
+ * twitter_thread_resolver_new:
+ * @client: a #TwitterClient
+ * @status_index: (allow-none): a #TwitterStatusIndex, or %NULL
+ *
+ * Creates a new #TwitterThreadResolver, looking up the statuses
+ * inside @status_index and the timelines of @client, and requesting
+ * the missing ones using @client.
+ *
+ * If @status_index is %NULL a new, empty index will be used.
+ *
+ * Return value: the newly created #TwitterThreadResolver. Use
+ *   g_object_unref() to free the allocated resources
+ *
+ * Since: 0.9.10
+ */
+TwitterThreadResolver *
+twitter_thread_resolver_new (TwitterClient      *client,
+                             TwitterStatusIndex *status_index)
+{
+  g_return_val_if_fail (TWITTER_IS_CLIENT (client), NULL);
+  g_return_val_if_fail (status_index == NULL ||
+                        TWITTER_IS_STATUS_INDEX (status_index), NULL);
+
+  return g_object_new (TWITTER_TYPE_THREAD_RESOLVER,
+                       "client", client,
+                       "status-index", status_index,
+                       NULL);
+}
+
+/**
+ * twitter_thread_resolver_get_status_index:
+ * @resolver: a #TwitterThreadResolver
+ *
+ * Retrieves the index used by @resolver, which also holds the
+ * statuses requested to the provider.
+ *
+ * Return value: (transfer none): a #TwitterStatusIndex, owned by
+ *   @resolver
+ *
+ * Since: 0.9.10
+ */
+TwitterStatusIndex *
+twitter_thread_resolver_get_status_index (TwitterThreadResolver *resolver)
+{
+  g_return_val_if_fail (TWITTER_IS_THREAD_RESOLVER (resolver), NULL);
+
+  return resolver->priv->status_index;
+}
+
+/**
+ * twitter_thread_resolver_resolve:
+ * @resolver: a #TwitterThreadResolver
+ * @status_id: the id of a status
+ *
+ * Rebuilds the thread containing the status with @status_id, by
+ * following its replies up to the first status of the conversation.
+ *
+ * The #TwitterThreadResolver::thread-resolved signal will be emitted
+ * with the thread, even if every status was available locally.
+ *
+ * Return value: the handle of the request
+ *
+ * Since: 0.9.10
+ */
+gulong
+twitter_thread_resolver_resolve (TwitterThreadResolver *resolver,
+                                 guint                  status_id)
+{
+  ThreadRequest *request;
+  gulong handle;
+
+  g_return_val_if_fail (TWITTER_IS_THREAD_RESOLVER (resolver), 0);
+  g_return_val_if_fail (status_id > 0, 0);
+
+  handle = ++resolver->priv->last_handle;
+
+  request = g_new0 (ThreadRequest, 1);
+  request->handle = handle;
+  request->current_id = status_id;
+
+  twitter_thread_resolver_walk (resolver, request);
+
+  return handle;
+}
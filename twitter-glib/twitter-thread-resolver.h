@@ -0,0 +1,92 @@
+/* twitter-thread-resolver.h: Reconstruction of conversation threads
+ *
+ * This file is part of Twitter-GLib.
+ * Copyright (C) 2008  Emmanuele Bassi  <ebassi@gnome.org>
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef __TWITTER_THREAD_RESOLVER_H__
+#define __TWITTER_THREAD_RESOLVER_H__
+
+#include <glib-object.h>
+
+#include <twitter-glib/twitter-client.h>
+#include <twitter-glib/twitter-status-index.h>
+
+G_BEGIN_DECLS
+
+#define TWITTER_TYPE_THREAD_RESOLVER            (twitter_thread_resolver_get_type ())
+#define TWITTER_THREAD_RESOLVER(obj)            (G_TYPE_CHECK_INSTANCE_CAST ((obj), TWITTER_TYPE_THREAD_RESOLVER, TwitterThreadResolver))
+#define TWITTER_IS_THREAD_RESOLVER(obj)         (G_TYPE_CHECK_INSTANCE_TYPE ((obj), TWITTER_TYPE_THREAD_RESOLVER))
+#define TWITTER_THREAD_RESOLVER_CLASS(klass)    (G_TYPE_CHECK_CLASS_CAST ((klass), TWITTER_TYPE_THREAD_RESOLVER, TwitterThreadResolverClass))
+#define TWITTER_IS_THREAD_RESOLVER_CLASS(klass) (G_TYPE_CHECK_CLASS_TYPE ((klass), TWITTER_TYPE_THREAD_RESOLVER))
+#define TWITTER_THREAD_RESOLVER_GET_CLASS(obj)  (G_TYPE_INSTANCE_GET_CLASS ((obj), TWITTER_TYPE_THREAD_RESOLVER, TwitterThreadResolverClass))
+
+typedef struct _TwitterThreadResolver           TwitterThreadResolver;
+typedef struct _TwitterThreadResolverPrivate    TwitterThreadResolverPrivate;
+typedef struct _TwitterThreadResolverClass      TwitterThreadResolverClass;
+
+/**
+ * TwitterThreadResolver:
+ *
+ * The #TwitterThreadResolver struct contains private data only, and
+ * should only be accessed using the functions below.
+ */
+struct _TwitterThreadResolver
+{
+  /*< private >*/
+  GObject parent_instance;
+
+  TwitterThreadResolverPrivate *priv;
+};
+
+/**
+ * TwitterThreadResolverClass:
+ * @thread_resolved: class handler for the
+ *   #TwitterThreadResolver::thread-resolved signal
+ *
+ * Base class for #TwitterThreadResolver.
+ */
+struct _TwitterThreadResolverClass
+{
+  /*< private >*/
+  GObjectClass parent_class;
+
+  /*< public >*/
+  void (* thread_resolved) (TwitterThreadResolver *resolver,
+                            gulong                 handle,
+                            GNode                 *thread,
+                            const GError          *error);
+
+  /*< private >*/
+  /* padding, for future expansion */
+  void (* _twitter_padding1) (void);
+  void (* _twitter_padding2) (void);
+  void (* _twitter_padding3) (void);
+  void (* _twitter_padding4) (void);
+};
+
+GType                  twitter_thread_resolver_get_type         (void) G_GNUC_CONST;
+
+TwitterThreadResolver *twitter_thread_resolver_new              (TwitterClient         *client,
+                                                                 TwitterStatusIndex    *status_index);
+
+TwitterStatusIndex *   twitter_thread_resolver_get_status_index (TwitterThreadResolver *resolver);
+
+gulong                 twitter_thread_resolver_resolve          (TwitterThreadResolver *resolver,
+                                                                 guint                  status_id);
+
+G_END_DECLS
+
+#endif /* __TWITTER_THREAD_RESOLVER_H__ */
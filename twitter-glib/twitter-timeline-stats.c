@@ -0,0 +1,591 @@
+/* twitter-timeline-stats.c: Aggregations over timelines
+ *
+ * This file is part of Twitter-GLib.
+ * Copyright (C) 2008  Emmanuele Bassi  <ebassi@gnome.org>
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:twitter-timeline-stats
+ * @short_description: Aggregations over timelines
+ *
+ * #TwitterTimelineStats computes aggregated values over the statuses
+ * of one or more timelines, like the number of statuses posted by
+ * each user, the most used hashtags, or the number of statuses
+ * posted in each hour.
+ *
+ * The statuses are added using twitter_timeline_stats_add_timeline(),
+ * for instance with the timelines kept inside a #TwitterStore; the
+ * statuses already added are skipped. Only the values needed by the
+ * aggregations are kept, so the statuses themselves can be released
+ * afterwards.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib.h>
+
+#include "twitter-status.h"
+#include "twitter-timeline.h"
+#include "twitter-timeline-stats.h"
+#include "twitter-user.h"
+
+#define TWITTER_TIMELINE_STATS_GET_PRIVATE(obj) (G_TYPE_INSTANCE_GET_PRIVATE ((obj), TWITTER_TYPE_TIMELINE_STATS, TwitterTimelineStatsPrivate))
+
+/* the user column value of the statuses without a user */
+#define NO_USER         G_MAXUINT
+
+/* Every status is stored as a row of columns, each column being an
+ * array of fixed size values; the users and the hashtags are stored
+ * as indexes into a dictionary, so that the aggregations count
+ * inside plain arrays instead of hash tables.
+ */
+struct _TwitterTimelineStatsPrivate
+{
+  /* the ids of the statuses already added */
+  GHashTable *status_ids;
+
+  /* one element for each status */
+  GArray *user_column;
+  GArray *time_column;
+
+  /* the hashtags of the i-th status are the elements of the tag
+   * column from tag_starts[i], included, to tag_starts[i + 1]
+   */
+  GArray *tag_starts;
+  GArray *tag_column;
+
+  /* user id -> index + 1; index -> user id */
+  GHashTable *user_index;
+  GArray *user_ids;
+
+  /* folded hashtag -> index + 1; index -> folded hashtag */
+  GHashTable *tag_index;
+  GPtrArray *tags;
+};
+
+G_DEFINE_TYPE (TwitterTimelineStats, twitter_timeline_stats, G_TYPE_OBJECT);
+
+static void
+twitter_timeline_stats_finalize (GObject *gobject)
+{
+  TwitterTimelineStatsPrivate *priv = TWITTER_TIMELINE_STATS (gobject)->priv;
+
+  g_hash_table_destroy (priv->status_ids);
+
+  g_array_free (priv->user_column, TRUE);
+  g_array_free (priv->time_column, TRUE);
+  g_array_free (priv->tag_starts, TRUE);
+  g_array_free (priv->tag_column, TRUE);
+
+  g_hash_table_destroy (priv->user_index);
+  g_array_free (priv->user_ids, TRUE);
+
+  /* the keys of the index are owned by the array */
+  g_hash_table_destroy (priv->tag_index);
+  g_ptr_array_foreach (priv->tags, (GFunc) g_free, NULL);
+  g_ptr_array_free (priv->tags, TRUE);
+
+  G_OBJECT_CLASS (twitter_timeline_stats_parent_class)->finalize (gobject);
+}
+
+static void
+twitter_timeline_stats_class_init (TwitterTimelineStatsClass *klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  g_type_class_add_private (klass, sizeof (TwitterTimelineStatsPrivate));
+
+  gobject_class->finalize = twitter_timeline_stats_finalize;
+}
+
+static void
+twitter_timeline_stats_init (TwitterTimelineStats *stats)
+{
+  TwitterTimelineStatsPrivate *priv;
+  guint start = 0;
+
+  stats->priv = priv = TWITTER_TIMELINE_STATS_GET_PRIVATE (stats);
+
+  priv->status_ids = g_hash_table_new (NULL, NULL);
+
+  priv->user_column = g_array_new (FALSE, FALSE, sizeof (guint));
+  priv->time_column = g_array_new (FALSE, FALSE, sizeof (gint64));
+  priv->tag_starts = g_array_new (FALSE, FALSE, sizeof (guint));
+  priv->tag_column = g_array_new (FALSE, FALSE, sizeof (guint));
+
+  g_array_append_val (priv->tag_starts, start);
+
+  priv->user_index = g_hash_table_new (NULL, NULL);
+  priv->user_ids = g_array_new (FALSE, FALSE, sizeof (guint));
+
+  priv->tag_index = g_hash_table_new (g_str_hash, g_str_equal);
+  priv->tags = g_ptr_array_new ();
+}
+
+/**
+ * twitter_timeline_stats_new:
+ *
+ * Creates a new, empty #TwitterTimelineStats
+ *
+ * Return value: the newly created #TwitterTimelineStats. Use
+ *   g_object_unref() to free the allocated resources
+ *
+ * Since: 0.9.10
+ */
+TwitterTimelineStats *
+twitter_timeline_stats_new (void)
+{
+  return g_object_new (TWITTER_TYPE_TIMELINE_STATS, NULL);
+}
+
+static guint
+twitter_timeline_stats_lookup_user (TwitterTimelineStats *stats,
+                                    guint                 user_id)
+{
+  TwitterTimelineStatsPrivate *priv = stats->priv;
+  guint index_;
+
+  index_ = GPOINTER_TO_UINT (g_hash_table_lookup (priv->user_index,
+                                                  GUINT_TO_POINTER (user_id)));
+  if (index_ == 0)
+    {
+      g_array_append_val (priv->user_ids, user_id);
+      index_ = priv->user_ids->len;
+
+      g_hash_table_insert (priv->user_index,
+                           GUINT_TO_POINTER (user_id),
+                           GUINT_TO_POINTER (index_));
+    }
+
+  return index_ - 1;
+}
+
+static guint
+twitter_timeline_stats_lookup_tag (TwitterTimelineStats *stats,
+                                   const gchar          *hashtag,
+                                   gsize                 length)
+{
+  TwitterTimelineStatsPrivate *priv = stats->priv;
+  gchar *folded;
+  guint index_;
+
+  folded = g_utf8_casefold (hashtag, length);
+
+  index_ = GPOINTER_TO_UINT (g_hash_table_lookup (priv->tag_index, folded));
+  if (index_ == 0)
+    {
+      g_ptr_array_add (priv->tags, folded);
+      index_ = priv->tags->len;
+
+      g_hash_table_insert (priv->tag_index, folded, GUINT_TO_POINTER (index_));
+    }
+  else
+    g_free (folded);
+
+  return index_ - 1;
+}
+
+static void
+twitter_timeline_stats_add_row (TwitterTimelineStats *stats,
+                                TwitterStatus        *status)
+{
+  TwitterTimelineStatsPrivate *priv = stats->priv;
+  const TwitterEntity *entities;
+  const gchar *text;
+  TwitterUser *user;
+  gint64 timestamp;
+  guint user_index, n_entities, first_tag, end, i;
+
+  user = twitter_status_get_user (status);
+  if (user != NULL)
+    user_index = twitter_timeline_stats_lookup_user (stats,
+                                                     twitter_user_get_id (user));
+  else
+    user_index = NO_USER;
+
+  timestamp = twitter_status_get_timestamp (status);
+
+  g_array_append_val (priv->user_column, user_index);
+  g_array_append_val (priv->time_column, timestamp);
+
+  first_tag = priv->tag_column->len;
+
+  text = twitter_status_get_text (status);
+  entities = twitter_status_get_entities (status, &n_entities);
+  for (i = 0; i < n_entities; i++)
+    {
+      guint tag, j;
+
+      if (entities[i].type != TWITTER_ENTITY_HASHTAG)
+        continue;
+
+      /* skip the '#' */
+      tag = twitter_timeline_stats_lookup_tag (stats,
+                                               text + entities[i].offset + 1,
+                                               entities[i].length - 1);
+
+      /* a hashtag is counted once per status */
+      for (j = first_tag; j < priv->tag_column->len; j++)
+        if (g_array_index (priv->tag_column, guint, j) == tag)
+          break;
+
+      if (j == priv->tag_column->len)
+        g_array_append_val (priv->tag_column, tag);
+    }
+
+  end = priv->tag_column->len;
+  g_array_append_val (priv->tag_starts, end);
+}
+
+/**
+ * twitter_timeline_stats_add_status:
+ * @stats: a #TwitterTimelineStats
+ * @status: a #TwitterStatus
+ *
+ * Adds @status to the statuses aggregated by @stats, unless a status
+ * with the same id has already been added
+ *
+ * Since: 0.9.10
+ */
+void
+twitter_timeline_stats_add_status (TwitterTimelineStats *stats,
+                                   TwitterStatus        *status)
+{
+  TwitterTimelineStatsPrivate *priv;
+  guint status_id;
+
+  g_return_if_fail (TWITTER_IS_TIMELINE_STATS (stats));
+  g_return_if_fail (TWITTER_IS_STATUS (status));
+
+  priv = stats->priv;
+
+  status_id = twitter_status_get_id (status);
+  if (status_id != 0)
+    {
+      if (g_hash_table_lookup (priv->status_ids,
+                               GUINT_TO_POINTER (status_id)) != NULL)
+        return;
+
+      g_hash_table_insert (priv->status_ids,
+                           GUINT_TO_POINTER (status_id),
+                           GUINT_TO_POINTER (1));
+    }
+
+  twitter_timeline_stats_add_row (stats, status);
+}
+
+/**
+ * twitter_timeline_stats_add_timeline:
+ * @stats: a #TwitterTimelineStats
+ * @timeline: a #TwitterTimeline
+ *
+ * Adds the statuses of @timeline to the statuses aggregated by
+ * @stats; the statuses that have already been added are skipped
+ *
+ * Since: 0.9.10
+ */
+void
+twitter_timeline_stats_add_timeline (TwitterTimelineStats *stats,
+                                     TwitterTimeline      *timeline)
+{
+  guint n_statuses, i;
+
+  g_return_if_fail (TWITTER_IS_TIMELINE_STATS (stats));
+  g_return_if_fail (TWITTER_IS_TIMELINE (timeline));
+
+  n_statuses = twitter_timeline_get_count (timeline);
+
+  for (i = 0; i < n_statuses; i++)
+    twitter_timeline_stats_add_status (stats,
+                                       twitter_timeline_get_pos (timeline, i));
+}
+
+/**
+ * twitter_timeline_stats_get_count:
+ * @stats: a #TwitterTimelineStats
+ *
+ * Retrieves the number of statuses aggregated by @stats
+ *
+ * Return value: the number of statuses
+ *
+ * Since: 0.9.10
+ */
+guint
+twitter_timeline_stats_get_count (TwitterTimelineStats *stats)
+{
+  g_return_val_if_fail (TWITTER_IS_TIMELINE_STATS (stats), 0);
+
+  return stats->priv->time_column->len;
+}
+
+static gint
+compare_user_count (gconstpointer a,
+                    gconstpointer b)
+{
+  const TwitterUserCount *count_a = a;
+  const TwitterUserCount *count_b = b;
+
+  if (count_a->count != count_b->count)
+    return count_a->count > count_b->count ? -1 : 1;
+
+  if (count_a->user_id != count_b->user_id)
+    return count_a->user_id < count_b->user_id ? -1 : 1;
+
+  return 0;
+}
+
+/**
+ * twitter_timeline_stats_count_by_user:
+ * @stats: a #TwitterTimelineStats
+ * @since: the start of the time range, in seconds from the epoch
+ * @until: the end of the time range, in seconds from the epoch
+ * @n_users: (out): return location for the number of users
+ *
+ * Counts the statuses posted by each user from @since, included, to
+ * @until, excluded. Use 0 and %G_MAXINT64 to count every status.
+ *
+ * Return value: (array length=n_users): the counts, from the user
+ *   with the most statuses, or %NULL. Use g_free() to free the
+ *   returned array
+ *
+ * Since: 0.9.10
+ */
+TwitterUserCount *
+twitter_timeline_stats_count_by_user (TwitterTimelineStats *stats,
+                                      gint64                since,
+                                      gint64                until,
+                                      guint                *n_users)
+{
+  TwitterTimelineStatsPrivate *priv;
+  const gint64 *times;
+  const guint *users;
+  TwitterUserCount *retval;
+  guint *counts;
+  guint n_rows, i, n;
+
+  g_return_val_if_fail (TWITTER_IS_TIMELINE_STATS (stats), NULL);
+  g_return_val_if_fail (n_users != NULL, NULL);
+
+  priv = stats->priv;
+
+  *n_users = 0;
+
+  if (priv->user_ids->len == 0)
+    return NULL;
+
+  times = (const gint64 *) priv->time_column->data;
+  users = (const guint *) priv->user_column->data;
+  n_rows = priv->time_column->len;
+
+  counts = g_new0 (guint, priv->user_ids->len);
+
+  for (i = 0; i < n_rows; i++)
+    {
+      if (times[i] < since || times[i] >= until || users[i] == NO_USER)
+        continue;
+
+      counts[users[i]] += 1;
+    }
+
+  retval = g_new (TwitterUserCount, priv->user_ids->len);
+
+  for (i = 0, n = 0; i < priv->user_ids->len; i++)
+    {
+      if (counts[i] == 0)
+        continue;
+
+      retval[n].user_id = g_array_index (priv->user_ids, guint, i);
+      retval[n].count = counts[i];
+      n += 1;
+    }
+
+  g_free (counts);
+
+  if (n == 0)
+    {
+      g_free (retval);
+      return NULL;
+    }
+
+  qsort (retval, n, sizeof (TwitterUserCount), compare_user_count);
+
+  *n_users = n;
+
+  return retval;
+}
+
+static gint
+compare_hashtag_count (gconstpointer a,
+                       gconstpointer b)
+{
+  const TwitterHashtagCount *count_a = a;
+  const TwitterHashtagCount *count_b = b;
+
+  if (count_a->count != count_b->count)
+    return count_a->count > count_b->count ? -1 : 1;
+
+  return strcmp (count_a->hashtag, count_b->hashtag);
+}
+
+/**
+ * twitter_timeline_stats_top_hashtags:
+ * @stats: a #TwitterTimelineStats
+ * @since: the start of the time range, in seconds from the epoch
+ * @until: the end of the time range, in seconds from the epoch
+ * @max_hashtags: the maximum number of hashtags to return, or 0
+ *   to return all of them
+ * @n_hashtags: (out): return location for the number of hashtags
+ *
+ * Counts the statuses containing each hashtag, from @since, included,
+ * to @until, excluded, and returns the most used hashtags. Hashtags
+ * differing only by case are counted together.
+ *
+ * Return value: (array length=n_hashtags): the counts, from the most
+ *   used hashtag, or %NULL. The hashtags are owned by @stats; use
+ *   g_free() to free the returned array
+ *
+ * Since: 0.9.10
+ */
+TwitterHashtagCount *
+twitter_timeline_stats_top_hashtags (TwitterTimelineStats *stats,
+                                     gint64                since,
+                                     gint64                until,
+                                     guint                 max_hashtags,
+                                     guint                *n_hashtags)
+{
+  TwitterTimelineStatsPrivate *priv;
+  const gint64 *times;
+  const guint *starts, *tags;
+  TwitterHashtagCount *retval;
+  guint *counts;
+  guint n_rows, i, n;
+
+  g_return_val_if_fail (TWITTER_IS_TIMELINE_STATS (stats), NULL);
+  g_return_val_if_fail (n_hashtags != NULL, NULL);
+
+  priv = stats->priv;
+
+  *n_hashtags = 0;
+
+  if (priv->tags->len == 0)
+    return NULL;
+
+  times = (const gint64 *) priv->time_column->data;
+  starts = (const guint *) priv->tag_starts->data;
+  tags = (const guint *) priv->tag_column->data;
+  n_rows = priv->time_column->len;
+
+  counts = g_new0 (guint, priv->tags->len);
+
+  for (i = 0; i < n_rows; i++)
+    {
+      guint j;
+
+      if (times[i] < since || times[i] >= until)
+        continue;
+
+      for (j = starts[i]; j < starts[i + 1]; j++)
+        counts[tags[j]] += 1;
+    }
+
+  retval = g_new (TwitterHashtagCount, priv->tags->len);
+
+  for (i = 0, n = 0; i < priv->tags->len; i++)
+    {
+      if (counts[i] == 0)
+        continue;
+
+      retval[n].hashtag = g_ptr_array_index (priv->tags, i);
+      retval[n].count = counts[i];
+      n += 1;
+    }
+
+  g_free (counts);
+
+  if (n == 0)
+    {
+      g_free (retval);
+      return NULL;
+    }
+
+  qsort (retval, n, sizeof (TwitterHashtagCount), compare_hashtag_count);
+
+  if (max_hashtags != 0 && n > max_hashtags)
+    n = max_hashtags;
+
+  *n_hashtags = n;
+
+  return retval;
+}
+
+/**
+ * twitter_timeline_stats_histogram:
+ * @stats: a #TwitterTimelineStats
+ * @start: the start of the first interval, in seconds from the epoch
+ * @interval: the length of each interval, in seconds
+ * @n_buckets: the number of intervals
+ *
+ * Counts the statuses created inside each of @n_buckets consecutive
+ * intervals of @interval seconds, starting from @start; for instance,
+ * an @interval of 3600 and 24 @n_buckets give the activity of each
+ * hour of a day. The statuses outside of the intervals are ignored.
+ *
+ * Return value: (array length=n_buckets): the number of statuses of
+ *   each interval. Use g_free() to free the returned array
+ *
+ * Since: 0.9.10
+ */
+guint *
+twitter_timeline_stats_histogram (TwitterTimelineStats *stats,
+                                  gint64                start,
+                                  gint64                interval,
+                                  guint                 n_buckets)
+{
+  TwitterTimelineStatsPrivate *priv;
+  const gint64 *times;
+  guint *retval;
+  guint n_rows, i;
+
+  g_return_val_if_fail (TWITTER_IS_TIMELINE_STATS (stats), NULL);
+  g_return_val_if_fail (interval > 0, NULL);
+  g_return_val_if_fail (n_buckets > 0, NULL);
+
+  priv = stats->priv;
+
+  times = (const gint64 *) priv->time_column->data;
+  n_rows = priv->time_column->len;
+
+  retval = g_new0 (guint, n_buckets);
+
+  for (i = 0; i < n_rows; i++)
+    {
+      gint64 bucket;
+
+      if (times[i] < start)
+        continue;
+
+      bucket = (times[i] - start) / interval;
+      if (bucket < n_buckets)
+        retval[bucket] += 1;
+    }
+
+  return retval;
+}
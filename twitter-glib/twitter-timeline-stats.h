@@ -0,0 +1,121 @@
+/* twitter-timeline-stats.h: Aggregations over timelines
+ *
+ * This file is part of Twitter-GLib.
+ * Copyright (C) 2008  Emmanuele Bassi  <ebassi@gnome.org>
+ *
+ * This library is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation, either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef __TWITTER_TIMELINE_STATS_H__
+#define __TWITTER_TIMELINE_STATS_H__
+
+#include <glib-object.h>
+
+#include <twitter-glib/twitter-status.h>
+#include <twitter-glib/twitter-timeline.h>
+
+G_BEGIN_DECLS
+
+#define TWITTER_TYPE_TIMELINE_STATS             (twitter_timeline_stats_get_type ())
+#define TWITTER_TIMELINE_STATS(obj)             (G_TYPE_CHECK_INSTANCE_CAST ((obj), TWITTER_TYPE_TIMELINE_STATS, TwitterTimelineStats))
+#define TWITTER_IS_TIMELINE_STATS(obj)          (G_TYPE_CHECK_INSTANCE_TYPE ((obj), TWITTER_TYPE_TIMELINE_STATS))
+#define TWITTER_TIMELINE_STATS_CLASS(klass)     (G_TYPE_CHECK_CLASS_CAST ((klass), TWITTER_TYPE_TIMELINE_STATS, TwitterTimelineStatsClass))
+#define TWITTER_IS_TIMELINE_STATS_CLASS(klass)  (G_TYPE_CHECK_CLASS_TYPE ((klass), TWITTER_TYPE_TIMELINE_STATS))
+#define TWITTER_TIMELINE_STATS_GET_CLASS(obj)   (G_TYPE_INSTANCE_GET_CLASS ((obj), TWITTER_TYPE_TIMELINE_STATS, TwitterTimelineStatsClass))
+
+typedef struct _TwitterTimelineStats            TwitterTimelineStats;
+typedef struct _TwitterTimelineStatsPrivate     TwitterTimelineStatsPrivate;
+typedef struct _TwitterTimelineStatsClass       TwitterTimelineStatsClass;
+
+/**
+ * TwitterUserCount:
+ * @user_id: the id of a user
+ * @count: the number of statuses posted by the user
+ *
+ * The number of statuses of a user, as computed by
+ * twitter_timeline_stats_count_by_user().
+ *
+ * Since: 0.9.10
+ */
+typedef struct {
+  guint user_id;
+  guint count;
+} TwitterUserCount;
+
+/**
+ * TwitterHashtagCount:
+ * @hashtag: the case folded hashtag, without the leading '#'
+ * @count: the number of statuses containing the hashtag
+ *
+ * The number of statuses containing a hashtag, as computed by
+ * twitter_timeline_stats_top_hashtags().
+ *
+ * Since: 0.9.10
+ */
+typedef struct {
+  const gchar *hashtag;
+  guint count;
+} TwitterHashtagCount;
+
+/**
+ * TwitterTimelineStats:
+ *
+ * The #TwitterTimelineStats struct contains private data only, and
+ * should only be accessed using the functions below.
+ */
+struct _TwitterTimelineStats
+{
+  /*< private >*/
+  GObject parent_instance;
+
+  TwitterTimelineStatsPrivate *priv;
+};
+
+/**
+ * TwitterTimelineStatsClass:
+ *
+ * The #TwitterTimelineStatsClass struct contains only private data
+ */
+struct _TwitterTimelineStatsClass
+{
+  /*< private >*/
+  GObjectClass parent_class;
+};
+
+GType                 twitter_timeline_stats_get_type      (void) G_GNUC_CONST;
+
+TwitterTimelineStats *twitter_timeline_stats_new           (void);
+
+void                  twitter_timeline_stats_add_status    (TwitterTimelineStats *stats,
+                                                            TwitterStatus        *status);
+void                  twitter_timeline_stats_add_timeline  (TwitterTimelineStats *stats,
+                                                            TwitterTimeline      *timeline);
+guint                 twitter_timeline_stats_get_count     (TwitterTimelineStats *stats);
+
+TwitterUserCount *    twitter_timeline_stats_count_by_user (TwitterTimelineStats *stats,
+                                                            gint64                since,
+                                                            gint64                until,
+                                                            guint                *n_users);
+TwitterHashtagCount * twitter_timeline_stats_top_hashtags  (TwitterTimelineStats *stats,
+                                                            gint64                since,
+                                                            gint64                until,
+                                                            guint                 max_hashtags,
+                                                            guint                *n_hashtags);
+guint *               twitter_timeline_stats_histogram     (TwitterTimelineStats *stats,
+                                                            gint64                start,
+                                                            gint64                interval,
+                                                            guint                 n_buckets);
+
+G_END_DECLS
+
+#endif /* __TWITTER_TIMELINE_STATS_H__ */
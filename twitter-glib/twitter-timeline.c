@@ -23,6 +23,23 @@
  *
  * #TwitterTimeline is a class that represents a list of Status
  * messages coming from Twitter
+ *
+ * The statuses inside a #TwitterTimeline are kept sorted by their
+ * id, newest first, and each status is present only once. Newly
+ * fetched pages can be added to an existing timeline using
+ * twitter_timeline_merge_from_data(); the #TwitterTimeline:max-length
+ * property can be used to limit the number of statuses kept, in
+ * which case the oldest statuses will be dropped first.
+ *
+ * Each change to the contents of a #TwitterTimeline is notified by
+ * the #TwitterTimeline::items-changed signal, which can be used to
+ * update a view incrementally.
+ *
+ * When built against GLib 2.44 or later, #TwitterTimeline also
+ * implements the #GListModel interface, whose #GListModel::items-changed
+ * signal is the same signal; views can then be bound directly to a
+ * timeline. The signal, and its class handler, are available with
+ * every version of GLib.
  */
 
 #ifdef HAVE_CONFIG_H
@@ -31,11 +48,14 @@
 
 #include <string.h>
 #include <glib.h>
+#include <gio/gio.h>
 
 #include <json-glib/json-glib.h>
 
 #include "twitter-common.h"
 #include "twitter-enum-types.h"
+#include "twitter-marshal.h"
+#include "twitter-parse-pool.h"
 #include "twitter-private.h"
 #include "twitter-status.h"
 #include "twitter-timeline.h"
@@ -45,11 +65,97 @@
 
 struct _TwitterTimelinePrivate
 {
+  /* owns a reference on each status */
   GHashTable *status_by_id;
-  GList *status_list;
+
+  /* sorted by descending id */
+  GPtrArray *statuses;
+
+  guint max_length;
+};
+
+enum
+{
+  PROP_0,
+
+  PROP_MAX_LENGTH
+};
+
+#if GLIB_CHECK_VERSION (2, 44, 0)
+static void twitter_timeline_list_model_init (GListModelInterface *iface);
+
+G_DEFINE_TYPE_WITH_CODE (TwitterTimeline, twitter_timeline, G_TYPE_OBJECT,
+                         G_IMPLEMENT_INTERFACE (G_TYPE_LIST_MODEL,
+                                                twitter_timeline_list_model_init));
+#else
+enum
+{
+  ITEMS_CHANGED,
+
+  LAST_SIGNAL
 };
 
+static guint timeline_signals[LAST_SIGNAL] = { 0, };
+
 G_DEFINE_TYPE (TwitterTimeline, twitter_timeline, G_TYPE_OBJECT);
+#endif
+
+#if GLIB_CHECK_VERSION (2, 44, 0)
+static GType
+twitter_timeline_get_item_type (GListModel *model)
+{
+  return TWITTER_TYPE_STATUS;
+}
+
+static guint
+twitter_timeline_get_n_items (GListModel *model)
+{
+  return TWITTER_TIMELINE (model)->priv->statuses->len;
+}
+
+static gpointer
+twitter_timeline_get_item (GListModel *model,
+                           guint       position)
+{
+  GPtrArray *statuses = TWITTER_TIMELINE (model)->priv->statuses;
+
+  if (position >= statuses->len)
+    return NULL;
+
+  return g_object_ref (g_ptr_array_index (statuses, position));
+}
+
+static void
+twitter_timeline_list_model_init (GListModelInterface *iface)
+{
+  iface->get_item_type = twitter_timeline_get_item_type;
+  iface->get_n_items = twitter_timeline_get_n_items;
+  iface->get_item = twitter_timeline_get_item;
+}
+#endif
+
+/* with GLib 2.44 the changes are notified through the signal of
+ * the GListModel interface, which cannot have our class handler; so
+ * we invoke it ourselves, like a G_SIGNAL_RUN_LAST handler would be
+ */
+static void
+twitter_timeline_items_changed (TwitterTimeline *timeline,
+                                guint            position,
+                                guint            removed,
+                                guint            added)
+{
+#if GLIB_CHECK_VERSION (2, 44, 0)
+  TwitterTimelineClass *klass = TWITTER_TIMELINE_GET_CLASS (timeline);
+
+  g_list_model_items_changed (G_LIST_MODEL (timeline), position, removed, added);
+
+  if (klass->items_changed != NULL)
+    klass->items_changed (timeline, position, removed, added);
+#else
+  g_signal_emit (timeline, timeline_signals[ITEMS_CHANGED], 0,
+                 position, removed, added);
+#endif
+}
 
 static void
 twitter_timeline_finalize (GObject *gobject)
@@ -57,11 +163,51 @@ twitter_timeline_finalize (GObject *gobject)
   TwitterTimelinePrivate *priv = TWITTER_TIMELINE (gobject)->priv;
 
   g_hash_table_destroy (priv->status_by_id);
-  g_list_free (priv->status_list);
+  g_ptr_array_free (priv->statuses, TRUE);
 
   G_OBJECT_CLASS (twitter_timeline_parent_class)->finalize (gobject);
 }
 
+static void
+twitter_timeline_set_property (GObject      *gobject,
+                               guint         prop_id,
+                               const GValue *value,
+                               GParamSpec   *pspec)
+{
+  TwitterTimeline *timeline = TWITTER_TIMELINE (gobject);
+
+  switch (prop_id)
+    {
+    case PROP_MAX_LENGTH:
+      twitter_timeline_set_max_length (timeline, g_value_get_uint (value));
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+twitter_timeline_get_property (GObject    *gobject,
+                               guint       prop_id,
+                               GValue     *value,
+                               GParamSpec *pspec)
+{
+  TwitterTimelinePrivate *priv = TWITTER_TIMELINE (gobject)->priv;
+
+  switch (prop_id)
+    {
+    case PROP_MAX_LENGTH:
+      g_value_set_uint (value, priv->max_length);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
+      break;
+    }
+}
+
 static void
 twitter_timeline_class_init (TwitterTimelineClass *klass)
 {
@@ -69,7 +215,61 @@ twitter_timeline_class_init (TwitterTimelineClass *klass)
 
   g_type_class_add_private (klass, sizeof (TwitterTimelinePrivate));
 
+  gobject_class->set_property = twitter_timeline_set_property;
+  gobject_class->get_property = twitter_timeline_get_property;
   gobject_class->finalize = twitter_timeline_finalize;
+
+  /**
+   * TwitterTimeline:max-length:
+   *
+   * The maximum number of statuses kept inside the timeline, or 0
+   * for no limit. When the limit is exceeded the oldest statuses
+   * are removed
+   *
+   * Since: 0.9.10
+   */
+  g_object_class_install_property (gobject_class,
+                                   PROP_MAX_LENGTH,
+                                   g_param_spec_uint ("max-length",
+                                                      "Max Length",
+                                                      "The maximum number of statuses",
+                                                      0, G_MAXUINT, 0,
+                                                      G_PARAM_READWRITE));
+
+  /**
+   * TwitterTimeline::items-changed:
+   * @timeline: the #TwitterTimeline that emitted the signal
+   * @position: the position of the change
+   * @removed: the number of statuses removed at @position
+   * @added: the number of statuses added at @position
+   *
+   * The ::items-changed signal is emitted each time the contents of
+   * @timeline change: @removed statuses were removed at @position,
+   * and @added statuses took their place. When the signal is emitted
+   * the change has already been applied, and the statuses can be
+   * retrieved using twitter_timeline_get_pos().
+   *
+   * Merging a page might emit the signal more than once; each
+   * emission should be applied in order.
+   *
+   * With GLib 2.44 or later, this is the #GListModel::items-changed
+   * signal of the #GListModel interface implemented by @timeline.
+   *
+   * Since: 0.9.10
+   */
+#if !GLIB_CHECK_VERSION (2, 44, 0)
+  timeline_signals[ITEMS_CHANGED] =
+    g_signal_new ("items-changed",
+                  G_TYPE_FROM_CLASS (gobject_class),
+                  G_SIGNAL_RUN_LAST,
+                  G_STRUCT_OFFSET (TwitterTimelineClass, items_changed),
+                  NULL, NULL,
+                  _twitter_marshal_VOID__UINT_UINT_UINT,
+                  G_TYPE_NONE, 3,
+                  G_TYPE_UINT,
+                  G_TYPE_UINT,
+                  G_TYPE_UINT);
+#endif
 }
 
 static void
@@ -82,68 +282,356 @@ twitter_timeline_init (TwitterTimeline *timeline)
   priv->status_by_id = g_hash_table_new_full (NULL, NULL,
                                               NULL,
                                               g_object_unref);
+  priv->statuses = g_ptr_array_new ();
 }
 
+/* removes every status after the first @length */
 static void
-twitter_timeline_clean (TwitterTimeline *timeline)
+twitter_timeline_remove_tail (TwitterTimeline *timeline,
+                              guint            length)
 {
   TwitterTimelinePrivate *priv = timeline->priv;
+  guint n_removed, i;
+
+  if (priv->statuses->len <= length)
+    return;
 
-  if (priv->status_list)
+  n_removed = priv->statuses->len - length;
+
+  for (i = length; i < priv->statuses->len; i++)
     {
-      g_list_free (priv->status_list);
-      priv->status_list = NULL;
+      TwitterStatus *status = g_ptr_array_index (priv->statuses, i);
+
+      g_hash_table_remove (priv->status_by_id,
+                           GUINT_TO_POINTER (twitter_status_get_id (status)));
     }
 
-  if (priv->status_by_id)
+  g_ptr_array_set_size (priv->statuses, length);
+
+  twitter_timeline_items_changed (timeline, length, n_removed, 0);
+}
+
+static void
+twitter_timeline_clean (TwitterTimeline *timeline)
+{
+  twitter_timeline_remove_tail (timeline, 0);
+}
+
+/* removes the statuses past the maximum length */
+static void
+twitter_timeline_truncate (TwitterTimeline *timeline)
+{
+  TwitterTimelinePrivate *priv = timeline->priv;
+
+  if (priv->max_length > 0)
+    twitter_timeline_remove_tail (timeline, priv->max_length);
+}
+
+/* inserts @n_statuses statuses at @position */
+static void
+twitter_timeline_insert (TwitterTimeline  *timeline,
+                         guint             position,
+                         TwitterStatus   **statuses,
+                         guint             n_statuses)
+{
+  TwitterTimelinePrivate *priv = timeline->priv;
+  guint length = priv->statuses->len;
+  guint i;
+
+  g_ptr_array_set_size (priv->statuses, length + n_statuses);
+  g_memmove (priv->statuses->pdata + position + n_statuses,
+             priv->statuses->pdata + position,
+             (length - position) * sizeof (gpointer));
+
+  for (i = 0; i < n_statuses; i++)
     {
-      g_hash_table_destroy (priv->status_by_id);
-      priv->status_by_id = g_hash_table_new_full (NULL, NULL,
-                                                  NULL,
-                                                  g_object_unref);
+      TwitterStatus *status = statuses[i];
+
+      priv->statuses->pdata[position + i] = status;
+      g_hash_table_insert (priv->status_by_id,
+                           GUINT_TO_POINTER (twitter_status_get_id (status)),
+                           status);
     }
+
+  twitter_timeline_items_changed (timeline, position, 0, n_statuses);
 }
 
+static gint
+compare_status_id (gconstpointer a,
+                   gconstpointer b)
+{
+  guint id_a = twitter_status_get_id (*((TwitterStatus **) a));
+  guint id_b = twitter_status_get_id (*((TwitterStatus **) b));
+
+  /* newest first */
+  if (id_a > id_b)
+    return -1;
+
+  if (id_a < id_b)
+    return 1;
+
+  return 0;
+}
+
+/* a sequence of new statuses, at their final position */
+typedef struct {
+  guint position;
+  guint n_statuses;
+} TimelineRun;
+
+/* merges @page, sorted by descending id and holding a reference on
+ * each status, with the statuses already inside the timeline; the
+ * statuses already present are kept, and the duplicates inside @page
+ * are released. Both lists are walked only once, to find the runs of
+ * new statuses; each run is then inserted and notified on its own, so
+ * that a refresh adding a few statuses at the top of the timeline only
+ * notifies those
+ */
 static void
-twitter_timeline_build (TwitterTimeline *timeline,
-                        JsonNode        *node)
+twitter_timeline_merge_sorted (TwitterTimeline *timeline,
+                               GPtrArray       *page)
 {
   TwitterTimelinePrivate *priv = timeline->priv;
-  JsonArray *array;
-  GList *elements, *l;
-  GList *status_list = NULL;
+  GPtrArray *statuses = priv->statuses;
+  GPtrArray *added;
+  GArray *runs;
+  guint n_old = statuses->len;
+  guint n_added, limit, offset;
+  guint position, last_id;
+  guint i, j;
 
-  if (!node || JSON_NODE_TYPE (node) != JSON_NODE_ARRAY)
+  if (page->len == 0)
     return;
 
-  array = json_node_get_array (node);
-  elements = json_array_get_elements (array);
+  added = g_ptr_array_sized_new (page->len);
+  runs = g_array_new (FALSE, FALSE, sizeof (TimelineRun));
 
-  for (l = elements; l != NULL; l = l->next)
+  i = j = 0;
+  position = last_id = 0;
+  while (i < n_old || j < page->len)
     {
-      JsonNode *element = l->data;
+      TwitterStatus *status;
+      gboolean is_new;
+      guint status_id;
 
-      if (JSON_NODE_TYPE (element) == JSON_NODE_OBJECT)
+      if (j == page->len ||
+          (i < n_old &&
+           compare_status_id (&g_ptr_array_index (statuses, i),
+                              &g_ptr_array_index (page, j)) <= 0))
+        {
+          status = g_ptr_array_index (statuses, i++);
+          is_new = FALSE;
+        }
+      else
         {
-          TwitterStatus *status;
-          guint status_id;
+          status = g_ptr_array_index (page, j++);
+          is_new = TRUE;
+        }
+
+      status_id = twitter_status_get_id (status);
 
-          status = twitter_status_new_from_node (element);
-          status_id = twitter_status_get_id (status);
-          if (status_id == 0)
+      /* on a tie the status already in the timeline comes first */
+      if (position > 0 && status_id == last_id)
+        {
+          if (is_new)
+            g_object_unref (status);
+
+          continue;
+        }
+
+      if (is_new)
+        {
+          TimelineRun *run = NULL;
+
+          if (runs->len > 0)
+            run = &g_array_index (runs, TimelineRun, runs->len - 1);
+
+          if (run != NULL && run->position + run->n_statuses == position)
+            run->n_statuses += 1;
+          else
             {
-              g_object_unref (status);
-              continue;
+              TimelineRun new_run = { position, 1 };
+
+              g_array_append_val (runs, new_run);
             }
 
-          g_hash_table_replace (priv->status_by_id,
-                                GUINT_TO_POINTER (status_id),
-                                g_object_ref_sink (status));
-          status_list = g_list_prepend (status_list, status);
+          g_ptr_array_add (added, status);
         }
+
+      position += 1;
+      last_id = status_id;
+    }
+
+  /* the new statuses past the maximum length are never added */
+  limit = position;
+  if (priv->max_length > 0 && priv->max_length < limit)
+    limit = priv->max_length;
+
+  n_added = 0;
+  for (i = 0; i < runs->len; i++)
+    {
+      TimelineRun *run = &g_array_index (runs, TimelineRun, i);
+
+      if (run->position >= limit)
+        run->n_statuses = 0;
+      else if (run->position + run->n_statuses > limit)
+        run->n_statuses = limit - run->position;
+
+      n_added += run->n_statuses;
+    }
+
+  /* the old statuses past the maximum length are removed first */
+  twitter_timeline_remove_tail (timeline, limit - n_added);
+
+  offset = 0;
+  for (i = 0; i < runs->len; i++)
+    {
+      TimelineRun *run = &g_array_index (runs, TimelineRun, i);
+
+      if (run->n_statuses == 0)
+        break;
+
+      twitter_timeline_insert (timeline, run->position,
+                               (TwitterStatus **) added->pdata + offset,
+                               run->n_statuses);
+
+      offset += run->n_statuses;
+    }
+
+  for (i = n_added; i < added->len; i++)
+    g_object_unref (g_ptr_array_index (added, i));
+
+  g_ptr_array_free (added, TRUE);
+  g_array_free (runs, TRUE);
+}
+
+/* adds the objects built out of an array */
+static void
+twitter_timeline_add_objects (TwitterTimeline *timeline,
+                              GPtrArray       *objects)
+{
+  GPtrArray *page;
+  gboolean sorted = TRUE;
+  guint i;
+
+  page = g_ptr_array_sized_new (objects->len);
+
+  for (i = 0; i < objects->len; i++)
+    {
+      TwitterStatus *status = g_ptr_array_index (objects, i);
+
+      if (status == NULL)
+        continue;
+
+      if (twitter_status_get_id (status) == 0)
+        {
+          g_object_unref (status);
+          continue;
+        }
+
+      g_object_ref_sink (status);
+
+      if (page->len > 0 &&
+          compare_status_id (&g_ptr_array_index (page, page->len - 1),
+                             &status) > 0)
+        sorted = FALSE;
+
+      g_ptr_array_add (page, status);
+    }
+
+  /* the pages are usually returned newest first already */
+  if (!sorted)
+    g_ptr_array_sort (page, compare_status_id);
+
+  twitter_timeline_merge_sorted (timeline, page);
+
+  g_ptr_array_free (page, TRUE);
+}
+
+/* adds @statuses, which may be floating, to @timeline */
+void
+_twitter_timeline_add_statuses (TwitterTimeline *timeline,
+                                GPtrArray       *statuses)
+{
+  twitter_timeline_add_objects (timeline, statuses);
+}
+
+static void
+twitter_timeline_build (TwitterTimeline *timeline,
+                        JsonNode        *node)
+{
+  JsonArray *array;
+  GPtrArray *objects;
+
+  if (!node || JSON_NODE_TYPE (node) != JSON_NODE_ARRAY)
+    return;
+
+  array = json_node_get_array (node);
+
+  /* large arrays are built in parallel, but in order */
+  objects = _twitter_parse_pool_build (array,
+                                       (TwitterParseFunc) twitter_status_new_from_node);
+
+  twitter_timeline_add_objects (timeline, objects);
+
+  g_ptr_array_free (objects, TRUE);
+}
+
+/* decodes the elements of the array in @buffer using the single
+ * pass decoder; large buffers are decoded in parallel. Returns
+ * %FALSE if json-glib should be used instead
+ */
+static gboolean
+twitter_timeline_decode_data (TwitterTimeline *timeline,
+                              const gchar     *buffer)
+{
+  GPtrArray *objects;
+
+  objects = _twitter_parse_pool_decode_data (buffer,
+                                             (TwitterNewFunc) twitter_status_new,
+                                             (TwitterDecodeFunc) _twitter_status_decode);
+  if (objects == NULL)
+    return FALSE;
+
+  twitter_timeline_add_objects (timeline, objects);
+
+  g_ptr_array_free (objects, TRUE);
+
+  return TRUE;
+}
+
+/* adds the statuses inside @buffer to @timeline */
+static gboolean
+twitter_timeline_load (TwitterTimeline  *timeline,
+                       const gchar      *buffer,
+                       GError          **error)
+{
+  JsonParser *parser;
+  GError *parse_error;
+  gboolean retval = TRUE;
+
+  if (twitter_timeline_decode_data (timeline, buffer))
+    return TRUE;
+
+  parser = _twitter_parse_pool_get_parser ();
+  parse_error = NULL;
+  json_parser_load_from_data (parser, buffer, -1, &parse_error);
+  if (parse_error)
+    {
+      g_set_error (error, TWITTER_ERROR,
+                   TWITTER_ERROR_PARSE_ERROR,
+                   "Parse error (%s)",
+                   parse_error->message);
+      g_error_free (parse_error);
+
+      retval = FALSE;
     }
+  else
+    twitter_timeline_build (timeline, json_parser_get_root (parser));
 
-  priv->status_list = status_list;
+  _twitter_parse_pool_put_parser (parser);
+
+  return retval;
 }
 
 /**
@@ -174,26 +662,19 @@ TwitterTimeline *
 twitter_timeline_new_from_data (const gchar *buffer)
 {
   TwitterTimeline *retval;
-  JsonParser *parser;
   GError *parse_error;
 
   g_return_val_if_fail (buffer != NULL, NULL);
 
   retval = twitter_timeline_new ();
 
-  parser = json_parser_new ();
   parse_error = NULL;
-  json_parser_load_from_data (parser, buffer, -1, &parse_error);
-  if (parse_error)
+  if (!twitter_timeline_load (retval, buffer, &parse_error))
     {
       g_warning ("Unable to parse data into a timeline: %s",
                  parse_error->message);
       g_error_free (parse_error);
     }
-  else
-    twitter_timeline_build (retval, json_parser_get_root (parser));
-
-  g_object_unref (parser);
 
   return retval;
 }
@@ -217,36 +698,306 @@ twitter_timeline_load_from_data (TwitterTimeline  *timeline,
                                  const gchar      *buffer,
                                  GError          **error)
 {
-  JsonParser *parser;
-  GError *parse_error;
-  gboolean retval = TRUE;
+  g_return_val_if_fail (TWITTER_IS_TIMELINE (timeline), FALSE);
+  g_return_val_if_fail (buffer != NULL, FALSE);
+
+  twitter_timeline_clean (timeline);
+
+  return twitter_timeline_load (timeline, buffer, error);
+}
 
+/**
+ * twitter_timeline_merge_from_data:
+ * @timeline: a #TwitterTimeline
+ * @buffer: a %NULL-terminated string containing the JSON description
+ *   of a timeline
+ * @error: return location for a #GError, or %NULL
+ *
+ * Adds the statuses described by @buffer to @timeline, keeping the
+ * statuses sorted by id. Unlike twitter_timeline_load_from_data(),
+ * the previous content of @timeline is preserved; the statuses that
+ * are already inside @timeline will not be replaced.
+ *
+ * If the #TwitterTimeline:max-length property is set, the oldest
+ * statuses will be removed from @timeline.
+ *
+ * Return value: %TRUE if @buffer was successfully parsed, %FALSE
+ *   otherwise
+ *
+ * Since: 0.9.10
+ */
+gboolean
+twitter_timeline_merge_from_data (TwitterTimeline  *timeline,
+                                  const gchar      *buffer,
+                                  GError          **error)
+{
   g_return_val_if_fail (TWITTER_IS_TIMELINE (timeline), FALSE);
   g_return_val_if_fail (buffer != NULL, FALSE);
 
+  return twitter_timeline_load (timeline, buffer, error);
+}
+
+/**
+ * twitter_timeline_merge:
+ * @timeline: a #TwitterTimeline
+ * @page: a #TwitterTimeline
+ *
+ * Adds the statuses of @page to @timeline, keeping the statuses
+ * sorted by id; the statuses that are already inside @timeline will
+ * not be replaced. The statuses will be shared by the two timelines.
+ *
+ * If the #TwitterTimeline:max-length property is set, the oldest
+ * statuses will be removed from @timeline.
+ *
+ * Since: 0.9.10
+ */
+void
+twitter_timeline_merge (TwitterTimeline *timeline,
+                        TwitterTimeline *page)
+{
+  GPtrArray *statuses;
+  guint i;
+
+  g_return_if_fail (TWITTER_IS_TIMELINE (timeline));
+  g_return_if_fail (TWITTER_IS_TIMELINE (page));
+
+  if (timeline == page)
+    return;
+
+  statuses = g_ptr_array_sized_new (page->priv->statuses->len);
+
+  for (i = 0; i < page->priv->statuses->len; i++)
+    g_ptr_array_add (statuses,
+                     g_object_ref (g_ptr_array_index (page->priv->statuses, i)));
+
+  twitter_timeline_merge_sorted (timeline, statuses);
+
+  g_ptr_array_free (statuses, TRUE);
+}
+
+/**
+ * twitter_timeline_to_binary:
+ * @timeline: a #TwitterTimeline
+ * @length: return location for the length of the data
+ *
+ * Saves the statuses of @timeline, and their users, using a compact
+ * binary format, which can be loaded back using
+ * twitter_timeline_load_from_binary(). Each user is saved only once,
+ * and each string only once; see twitter_status_to_binary() for
+ * the details
+ *
+ * Return value: a newly allocated buffer. Use g_free() to free it
+ *
+ * Since: 0.9.10
+ */
+gchar *
+twitter_timeline_to_binary (TwitterTimeline *timeline,
+                            gsize           *length)
+{
+  TwitterTimelinePrivate *priv;
+  TwitterRecordWriter writer;
+  GHashTable *user_ids;
+  GPtrArray *users;
+  guint i;
+
+  g_return_val_if_fail (TWITTER_IS_TIMELINE (timeline), NULL);
+  g_return_val_if_fail (length != NULL, NULL);
+
+  priv = timeline->priv;
+
+  user_ids = g_hash_table_new (NULL, NULL);
+  users = g_ptr_array_new ();
+
+  for (i = 0; i < priv->statuses->len; i++)
+    {
+      TwitterStatus *status = g_ptr_array_index (priv->statuses, i);
+      TwitterUser *user = twitter_status_get_user (status);
+      guint user_id;
+
+      if (user == NULL)
+        continue;
+
+      user_id = twitter_user_get_id (user);
+      if (user_id == 0 ||
+          g_hash_table_lookup (user_ids, GUINT_TO_POINTER (user_id)) != NULL)
+        continue;
+
+      g_hash_table_insert (user_ids, GUINT_TO_POINTER (user_id), user);
+      g_ptr_array_add (users, user);
+    }
+
+  _twitter_record_writer_init (&writer, TRUE);
+
+  /* the users come first, so that the statuses can be attached
+   * to them while loading
+   */
+  _twitter_record_write_uint32 (&writer, users->len);
+  for (i = 0; i < users->len; i++)
+    _twitter_user_write_record (g_ptr_array_index (users, i), &writer);
+
+  _twitter_record_write_uint32 (&writer, priv->statuses->len);
+  for (i = 0; i < priv->statuses->len; i++)
+    _twitter_status_write_record (g_ptr_array_index (priv->statuses, i),
+                                  &writer);
+
+  g_ptr_array_free (users, TRUE);
+  g_hash_table_destroy (user_ids);
+
+  return _twitter_record_writer_finish (&writer, TWITTER_RECORD_TIMELINE,
+                                        length);
+}
+
+/**
+ * twitter_timeline_load_from_binary:
+ * @timeline: a #TwitterTimeline
+ * @data: the data saved by twitter_timeline_to_binary()
+ * @length: the length of @data
+ * @error: return location for a #GError, or %NULL
+ *
+ * Replaces the contents of @timeline with the statuses saved by
+ * twitter_timeline_to_binary()
+ *
+ * Return value: %TRUE if the data was loaded
+ *
+ * Since: 0.9.10
+ */
+gboolean
+twitter_timeline_load_from_binary (TwitterTimeline  *timeline,
+                                   const gchar      *data,
+                                   gsize             length,
+                                   GError          **error)
+{
+  TwitterRecordReader reader;
+  GHashTable *users;
+  GPtrArray *statuses;
+  guint32 n_users, n_statuses, i;
+  gboolean retval = TRUE;
+
+  g_return_val_if_fail (TWITTER_IS_TIMELINE (timeline), FALSE);
+  g_return_val_if_fail (data != NULL, FALSE);
+
   twitter_timeline_clean (timeline);
 
-  parser = json_parser_new ();
-  parse_error = NULL;
-  json_parser_load_from_data (parser, buffer, -1, &parse_error);
-  if (parse_error)
+  if (!_twitter_record_reader_init_binary (&reader, data, length,
+                                           TWITTER_RECORD_TIMELINE,
+                                           error))
+    return FALSE;
+
+  users = g_hash_table_new (NULL, NULL);
+
+  n_users = _twitter_record_read_uint32 (&reader);
+  for (i = 0; i < n_users && !_twitter_record_reader_failed (&reader); i++)
+    {
+      TwitterUser *user = twitter_user_new ();
+
+      if (!_twitter_user_read_record (user, &reader))
+        {
+          g_object_unref (user);
+          break;
+        }
+
+      g_hash_table_insert (users,
+                           GUINT_TO_POINTER (twitter_user_get_id (user)),
+                           user);
+    }
+
+  n_statuses = _twitter_record_read_uint32 (&reader);
+  statuses = g_ptr_array_sized_new (MIN (n_statuses, 1024));
+
+  for (i = 0; i < n_statuses && !_twitter_record_reader_failed (&reader); i++)
+    {
+      TwitterStatus *status = twitter_status_new ();
+      TwitterUser *user;
+      guint user_id;
+
+      if (!_twitter_status_read_record (status, &reader, &user_id))
+        {
+          g_object_unref (status);
+          break;
+        }
+
+      user = g_hash_table_lookup (users, GUINT_TO_POINTER (user_id));
+      if (user != NULL)
+        _twitter_status_set_user (status, user);
+
+      g_ptr_array_add (statuses, status);
+    }
+
+  if (_twitter_record_reader_failed (&reader))
     {
+      GList *values;
+
+      g_ptr_array_foreach (statuses, unref_object, NULL);
+
+      values = g_hash_table_get_values (users);
+      g_list_foreach (values, unref_object, NULL);
+      g_list_free (values);
+
       g_set_error (error, TWITTER_ERROR,
                    TWITTER_ERROR_PARSE_ERROR,
-                   "Parse error (%s)",
-                   parse_error->message);
-      g_error_free (parse_error);
+                   "Invalid binary data");
 
       retval = FALSE;
     }
   else
-    twitter_timeline_build (timeline, json_parser_get_root (parser));
+    twitter_timeline_add_objects (timeline, statuses);
 
-  g_object_unref (parser);
+  g_ptr_array_free (statuses, TRUE);
+  g_hash_table_destroy (users);
+  _twitter_record_reader_clear (&reader);
 
   return retval;
 }
 
+/**
+ * twitter_timeline_set_max_length:
+ * @timeline: a #TwitterTimeline
+ * @max_length: the maximum number of statuses, or 0
+ *
+ * Sets the maximum number of statuses kept inside @timeline; if
+ * @timeline contains more than @max_length statuses, the oldest
+ * ones will be removed. A @max_length of 0 removes the limit.
+ *
+ * Since: 0.9.10
+ */
+void
+twitter_timeline_set_max_length (TwitterTimeline *timeline,
+                                 guint            max_length)
+{
+  TwitterTimelinePrivate *priv;
+
+  g_return_if_fail (TWITTER_IS_TIMELINE (timeline));
+
+  priv = timeline->priv;
+
+  if (priv->max_length == max_length)
+    return;
+
+  priv->max_length = max_length;
+
+  twitter_timeline_truncate (timeline);
+
+  g_object_notify (G_OBJECT (timeline), "max-length");
+}
+
+/**
+ * twitter_timeline_get_max_length:
+ * @timeline: a #TwitterTimeline
+ *
+ * Retrieves the maximum number of statuses kept inside @timeline
+ *
+ * Return value: the maximum length, or 0 for no limit
+ *
+ * Since: 0.9.10
+ */
+guint
+twitter_timeline_get_max_length (TwitterTimeline *timeline)
+{
+  g_return_val_if_fail (TWITTER_IS_TIMELINE (timeline), 0);
+
+  return timeline->priv->max_length;
+}
+
 /**
  * twitter_timeline_get_count:
  * @timeline: a #TwitterTimeline
@@ -288,7 +1039,9 @@ twitter_timeline_get_id (TwitterTimeline *timeline,
  * @timeline: a #TwitterTimeline
  * @index_: the position in the timeline
  *
- * Retrieves the #TwitterStatus at the given @index_
+ * Retrieves the #TwitterStatus at the given @index_; the statuses
+ * are sorted by id, newest first. A negative @index_ is counted
+ * from the end of the timeline
  *
  * Return value: a #TwitterStatus
  */
@@ -299,15 +1052,10 @@ twitter_timeline_get_pos (TwitterTimeline *timeline,
   g_return_val_if_fail (TWITTER_IS_TIMELINE (timeline), NULL);
   g_return_val_if_fail (ABS (index_) < twitter_timeline_get_count (timeline), NULL);
 
-  if (index_ >= 0)
-    return g_list_nth_data (timeline->priv->status_list, index_);
-  else
-    {
-      guint roll = g_list_length (timeline->priv->status_list);
+  if (index_ < 0)
+    index_ += timeline->priv->statuses->len;
 
-      roll += index_;
-      return g_list_nth_data (timeline->priv->status_list, roll);
-    }
+  return g_ptr_array_index (timeline->priv->statuses, index_);
 }
 
 /**
@@ -324,7 +1072,16 @@ twitter_timeline_get_pos (TwitterTimeline *timeline,
 GList *
 twitter_timeline_get_all (TwitterTimeline *timeline)
 {
+  GPtrArray *statuses;
+  GList *retval = NULL;
+  guint i;
+
   g_return_val_if_fail (TWITTER_IS_TIMELINE (timeline), NULL);
 
-  return g_list_copy (timeline->priv->status_list);
+  statuses = timeline->priv->statuses;
+
+  for (i = statuses->len; i > 0; i--)
+    retval = g_list_prepend (retval, g_ptr_array_index (statuses, i - 1));
+
+  return retval;
 }
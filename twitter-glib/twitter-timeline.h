@@ -51,13 +51,29 @@ struct _TwitterTimeline
 
 /**
  * TwitterTimelineClass:
+ * @items_changed: class handler for the #TwitterTimeline::items-changed
+ *   signal, invoked with every version of GLib; added in 0.9.10
  *
- * The #TwitterTimelineClass contains only private data
+ * The #TwitterTimelineClass struct contains only the class handlers of
+ * the #TwitterTimeline signals.
  */
 struct _TwitterTimelineClass
 {
   /*< private >*/
   GObjectClass parent_class;
+
+  /*< public >*/
+  void (* items_changed) (TwitterTimeline *timeline,
+                          guint position,
+                          guint removed,
+                          guint added);
+
+  /*< private >*/
+  /* padding, for future expansion */
+  void (* _twitter_padding1) (void);
+  void (* _twitter_padding2) (void);
+  void (* _twitter_padding3) (void);
+  void (* _twitter_padding4) (void);
 };
 
 GType            twitter_timeline_get_type       (void) G_GNUC_CONST;
@@ -68,6 +84,21 @@ TwitterTimeline *twitter_timeline_new_from_data  (const gchar      *buffer);
 gboolean         twitter_timeline_load_from_data (TwitterTimeline  *timeline,
                                                   const gchar      *buffer,
                                                   GError          **error);
+gchar *          twitter_timeline_to_binary      (TwitterTimeline  *timeline,
+                                                  gsize            *length);
+gboolean         twitter_timeline_load_from_binary (TwitterTimeline  *timeline,
+                                                    const gchar      *data,
+                                                    gsize             length,
+                                                    GError          **error);
+gboolean         twitter_timeline_merge_from_data (TwitterTimeline *timeline,
+                                                   const gchar     *buffer,
+                                                   GError         **error);
+void             twitter_timeline_merge          (TwitterTimeline  *timeline,
+                                                  TwitterTimeline  *page);
+
+void             twitter_timeline_set_max_length (TwitterTimeline  *timeline,
+                                                  guint             max_length);
+guint            twitter_timeline_get_max_length (TwitterTimeline  *timeline);
 
 guint            twitter_timeline_get_count      (TwitterTimeline  *timeline);
 TwitterStatus *  twitter_timeline_get_id         (TwitterTimeline  *timeline,
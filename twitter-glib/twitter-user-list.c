@@ -23,6 +23,14 @@
  *
  * #TwitterUserList is a class collecting a list of #TwitterUser
  * instances.
+ *
+ * Each change to the contents of a #TwitterUserList is notified by
+ * the #TwitterUserList::items-changed signal, which is available with
+ * every version of GLib.
+ *
+ * When built against GLib 2.44 or later, #TwitterUserList also
+ * implements the #GListModel interface, whose #GListModel::items-changed
+ * signal is the same signal.
  */
 
 #ifdef HAVE_CONFIG_H
@@ -31,11 +39,14 @@
 
 #include <string.h>
 #include <glib.h>
+#include <gio/gio.h>
 
 #include <json-glib/json-glib.h>
 
 #include "twitter-common.h"
 #include "twitter-enum-types.h"
+#include "twitter-marshal.h"
+#include "twitter-parse-pool.h"
 #include "twitter-private.h"
 #include "twitter-status.h"
 #include "twitter-user-list.h"
@@ -45,11 +56,88 @@
 
 struct _TwitterUserListPrivate
 {
+  /* owns a reference on each user */
   GHashTable *user_by_id;
-  GList *user_list;
+
+  /* in the order of the response */
+  GPtrArray *users;
 };
 
+#if GLIB_CHECK_VERSION (2, 44, 0)
+static void twitter_user_list_list_model_init (GListModelInterface *iface);
+
+G_DEFINE_TYPE_WITH_CODE (TwitterUserList, twitter_user_list, G_TYPE_OBJECT,
+                         G_IMPLEMENT_INTERFACE (G_TYPE_LIST_MODEL,
+                                                twitter_user_list_list_model_init));
+#else
+enum
+{
+  ITEMS_CHANGED,
+
+  LAST_SIGNAL
+};
+
+static guint user_list_signals[LAST_SIGNAL] = { 0, };
+
 G_DEFINE_TYPE (TwitterUserList, twitter_user_list, G_TYPE_OBJECT);
+#endif
+
+#if GLIB_CHECK_VERSION (2, 44, 0)
+static GType
+twitter_user_list_get_item_type (GListModel *model)
+{
+  return TWITTER_TYPE_USER;
+}
+
+static guint
+twitter_user_list_get_n_items (GListModel *model)
+{
+  return TWITTER_USER_LIST (model)->priv->users->len;
+}
+
+static gpointer
+twitter_user_list_get_item (GListModel *model,
+                            guint       position)
+{
+  GPtrArray *users = TWITTER_USER_LIST (model)->priv->users;
+
+  if (position >= users->len)
+    return NULL;
+
+  return g_object_ref (g_ptr_array_index (users, position));
+}
+
+static void
+twitter_user_list_list_model_init (GListModelInterface *iface)
+{
+  iface->get_item_type = twitter_user_list_get_item_type;
+  iface->get_n_items = twitter_user_list_get_n_items;
+  iface->get_item = twitter_user_list_get_item;
+}
+#endif
+
+/* with GLib 2.44 the changes are notified through the signal of
+ * the GListModel interface, which cannot have our class handler; so
+ * we invoke it ourselves, like a G_SIGNAL_RUN_LAST handler would be
+ */
+static void
+twitter_user_list_items_changed (TwitterUserList *user_list,
+                                 guint            position,
+                                 guint            removed,
+                                 guint            added)
+{
+#if GLIB_CHECK_VERSION (2, 44, 0)
+  TwitterUserListClass *klass = TWITTER_USER_LIST_GET_CLASS (user_list);
+
+  g_list_model_items_changed (G_LIST_MODEL (user_list), position, removed, added);
+
+  if (klass->items_changed != NULL)
+    klass->items_changed (user_list, position, removed, added);
+#else
+  g_signal_emit (user_list, user_list_signals[ITEMS_CHANGED], 0,
+                 position, removed, added);
+#endif
+}
 
 static void
 twitter_user_list_finalize (GObject *gobject)
@@ -57,7 +145,7 @@ twitter_user_list_finalize (GObject *gobject)
   TwitterUserListPrivate *priv = TWITTER_USER_LIST (gobject)->priv;
 
   g_hash_table_destroy (priv->user_by_id);
-  g_list_free (priv->user_list);
+  g_ptr_array_free (priv->users, TRUE);
 
   G_OBJECT_CLASS (twitter_user_list_parent_class)->finalize (gobject);
 }
@@ -70,6 +158,36 @@ twitter_user_list_class_init (TwitterUserListClass *klass)
   g_type_class_add_private (klass, sizeof (TwitterUserListPrivate));
 
   gobject_class->finalize = twitter_user_list_finalize;
+
+  /**
+   * TwitterUserList::items-changed:
+   * @user_list: the #TwitterUserList that emitted the signal
+   * @position: the position of the change
+   * @removed: the number of users removed at @position
+   * @added: the number of users added at @position
+   *
+   * The ::items-changed signal is emitted each time the contents of
+   * @user_list change. When the signal is emitted the change has
+   * already been applied.
+   *
+   * With GLib 2.44 or later, this is the #GListModel::items-changed
+   * signal of the #GListModel interface implemented by @user_list.
+   *
+   * Since: 0.9.10
+   */
+#if !GLIB_CHECK_VERSION (2, 44, 0)
+  user_list_signals[ITEMS_CHANGED] =
+    g_signal_new ("items-changed",
+                  G_TYPE_FROM_CLASS (gobject_class),
+                  G_SIGNAL_RUN_LAST,
+                  G_STRUCT_OFFSET (TwitterUserListClass, items_changed),
+                  NULL, NULL,
+                  _twitter_marshal_VOID__UINT_UINT_UINT,
+                  G_TYPE_NONE, 3,
+                  G_TYPE_UINT,
+                  G_TYPE_UINT,
+                  G_TYPE_UINT);
+#endif
 }
 
 static void
@@ -82,68 +200,129 @@ twitter_user_list_init (TwitterUserList *user_list)
   priv->user_by_id = g_hash_table_new_full (NULL, NULL,
                                             NULL,
                                             g_object_unref);
+  priv->users = g_ptr_array_new ();
 }
 
 static void
 twitter_user_list_clean (TwitterUserList *user_list)
 {
   TwitterUserListPrivate *priv = user_list->priv;
+  guint n_users;
 
-  if (priv->user_list)
-    {
-      g_list_free (priv->user_list);
-      priv->user_list = NULL;
-    }
+  n_users = g_hash_table_size (priv->user_by_id);
+  if (n_users == 0)
+    return;
+
+  g_ptr_array_set_size (priv->users, 0);
+
+  g_hash_table_remove_all (priv->user_by_id);
+
+  twitter_user_list_items_changed (user_list, 0, n_users, 0);
+}
 
-  if (priv->user_by_id)
+/* adds the objects built out of an array, in order */
+static void
+twitter_user_list_add_objects (TwitterUserList *user_list,
+                               GPtrArray       *objects)
+{
+  TwitterUserListPrivate *priv = user_list->priv;
+  guint n_users, i;
+
+  n_users = priv->users->len;
+
+  for (i = 0; i < objects->len; i++)
     {
-      g_hash_table_destroy (priv->user_by_id);
-      priv->user_by_id = g_hash_table_new_full (NULL, NULL,
-                                                NULL,
-                                                g_object_unref);
+      TwitterUser *user = g_ptr_array_index (objects, i);
+      guint user_id;
+
+      if (user == NULL)
+        continue;
+
+      /* each user is listed only once */
+      user_id = twitter_user_get_id (user);
+      if (user_id == 0 ||
+          g_hash_table_lookup (priv->user_by_id, GUINT_TO_POINTER (user_id)))
+        {
+          g_object_unref (user);
+          continue;
+        }
+
+      g_hash_table_insert (priv->user_by_id,
+                           GUINT_TO_POINTER (user_id),
+                           g_object_ref_sink (user));
+      g_ptr_array_add (priv->users, user);
     }
+
+  if (priv->users->len > n_users)
+    twitter_user_list_items_changed (user_list, n_users, 0,
+                                     priv->users->len - n_users);
+}
+
+/* replaces the user at @index_ with @user, another instance of
+ * the same user
+ */
+void
+_twitter_user_list_replace (TwitterUserList *user_list,
+                            guint            index_,
+                            TwitterUser     *user)
+{
+  TwitterUserListPrivate *priv = user_list->priv;
+
+  g_return_if_fail (index_ < priv->users->len);
+  g_return_if_fail (twitter_user_get_id (user) ==
+                    twitter_user_get_id (g_ptr_array_index (priv->users, index_)));
+
+  /* the hash table holds the reference on the replaced user */
+  g_ptr_array_index (priv->users, index_) = user;
+  g_hash_table_insert (priv->user_by_id,
+                       GUINT_TO_POINTER (twitter_user_get_id (user)),
+                       g_object_ref (user));
+
+  twitter_user_list_items_changed (user_list, index_, 1, 1);
 }
 
 static void
 twitter_user_list_build (TwitterUserList *user_list,
                         JsonNode        *node)
 {
-  TwitterUserListPrivate *priv = user_list->priv;
   JsonArray *array;
-  GList *elements, *l;
-  GList *list = NULL;
+  GPtrArray *objects;
 
   if (!node || JSON_NODE_TYPE (node) != JSON_NODE_ARRAY)
     return;
 
   array = json_node_get_array (node);
-  elements = json_array_get_elements (array);
 
-  for (l = elements; l != NULL; l = l->next)
-    {
-      JsonNode *element = l->data;
+  /* large arrays are built in parallel, but in order */
+  objects = _twitter_parse_pool_build (array,
+                                       (TwitterParseFunc) twitter_user_new_from_node);
 
-      if (JSON_NODE_TYPE (element) == JSON_NODE_OBJECT)
-        {
-          TwitterUser *user;
-          guint user_id;
-
-          user = twitter_user_new_from_node (element);
-          user_id = twitter_user_get_id (user);
-          if (user_id == 0)
-            {
-              g_object_unref (user);
-              continue;
-            }
-
-          g_hash_table_replace (priv->user_by_id,
-                                GUINT_TO_POINTER (user_id),
-                                g_object_ref_sink (user));
-          list = g_list_prepend (list, user);
-        }
-    }
+  twitter_user_list_add_objects (user_list, objects);
 
-  priv->user_list = g_list_reverse (list);
+  g_ptr_array_free (objects, TRUE);
+}
+
+/* decodes the elements of the array in @buffer using the single
+ * pass decoder; large buffers are decoded in parallel. Returns
+ * %FALSE if json-glib should be used instead
+ */
+static gboolean
+twitter_user_list_decode_data (TwitterUserList *user_list,
+                               const gchar     *buffer)
+{
+  GPtrArray *objects;
+
+  objects = _twitter_parse_pool_decode_data (buffer,
+                                             (TwitterNewFunc) twitter_user_new,
+                                             (TwitterDecodeFunc) _twitter_user_decode);
+  if (objects == NULL)
+    return FALSE;
+
+  twitter_user_list_add_objects (user_list, objects);
+
+  g_ptr_array_free (objects, TRUE);
+
+  return TRUE;
 }
 
 TwitterUserList *
@@ -163,7 +342,10 @@ twitter_user_list_new_from_data (const gchar *buffer)
 
   retval = twitter_user_list_new ();
 
-  parser = json_parser_new ();
+  if (twitter_user_list_decode_data (retval, buffer))
+    return retval;
+
+  parser = _twitter_parse_pool_get_parser ();
   parse_error = NULL;
   json_parser_load_from_data (parser, buffer, -1, &parse_error);
   if (parse_error)
@@ -175,7 +357,7 @@ twitter_user_list_new_from_data (const gchar *buffer)
   else
     twitter_user_list_build (retval, json_parser_get_root (parser));
 
-  g_object_unref (parser);
+  _twitter_parse_pool_put_parser (parser);
 
   return retval;
 }
@@ -194,7 +376,10 @@ twitter_user_list_load_from_data (TwitterUserList  *user_list,
 
   twitter_user_list_clean (user_list);
 
-  parser = json_parser_new ();
+  if (twitter_user_list_decode_data (user_list, buffer))
+    return TRUE;
+
+  parser = _twitter_parse_pool_get_parser ();
   parse_error = NULL;
   json_parser_load_from_data (parser, buffer, -1, &parse_error);
   if (parse_error)
@@ -210,7 +395,113 @@ twitter_user_list_load_from_data (TwitterUserList  *user_list,
   else
     twitter_user_list_build (user_list, json_parser_get_root (parser));
 
-  g_object_unref (parser);
+  _twitter_parse_pool_put_parser (parser);
+
+  return retval;
+}
+
+/**
+ * twitter_user_list_to_binary:
+ * @user_list: a #TwitterUserList
+ * @length: return location for the length of the data
+ *
+ * Saves the users of @user_list using a compact binary format, which
+ * can be loaded back using twitter_user_list_load_from_binary(); see
+ * twitter_status_to_binary() for the details
+ *
+ * Return value: a newly allocated buffer. Use g_free() to free it
+ *
+ * Since: 0.9.10
+ */
+gchar *
+twitter_user_list_to_binary (TwitterUserList *user_list,
+                             gsize           *length)
+{
+  TwitterRecordWriter writer;
+  GPtrArray *users;
+  guint i;
+
+  g_return_val_if_fail (TWITTER_IS_USER_LIST (user_list), NULL);
+  g_return_val_if_fail (length != NULL, NULL);
+
+  users = user_list->priv->users;
+
+  _twitter_record_writer_init (&writer, TRUE);
+
+  _twitter_record_write_uint32 (&writer, users->len);
+  for (i = 0; i < users->len; i++)
+    _twitter_user_write_record (g_ptr_array_index (users, i), &writer);
+
+  return _twitter_record_writer_finish (&writer, TWITTER_RECORD_USER_LIST,
+                                        length);
+}
+
+/**
+ * twitter_user_list_load_from_binary:
+ * @user_list: a #TwitterUserList
+ * @data: the data saved by twitter_user_list_to_binary()
+ * @length: the length of @data
+ * @error: return location for a #GError, or %NULL
+ *
+ * Replaces the contents of @user_list with the users saved by
+ * twitter_user_list_to_binary()
+ *
+ * Return value: %TRUE if the data was loaded
+ *
+ * Since: 0.9.10
+ */
+gboolean
+twitter_user_list_load_from_binary (TwitterUserList  *user_list,
+                                    const gchar      *data,
+                                    gsize             length,
+                                    GError          **error)
+{
+  TwitterRecordReader reader;
+  GPtrArray *users;
+  guint32 n_users, i;
+  gboolean retval = TRUE;
+
+  g_return_val_if_fail (TWITTER_IS_USER_LIST (user_list), FALSE);
+  g_return_val_if_fail (data != NULL, FALSE);
+
+  twitter_user_list_clean (user_list);
+
+  if (!_twitter_record_reader_init_binary (&reader, data, length,
+                                           TWITTER_RECORD_USER_LIST,
+                                           error))
+    return FALSE;
+
+  n_users = _twitter_record_read_uint32 (&reader);
+  users = g_ptr_array_sized_new (MIN (n_users, 1024));
+
+  for (i = 0; i < n_users && !_twitter_record_reader_failed (&reader); i++)
+    {
+      TwitterUser *user = twitter_user_new ();
+
+      if (!_twitter_user_read_record (user, &reader))
+        {
+          g_object_unref (user);
+          break;
+        }
+
+      g_ptr_array_add (users, user);
+    }
+
+  if (_twitter_record_reader_failed (&reader))
+    {
+      g_ptr_array_foreach (users, unref_object, NULL);
+
+      g_set_error (error, TWITTER_ERROR,
+                   TWITTER_ERROR_PARSE_ERROR,
+                   "Invalid binary data");
+
+      retval = FALSE;
+    }
+  else
+    twitter_user_list_add_objects (user_list, users);
+
+  g_ptr_array_free (users, TRUE);
+  _twitter_record_reader_clear (&reader);
 
   return retval;
 }
@@ -240,21 +531,25 @@ twitter_user_list_get_pos (TwitterUserList *user_list,
   g_return_val_if_fail (TWITTER_IS_USER_LIST (user_list), NULL);
   g_return_val_if_fail (ABS (index_) < twitter_user_list_get_count (user_list), NULL);
 
-  if (index_ >= 0)
-    return g_list_nth_data (user_list->priv->user_list, index_);
-  else
-    {
-      guint roll = g_list_length (user_list->priv->user_list);
+  if (index_ < 0)
+    index_ += user_list->priv->users->len;
 
-      roll += index_;
-      return g_list_nth_data (user_list->priv->user_list, roll);
-    }
+  return g_ptr_array_index (user_list->priv->users, index_);
 }
 
 GList *
 twitter_user_list_get_all (TwitterUserList *user_list)
 {
+  GPtrArray *users;
+  GList *retval = NULL;
+  guint i;
+
   g_return_val_if_fail (TWITTER_IS_USER_LIST (user_list), NULL);
 
-  return g_list_copy (user_list->priv->user_list);
+  users = user_list->priv->users;
+
+  for (i = users->len; i > 0; i--)
+    retval = g_list_prepend (retval, g_ptr_array_index (users, i - 1));
+
+  return retval;
 }
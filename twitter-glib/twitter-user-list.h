@@ -51,13 +51,29 @@ struct _TwitterUserList
 
 /**
  * TwitterUserListClass:
+ * @items_changed: class handler for the #TwitterUserList::items-changed
+ *   signal, invoked with every version of GLib; added in 0.9.10
  *
- * The #TwitterUserListClass struct contains only private data
+ * The #TwitterUserListClass struct contains only the class handlers of
+ * the #TwitterUserList signals.
  */
 struct _TwitterUserListClass
 {
   /*< private >*/
   GObjectClass parent_class;
+
+  /*< public >*/
+  void (* items_changed) (TwitterUserList *user_list,
+                          guint position,
+                          guint removed,
+                          guint added);
+
+  /*< private >*/
+  /* padding, for future expansion */
+  void (* _twitter_padding1) (void);
+  void (* _twitter_padding2) (void);
+  void (* _twitter_padding3) (void);
+  void (* _twitter_padding4) (void);
 };
 
 GType            twitter_user_list_get_type       (void) G_GNUC_CONST;
@@ -68,6 +84,12 @@ TwitterUserList *twitter_user_list_new_from_data  (const gchar      *buffer);
 gboolean         twitter_user_list_load_from_data (TwitterUserList  *user_list,
                                                    const gchar      *buffer,
                                                    GError          **error);
+gchar *          twitter_user_list_to_binary      (TwitterUserList  *user_list,
+                                                   gsize            *length);
+gboolean         twitter_user_list_load_from_binary (TwitterUserList  *user_list,
+                                                     const gchar      *data,
+                                                     gsize             length,
+                                                     GError          **error);
 
 guint            twitter_user_list_get_count      (TwitterUserList  *user_list);
 TwitterUser   *  twitter_user_list_get_id         (TwitterUserList  *user_list,
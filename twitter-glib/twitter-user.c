@@ -47,7 +47,9 @@
 #include <libsoup/soup.h>
 
 #include "twitter-common.h"
+#include "twitter-intern-pool.h"
 #include "twitter-marshal.h"
+#include "twitter-parse-pool.h"
 #include "twitter-private.h"
 #include "twitter-user.h"
 
@@ -58,11 +60,11 @@ struct _TwitterUserPrivate
   gchar *name;
   gchar *url;
   gchar *description;
-  gchar *location;
+  const gchar *location;
   gchar *screen_name;
-  gchar *profile_image_url;
+  const gchar *profile_image_url;
   gchar *created_at;
-  gchar *time_zone;
+  const gchar *time_zone;
 
   guint id;
   guint friends_count;
@@ -72,6 +74,9 @@ struct _TwitterUserPrivate
 
   gint utc_offset;
 
+  /* created_at, in seconds from the epoch */
+  gint64 timestamp;
+
   guint protected : 1;
   guint following : 1;
 
@@ -80,8 +85,22 @@ struct _TwitterUserPrivate
   GdkPixbuf *profile_image;
 
   guint profile_image_load : 1;
+  guint shared_session     : 1;
 
   SoupSession *async_session;
+
+  /* owns every string but the interned ones, when set */
+  TwitterStringArena *arena;
+
+  /* strings decoded on demand, see TWITTER_PARSE_LAZY */
+  TwitterJsonBuffer *raw;
+  TwitterJsonSpan name_span;
+  TwitterJsonSpan url_span;
+  TwitterJsonSpan description_span;
+  TwitterJsonSpan location_span;
+  TwitterJsonSpan profile_image_url_span;
+  TwitterJsonSpan created_at_span;
+  TwitterJsonSpan time_zone_span;
 };
 
 enum
@@ -104,7 +123,8 @@ enum
   PROP_FAVORITES_COUNT,
   PROP_CREATED_AT,
   PROP_TIME_ZONE,
-  PROP_UTC_OFFSET
+  PROP_UTC_OFFSET,
+  PROP_TIMESTAMP
 };
 
 enum
@@ -123,14 +143,23 @@ twitter_user_finalize (GObject *gobject)
 {
   TwitterUserPrivate *priv = TWITTER_USER (gobject)->priv;
 
-  g_free (priv->name);
-  g_free (priv->url);
-  g_free (priv->description);
-  g_free (priv->location);
-  g_free (priv->screen_name);
-  g_free (priv->profile_image_url);
-  g_free (priv->created_at);
-  g_free (priv->time_zone);
+  _twitter_intern_pool_release (priv->location);
+  _twitter_intern_pool_release (priv->profile_image_url);
+  _twitter_intern_pool_release (priv->time_zone);
+
+  if (priv->arena)
+    _twitter_string_arena_unref (priv->arena);
+  else
+    {
+      g_free (priv->name);
+      g_free (priv->url);
+      g_free (priv->description);
+      g_free (priv->screen_name);
+      g_free (priv->created_at);
+    }
+
+  if (priv->raw)
+    _twitter_json_buffer_unref (priv->raw);
 
   G_OBJECT_CLASS (twitter_user_parent_class)->finalize (gobject);
 }
@@ -154,7 +183,10 @@ twitter_user_dispose (GObject *gobject)
 
   if (priv->async_session)
     {
-      soup_session_abort (priv->async_session);
+      /* a shared session might still be used by other users */
+      if (!priv->shared_session)
+        soup_session_abort (priv->async_session);
+
       g_object_unref (priv->async_session);
       priv->async_session = NULL;
     }
@@ -168,24 +200,25 @@ twitter_user_get_property (GObject    *gobject,
                            GValue     *value,
                            GParamSpec *pspec)
 {
-  TwitterUserPrivate *priv = TWITTER_USER (gobject)->priv;
+  TwitterUser *user = TWITTER_USER (gobject);
+  TwitterUserPrivate *priv = user->priv;
 
   switch (prop_id)
     {
     case PROP_NAME:
-      g_value_set_string (value, priv->name);
+      g_value_set_string (value, twitter_user_get_name (user));
       break;
 
     case PROP_URL:
-      g_value_set_string (value, priv->url);
+      g_value_set_string (value, twitter_user_get_url (user));
       break;
 
     case PROP_DESCRIPTION:
-      g_value_set_string (value, priv->description);
+      g_value_set_string (value, twitter_user_get_description (user));
       break;
 
     case PROP_LOCATION:
-      g_value_set_string (value, priv->location);
+      g_value_set_string (value, twitter_user_get_location (user));
       break;
 
     case PROP_SCREEN_NAME:
@@ -193,7 +226,7 @@ twitter_user_get_property (GObject    *gobject,
       break;
 
     case PROP_PROFILE_IMAGE_URL:
-      g_value_set_string (value, priv->profile_image_url);
+      g_value_set_string (value, twitter_user_get_profile_image_url (user));
       break;
 
     case PROP_ID:
@@ -225,17 +258,21 @@ twitter_user_get_property (GObject    *gobject,
       break;
 
     case PROP_CREATED_AT:
-      g_value_set_string (value, priv->created_at);
+      g_value_set_string (value, twitter_user_get_created_at (user));
       break;
 
     case PROP_TIME_ZONE:
-      g_value_set_string (value, priv->time_zone);
+      g_value_set_string (value, twitter_user_get_time_zone (user));
       break;
 
     case PROP_UTC_OFFSET:
       g_value_set_int (value, priv->utc_offset);
       break;
 
+    case PROP_TIMESTAMP:
+      g_value_set_int64 (value, priv->timestamp);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
       break;
@@ -373,6 +410,21 @@ twitter_user_class_init (TwitterUserClass *klass)
                                                      G_MININT, G_MAXINT, 0,
                                                      G_PARAM_READABLE));
 
+  /**
+   * TwitterUser:timestamp:
+   *
+   * The creation date of the user, in seconds from the epoch
+   *
+   * Since: 0.9.10
+   */
+  g_object_class_install_property (gobject_class,
+                                   PROP_TIMESTAMP,
+                                   g_param_spec_int64 ("timestamp",
+                                                       "Timestamp",
+                                                       "The creation date of the user",
+                                                       G_MININT64, G_MAXINT64, 0,
+                                                       G_PARAM_READABLE));
+
   /**
    * TwitterUser::changed:
    * @user: the #TwitterUser that emitted the signal
@@ -401,17 +453,71 @@ twitter_user_clean (TwitterUser *user)
 {
   TwitterUserPrivate *priv = user->priv;
 
-  g_free (priv->name);
-  g_free (priv->url);
-  g_free (priv->description);
-  g_free (priv->location);
-  g_free (priv->screen_name);
-  g_free (priv->profile_image_url);
-  g_free (priv->created_at);
-  g_free (priv->time_zone);
+  if (priv->arena)
+    {
+      _twitter_string_arena_unref (priv->arena);
+      priv->arena = NULL;
+    }
+  else
+    {
+      g_free (priv->name);
+      g_free (priv->url);
+      g_free (priv->description);
+      g_free (priv->screen_name);
+      g_free (priv->created_at);
+    }
+
+  priv->name = NULL;
+  priv->url = NULL;
+  priv->description = NULL;
+  priv->screen_name = NULL;
+  priv->created_at = NULL;
+  priv->timestamp = 0;
+
+  _twitter_intern_pool_release (priv->location);
+  priv->location = NULL;
+
+  _twitter_intern_pool_release (priv->profile_image_url);
+  priv->profile_image_url = NULL;
+
+  _twitter_intern_pool_release (priv->time_zone);
+  priv->time_zone = NULL;
+
+  memset (&priv->name_span, 0, sizeof (TwitterJsonSpan));
+  memset (&priv->url_span, 0, sizeof (TwitterJsonSpan));
+  memset (&priv->description_span, 0, sizeof (TwitterJsonSpan));
+  memset (&priv->location_span, 0, sizeof (TwitterJsonSpan));
+  memset (&priv->profile_image_url_span, 0, sizeof (TwitterJsonSpan));
+  memset (&priv->created_at_span, 0, sizeof (TwitterJsonSpan));
+  memset (&priv->time_zone_span, 0, sizeof (TwitterJsonSpan));
+
+  if (priv->raw)
+    {
+      _twitter_json_buffer_unref (priv->raw);
+      priv->raw = NULL;
+    }
 
   if (priv->status)
-    g_object_unref (priv->status);
+    {
+      g_object_unref (priv->status);
+      priv->status = NULL;
+    }
+}
+
+/* keeps alive the buffer lazily decoded strings point into */
+static void
+twitter_user_hold_buffer (TwitterUser       *user,
+                          TwitterJsonBuffer *buffer)
+{
+  TwitterUserPrivate *priv = user->priv;
+
+  if (priv->raw == buffer)
+    return;
+
+  if (priv->raw)
+    _twitter_json_buffer_unref (priv->raw);
+
+  priv->raw = _twitter_json_buffer_ref (buffer);
 }
 
 static void
@@ -441,7 +547,7 @@ twitter_user_build (TwitterUser *user,
 
   member = json_object_get_member (obj, "location");
   if (member)
-    priv->location = json_node_dup_string (member);
+    priv->location = _twitter_intern_pool_acquire (json_node_get_string (member), -1);
     
   member = json_object_get_member (obj, "screen_name");
   if (member)
@@ -449,7 +555,7 @@ twitter_user_build (TwitterUser *user,
 
   member = json_object_get_member (obj, "profile_image_url");
   if (member)
-    priv->profile_image_url = json_node_dup_string (member);
+    priv->profile_image_url = _twitter_intern_pool_acquire (json_node_get_string (member), -1);
 
   member = json_object_get_member (obj, "id");
   if (member)
@@ -495,17 +601,340 @@ twitter_user_build (TwitterUser *user,
 
   member = json_object_get_member (obj, "created_at");
   if (member)
-    priv->created_at = json_node_dup_string (member);
+    {
+      priv->created_at = json_node_dup_string (member);
+      priv->timestamp = _twitter_date_to_timestamp (priv->created_at, -1);
+    }
 
   member = json_object_get_member (obj, "time_zone");
   if (member)
-    priv->time_zone = json_node_dup_string (member);
+    priv->time_zone = _twitter_intern_pool_acquire (json_node_get_string (member), -1);
 
   member = json_object_get_member (obj, "utc_offset");
   if (member)
     priv->utc_offset = json_node_get_int (member);
 }
 
+/* the single pass equivalent of twitter_user_build(), decoding
+ * the object at the cursor of @decoder into an empty @user
+ */
+void
+_twitter_user_decode (TwitterUser        *user,
+                      TwitterJsonDecoder *decoder)
+{
+  TwitterUserPrivate *priv = user->priv;
+  const gchar *key;
+  gsize len;
+
+  if (!_twitter_json_decoder_begin_object (decoder))
+    {
+      _twitter_json_decoder_skip (decoder);
+      return;
+    }
+
+  /* the strings already allocated with g_malloc() must be freed
+   * the same way, so we only move to the arena of the decoder if
+   * there are none
+   */
+  if (decoder->arena != NULL && priv->arena == NULL &&
+      priv->name == NULL &&
+      priv->url == NULL &&
+      priv->description == NULL &&
+      priv->screen_name == NULL &&
+      priv->created_at == NULL)
+    priv->arena = _twitter_string_arena_ref (decoder->arena);
+
+  while (_twitter_json_decoder_next_member (decoder, &key, &len))
+    {
+      switch (len)
+        {
+        case 2:
+          if (TWITTER_JSON_KEY_IS (key, len, "id"))
+            {
+              priv->id = _twitter_json_decoder_read_int (decoder);
+              continue;
+            }
+          break;
+
+        case 3:
+          if (TWITTER_JSON_KEY_IS (key, len, "url"))
+            {
+              if (_twitter_json_decoder_read_lazy_string (decoder,
+                                                          priv->arena,
+                                                          &priv->url,
+                                                          &priv->url_span))
+                twitter_user_hold_buffer (user, decoder->buffer);
+              continue;
+            }
+          break;
+
+        case 4:
+          if (TWITTER_JSON_KEY_IS (key, len, "name"))
+            {
+              if (_twitter_json_decoder_read_lazy_string (decoder,
+                                                          priv->arena,
+                                                          &priv->name,
+                                                          &priv->name_span))
+                twitter_user_hold_buffer (user, decoder->buffer);
+              continue;
+            }
+          break;
+
+        case 6:
+          if (TWITTER_JSON_KEY_IS (key, len, "status"))
+            {
+              if (priv->status)
+                g_object_unref (priv->status);
+
+              priv->status = twitter_status_new ();
+              _twitter_status_decode (priv->status, decoder);
+              g_object_ref_sink (priv->status);
+
+              /* back link, see twitter_user_build() */
+              _twitter_status_set_user (priv->status, user);
+              continue;
+            }
+          break;
+
+        case 8:
+          if (TWITTER_JSON_KEY_IS (key, len, "location"))
+            {
+              if (_twitter_json_decoder_read_interned (decoder,
+                                                       &priv->location,
+                                                       &priv->location_span))
+                twitter_user_hold_buffer (user, decoder->buffer);
+              continue;
+            }
+          break;
+
+        case 9:
+          if (TWITTER_JSON_KEY_IS (key, len, "protected"))
+            {
+              priv->protected = _twitter_json_decoder_read_boolean (decoder);
+              continue;
+            }
+          else if (TWITTER_JSON_KEY_IS (key, len, "following"))
+            {
+              priv->following = _twitter_json_decoder_read_boolean (decoder);
+              continue;
+            }
+          else if (TWITTER_JSON_KEY_IS (key, len, "time_zone"))
+            {
+              if (_twitter_json_decoder_read_interned (decoder,
+                                                       &priv->time_zone,
+                                                       &priv->time_zone_span))
+                twitter_user_hold_buffer (user, decoder->buffer);
+              continue;
+            }
+          break;
+
+        case 10:
+          if (TWITTER_JSON_KEY_IS (key, len, "created_at"))
+            {
+              if (_twitter_json_decoder_read_lazy_string (decoder,
+                                                          priv->arena,
+                                                          &priv->created_at,
+                                                          &priv->created_at_span))
+                twitter_user_hold_buffer (user, decoder->buffer);
+              continue;
+            }
+          else if (TWITTER_JSON_KEY_IS (key, len, "utc_offset"))
+            {
+              priv->utc_offset = _twitter_json_decoder_read_int (decoder);
+              continue;
+            }
+          break;
+
+        case 11:
+          if (TWITTER_JSON_KEY_IS (key, len, "description"))
+            {
+              if (_twitter_json_decoder_read_lazy_string (decoder,
+                                                          priv->arena,
+                                                          &priv->description,
+                                                          &priv->description_span))
+                twitter_user_hold_buffer (user, decoder->buffer);
+              continue;
+            }
+          else if (TWITTER_JSON_KEY_IS (key, len, "screen_name"))
+            {
+              _twitter_json_decoder_read_field (decoder, priv->arena,
+                                                &priv->screen_name);
+              continue;
+            }
+          break;
+
+        case 13:
+          if (TWITTER_JSON_KEY_IS (key, len, "friends_count"))
+            {
+              priv->friends_count = _twitter_json_decoder_read_int (decoder);
+              continue;
+            }
+          break;
+
+        case 14:
+          if (TWITTER_JSON_KEY_IS (key, len, "statuses_count"))
+            {
+              priv->statuses_count = _twitter_json_decoder_read_int (decoder);
+              continue;
+            }
+          break;
+
+        case 15:
+          if (TWITTER_JSON_KEY_IS (key, len, "followers_count"))
+            {
+              priv->followers_count = _twitter_json_decoder_read_int (decoder);
+              continue;
+            }
+          break;
+
+        case 16:
+          if (TWITTER_JSON_KEY_IS (key, len, "favourites_count"))
+            {
+              priv->favorites_count = _twitter_json_decoder_read_int (decoder);
+              continue;
+            }
+          break;
+
+        case 17:
+          if (TWITTER_JSON_KEY_IS (key, len, "profile_image_url"))
+            {
+              if (_twitter_json_decoder_read_interned (decoder,
+                                                       &priv->profile_image_url,
+                                                       &priv->profile_image_url_span))
+                twitter_user_hold_buffer (user, decoder->buffer);
+              continue;
+            }
+          break;
+
+        default:
+          break;
+        }
+
+      _twitter_json_decoder_skip (decoder);
+    }
+
+  /* the raw span of a lazy string is still quoted */
+  if (priv->created_at != NULL)
+    priv->timestamp = _twitter_date_to_timestamp (priv->created_at, -1);
+  else if (priv->created_at_span.start != NULL)
+    priv->timestamp =
+      _twitter_date_to_timestamp (priv->created_at_span.start + 1,
+                                  priv->created_at_span.length - 2);
+}
+
+/* appends the fields of @user to @record; the last status of the
+ * user is not written
+ */
+void
+_twitter_user_write_record (TwitterUser         *user,
+                            TwitterRecordWriter *record)
+{
+  TwitterUserPrivate *priv = user->priv;
+
+  _twitter_record_write_uint32 (record, priv->id);
+  _twitter_record_write_uint32 (record, priv->friends_count);
+  _twitter_record_write_uint32 (record, priv->statuses_count);
+  _twitter_record_write_uint32 (record, priv->followers_count);
+  _twitter_record_write_uint32 (record, priv->favorites_count);
+  _twitter_record_write_uint32 (record, (guint32) priv->utc_offset);
+  _twitter_record_write_int64 (record, priv->timestamp);
+  _twitter_record_write_uint32 (record, (priv->protected ? 1 : 0)
+                                      | (priv->following ? 2 : 0));
+
+  _twitter_record_write_string (record, priv->screen_name);
+  _twitter_record_write_string (record, twitter_user_get_name (user));
+  _twitter_record_write_string (record, twitter_user_get_url (user));
+  _twitter_record_write_string (record, twitter_user_get_description (user));
+  _twitter_record_write_string (record, twitter_user_get_location (user));
+  _twitter_record_write_string (record, twitter_user_get_profile_image_url (user));
+  _twitter_record_write_string (record, twitter_user_get_created_at (user));
+  _twitter_record_write_string (record, twitter_user_get_time_zone (user));
+}
+
+/* reads the fields written by _twitter_user_write_record() into an
+ * empty @user. Returns %FALSE if the record is truncated
+ */
+gboolean
+_twitter_user_read_record (TwitterUser         *user,
+                           TwitterRecordReader *reader)
+{
+  TwitterUserPrivate *priv = user->priv;
+  guint32 flags;
+
+  priv->id = _twitter_record_read_uint32 (reader);
+  priv->friends_count = _twitter_record_read_uint32 (reader);
+  priv->statuses_count = _twitter_record_read_uint32 (reader);
+  priv->followers_count = _twitter_record_read_uint32 (reader);
+  priv->favorites_count = _twitter_record_read_uint32 (reader);
+  priv->utc_offset = (gint32) _twitter_record_read_uint32 (reader);
+  priv->timestamp = _twitter_record_read_int64 (reader);
+
+  flags = _twitter_record_read_uint32 (reader);
+  priv->protected = (flags & 1) != 0;
+  priv->following = (flags & 2) != 0;
+
+  priv->screen_name = _twitter_record_read_string (reader);
+  priv->name = _twitter_record_read_string (reader);
+  priv->url = _twitter_record_read_string (reader);
+  priv->description = _twitter_record_read_string (reader);
+  priv->location = _twitter_record_read_interned (reader);
+  priv->profile_image_url = _twitter_record_read_interned (reader);
+  priv->created_at = _twitter_record_read_string (reader);
+  priv->time_zone = _twitter_record_read_interned (reader);
+
+  if (_twitter_record_reader_failed (reader))
+    {
+      twitter_user_clean (user);
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+/* decodes @buffer using the single pass decoder, unless the
+ * application asked for json-glib; returns %FALSE if json-glib
+ * should be used instead
+ */
+static gboolean
+twitter_user_decode_data (TwitterUser *user,
+                          const gchar *buffer)
+{
+  TwitterParseFlags flags = twitter_get_parse_flags ();
+  TwitterJsonDecoder decoder;
+  gboolean retval;
+
+  if (flags & TWITTER_PARSE_USE_JSON_GLIB)
+    return FALSE;
+
+  if (flags & TWITTER_PARSE_LAZY)
+    {
+      TwitterJsonBuffer *raw;
+
+      raw = _twitter_json_buffer_new (buffer, strlen (buffer));
+      _twitter_json_decoder_init_lazy (&decoder, raw, raw->data, raw->length);
+      _twitter_user_decode (user, &decoder);
+
+      retval = _twitter_json_decoder_at_end (&decoder);
+
+      _twitter_json_buffer_unref (raw);
+    }
+  else
+    {
+      _twitter_json_decoder_init (&decoder, buffer, strlen (buffer));
+      _twitter_user_decode (user, &decoder);
+
+      retval = _twitter_json_decoder_at_end (&decoder);
+    }
+
+  if (retval)
+    return TRUE;
+
+  /* json-glib will report the error */
+  twitter_user_clean (user);
+
+  return FALSE;
+}
+
 TwitterUser *
 twitter_user_new (void)
 {
@@ -536,7 +965,10 @@ twitter_user_new_from_data (const gchar *buffer)
 
   retval = twitter_user_new ();
 
-  parser = json_parser_new ();
+  if (twitter_user_decode_data (retval, buffer))
+    return retval;
+
+  parser = _twitter_parse_pool_get_parser ();
   parse_error = NULL;
   json_parser_load_from_data (parser, buffer, -1, &parse_error);
   if (parse_error)
@@ -548,7 +980,7 @@ twitter_user_new_from_data (const gchar *buffer)
   else
     twitter_user_build (retval, json_parser_get_root (parser));
 
-  g_object_unref (parser);
+  _twitter_parse_pool_put_parser (parser);
 
   return retval;
 }
@@ -567,7 +999,10 @@ twitter_user_load_from_data (TwitterUser  *user,
 
   twitter_user_clean (user);
 
-  parser = json_parser_new ();
+  if (twitter_user_decode_data (user, buffer))
+    return TRUE;
+
+  parser = _twitter_parse_pool_get_parser ();
   parse_error = NULL;
   json_parser_load_from_data (parser, buffer, -1, &parse_error);
   if (parse_error)
@@ -584,7 +1019,79 @@ twitter_user_load_from_data (TwitterUser  *user,
   else
     twitter_user_build (user, json_parser_get_root (parser));
 
-  g_object_unref (parser);
+  _twitter_parse_pool_put_parser (parser);
+
+  return retval;
+}
+
+/**
+ * twitter_user_to_binary:
+ * @user: a #TwitterUser
+ * @length: return location for the length of the data
+ *
+ * Saves @user using a compact binary format, which can be loaded
+ * back using twitter_user_load_from_binary(). See
+ * twitter_status_to_binary() for the details
+ *
+ * Return value: a newly allocated buffer. Use g_free() to free it
+ *
+ * Since: 0.9.10
+ */
+gchar *
+twitter_user_to_binary (TwitterUser *user,
+                        gsize       *length)
+{
+  TwitterRecordWriter writer;
+
+  g_return_val_if_fail (TWITTER_IS_USER (user), NULL);
+  g_return_val_if_fail (length != NULL, NULL);
+
+  _twitter_record_writer_init (&writer, TRUE);
+  _twitter_user_write_record (user, &writer);
+
+  return _twitter_record_writer_finish (&writer, TWITTER_RECORD_USER, length);
+}
+
+/**
+ * twitter_user_load_from_binary:
+ * @user: a #TwitterUser
+ * @data: the data saved by twitter_user_to_binary()
+ * @length: the length of @data
+ * @error: return location for a #GError, or %NULL
+ *
+ * Loads the contents of @user out of the binary data saved by
+ * twitter_user_to_binary()
+ *
+ * Return value: %TRUE if the data was loaded
+ *
+ * Since: 0.9.10
+ */
+gboolean
+twitter_user_load_from_binary (TwitterUser  *user,
+                               const gchar  *data,
+                               gsize         length,
+                               GError      **error)
+{
+  TwitterRecordReader reader;
+  gboolean retval;
+
+  g_return_val_if_fail (TWITTER_IS_USER (user), FALSE);
+  g_return_val_if_fail (data != NULL, FALSE);
+
+  twitter_user_clean (user);
+
+  if (!_twitter_record_reader_init_binary (&reader, data, length,
+                                           TWITTER_RECORD_USER,
+                                           error))
+    return FALSE;
+
+  retval = _twitter_user_read_record (user, &reader);
+  if (!retval)
+    g_set_error (error, TWITTER_ERROR,
+                 TWITTER_ERROR_PARSE_ERROR,
+                 "Invalid binary data");
+
+  _twitter_record_reader_clear (&reader);
 
   return retval;
 }
@@ -594,7 +1101,9 @@ twitter_user_get_name (TwitterUser *user)
 {
   g_return_val_if_fail (TWITTER_IS_USER (user), NULL);
 
-  return user->priv->name;
+  return _twitter_json_span_materialize (&user->priv->name,
+                                         &user->priv->name_span,
+                                         user->priv->arena);
 }
 
 G_CONST_RETURN gchar *
@@ -602,7 +1111,9 @@ twitter_user_get_url (TwitterUser *user)
 {
   g_return_val_if_fail (TWITTER_IS_USER (user), NULL);
 
-  return user->priv->url;
+  return _twitter_json_span_materialize (&user->priv->url,
+                                         &user->priv->url_span,
+                                         user->priv->arena);
 }
 
 G_CONST_RETURN gchar *
@@ -610,7 +1121,9 @@ twitter_user_get_description (TwitterUser *user)
 {
   g_return_val_if_fail (TWITTER_IS_USER (user), NULL);
 
-  return user->priv->description;
+  return _twitter_json_span_materialize (&user->priv->description,
+                                         &user->priv->description_span,
+                                         user->priv->arena);
 }
 
 G_CONST_RETURN gchar *
@@ -618,7 +1131,8 @@ twitter_user_get_location (TwitterUser *user)
 {
   g_return_val_if_fail (TWITTER_IS_USER (user), NULL);
 
-  return user->priv->location;
+  return _twitter_json_span_materialize_interned (&user->priv->location,
+                                                  &user->priv->location_span);
 }
 
 G_CONST_RETURN gchar *
@@ -634,7 +1148,8 @@ twitter_user_get_profile_image_url (TwitterUser *user)
 {
   g_return_val_if_fail (TWITTER_IS_USER (user), NULL);
 
-  return user->priv->profile_image_url;
+  return _twitter_json_span_materialize_interned (&user->priv->profile_image_url,
+                                                  &user->priv->profile_image_url_span);
 }
 
 typedef struct {
@@ -851,7 +1366,7 @@ twitter_user_get_profile_image (TwitterUser *user)
 
   priv = user->priv;
 
-  if (!priv->profile_image_url)
+  if (!twitter_user_get_profile_image_url (user))
     return NULL;
 
   if (priv->profile_image)
@@ -978,7 +1493,9 @@ twitter_user_get_created_at (TwitterUser *user)
 {
   g_return_val_if_fail (TWITTER_IS_USER (user), NULL);
 
-  return user->priv->created_at;
+  return _twitter_json_span_materialize (&user->priv->created_at,
+                                         &user->priv->created_at_span,
+                                         user->priv->arena);
 }
 
 G_CONST_RETURN gchar *
@@ -986,7 +1503,8 @@ twitter_user_get_time_zone (TwitterUser *user)
 {
   g_return_val_if_fail (TWITTER_IS_USER (user), NULL);
 
-  return user->priv->time_zone;
+  return _twitter_json_span_materialize_interned (&user->priv->time_zone,
+                                                  &user->priv->time_zone_span);
 }
 
 gint
@@ -996,3 +1514,118 @@ twitter_user_get_utc_offset (TwitterUser *user)
 
   return user->priv->utc_offset;
 }
+
+/**
+ * twitter_user_get_timestamp:
+ * @user: a #TwitterUser
+ *
+ * Retrieves the creation date of @user, as parsed when @user
+ * was loaded
+ *
+ * Return value: the seconds from the epoch, or 0 if the date is
+ *   not known
+ *
+ * Since: 0.9.10
+ */
+gint64
+twitter_user_get_timestamp (TwitterUser *user)
+{
+  g_return_val_if_fail (TWITTER_IS_USER (user), 0);
+
+  return user->priv->timestamp;
+}
+
+void
+_twitter_user_set_session (TwitterUser *user,
+                           SoupSession *session)
+{
+  TwitterUserPrivate *priv;
+
+  g_return_if_fail (TWITTER_IS_USER (user));
+  g_return_if_fail (SOUP_IS_SESSION (session));
+
+  priv = user->priv;
+
+  if (priv->async_session == session)
+    return;
+
+  /* a profile image download might be in flight using the old session */
+  if (priv->profile_image_load)
+    return;
+
+  if (priv->async_session)
+    {
+      if (!priv->shared_session)
+        soup_session_abort (priv->async_session);
+
+      g_object_unref (priv->async_session);
+    }
+
+  priv->async_session = g_object_ref (session);
+  priv->shared_session = TRUE;
+}
+
+/* refreshes @user with the fields of @source, a newer copy of the
+ * same user; the profile image already loaded is kept unless its URL
+ * changed. Emits TwitterUser::changed if anything was updated
+ */
+void
+_twitter_user_update (TwitterUser *user,
+                      TwitterUser *source)
+{
+  TwitterUserPrivate *priv;
+  TwitterStatus *status;
+  gchar *data, *old_data;
+  gsize length, old_length;
+  gboolean same_image;
+
+  g_return_if_fail (TWITTER_IS_USER (user));
+  g_return_if_fail (TWITTER_IS_USER (source));
+
+  priv = user->priv;
+
+  if (user == source)
+    return;
+
+  data = twitter_user_to_binary (source, &length);
+  old_data = twitter_user_to_binary (user, &old_length);
+
+  if (source->priv->status == NULL &&
+      length == old_length &&
+      memcmp (data, old_data, length) == 0)
+    goto out;
+
+  /* the URLs are interned, so they can be compared directly */
+  same_image = twitter_user_get_profile_image_url (user) ==
+               twitter_user_get_profile_image_url (source);
+
+  /* the last status is not part of the record; keep the back link
+   * of the status pointing to @user
+   */
+  status = source->priv->status;
+  if (status != NULL)
+    {
+      g_object_ref (status);
+      _twitter_status_set_user (status, user);
+    }
+  else
+    {
+      status = priv->status;
+      priv->status = NULL;
+    }
+
+  twitter_user_load_from_binary (user, data, length, NULL);
+  priv->status = status;
+
+  if (!same_image && priv->profile_image != NULL)
+    {
+      g_object_unref (priv->profile_image);
+      priv->profile_image = NULL;
+    }
+
+  g_signal_emit (user, user_signals[CHANGED], 0);
+
+out:
+  g_free (data);
+  g_free (old_data);
+}
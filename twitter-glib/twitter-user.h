@@ -71,6 +71,12 @@ TwitterUser *         twitter_user_new_from_data         (const gchar  *buffer);
 gboolean              twitter_user_load_from_data        (TwitterUser  *user,
                                                           const gchar  *buffer,
                                                           GError      **error);
+gchar *               twitter_user_to_binary             (TwitterUser  *user,
+                                                          gsize        *length);
+gboolean              twitter_user_load_from_binary      (TwitterUser  *user,
+                                                          const gchar  *data,
+                                                          gsize         length,
+                                                          GError      **error);
 
 G_CONST_RETURN gchar *twitter_user_get_name              (TwitterUser  *user);
 G_CONST_RETURN gchar *twitter_user_get_url               (TwitterUser  *user);
@@ -91,6 +97,7 @@ guint                 twitter_user_get_favorites_count   (TwitterUser  *user);
 G_CONST_RETURN gchar *twitter_user_get_created_at        (TwitterUser  *user);
 G_CONST_RETURN gchar *twitter_user_get_time_zone         (TwitterUser  *user);
 gint                  twitter_user_get_utc_offset        (TwitterUser  *user);
+gint64                twitter_user_get_timestamp         (TwitterUser  *user);
 
 GdkPixbuf *           twitter_user_get_profile_image     (TwitterUser  *user);
 